@@ -0,0 +1,114 @@
+/*
+ * バッファ管理性能測定プログラム
+ *
+ * 使い方:
+ *	./bench-buffer [バッファ数] [操作回数]
+ *
+ * バッファに載っているページの読み出し(ヒット)と、
+ * 追い出しをともなう読み出し・書き出しの1回あたりの時間を測る。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "bench.h"
+
+/*
+ * テスト名
+ */
+#define TEST_NAME "bench-buffer"
+
+/*
+ * 測定用ファイルのファイル名
+ */
+#define BENCH_FILE "benchfile"
+
+/*
+ * デフォルトのバッファ数と操作回数
+ */
+#define DEFAULT_NUM_BUFFER 256
+#define DEFAULT_NUM_OPERATION 1000000
+
+/*
+ * main -- バッファ管理の性能測定
+ */
+int main(int argc, char **argv)
+{
+    File *file;
+    char page[PAGE_SIZE];
+    int numBuffer = DEFAULT_NUM_BUFFER;
+    int numOperation = DEFAULT_NUM_OPERATION;
+    int numPage;
+    int i;
+    unsigned int seed = 1;
+    double start, elapsed;
+
+    if (argc > 1) {
+	numBuffer = atoi(argv[1]);
+    }
+    if (argc > 2) {
+	numOperation = atoi(argv[2]);
+    }
+
+    if (initializeFileModuleWithOption(numBuffer, NULL) != OK) {
+	fprintf(stderr, "%s: initialization failed.\n", TEST_NAME);
+	exit(1);
+    }
+
+    /* バッファ数の2倍のページを持つファイルを作る */
+    numPage = numBuffer * 2;
+    deleteFile(BENCH_FILE);
+    if (createFile(BENCH_FILE) != OK || (file = openFile(BENCH_FILE)) == NULL) {
+	fprintf(stderr, "Cannot create file.\n");
+	exit(1);
+    }
+    memset(page, 0, PAGE_SIZE);
+    for (i = 0; i < numPage; i++) {
+	writePage(file, i, page);
+    }
+    closeFile(file);
+
+    if ((file = openFile(BENCH_FILE)) == NULL) {
+	fprintf(stderr, "Cannot open file.\n");
+	exit(1);
+    }
+
+    /* バッファにnumBuffer枚のページを載せる */
+    for (i = 0; i < numBuffer; i++) {
+	readPage(file, i, page);
+    }
+
+    /* 1. すべてヒットするランダムな読み出し */
+    start = getTime();
+    for (i = 0; i < numOperation; i++) {
+	readPage(file, rand_r(&seed) % numBuffer, page);
+    }
+    elapsed = getTime() - start;
+    printf("%d buffers: lookup (hit)        %8.1f ns/op\n",
+	   numBuffer, elapsed * 1e9 / numOperation);
+
+    /* 2. 毎回追い出しが起きる読み出し(変更なしのページ) */
+    start = getTime();
+    for (i = 0; i < numOperation; i++) {
+	readPage(file, i % numPage, page);
+    }
+    elapsed = getTime() - start;
+    printf("%d buffers: evict clean (read)  %8.1f ns/op\n",
+	   numBuffer, elapsed * 1e9 / numOperation);
+
+    /* 3. 毎回追い出しと書き戻しが起きる書き出し */
+    start = getTime();
+    for (i = 0; i < numOperation; i++) {
+	writePage(file, i % numPage, page);
+    }
+    elapsed = getTime() - start;
+    printf("%d buffers: evict dirty (write) %8.1f ns/op\n",
+	   numBuffer, elapsed * 1e9 / numOperation);
+
+    closeFile(file);
+    finalizeFileModule();
+    deleteFile(BENCH_FILE);
+
+    return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ * クラッキング(適応型索引)による検索の性能測定プログラム
+ *
+ * 使い方:
+ *	./bench-crack [行数]
+ *
+ * bench(id integer, val integer, pad string)の形式の固定長形式のテーブルに
+ * 指定した行数(省略時は1000000)のレコードを挿入し、valについての検索
+ * (ランダムな値の=と、ランダムな小さな値の<)を繰り返したときの1回あたりの時間と
+ * 読んだページの数を、最初の1回、2〜10回目、11〜100回目、101〜1000回目に分けて測る。
+ * valの値は挿入の順とは無関係にばらばらにしてある。
+ * crackを指定しないテーブル(毎回テーブル全体を読む)と、crackを指定したテーブルで比べる。
+ * crackを指定したテーブルでは、クラッカー列がある状態での挿入の時間も測る。
+ * 最初の検索の時間には、クラッカー列を作るためにテーブル全体を読む時間が含まれる
+ * (そのページは読んだページ数には数えない)。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "bench.h"
+
+/*
+ * テスト名
+ */
+#define TEST_NAME "bench-crack"
+
+/*
+ * 測定用テーブルのテーブル名
+ */
+#define BENCH_TABLE "benchcrack"
+
+/*
+ * デフォルトの行数、crackを指定しないテーブルで検索する回数、
+ * crackを指定したテーブルで検索する回数、クラッカー列がある状態で挿入する行数
+ */
+#define DEFAULT_NUM_ROW 1000000
+#define NUM_SCAN_QUERY 3
+#define NUM_CRACK_QUERY 1000
+#define NUM_CRACKED_INSERT 10000
+
+/*
+ * LESS_THAN_RANGE -- <の条件の値の上限(<の検索で見つかるレコードはこれより少ない)
+ */
+#define LESS_THAN_RANGE 1000
+
+/*
+ * VALUE -- n番目のレコードのvalの値(0からMAX_VALUE - 1まで)
+ *
+ * 挿入の順と値の順が一致するとゾーンマップで読み飛ばせてしまうので、
+ * 素数を法とする掛け算で値をばらばらにする。
+ */
+#define MAX_VALUE 10000000
+#define VALUE(n) ((int) ((long long) (n) * 48271 % 2147483647 % MAX_VALUE))
+
+/*
+ * createBenchTable -- 測定用テーブルの作成
+ */
+Result createBenchTable(int crack)
+{
+    TableInfo tableInfo;
+    TableOption option;
+
+    tableInfo.numField = 0;
+    addTableField(&tableInfo, "id", TYPE_INTEGER);
+    addTableField(&tableInfo, "val", TYPE_INTEGER);
+    addTableField(&tableInfo, "pad", TYPE_STRING);
+
+    memset(&option, 0, sizeof(option));
+    option.layout = LAYOUT_FIXED;
+    option.crack[1] = crack;
+    return recreateTable(BENCH_TABLE, &tableInfo, &option);
+}
+
+/*
+ * makeRecord -- n番目に挿入するレコードを作る
+ */
+void makeRecord(RecordData *record, int n)
+{
+    record->numField = 0;
+    addIntField(record, "id", n);
+    addIntField(record, "val", VALUE(n));
+    addStringField(record, "pad", "p%08d", n);
+}
+
+/*
+ * insertRows -- n番目から(n + numRow - 1)番目までのレコードを挿入する
+ */
+Result insertRows(int n, int numRow)
+{
+    RecordData record;
+    int i;
+
+    for (i = n; i < n + numRow; i++) {
+	makeRecord(&record, i);
+	if (insertRecord(BENCH_TABLE, &record) != OK) {
+	    fprintf(stderr, "%s: cannot insert record %d.\n", TEST_NAME, i);
+	    return NG;
+	}
+    }
+    return OK;
+}
+
+/*
+ * benchQuery -- valについての検索を繰り返し、区切りごとの時間と読んだページ数を測る
+ *
+ * 検索の条件は、奇数回目はランダムな値の=、偶数回目はLESS_THAN_RANGEより小さい
+ * ランダムな値の<にする。
+ */
+Result benchQuery(char *label, int numQuery, int numRow)
+{
+    static int bounds[] = {1, 10, 100, 1000};
+    RecordSet *recordSet;
+    Condition condition;
+    QueryStat stat;
+    double start;
+    long numPageRead;
+    int numPage = 0;
+    int from;
+    int i, b;
+
+    strcpy(condition.name, "val");
+    condition.dataType = TYPE_INTEGER;
+    condition.distinct = NOT_DISTINCT;
+
+    printf("%s:\n", label);
+    i = 0;
+    for (b = 0; b < (int) (sizeof(bounds) / sizeof(bounds[0])) && i < numQuery; b++) {
+	from = i;
+	numPageRead = 0;
+	start = getTime();
+	for (; i < bounds[b] && i < numQuery; i++) {
+	    if (i % 2 == 0) {
+		condition.operator = OPR_EQUAL;
+		condition.intValue = VALUE(rand() % numRow);
+	    } else {
+		condition.operator = OPR_LESS_THAN;
+		condition.intValue = rand() % LESS_THAN_RANGE;
+	    }
+	    if ((recordSet = selectRecord(BENCH_TABLE, &condition)) == NULL) {
+		fprintf(stderr, "%s: cannot select records.\n", TEST_NAME);
+		return NG;
+	    }
+	    freeRecordSet(recordSet);
+	    getQueryStat(&stat);
+	    numPageRead += stat.numPageRead;
+	    numPage = stat.numPage;
+	}
+	printf("    queries %4d-%-4d %10.3f ms/query, %10.1f/%d data pages read/query\n", from + 1, i,
+	       (getTime() - start) * 1e3 / (i - from), (double) numPageRead / (i - from), numPage);
+    }
+    return OK;
+}
+
+/*
+ * main -- クラッキングによる検索の性能測定
+ */
+int main(int argc, char **argv)
+{
+    double start;
+    int numRow = DEFAULT_NUM_ROW;
+
+    if (argc > 1) {
+	numRow = atoi(argv[1]);
+    }
+
+    if (initializeFileModule() != OK || initializeDataDefModule() != OK
+	|| initializeDataManipModule() != OK) {
+	fprintf(stderr, "%s: initialization failed.\n", TEST_NAME);
+	exit(1);
+    }
+
+    /* crackを指定しないテーブルでは、検索のたびにテーブル全体を読む */
+    if (createBenchTable(0) != OK) {
+	fprintf(stderr, "%s: cannot create table.\n", TEST_NAME);
+	exit(1);
+    }
+    start = getTime();
+    if (insertRows(0, numRow) != OK) {
+	exit(1);
+    }
+    printf("%d rows, %d pages, %.1f s to insert\n", numRow, getNumPages(BENCH_TABLE ".dat"), getTime() - start);
+    srand(1);
+    if (benchQuery("without cracking", NUM_SCAN_QUERY, numRow) != OK) {
+	exit(1);
+    }
+
+    /* crackを指定したテーブルでは、検索を繰り返すほど読むページが減る */
+    if (createBenchTable(1) != OK || insertRows(0, numRow) != OK) {
+	fprintf(stderr, "%s: cannot create table.\n", TEST_NAME);
+	exit(1);
+    }
+    srand(1);
+    if (benchQuery("crack (val)", NUM_CRACK_QUERY, numRow) != OK) {
+	exit(1);
+    }
+
+    /* クラッカー列がある状態での挿入(クラッカー列も直す) */
+    start = getTime();
+    if (insertRows(numRow, NUM_CRACKED_INSERT) != OK) {
+	exit(1);
+    }
+    printf("insert with cracker column: %.1f us/row\n", (getTime() - start) * 1e6 / NUM_CRACKED_INSERT);
+    if (benchQuery("crack (val) after insert", NUM_CRACK_QUERY, numRow) != OK) {
+	exit(1);
+    }
+
+    dropTable(BENCH_TABLE);
+    finalizeDataManipModule();
+    finalizeDataDefModule();
+    finalizeFileModule();
+    return 0;
+}
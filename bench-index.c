@@ -0,0 +1,232 @@
+/*
+ * 索引による検索の性能測定プログラム
+ *
+ * 使い方:
+ *	./bench-index [行数]
+ *
+ * bench(id integer, key string, value integer)の形式の固定長形式のテーブルに
+ * 指定した行数(省略時は10000000)のレコードを挿入し、idとkeyの1つの値を
+ * 探す検索(ポイントルックアップ)の1回あたりの時間と、バッファプールに
+ * なかったページの数を、索引を作る前と後で測る。
+ * idとkeyの値は挿入の順とは無関係にばらばらにしてある。
+ * 索引はB+木で作り、最後にkeyの索引をハッシュ索引に作り直して同じ検索を測る。
+ * 索引を作る時間と、索引がある状態での挿入の時間も測る。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "bench.h"
+
+/*
+ * テスト名
+ */
+#define TEST_NAME "bench-index"
+
+/*
+ * 測定用テーブルのテーブル名と索引名
+ */
+#define BENCH_TABLE "benchindex"
+#define BENCH_ID_INDEX "benchindex_id"
+#define BENCH_KEY_INDEX "benchindex_key"
+#define BENCH_HASH_INDEX "benchindex_hash"
+
+/*
+ * デフォルトの行数、索引を使わない検索の回数、索引を使う検索の回数、
+ * 索引がある状態で挿入する行数
+ */
+#define DEFAULT_NUM_ROW 10000000
+#define NUM_SCAN_LOOKUP 3
+#define NUM_INDEX_LOOKUP 1000
+#define NUM_INDEXED_INSERT 10000
+
+/*
+ * SCRAMBLE -- n番目のレコードのidの値(keyはこれを10桁の文字列にしたもの)
+ *
+ * 挿入の順と値の順が一致するとゾーンマップで読み飛ばせてしまうので、
+ * 32ビットの整数を並べ替える掛け算で値をばらばらにする(値は重複しない)。
+ */
+#define SCRAMBLE(n) ((int) ((unsigned int) (n) * 2654435761u))
+
+/*
+ * createBenchTable -- 測定用テーブルの作成
+ */
+Result createBenchTable()
+{
+    TableInfo tableInfo;
+    TableOption option;
+
+    tableInfo.numField = 0;
+    addTableField(&tableInfo, "id", TYPE_INTEGER);
+    addTableField(&tableInfo, "key", TYPE_STRING);
+    addTableField(&tableInfo, "value", TYPE_INTEGER);
+
+    memset(&option, 0, sizeof(option));
+    option.layout = LAYOUT_FIXED;
+    return recreateTable(BENCH_TABLE, &tableInfo, &option);
+}
+
+/*
+ * makeRecord -- n番目に挿入するレコードを作る
+ */
+void makeRecord(RecordData *record, int n)
+{
+    record->numField = 0;
+    addIntField(record, "id", SCRAMBLE(n));
+    addStringField(record, "key", "k%010u", (unsigned int) SCRAMBLE(n));
+    addIntField(record, "value", n % 1000);
+}
+
+/*
+ * benchLookup -- idかkeyの1つの値を探す検索の時間を測る
+ *
+ * numLookup回、ランダムな値を探す。どの検索もちょうど1件見つかるはず。
+ */
+Result benchLookup(char *label, char *fieldName, int numLookup, int numRow)
+{
+    RecordSet *recordSet;
+    Condition condition;
+    QueryStat stat;
+    BufferPartitionStat before, after;
+    double start;
+    int n;
+    int i;
+
+    strcpy(condition.name, fieldName);
+    condition.operator = OPR_EQUAL;
+    condition.distinct = NOT_DISTINCT;
+
+    getBufferPartitionStat(DEFAULT_PARTITION_NAME, &before);
+    start = getTime();
+    for (i = 0; i < numLookup; i++) {
+	n = rand() % numRow;
+	if (strcmp(fieldName, "id") == 0) {
+	    condition.dataType = TYPE_INTEGER;
+	    condition.intValue = SCRAMBLE(n);
+	} else {
+	    condition.dataType = TYPE_STRING;
+	    snprintf(condition.stringValue, MAX_STRING, "k%010u", (unsigned int) SCRAMBLE(n));
+	}
+	if ((recordSet = selectRecord(BENCH_TABLE, &condition)) == NULL) {
+	    fprintf(stderr, "%s: cannot select records.\n", TEST_NAME);
+	    return NG;
+	}
+	if (recordSet->numRecord != 1) {
+	    fprintf(stderr, "%s: %d rows for record %d.\n", TEST_NAME, recordSet->numRecord, n);
+	    freeRecordSet(recordSet);
+	    return NG;
+	}
+	freeRecordSet(recordSet);
+    }
+    getQueryStat(&stat);
+    getBufferPartitionStat(DEFAULT_PARTITION_NAME, &after);
+    printf("    %-25s %10.3f ms/lookup, %d/%d data pages read, %.1f buffer misses/lookup\n", label,
+	   (getTime() - start) * 1e3 / numLookup, stat.numPageRead, stat.numPage,
+	   (double) (after.misses - before.misses) / numLookup);
+    return OK;
+}
+
+/*
+ * main -- 索引による検索の性能測定
+ */
+int main(int argc, char **argv)
+{
+    RecordData record;
+    double start;
+    int numRow = DEFAULT_NUM_ROW;
+    int i;
+
+    if (argc > 1) {
+	numRow = atoi(argv[1]);
+    }
+
+    if (initializeFileModule() != OK || initializeDataDefModule() != OK
+	|| initializeDataManipModule() != OK) {
+	fprintf(stderr, "%s: initialization failed.\n", TEST_NAME);
+	exit(1);
+    }
+
+    /* テーブルを作ってレコードを挿入する */
+    if (createBenchTable() != OK) {
+	fprintf(stderr, "%s: cannot create table.\n", TEST_NAME);
+	exit(1);
+    }
+    start = getTime();
+    for (i = 0; i < numRow; i++) {
+	makeRecord(&record, i);
+	if (insertRecord(BENCH_TABLE, &record) != OK) {
+	    fprintf(stderr, "%s: cannot insert record %d.\n", TEST_NAME, i);
+	    exit(1);
+	}
+    }
+    printf("%d rows, %d pages, %.1f s to insert\n", numRow, getNumPages(BENCH_TABLE ".dat"), getTime() - start);
+
+    /* 索引を作る前は、検索のたびにテーブル全体を読む */
+    printf("without index:\n");
+    if (benchLookup("where id = x", "id", NUM_SCAN_LOOKUP, numRow) != OK
+	|| benchLookup("where key = 'k...'", "key", NUM_SCAN_LOOKUP, numRow) != OK) {
+	exit(1);
+    }
+
+    /* idとkeyに索引を作る */
+    start = getTime();
+    if (createIndex(BENCH_ID_INDEX, BENCH_TABLE, "id") != OK) {
+	fprintf(stderr, "%s: cannot create index on id.\n", TEST_NAME);
+	exit(1);
+    }
+    printf("create index on id: %.1f s\n", getTime() - start);
+    start = getTime();
+    if (createIndex(BENCH_KEY_INDEX, BENCH_TABLE, "key") != OK) {
+	fprintf(stderr, "%s: cannot create index on key.\n", TEST_NAME);
+	exit(1);
+    }
+    printf("create index on key: %.1f s\n", getTime() - start);
+
+    /* 索引を使う検索 */
+    printf("with index:\n");
+    if (benchLookup("where id = x", "id", NUM_INDEX_LOOKUP, numRow) != OK
+	|| benchLookup("where key = 'k...'", "key", NUM_INDEX_LOOKUP, numRow) != OK) {
+	exit(1);
+    }
+
+    /* 索引がある状態での挿入(索引も更新する) */
+    start = getTime();
+    for (i = numRow; i < numRow + NUM_INDEXED_INSERT; i++) {
+	makeRecord(&record, i);
+	if (insertRecord(BENCH_TABLE, &record) != OK) {
+	    fprintf(stderr, "%s: cannot insert record %d.\n", TEST_NAME, i);
+	    exit(1);
+	}
+    }
+    printf("insert with 2 indexes: %.1f us/row\n", (getTime() - start) * 1e6 / NUM_INDEXED_INSERT);
+    numRow += NUM_INDEXED_INSERT;
+
+    /* keyの索引をハッシュ索引に作り直す */
+    start = getTime();
+    if (dropIndex(BENCH_KEY_INDEX) != OK
+	|| createIndexWithType(BENCH_HASH_INDEX, BENCH_TABLE, "key", INDEX_HASH) != OK) {
+	fprintf(stderr, "%s: cannot create hash index on key.\n", TEST_NAME);
+	exit(1);
+    }
+    printf("create hash index on key: %.1f s\n", getTime() - start);
+    printf("with hash index:\n");
+    if (benchLookup("where key = 'k...'", "key", NUM_INDEX_LOOKUP, numRow) != OK) {
+	exit(1);
+    }
+    start = getTime();
+    for (i = numRow; i < numRow + NUM_INDEXED_INSERT; i++) {
+	makeRecord(&record, i);
+	if (insertRecord(BENCH_TABLE, &record) != OK) {
+	    fprintf(stderr, "%s: cannot insert record %d.\n", TEST_NAME, i);
+	    exit(1);
+	}
+    }
+    printf("insert with btree(id) and hash(key): %.1f us/row\n", (getTime() - start) * 1e6 / NUM_INDEXED_INSERT);
+
+    dropTable(BENCH_TABLE);
+    finalizeDataManipModule();
+    finalizeDataDefModule();
+    finalizeFileModule();
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * レコード挿入性能測定プログラム
+ *
+ * 使い方:
+ *	./bench-insert [-l fixed|slotted|pax] [行数]...
+ *
+ * 指定した行数(省略時は1000と100000と10000000)ずつ、空のテーブルにレコードを挿入し、
+ * 1件あたりの平均時間と、最後の1000件の1件あたりの時間を測る。
+ * 挿入時間が表の大きさに比例して増えていないかどうかは、後者で分かる。
+ * -lでテーブルのページ形式を指定する。挿入後のデータファイルのページ数も表示する。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "bench.h"
+
+/*
+ * テスト名
+ */
+#define TEST_NAME "bench-insert"
+
+/*
+ * 測定用テーブルのテーブル名
+ */
+#define BENCH_TABLE "benchinsert"
+
+/*
+ * 最後に測る挿入の件数
+ */
+#define TAIL_ROWS 1000
+
+/*
+ * 測定用テーブルのページ形式
+ */
+TableLayout layout = LAYOUT_FIXED;
+
+/*
+ * createBenchTable -- 測定用テーブルの作成
+ *
+ * テーブルの形式はテストと同じ student(id, name, age, address)。
+ */
+Result createBenchTable()
+{
+    TableInfo tableInfo;
+    TableOption option;
+
+    tableInfo.numField = 0;
+    addTableField(&tableInfo, "id", TYPE_STRING);
+    addTableField(&tableInfo, "name", TYPE_STRING);
+    addTableField(&tableInfo, "age", TYPE_INTEGER);
+    addTableField(&tableInfo, "address", TYPE_STRING);
+
+    memset(&option, 0, sizeof(option));
+    option.layout = layout;
+    return recreateTable(BENCH_TABLE, &tableInfo, &option);
+}
+
+/*
+ * makeRecord -- n番目に挿入するレコードを作る
+ */
+void makeRecord(RecordData *record, int n)
+{
+    record->numField = 0;
+    addStringField(record, "id", "i%08d", n);
+    addStringField(record, "name", "Mickey");
+    addIntField(record, "age", n % 100);
+    addStringField(record, "address", "Urayasu");
+}
+
+/*
+ * benchInsert -- numRow件のレコードを挿入して時間を測る
+ */
+Result benchInsert(int numRow)
+{
+    RecordData record;
+    double start, tailStart, end;
+    int i;
+
+    if (createBenchTable() != OK) {
+	fprintf(stderr, "%s: cannot create table.\n", TEST_NAME);
+	return NG;
+    }
+
+    start = tailStart = getTime();
+    for (i = 0; i < numRow; i++) {
+	if (i == numRow - TAIL_ROWS) {
+	    tailStart = getTime();
+	}
+	makeRecord(&record, i);
+	if (insertRecord(BENCH_TABLE, &record) != OK) {
+	    fprintf(stderr, "%s: cannot insert record %d.\n", TEST_NAME, i);
+	    return NG;
+	}
+    }
+    end = getTime();
+
+    printf("%10d rows: %8.2f us/insert (average), %8.2f us/insert (last %d rows), %d pages\n",
+	   numRow, (end - start) * 1e6 / numRow,
+	   (end - tailStart) * 1e6 / (numRow < TAIL_ROWS ? numRow : TAIL_ROWS),
+	   numRow < TAIL_ROWS ? numRow : TAIL_ROWS, getNumPages(BENCH_TABLE ".dat"));
+
+    dropTable(BENCH_TABLE);
+    return OK;
+}
+
+/*
+ * main -- レコード挿入の性能測定
+ */
+int main(int argc, char **argv)
+{
+    int i;
+    int numBench = 0;
+
+    if (initializeFileModule() != OK || initializeDataDefModule() != OK
+	|| initializeDataManipModule() != OK) {
+	fprintf(stderr, "%s: initialization failed.\n", TEST_NAME);
+	exit(1);
+    }
+
+    for (i = 1; i < argc; i++) {
+	if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+	    i++;
+	    if (strcmp(argv[i], "slotted") == 0) {
+		layout = LAYOUT_SLOTTED;
+	    } else if (strcmp(argv[i], "pax") == 0) {
+		layout = LAYOUT_PAX;
+	    } else {
+		layout = LAYOUT_FIXED;
+	    }
+	    continue;
+	}
+	if (benchInsert(atoi(argv[i])) != OK) {
+	    exit(1);
+	}
+	numBench++;
+    }
+    if (numBench == 0) {
+	benchInsert(1000);
+	benchInsert(100000);
+	benchInsert(10000000);
+    }
+
+    finalizeDataManipModule();
+    finalizeDataDefModule();
+    finalizeFileModule();
+    return 0;
+}
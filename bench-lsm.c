@@ -0,0 +1,208 @@
+/*
+ * ログ構造化(LSM)テーブルへの挿入の性能測定プログラム
+ *
+ * 使い方:
+ *	./bench-lsm [行数]
+ *
+ * bench(id integer, val integer, pad string)の形式のテーブルに、指定した行数
+ * (省略時は1000000)のレコードを挿入したときの1行あたりの時間を、lsmを指定しない
+ * テーブル(固定長形式のデータファイル)と、lsm (id)を指定したテーブルで比べる。
+ * idの値は挿入の順とは無関係にばらばらにしてある。
+ * 続けて、ランダムなidの=と、ランダムなidから始まる狭い範囲(>)の検索の1回あたりの時間と
+ * 読んだページの数を測る。lsmを指定したテーブルでは、すべてのランを併合する時間と、
+ * 併合した後の検索も測る。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "bench.h"
+
+/*
+ * テスト名
+ */
+#define TEST_NAME "bench-lsm"
+
+/*
+ * 測定用テーブルのテーブル名
+ */
+#define BENCH_TABLE "benchlsm"
+
+/*
+ * デフォルトの行数、lsmを指定しないテーブルで検索する回数、lsmを指定したテーブルで検索する回数
+ */
+#define DEFAULT_NUM_ROW 1000000
+#define NUM_SCAN_QUERY 3
+#define NUM_LSM_QUERY 1000
+
+/*
+ * KEY -- n番目のレコードのidの値(0からnumRow - 1までを1回ずつ)
+ *
+ * 挿入の順とキーの順が一致すると併合が楽になるので、行数と互いに素な数を掛けてばらばらにする。
+ */
+#define KEY(n, numRow) ((int) ((long long) (n) * 48271 % (numRow)))
+
+/*
+ * createBenchTable -- 測定用テーブルの作成
+ */
+Result createBenchTable(int lsm)
+{
+    TableInfo tableInfo;
+    TableOption option;
+
+    tableInfo.numField = 0;
+    addTableField(&tableInfo, "id", TYPE_INTEGER);
+    addTableField(&tableInfo, "val", TYPE_INTEGER);
+    addTableField(&tableInfo, "pad", TYPE_STRING);
+
+    memset(&option, 0, sizeof(option));
+    option.layout = LAYOUT_FIXED;
+    option.lsm[0] = lsm;
+    return recreateTable(BENCH_TABLE, &tableInfo, &option);
+}
+
+/*
+ * insertRows -- numRow行のレコードを挿入し、1行あたりの時間を表示する
+ */
+Result insertRows(char *label, int numRow)
+{
+    RecordData record;
+    double start;
+    int i;
+
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "pad");
+    record.fieldData[2].dataType = TYPE_STRING;
+
+    start = getTime();
+    for (i = 0; i < numRow; i++) {
+	record.fieldData[0].intValue = KEY(i, numRow);
+	record.fieldData[1].intValue = i;
+	snprintf(record.fieldData[2].stringValue, MAX_STRING, "p%08d", i);
+	if (insertRecord(BENCH_TABLE, &record) != OK) {
+	    fprintf(stderr, "%s: cannot insert record %d.\n", TEST_NAME, i);
+	    return NG;
+	}
+    }
+    printf("%s: %d rows, %.2f us/row to insert\n", label, numRow, (getTime() - start) * 1e6 / numRow);
+    return OK;
+}
+
+/*
+ * benchQuery -- idについての検索を繰り返し、1回あたりの時間と読んだページ数を測る
+ *
+ * 検索の条件は、奇数回目はランダムな値の=、偶数回目はランダムな値の>にする
+ * (>の結果は多くなるので、時間は=と分けて測る)。
+ */
+Result benchQuery(char *label, int numQuery, int numRow)
+{
+    RecordSet *recordSet;
+    Condition condition;
+    QueryStat stat;
+    double elapsed[2] = {0, 0};
+    long numPageRead[2] = {0, 0};
+    double start;
+    int count[2] = {0, 0};
+    int i, k;
+
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.distinct = NOT_DISTINCT;
+
+    for (i = 0; i < numQuery; i++) {
+	k = i % 2;
+	if (k == 0) {
+	    condition.operator = OPR_EQUAL;
+	    condition.intValue = rand() % numRow;
+	} else {
+	    condition.operator = OPR_GREATER_THAN;
+	    condition.intValue = numRow - 1 - rand() % 1000;
+	}
+	start = getTime();
+	if ((recordSet = selectRecord(BENCH_TABLE, &condition)) == NULL) {
+	    fprintf(stderr, "%s: cannot select records.\n", TEST_NAME);
+	    return NG;
+	}
+	freeRecordSet(recordSet);
+	elapsed[k] += getTime() - start;
+	getQueryStat(&stat);
+	numPageRead[k] += stat.numPageRead;
+	count[k]++;
+    }
+    printf("%s:\n", label);
+    printf("    id =  %10.3f ms/query, %10.1f/%d pages read/query\n",
+	   elapsed[0] * 1e3 / count[0], (double) numPageRead[0] / count[0], stat.numPage);
+    if (count[1] > 0) {
+	printf("    id >  %10.3f ms/query, %10.1f/%d pages read/query (up to 1000 rows)\n",
+	       elapsed[1] * 1e3 / count[1], (double) numPageRead[1] / count[1], stat.numPage);
+    }
+    return OK;
+}
+
+/*
+ * main -- ログ構造化テーブルへの挿入の性能測定
+ */
+int main(int argc, char **argv)
+{
+    double start;
+    int numRow = DEFAULT_NUM_ROW;
+
+    if (argc > 1) {
+	numRow = atoi(argv[1]);
+    }
+
+    if (initializeFileModule() != OK || initializeDataDefModule() != OK
+	|| initializeDataManipModule() != OK) {
+	fprintf(stderr, "%s: initialization failed.\n", TEST_NAME);
+	exit(1);
+    }
+
+    /* lsmを指定しないテーブルでは、挿入のたびにデータファイルのページを書き換える */
+    if (createBenchTable(0) != OK) {
+	fprintf(stderr, "%s: cannot create table.\n", TEST_NAME);
+	exit(1);
+    }
+    if (insertRows("heap", numRow) != OK) {
+	exit(1);
+    }
+    srand(1);
+    if (benchQuery("heap", NUM_SCAN_QUERY, numRow) != OK) {
+	exit(1);
+    }
+
+    /* lsmを指定したテーブルでは、挿入はメムテーブルにためて、まとめてランに書き出す */
+    if (createBenchTable(1) != OK) {
+	fprintf(stderr, "%s: cannot create table.\n", TEST_NAME);
+	exit(1);
+    }
+    if (insertRows("lsm (id)", numRow) != OK) {
+	exit(1);
+    }
+    srand(1);
+    if (benchQuery("lsm (id)", NUM_LSM_QUERY, numRow) != OK) {
+	exit(1);
+    }
+
+    /* すべてのランを1つに併合すると、検索で調べるランが減る */
+    start = getTime();
+    if (compactLsmTable(BENCH_TABLE) != OK) {
+	fprintf(stderr, "%s: cannot compact table.\n", TEST_NAME);
+	exit(1);
+    }
+    printf("compaction: %.1f s\n", getTime() - start);
+    srand(1);
+    if (benchQuery("lsm (id) after compaction", NUM_LSM_QUERY, numRow) != OK) {
+	exit(1);
+    }
+
+    dropTable(BENCH_TABLE);
+    finalizeDataManipModule();
+    finalizeDataDefModule();
+    finalizeFileModule();
+    return 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * インメモリテーブルの性能測定プログラム
+ *
+ * 使い方:
+ *	./bench-memory [行数]
+ *
+ * bench(id integer, val integer, name string)の形式のテーブルに対して、
+ * 同じ処理(指定した行数(省略時は100000)の挿入、ランダムなidの=の検索、
+ * valの狭い範囲(<)の検索、nameの=の検索、valの=の条件での削除)を行い、
+ * 1回あたりの時間を、ファイルに置くテーブル(固定長形式のデータファイル)と
+ * create memory tableで作ったインメモリテーブルで比べる。
+ * ファイルに置くテーブルでは、整数の条件の検索を繰り返すうちにクラッキングが働くので、
+ * idの=の検索は全件を読むよりずっと速くなる。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "bench.h"
+
+/*
+ * テスト名
+ */
+#define TEST_NAME "bench-memory"
+
+/*
+ * 測定用テーブルのテーブル名
+ */
+#define BENCH_TABLE "benchmem"
+
+/*
+ * デフォルトの行数、検索の回数、削除の回数
+ */
+#define DEFAULT_NUM_ROW 100000
+#define NUM_QUERY 50
+#define NUM_DELETE 10
+
+/*
+ * NUM_VAL -- valの値の種類の数(valは0からNUM_VAL - 1まで)
+ */
+#define NUM_VAL 1000
+
+/*
+ * createBenchTable -- 測定用テーブルの作成
+ */
+Result createBenchTable(int memory)
+{
+    TableInfo tableInfo;
+    TableOption option;
+
+    tableInfo.numField = 0;
+    addTableField(&tableInfo, "id", TYPE_INTEGER);
+    addTableField(&tableInfo, "val", TYPE_INTEGER);
+    addTableField(&tableInfo, "name", TYPE_STRING);
+
+    memset(&option, 0, sizeof(option));
+    option.layout = LAYOUT_FIXED;
+    option.memory = memory;
+    return recreateTable(BENCH_TABLE, &tableInfo, &option);
+}
+
+/*
+ * countQuery -- 条件に合うレコードを検索し、その数を返す
+ */
+int countQuery(Condition *condition)
+{
+    RecordSet *recordSet;
+    int numRecord;
+
+    if ((recordSet = selectRecord(BENCH_TABLE, condition)) == NULL) {
+	fprintf(stderr, "%s: cannot select records.\n", TEST_NAME);
+	exit(1);
+    }
+    numRecord = recordSet->numRecord;
+    freeRecordSet(recordSet);
+    return numRecord;
+}
+
+/*
+ * runWorkload -- 測定用テーブルへの一連の処理を行い、1回あたりの時間を表示する
+ */
+Result runWorkload(char *label, int numRow)
+{
+    RecordData record;
+    Condition condition;
+    double start;
+    long found = 0;
+    int i;
+
+    printf("%s:\n", label);
+
+    /* 挿入 */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    start = getTime();
+    for (i = 0; i < numRow; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = rand() % NUM_VAL;
+	snprintf(record.fieldData[2].stringValue, MAX_STRING, "n%08d", i);
+	if (insertRecord(BENCH_TABLE, &record) != OK) {
+	    fprintf(stderr, "%s: cannot insert record %d.\n", TEST_NAME, i);
+	    return NG;
+	}
+    }
+    printf("    insert        %10.3f us/row\n", (getTime() - start) * 1e6 / numRow);
+
+    /* idの=の検索(結果は1件) */
+    condition.distinct = NOT_DISTINCT;
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_EQUAL;
+    start = getTime();
+    for (i = 0; i < NUM_QUERY; i++) {
+	condition.intValue = rand() % numRow;
+	found += countQuery(&condition);
+    }
+    printf("    id =          %10.3f ms/query (%ld rows)\n", (getTime() - start) * 1e3 / NUM_QUERY, found);
+
+    /* valの狭い範囲の検索(結果は全体の1%ほど) */
+    found = 0;
+    strcpy(condition.name, "val");
+    condition.operator = OPR_LESS_THAN;
+    start = getTime();
+    for (i = 0; i < NUM_QUERY; i++) {
+	condition.intValue = NUM_VAL / 100;
+	found += countQuery(&condition);
+    }
+    printf("    val <         %10.3f ms/query (%ld rows)\n", (getTime() - start) * 1e3 / NUM_QUERY, found);
+
+    /* nameの=の検索(文字列の比較) */
+    found = 0;
+    strcpy(condition.name, "name");
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_EQUAL;
+    start = getTime();
+    for (i = 0; i < NUM_QUERY; i++) {
+	snprintf(condition.stringValue, MAX_STRING, "n%08d", rand() % numRow);
+	found += countQuery(&condition);
+    }
+    printf("    name =        %10.3f ms/query (%ld rows)\n", (getTime() - start) * 1e3 / NUM_QUERY, found);
+
+    /* valの=の条件での削除(1回で全体の0.1%ほど) */
+    strcpy(condition.name, "val");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_EQUAL;
+    start = getTime();
+    for (i = 0; i < NUM_DELETE; i++) {
+	condition.intValue = i;
+	if (deleteRecord(BENCH_TABLE, &condition) != OK) {
+	    fprintf(stderr, "%s: cannot delete records.\n", TEST_NAME);
+	    return NG;
+	}
+    }
+    printf("    delete val =  %10.3f ms/delete (%d rows left)\n",
+	   (getTime() - start) * 1e3 / NUM_DELETE, countRecord(BENCH_TABLE));
+    return OK;
+}
+
+/*
+ * main -- インメモリテーブルの性能測定
+ */
+int main(int argc, char **argv)
+{
+    int numRow = DEFAULT_NUM_ROW;
+
+    if (argc > 1) {
+	numRow = atoi(argv[1]);
+    }
+
+    if (initializeFileModule() != OK || initializeDataDefModule() != OK
+	|| initializeDataManipModule() != OK) {
+	fprintf(stderr, "%s: initialization failed.\n", TEST_NAME);
+	exit(1);
+    }
+
+    /* ファイルに置くテーブルでは、どの処理もバッファプールのページを通る */
+    if (createBenchTable(0) != OK) {
+	fprintf(stderr, "%s: cannot create table.\n", TEST_NAME);
+	exit(1);
+    }
+    srand(1);
+    if (runWorkload("heap", numRow) != OK) {
+	exit(1);
+    }
+    dropTable(BENCH_TABLE);
+
+    /* インメモリテーブルでは、フィールドごとの配列を直接読み書きする */
+    if (createBenchTable(1) != OK) {
+	fprintf(stderr, "%s: cannot create table.\n", TEST_NAME);
+	exit(1);
+    }
+    srand(1);
+    if (runWorkload("memory", numRow) != OK) {
+	exit(1);
+    }
+    dropTable(BENCH_TABLE);
+
+    finalizeDataManipModule();
+    finalizeDataDefModule();
+    finalizeFileModule();
+    return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * 表の走査性能測定プログラム
+ *
+ * 使い方:
+ *	./bench-scan [行数]
+ *
+ * student(id, name, age, address)の形式のテーブルを、固定長形式(行ごと)、
+ * 列ごとの形式(PAX)、addressを辞書圧縮した固定長形式、ageを7ビットに詰めた
+ * 列ごとの形式、idのブルームフィルタを作るスロット形式、nameとaddressに
+ * ビットマップ索引やトライグラム索引を作る固定長形式でそれぞれ作って
+ * 指定した行数(省略時は100000)のレコードを挿入し、1つのフィールドだけを見る
+ * 条件(likeを含む)でselectRecordを呼んだときの1回あたりの時間を測る。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "bench.h"
+
+/*
+ * テスト名
+ */
+#define TEST_NAME "bench-scan"
+
+/*
+ * 測定用テーブルのテーブル名
+ */
+#define BENCH_TABLE "benchscan"
+
+/*
+ * デフォルトの行数と、1つの条件あたりの走査の回数
+ */
+#define DEFAULT_NUM_ROW 100000
+#define NUM_SCAN 10
+
+/*
+ * createBenchTable -- 測定用テーブルの作成
+ */
+Result createBenchTable(TableLayout layout, int dictionary, int packBits, int bloom)
+{
+    TableInfo tableInfo;
+    TableOption option;
+
+    tableInfo.numField = 0;
+    addTableField(&tableInfo, "id", TYPE_STRING);
+    addTableField(&tableInfo, "name", TYPE_STRING);
+    addTableField(&tableInfo, "age", TYPE_INTEGER);
+    addTableField(&tableInfo, "address", TYPE_STRING);
+
+    memset(&option, 0, sizeof(option));
+    option.layout = layout;
+    option.dictionary[3] = dictionary;
+    option.packBits[2] = packBits;
+    option.bloom[0] = bloom;
+    return recreateTable(BENCH_TABLE, &tableInfo, &option);
+}
+
+/*
+ * makeRecord -- n番目に挿入するレコードを作る
+ */
+void makeRecord(RecordData *record, int n)
+{
+    record->numField = 0;
+    addStringField(record, "id", "i%08d", n);
+    addStringField(record, "name", "name%d", n % 1000);
+    addIntField(record, "age", n % 100);
+    addStringField(record, "address", "city%d", n % 30);
+}
+
+/*
+ * benchScan -- 条件conditionでの走査の時間を測る
+ */
+void benchScan(char *label, Condition *condition)
+{
+    RecordSet *recordSet;
+    QueryStat stat;
+    double start;
+    int numRecord = 0;
+    int i;
+
+    start = getTime();
+    for (i = 0; i < NUM_SCAN; i++) {
+	if ((recordSet = selectRecord(BENCH_TABLE, condition)) == NULL) {
+	    fprintf(stderr, "%s: cannot select records.\n", TEST_NAME);
+	    return;
+	}
+	numRecord = recordSet->numRecord;
+	freeRecordSet(recordSet);
+    }
+    getQueryStat(&stat);
+    printf("    %-25s %8.2f ms/scan, %d rows, %d/%d pages skipped\n", label,
+	   (getTime() - start) * 1e3 / NUM_SCAN, numRecord, stat.numPageSkipped, stat.numPage);
+}
+
+/*
+ * benchLayout -- ページ形式layoutのテーブルで走査の時間を測る
+ *
+ * dictionaryが1なら、addressを辞書圧縮する。packBitsが0でなければ、ageをそのビット数に詰める。
+ * bloomが1なら、idのブルームフィルタを作る。indexTypeが-1でなければ、挿入の後でnameとaddressに
+ * その種類の索引を作る。
+ */
+Result benchLayout(char *layoutName, TableLayout layout, int dictionary, int packBits, int bloom, int indexType,
+                   int numRow)
+{
+    RecordData record;
+    Condition condition;
+    int i;
+
+    if (createBenchTable(layout, dictionary, packBits, bloom) != OK) {
+	fprintf(stderr, "%s: cannot create table.\n", TEST_NAME);
+	return NG;
+    }
+    for (i = 0; i < numRow; i++) {
+	makeRecord(&record, i);
+	if (insertRecord(BENCH_TABLE, &record) != OK) {
+	    fprintf(stderr, "%s: cannot insert record %d.\n", TEST_NAME, i);
+	    return NG;
+	}
+    }
+    if (indexType != -1
+	&& (createIndexWithType(BENCH_TABLE "_name", BENCH_TABLE, "name", indexType) != OK
+	    || createIndexWithType(BENCH_TABLE "_address", BENCH_TABLE, "address", indexType) != OK)) {
+	fprintf(stderr, "%s: cannot create index.\n", TEST_NAME);
+	return NG;
+    }
+    printf("%s: %d rows, %d pages\n", layoutName, numRow, getNumPages(BENCH_TABLE ".dat"));
+
+    condition.distinct = NOT_DISTINCT;
+
+    /* 整数のフィールドの条件(1%のレコードが合う) */
+    strcpy(condition.name, "age");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_EQUAL;
+    condition.intValue = 42;
+    benchScan("where age = 42", &condition);
+
+    /* 整数のフィールドの条件(合うレコードなし) */
+    condition.operator = OPR_GREATER_THAN;
+    condition.intValue = 100;
+    benchScan("where age > 100", &condition);
+
+    /* 値が一意な文字列のフィールドの条件(1件だけ合う) */
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_EQUAL;
+    strcpy(condition.stringValue, "i00004001");
+    benchScan("where id = 'i00004001'", &condition);
+
+    /* 文字列のフィールドの条件(0.1%のレコードが合う) */
+    strcpy(condition.name, "name");
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_EQUAL;
+    strcpy(condition.stringValue, "name42");
+    benchScan("where name = 'name42'", &condition);
+
+    /* 辞書圧縮できるフィールドの条件(1/30のレコードが合う) */
+    strcpy(condition.name, "address");
+    strcpy(condition.stringValue, "city7");
+    benchScan("where address = 'city7'", &condition);
+
+    /* 文字列のフィールドの部分文字列の条件(0.1%のレコードが合う) */
+    strcpy(condition.name, "name");
+    condition.operator = OPR_LIKE;
+    strcpy(condition.stringValue, "%me42");
+    benchScan("where name like '%me42'", &condition);
+
+    dropTable(BENCH_TABLE);
+    return OK;
+}
+
+/*
+ * main -- 表の走査の性能測定
+ */
+int main(int argc, char **argv)
+{
+    int numRow = DEFAULT_NUM_ROW;
+
+    if (argc > 1) {
+	numRow = atoi(argv[1]);
+    }
+
+    if (initializeFileModule() != OK || initializeDataDefModule() != OK
+	|| initializeDataManipModule() != OK) {
+	fprintf(stderr, "%s: initialization failed.\n", TEST_NAME);
+	exit(1);
+    }
+
+    if (benchLayout("fixed", LAYOUT_FIXED, 0, 0, 0, -1, numRow) != OK
+	|| benchLayout("pax", LAYOUT_PAX, 0, 0, 0, -1, numRow) != OK
+	|| benchLayout("fixed, dictionary(address)", LAYOUT_FIXED, 1, 0, 0, -1, numRow) != OK
+	|| benchLayout("pax, pack(age 7)", LAYOUT_PAX, 0, 7, 0, -1, numRow) != OK
+	|| benchLayout("slotted", LAYOUT_SLOTTED, 0, 0, 0, -1, numRow) != OK
+	|| benchLayout("slotted, bloom(id)", LAYOUT_SLOTTED, 0, 0, 1, -1, numRow) != OK
+	|| benchLayout("fixed, bitmap(name, address)", LAYOUT_FIXED, 0, 0, 0, INDEX_BITMAP, numRow) != OK
+	|| benchLayout("fixed, trigram(name, address)", LAYOUT_FIXED, 0, 0, 0, INDEX_TRIGRAM, numRow) != OK) {
+	exit(1);
+    }
+
+    finalizeDataManipModule();
+    finalizeDataDefModule();
+    finalizeFileModule();
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * bench.c -- 性能測定プログラムに共通の関数
+ *
+ * 時間の測定と、測定用テーブルやレコードの組み立てに使う。
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+
+/*
+ * getTime -- 現在時刻(秒)の取得
+ */
+double getTime()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * addTableField -- テーブルの定義の最後にフィールドを加える
+ *
+ * 引数:
+ *	tableInfo: フィールドを加えるテーブルの定義(numFieldを0にしてから使う)
+ *	name: フィールド名
+ *	dataType: データ型
+ *
+ * 返り値:
+ *	なし
+ */
+void addTableField(TableInfo *tableInfo, char *name, DataType dataType)
+{
+    strcpy(tableInfo->fieldInfo[tableInfo->numField].name, name);
+    tableInfo->fieldInfo[tableInfo->numField].dataType = dataType;
+    tableInfo->numField++;
+}
+
+/*
+ * recreateTable -- 測定用テーブルの作成
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	tableInfo: テーブルの定義
+ *	option: 格納方法の指定
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * 前回の測定で残った同じ名前のテーブルがあれば、削除してから作り直す。
+ */
+Result recreateTable(char *tableName, TableInfo *tableInfo, TableOption *option)
+{
+    char filename[MAX_FILENAME];
+
+    snprintf(filename, MAX_FILENAME, "%s.def", tableName);
+    if (getNumPages(filename) >= 0) {
+        dropTable(tableName);
+    }
+    return createTableWithOption(tableName, tableInfo, option);
+}
+
+/*
+ * addIntField -- レコードの最後に整数型のフィールドを加える
+ *
+ * 引数:
+ *	record: フィールドを加えるレコード(numFieldを0にしてから使う)
+ *	name: フィールド名
+ *	value: 値
+ *
+ * 返り値:
+ *	なし
+ */
+void addIntField(RecordData *record, char *name, int value)
+{
+    strcpy(record->fieldData[record->numField].name, name);
+    record->fieldData[record->numField].dataType = TYPE_INTEGER;
+    record->fieldData[record->numField].intValue = value;
+    record->numField++;
+}
+
+/*
+ * addStringField -- レコードの最後に文字列型のフィールドを加える
+ *
+ * 引数:
+ *	record: フィールドを加えるレコード(numFieldを0にしてから使う)
+ *	name: フィールド名
+ *	format: 値を作るprintfの書式(値はMAX_STRING - 1文字までに切り詰める)
+ *
+ * 返り値:
+ *	なし
+ */
+void addStringField(RecordData *record, char *name, const char *format, ...)
+{
+    va_list args;
+
+    strcpy(record->fieldData[record->numField].name, name);
+    record->fieldData[record->numField].dataType = TYPE_STRING;
+    va_start(args, format);
+    vsnprintf(record->fieldData[record->numField].stringValue, MAX_STRING, format, args);
+    va_end(args);
+    record->numField++;
+}
@@ -0,0 +1,18 @@
+/*
+ * bench.h - 性能測定プログラムの共通定義ファイル
+ */
+#ifndef __bench_INCLUDED__
+#define __bench_INCLUDED__
+
+#include "microdb.h"
+
+/*
+ * bench.cに定義されている関数群
+ */
+extern double getTime();
+extern void addTableField(TableInfo *tableInfo, char *name, DataType dataType);
+extern Result recreateTable(char *tableName, TableInfo *tableInfo, TableOption *option);
+extern void addIntField(RecordData *record, char *name, int value);
+extern void addStringField(RecordData *record, char *name, const char *format, ...);
+
+#endif
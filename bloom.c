@@ -0,0 +1,506 @@
+/*
+ * bloom.c -- ブルームフィルタモジュール
+ *
+ * ブルームフィルタを指定した文字列型のフィールド(TableOptionのbloom)について、
+ * データファイルの各ページに格納した値のブルームフィルタを、ブルームフィルタファイル
+ * (ファイル名: tableName.blm)に記録する。文字列の値との等号の条件で検索・削除する
+ * ときに、その値がないと分かるページを読まずに済ませられる。
+ *
+ * フィルタのビットは挿入のたびに立てるが、削除では落とさない(ページが空になった
+ * ときだけ、すべて落とす)。ページにある値について、フィルタが「ない」と答えることはない。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * BLOOM_FILE_EXT -- ブルームフィルタファイルの拡張子
+ */
+#define BLOOM_FILE_EXT ".blm"
+
+/*
+ * BLOOM_MAGIC -- ブルームフィルタファイルであることを示す値
+ */
+#define BLOOM_MAGIC 0x626c6d31
+
+/*
+ * BLOOM_MAX_HASH -- 1つの値について立てるビットの数の上限
+ */
+#define BLOOM_MAX_HASH 16
+
+/*
+ * BLOOM_BITS_PER_HASH -- 立てるビット1つあたりに用意する、値1つあたりのビット数の1000倍
+ *
+ * 立てるビットの数をkとすると、値1つあたりk / ln 2ビットのときに偽陽性率が最小の(1/2)^kになる。
+ */
+#define BLOOM_BITS_PER_HASH 1443
+
+/*
+ * ブルームフィルタファイルの構造
+ *
+ * 0ページ目(ヘッダ):
+ *   +-------------+-------------+-------------+-------------+-------------+
+ *   |BLOOM_MAGIC  |データページ数|フィールド数 |フィルタの   |立てるビット |
+ *   |             |             |             |大きさ       |の数         |
+ *   +-------------+-------------+-------------+-------------+-------------+
+ *   (それぞれsizeof(int)バイト)
+ * 1ページ目以降:
+ *   データページ1つにつき、フィルタを作るフィールドごとのフィルタ(フィルタの大きさ
+ *   バイト)をフィールドの順に並べた項目を記録する。1ページに入る項目の数を n とすると、
+ *   データファイルのiページ目の項目は、(1 + i / n)ページ目の(i % n)番目にある。
+ *
+ * フィルタの大きさと立てるビットの数は、1ページに格納できるレコード数の上限と
+ * 偽陽性率の目標から決めるので、ページがどれだけ埋まっていても偽陽性率は目標以下になる。
+ */
+
+/*
+ * BloomHeader -- ブルームフィルタファイルのヘッダ
+ */
+typedef struct BloomHeader BloomHeader;
+struct BloomHeader {
+    int magic;                  /* BLOOM_MAGIC */
+    int numPage;                /* 記録しているデータページ数 */
+    int numField;               /* フィルタを作るフィールドの数 */
+    int filterSize;             /* フィルタの大きさ(バイト数) */
+    int numHash;                /* 1つの値について立てるビットの数 */
+};
+
+/*
+ * makeBloomFileName -- ブルームフィルタファイルのファイル名を作る
+ */
+static void makeBloomFileName(char *filename, char *tableName)
+{
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, BLOOM_FILE_EXT);
+}
+
+/*
+ * makeBloomHeader -- テーブルの定義から、フィルタの大きさと立てるビットの数を決める
+ */
+static void makeBloomHeader(TableInfo *tableInfo, BloomHeader *header)
+{
+    int rate = tableInfo->option.bloomRate;
+    int numRecord = getMaxRecordsPerPage(tableInfo);
+    int bits;
+    int i;
+
+    header->magic = BLOOM_MAGIC;
+    header->numPage = 0;
+    header->numField = 0;
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (IS_BLOOM_FIELD(tableInfo, i)) {
+            header->numField++;
+        }
+    }
+    if (rate <= 0 || rate > MAX_BLOOM_RATE) {
+        rate = BLOOM_DEFAULT_RATE;
+    }
+
+    /* (1/2)^kが目標の偽陽性率以下になる最小のkを、立てるビットの数にする */
+    for (header->numHash = 1; header->numHash < BLOOM_MAX_HASH; header->numHash++) {
+        if (1000 <= rate << header->numHash) {
+            break;
+        }
+    }
+
+    /* 項目が1ページに収まる範囲で、値1つあたりk / ln 2ビットを用意する */
+    bits = numRecord * header->numHash * BLOOM_BITS_PER_HASH / 1000;
+    header->filterSize = (bits + 7) / 8;
+    if (header->numField > 0 && header->filterSize > PAGE_SIZE / header->numField) {
+        header->filterSize = PAGE_SIZE / header->numField;
+    }
+    if (header->filterSize < 1) {
+        header->filterSize = 1;
+    }
+}
+
+/*
+ * hashString -- 文字列のハッシュ値(FNV-1a)
+ */
+static unsigned int hashString(char *s, unsigned int seed)
+{
+    unsigned int hash = 2166136261u ^ seed;
+
+    while (*s != '\0') {
+        hash ^= (unsigned char) *s++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * getEntriesPerPage -- ブルームフィルタファイルの1ページに入る項目の数
+ */
+static int getEntriesPerPage(BloomFilter *bloom)
+{
+    return PAGE_SIZE / (bloom->numField * bloom->filterSize);
+}
+
+/*
+ * writeBloomHeader -- ヘッダを0ページ目に書き出す
+ */
+static Result writeBloomHeader(File *file, BloomHeader *header)
+{
+    char page[PAGE_SIZE];
+
+    memset(page, 0, PAGE_SIZE);
+    memcpy(page, header, sizeof(BloomHeader));
+    if (writePage(file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    return OK;
+}
+
+/*
+ * getBloomEntry -- データページの項目を読み込み、その番地を返す
+ *
+ * 項目を含むページはbloom->pageに読み込んでおき、続けて同じページの
+ * 項目を使うときは読み直さない。まだファイルに存在しないページなら、
+ * すべてのビットが0のページを用意する。
+ */
+static unsigned char *getBloomEntry(BloomFilter *bloom, int pageNum)
+{
+    int filterPageNum = 1 + pageNum / getEntriesPerPage(bloom);
+
+    if (filterPageNum != bloom->cachedPageNum) {
+        if (filterPageNum >= bloom->numFilterPage
+            || readPage(bloom->file, filterPageNum, bloom->page) != OK) {
+            memset(bloom->page, 0, PAGE_SIZE);
+        }
+        bloom->cachedPageNum = filterPageNum;
+    }
+
+    return (unsigned char *) bloom->page
+        + (pageNum % getEntriesPerPage(bloom)) * bloom->numField * bloom->filterSize;
+}
+
+/*
+ * writeBloomEntry -- getBloomEntryで読み込んだページをファイルに書き戻す
+ */
+static Result writeBloomEntry(BloomFilter *bloom, int pageNum)
+{
+    if (writePage(bloom->file, bloom->cachedPageNum, bloom->page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    if (bloom->cachedPageNum >= bloom->numFilterPage) {
+        bloom->numFilterPage = bloom->cachedPageNum + 1;
+    }
+    if (pageNum >= bloom->numPage) {
+        bloom->numPage = pageNum + 1;
+        bloom->headerModified = 1;
+    }
+    return OK;
+}
+
+/*
+ * hasBloomField -- ブルームフィルタを作るフィールドがあるかどうか
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	ブルームフィルタを作るフィールドが1つでもあれば1、なければ0を返す
+ */
+int hasBloomField(TableInfo *tableInfo)
+{
+    int i;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (IS_BLOOM_FIELD(tableInfo, i)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * createBloomFilter -- ブルームフィルタファイルの作成
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result createBloomFilter(char *tableName, TableInfo *tableInfo)
+{
+    char filename[MAX_FILENAME];
+    BloomHeader header;
+    File *file;
+
+    makeBloomFileName(filename, tableName);
+    if (createFile(filename) != OK) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        return NG;
+    }
+
+    if ((file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+    makeBloomHeader(tableInfo, &header);
+    if (writeBloomHeader(file, &header) != OK) {
+        closeFile(file);
+        return NG;
+    }
+
+    return closeFile(file);
+}
+
+/*
+ * deleteBloomFilter -- ブルームフィルタファイルの削除
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result deleteBloomFilter(char *tableName)
+{
+    char filename[MAX_FILENAME];
+
+    makeBloomFileName(filename, tableName);
+    return deleteFile(filename);
+}
+
+/*
+ * openBloomFilter -- ブルームフィルタのオープン
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	オープンしたブルームフィルタ
+ *	ファイルがない場合や壊れている場合、ブルームフィルタを作るフィールドが
+ *	ない場合はNULLを返す
+ *
+ * ***注意***
+ *	使い終わったら必ずcloseBloomFilterでクローズすること。
+ */
+BloomFilter *openBloomFilter(char *tableName, TableInfo *tableInfo)
+{
+    char filename[MAX_FILENAME];
+    BloomHeader header;
+    BloomHeader expected;
+    BloomFilter *bloom;
+    int numField = 0;
+    int i;
+
+    makeBloomHeader(tableInfo, &expected);
+    if (expected.numField == 0) {
+        return NULL;
+    }
+
+    makeBloomFileName(filename, tableName);
+    if ((bloom = (BloomFilter *) malloc(sizeof(BloomFilter))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    if ((bloom->numFilterPage = getNumPages(filename)) < 1
+        || (bloom->file = openFile(filename)) == NULL) {
+        free(bloom);
+        return NULL;
+    }
+
+    /* ヘッダを読み込み、テーブルの定義と合っているか確かめる */
+    if (readPage(bloom->file, 0, bloom->page) != OK) {
+        closeFile(bloom->file);
+        free(bloom);
+        return NULL;
+    }
+    memcpy(&header, bloom->page, sizeof(header));
+    if (header.magic != BLOOM_MAGIC || header.numField != expected.numField
+        || header.filterSize != expected.filterSize || header.numHash != expected.numHash) {
+        closeFile(bloom->file);
+        free(bloom);
+        return NULL;
+    }
+
+    /* フィールドの番号から、項目の中での位置への対応を作る */
+    for (i = 0; i < MAX_FIELD; i++) {
+        bloom->column[i] = -1;
+        if (i < tableInfo->numField && IS_BLOOM_FIELD(tableInfo, i)) {
+            bloom->column[i] = numField++;
+        }
+    }
+
+    bloom->numPage = header.numPage;
+    bloom->numField = header.numField;
+    bloom->numTableField = tableInfo->numField;
+    bloom->filterSize = header.filterSize;
+    bloom->numHash = header.numHash;
+    bloom->cachedPageNum = -1;
+    bloom->headerModified = 0;
+    return bloom;
+}
+
+/*
+ * closeBloomFilter -- ブルームフィルタのクローズ
+ *
+ * 引数:
+ *	bloom: クローズするブルームフィルタ
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result closeBloomFilter(BloomFilter *bloom)
+{
+    BloomHeader header;
+    Result result = OK;
+
+    if (bloom->headerModified) {
+        header.magic = BLOOM_MAGIC;
+        header.numPage = bloom->numPage;
+        header.numField = bloom->numField;
+        header.filterSize = bloom->filterSize;
+        header.numHash = bloom->numHash;
+        result = writeBloomHeader(bloom->file, &header);
+    }
+    if (closeFile(bloom->file) != OK) {
+        result = NG;
+    }
+    free(bloom);
+    return result;
+}
+
+/*
+ * addToBloomFilter -- データページに格納したレコードの値をフィルタに加える
+ *
+ * 引数:
+ *	bloom: ブルームフィルタ
+ *	pageNum: レコードを格納したデータページの番号
+ *	recordData: 格納したレコード
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * データファイルの末尾にページを追加したときも、この関数で記録する。
+ */
+Result addToBloomFilter(BloomFilter *bloom, int pageNum, RecordData *recordData)
+{
+    unsigned char *entry;
+    unsigned char *filter;
+    unsigned int h1, h2, bit;
+    int modified = 0;
+    int i, k, n;
+
+    /* 記録のないページを飛ばしてページを追加したなら、飛ばしたページは何でもあり得るとしておく */
+    for (n = bloom->numPage; n < pageNum; n++) {
+        entry = getBloomEntry(bloom, n);
+        memset(entry, 0xff, bloom->numField * bloom->filterSize);
+        if (writeBloomEntry(bloom, n) != OK) {
+            return NG;
+        }
+    }
+
+    /*
+     * 値ごとに、2つのハッシュ値の組み合わせで決まるnumHash個のビットを立てる
+     * (フィールドの数はゾーンマップと同じくテーブルの定義から取る)
+     */
+    entry = getBloomEntry(bloom, pageNum);
+    for (i = 0; i < bloom->numTableField; i++) {
+        if ((n = bloom->column[i]) == -1) {
+            continue;
+        }
+        filter = entry + n * bloom->filterSize;
+        h1 = hashString(recordData->fieldData[i].stringValue, 0);
+        h2 = hashString(recordData->fieldData[i].stringValue, h1) | 1;
+        for (k = 0; k < bloom->numHash; k++) {
+            bit = (h1 + k * h2) % (bloom->filterSize * 8);
+            if ((filter[bit / 8] & (1 << (bit % 8))) == 0) {
+                filter[bit / 8] |= 1 << (bit % 8);
+                modified = 1;
+            }
+        }
+    }
+
+    if (modified || pageNum >= bloom->numPage) {
+        return writeBloomEntry(bloom, pageNum);
+    }
+    return OK;
+}
+
+/*
+ * clearBloomFilter -- データページが空になったことの記録
+ *
+ * 引数:
+ *	bloom: ブルームフィルタ
+ *	pageNum: 空になったデータページの番号
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result clearBloomFilter(BloomFilter *bloom, int pageNum)
+{
+    if (pageNum >= bloom->numPage) {
+        return OK;
+    }
+
+    memset(getBloomEntry(bloom, pageNum), 0, bloom->numField * bloom->filterSize);
+    return writeBloomEntry(bloom, pageNum);
+}
+
+/*
+ * truncateBloomFilter -- データファイルを切り詰めたことの記録
+ *
+ * 引数:
+ *	bloom: ブルームフィルタ
+ *	numPage: 切り詰めた後のデータファイルのページ数
+ *
+ * 返り値:
+ *	なし
+ *
+ * 切り詰めるページは、先にclearBloomFilterで空にしておくこと
+ * (後でページを追加したときに、そのフィルタを空からビットを立てるため)。
+ */
+void truncateBloomFilter(BloomFilter *bloom, int numPage)
+{
+    if (numPage < bloom->numPage) {
+        bloom->numPage = numPage;
+        bloom->headerModified = 1;
+    }
+}
+
+/*
+ * checkBloomFilter -- データページに条件に合うレコードがあり得るかどうか
+ *
+ * 引数:
+ *	bloom: ブルームフィルタ
+ *	pageNum: データページの番号
+ *	field: 条件のフィールドの番号
+ *	condition: 条件
+ *
+ * 返り値:
+ *	条件に合うレコードがあり得なければ0、あり得れば1を返す
+ *	(記録のないページ、文字列の値との等号でない条件では1を返す)
+ */
+int checkBloomFilter(BloomFilter *bloom, int pageNum, int field, Condition *condition)
+{
+    unsigned char *filter;
+    unsigned int h1, h2, bit;
+    int k;
+
+    if (pageNum >= bloom->numPage || field < 0 || field >= MAX_FIELD
+        || bloom->column[field] == -1 || condition->dataType != TYPE_STRING
+        || condition->operator != OPR_EQUAL) {
+        return 1;
+    }
+
+    filter = getBloomEntry(bloom, pageNum) + bloom->column[field] * bloom->filterSize;
+    h1 = hashString(condition->stringValue, 0);
+    h2 = hashString(condition->stringValue, h1) | 1;
+    for (k = 0; k < bloom->numHash; k++) {
+        bit = (h1 + k * h2) % (bloom->filterSize * 8);
+        if ((filter[bit / 8] & (1 << (bit % 8))) == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
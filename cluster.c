@@ -0,0 +1,423 @@
+/*
+ * cluster.c -- クラスタ化テーブルのモジュール
+ *
+ * clustered byを指定したテーブルでは、レコードをキー(1つのフィールド)の順に
+ * ページへ振り分ける。ページの中のレコードの順序は決めないが、どのページも、
+ * キーがある範囲に入るレコードだけを持つ。
+ * ページごとのキーの下限(フェンスキー)をキーの順に並べた配列をメモリ上に持ち、
+ * 挿入先のページと、範囲の条件に合うレコードがあるページを二分探索で求める。
+ *
+ * フェンスキーの配列の要素kのページには、キーがkの値以上、k+1の値以下の
+ * レコードが入っている(同じキーのレコードが隣り合う2つのページにまたがることがある)。
+ * 配列はデータファイルには書かず、最初に使うときにデータファイルを1回読み、
+ * ページごとの最小のキーから作る。データファイルのページ数が作ったときと
+ * 食い違っていれば作り直す。空のページは配列に入れない。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * ClusterFence -- フェンスキー
+ */
+typedef struct ClusterFence ClusterFence;
+struct ClusterFence {
+    int intValue;                       /*キーの下限(整数型)*/
+    char stringValue[MAX_VARSTRING];    /*キーの下限(文字列型)*/
+    int pageNum;                        /*ページ番号*/
+};
+
+/*
+ * FenceArray -- テーブルのフェンスキーの配列
+ */
+typedef struct FenceArray FenceArray;
+struct FenceArray {
+    char tableName[MAX_FILENAME];       /*テーブル名*/
+    int numPage;                        /*データファイルのページ数*/
+    DataType keyType;                   /*キーのデータ型*/
+    ClusterFence *fences;               /*キーの順に並べたフェンスキー*/
+    int numFence;                       /*フェンスキーの数*/
+    int maxFence;                       /*配列の大きさ*/
+    FenceArray *next;                   /*次のテーブルの配列*/
+};
+
+/*
+ * fenceList -- 作ったフェンスキーの配列のリスト
+ */
+static FenceArray *fenceList = NULL;
+
+/*
+ * getClusterField -- テーブルのレコードを並べるキーのフィールドの番号の取得
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	キーのフィールドの番号。クラスタ化テーブルでなければ-1を返す。
+ */
+int getClusterField(TableInfo *tableInfo)
+{
+    int i;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (IS_CLUSTER_FIELD(tableInfo, i)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * compareKey -- フェンスキーと値の比較
+ *
+ * 返り値:
+ *	フェンスキーが値より小さければ負、等しければ0、大きければ正の数
+ */
+static int compareKey(FenceArray *array, ClusterFence *fence, int intValue, char *stringValue)
+{
+    if (array->keyType == TYPE_STRING) {
+        return strcmp(fence->stringValue, stringValue);
+    }
+    return fence->intValue < intValue ? -1 : fence->intValue > intValue ? 1 : 0;
+}
+
+/*
+ * compareFence -- qsortに渡す、フェンスキーの比較関数(キーが同じならページ番号の順)
+ */
+static DataType sortKeyType;
+static int compareFence(const void *a, const void *b)
+{
+    const ClusterFence *x = a;
+    const ClusterFence *y = b;
+    int c;
+
+    if (sortKeyType == TYPE_STRING) {
+        c = strcmp(x->stringValue, y->stringValue);
+    } else {
+        c = x->intValue < y->intValue ? -1 : x->intValue > y->intValue ? 1 : 0;
+    }
+    return c != 0 ? c : x->pageNum - y->pageNum;
+}
+
+/*
+ * comparePageList -- qsortに渡す、ページ番号の比較関数
+ */
+static int comparePageList(const void *a, const void *b)
+{
+    return *(const int *) a - *(const int *) b;
+}
+
+/*
+ * freeFenceArray -- フェンスキーの配列をリストから外して解放する
+ */
+static void freeFenceArray(FenceArray *array)
+{
+    FenceArray **p;
+
+    for (p = &fenceList; *p != NULL; p = &(*p)->next) {
+        if (*p == array) {
+            *p = array->next;
+            break;
+        }
+    }
+    free(array->fences);
+    free(array);
+}
+
+/*
+ * growFences -- フェンスキーの配列を、もう1つ要素を加えられる大きさにする
+ *
+ * 引数:
+ *	array: フェンスキーの配列
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+static Result growFences(FenceArray *array)
+{
+    ClusterFence *fences;
+    int maxFence;
+
+    if (array->numFence < array->maxFence) {
+        return OK;
+    }
+    maxFence = array->maxFence == 0 ? 64 : array->maxFence * 2;
+    if ((fences = (ClusterFence *) realloc(array->fences, maxFence * sizeof(ClusterFence))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    array->fences = fences;
+    array->maxFence = maxFence;
+    return OK;
+}
+
+/*
+ * openFenceArray -- テーブルのフェンスキーの配列を取り出す(なければ作る)
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	フェンスキーの配列。クラスタ化テーブルでない場合やエラーの場合はNULLを返す。
+ */
+static FenceArray *openFenceArray(char *tableName, File *file, int numPage, TableInfo *tableInfo)
+{
+    FenceArray *array;
+    ClusterFence *fence;
+    FieldData fieldData;
+    char page[PAGE_SIZE];
+    int field;
+    int i, j;
+
+    if ((field = getClusterField(tableInfo)) == -1) {
+        return NULL;
+    }
+    for (array = fenceList; array != NULL; array = array->next) {
+        if (strcmp(array->tableName, tableName) == 0) {
+            break;
+        }
+    }
+    if (array != NULL) {
+        if (array->numPage == numPage) {
+            return array;
+        }
+        freeFenceArray(array);
+    }
+
+    /* ページごとに最小のキーを求めて、キーの順に並べる */
+    if ((array = (FenceArray *) calloc(1, sizeof(FenceArray))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    snprintf(array->tableName, MAX_FILENAME, "%s", tableName);
+    array->numPage = numPage;
+    array->keyType = tableInfo->fieldInfo[field].dataType;
+    for (i = 0; i < numPage; i++) {
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            free(array->fences);
+            free(array);
+            return NULL;
+        }
+        fence = NULL;
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            if (readSlotField(page, j, tableInfo, field, &fieldData) != OK) {
+                continue;
+            }
+            if (fence == NULL) {
+                if (growFences(array) != OK) {
+                    free(array->fences);
+                    free(array);
+                    return NULL;
+                }
+                fence = &array->fences[array->numFence++];
+                fence->pageNum = i;
+            } else if (compareKey(array, fence, fieldData.intValue, fieldData.stringValue) <= 0) {
+                continue;
+            }
+            fence->intValue = fieldData.intValue;
+            strcpy(fence->stringValue, fieldData.stringValue);
+        }
+    }
+    sortKeyType = array->keyType;
+    if (array->numFence > 0) {
+        qsort(array->fences, array->numFence, sizeof(ClusterFence), compareFence);
+    }
+
+    array->next = fenceList;
+    fenceList = array;
+    return array;
+}
+
+/*
+ * countFencesBelow -- キーが値より小さい(orEqualが1なら値以下の)フェンスキーの数を求める
+ */
+static int countFencesBelow(FenceArray *array, int intValue, char *stringValue, int orEqual)
+{
+    int lo = 0;
+    int hi = array->numFence;
+    int mid;
+    int c;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        c = compareKey(array, &array->fences[mid], intValue, stringValue);
+        if (c < 0 || (orEqual && c == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+ * findClusterPage -- レコードを挿入するページの検索
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *	key: 挿入するレコードのキーのフィールドの値
+ *
+ * 返り値:
+ *	キーが入る範囲のページの番号。レコードがまだない場合やエラーの場合は-1を返す。
+ *
+ * キー以下の最後のフェンスキーのページを返す。キーがどのフェンスキーよりも
+ * 小さい場合は、最初のページのフェンスキーをキーまで下げてそのページを返す。
+ */
+int findClusterPage(char *tableName, File *file, int numPage, TableInfo *tableInfo, FieldData *key)
+{
+    FenceArray *array;
+    ClusterFence *fence;
+    int k;
+
+    if ((array = openFenceArray(tableName, file, numPage, tableInfo)) == NULL || array->numFence == 0) {
+        return -1;
+    }
+    k = countFencesBelow(array, key->intValue, key->stringValue, 1);
+    if (k == 0) {
+        fence = &array->fences[0];
+        fence->intValue = key->intValue;
+        strcpy(fence->stringValue, key->stringValue);
+        return fence->pageNum;
+    }
+    return array->fences[k - 1].pageNum;
+}
+
+/*
+ * addClusterFence -- 新しいページのフェンスキーを加える
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	numPage: ページを加えた後のデータファイルのページ数
+ *	prevPage: キーの範囲が新しいページのすぐ前になるページの番号(最初のページなら-1)
+ *	key: 新しいページのキーの下限
+ *	pageNum: 新しいページの番号
+ *
+ * 返り値:
+ *	なし
+ *
+ * 加えられなかった場合は配列を捨て、次に使うときにデータファイルから作り直す。
+ */
+void addClusterFence(char *tableName, int numPage, int prevPage, FieldData *key, int pageNum)
+{
+    FenceArray *array;
+    int k;
+
+    for (array = fenceList; array != NULL; array = array->next) {
+        if (strcmp(array->tableName, tableName) == 0) {
+            break;
+        }
+    }
+    if (array == NULL) {
+        return;
+    }
+    for (k = 0; k < array->numFence && array->fences[k].pageNum != prevPage; k++) {
+        ;
+    }
+    if ((prevPage != -1 && k == array->numFence) || growFences(array) != OK) {
+        freeFenceArray(array);
+        return;
+    }
+    k = prevPage == -1 ? 0 : k + 1;
+    memmove(&array->fences[k + 1], &array->fences[k], (array->numFence - k) * sizeof(ClusterFence));
+    array->fences[k].intValue = key->intValue;
+    strcpy(array->fences[k].stringValue, key->stringValue);
+    array->fences[k].pageNum = pageNum;
+    array->numFence++;
+    array->numPage = numPage;
+}
+
+/*
+ * searchClusterPages -- フェンスキーを使った、条件に合うレコードがあるページの検索
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *	condition: キーのフィールドについての条件
+ *	numListed: 見つかったページの数を格納する場所
+ *
+ * 返り値:
+ *	条件に合うレコードがあるページの番号を昇順に並べた配列。使い終わったらfreeで解放すること。
+ *	フェンスキーを使えない条件(!=、like)の場合やエラーの場合はNULLを返す。
+ *
+ * =、<、>の条件では、合うキーの範囲はフェンスキーの配列の連続した部分になる。
+ */
+int *searchClusterPages(char *tableName, File *file, int numPage, TableInfo *tableInfo,
+                        Condition *condition, int *numListed)
+{
+    FenceArray *array;
+    int *pageList;
+    int start, end;
+    int i;
+
+    if (condition->dataType != tableInfo->fieldInfo[getClusterField(tableInfo)].dataType
+        || (condition->operator != OPR_EQUAL && condition->operator != OPR_LESS_THAN
+            && condition->operator != OPR_GREATER_THAN)
+        || (array = openFenceArray(tableName, file, numPage, tableInfo)) == NULL) {
+        return NULL;
+    }
+
+    /* 条件に合うキーがあるかもしれないフェンスキーの範囲[start, end)を求める */
+    switch (condition->operator) {
+    case OPR_LESS_THAN:
+        start = 0;
+        end = countFencesBelow(array, condition->intValue, condition->stringValue, 0);
+        break;
+    case OPR_GREATER_THAN:
+        start = countFencesBelow(array, condition->intValue, condition->stringValue, 1) - 1;
+        end = array->numFence;
+        break;
+    default:
+        start = countFencesBelow(array, condition->intValue, condition->stringValue, 0) - 1;
+        end = countFencesBelow(array, condition->intValue, condition->stringValue, 1);
+        break;
+    }
+    if (start < 0) {
+        start = 0;
+    }
+
+    if ((pageList = (int *) malloc((end - start + 1) * sizeof(int))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    *numListed = 0;
+    for (i = start; i < end; i++) {
+        pageList[(*numListed)++] = array->fences[i].pageNum;
+    }
+    if (*numListed > 0) {
+        qsort(pageList, *numListed, sizeof(int), comparePageList);
+    }
+    return pageList;
+}
+
+/*
+ * discardClusterFence -- テーブルのフェンスキーの配列を捨てる
+ *
+ * 引数:
+ *	tableName: テーブル名(NULLならすべてのテーブル)
+ *
+ * 返り値:
+ *	なし
+ */
+void discardClusterFence(char *tableName)
+{
+    FenceArray *array, *next;
+
+    for (array = fenceList; array != NULL; array = next) {
+        next = array->next;
+        if (tableName == NULL || strcmp(array->tableName, tableName) == 0) {
+            freeFenceArray(array);
+        }
+    }
+}
@@ -0,0 +1,529 @@
+/*
+ * crack.c -- 適応型索引(クラッキング)モジュール
+ *
+ * crackを指定した整数型のフィールドについて、(値, RecordId)の組をメモリ上の
+ * 配列(クラッカー列)に持つ。最初に範囲の条件で検索したときにデータファイルを
+ * 1回読んで配列を作り、その後は検索のたびに、条件の境界の値で配列の一部だけを
+ * 2つに分ける(境界の値より小さいものを前に、それ以上のものを後ろに並べ直す)。
+ * 分けた位置(カット)を覚えておくので、同じ列への検索を繰り返すほど配列は
+ * 値の順に近づき、条件に合う部分をすぐに取り出せるようになる。
+ * 索引を前もって作る必要はなく、検索しない列には何のコストもかからない。
+ *
+ * 配列はデータファイルには書かず、プロセスの中だけで持つ。
+ * 挿入と削除ではカットの位置を保ったまま配列を直す。直せない場合や、
+ * データファイルのページ数が作ったときと食い違った場合は配列を捨て、
+ * 次の検索で作り直す。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * CRACK_INITIAL_ENTRIES -- クラッカー列の配列の最初の大きさ
+ */
+#define CRACK_INITIAL_ENTRIES 1024
+
+/*
+ * CRACK_MAX_DELETE_SCAN -- 削除で、消すレコードを探すために調べる範囲の上限
+ *
+ * 消すレコードはその値が入る区間(カットとカットの間)の中を順に探す。
+ * 区間がこれより大きい(まだ十分に分けていない)場合は、探さずに配列を捨てる。
+ */
+#define CRACK_MAX_DELETE_SCAN 4096
+
+/*
+ * CrackerEntry -- クラッカー列の要素
+ */
+typedef struct CrackerEntry CrackerEntry;
+struct CrackerEntry {
+    int value;                          /*フィールドの値*/
+    RecordId rid;                       /*レコードの位置*/
+};
+
+/*
+ * CrackerColumn -- クラッカー列
+ *
+ * カットk(0 <= k < numCut)より前の要素の値はpivot[k]未満、position[k]以降の
+ * 要素の値はpivot[k]以上になっている。pivotは昇順に並べる。
+ */
+typedef struct CrackerColumn CrackerColumn;
+struct CrackerColumn {
+    char tableName[MAX_FILENAME];       /*テーブル名*/
+    int field;                          /*フィールドの番号*/
+    int numPage;                        /*データファイルのページ数*/
+    CrackerEntry *entries;              /*要素の配列*/
+    int numEntry;                       /*要素の数*/
+    int maxEntry;                       /*配列の大きさ*/
+    int *pivot;                         /*カットの値*/
+    int *position;                      /*カットの位置(pivot以上の最初の要素の番号)*/
+    int numCut;                         /*カットの数*/
+    int maxCut;                         /*pivotとpositionの配列の大きさ*/
+    CrackerColumn *next;                /*次のクラッカー列*/
+};
+
+/*
+ * crackerList -- 作ったクラッカー列のリスト
+ */
+static CrackerColumn *crackerList = NULL;
+
+/*
+ * freeCracker -- クラッカー列の解放
+ *
+ * 引数:
+ *	cracker: 解放するクラッカー列
+ *
+ * 返り値:
+ *	なし
+ */
+static void freeCracker(CrackerColumn *cracker)
+{
+    free(cracker->entries);
+    free(cracker->pivot);
+    free(cracker->position);
+    free(cracker);
+}
+
+/*
+ * findCracker -- クラッカー列を探す
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	field: フィールドの番号
+ *
+ * 返り値:
+ *	見つかったクラッカー列。作っていなければNULLを返す。
+ */
+static CrackerColumn *findCracker(char *tableName, int field)
+{
+    CrackerColumn *cracker;
+
+    for (cracker = crackerList; cracker != NULL; cracker = cracker->next) {
+        if (cracker->field == field && strcmp(cracker->tableName, tableName) == 0) {
+            return cracker;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * removeCracker -- クラッカー列をリストから外して解放する
+ *
+ * 引数:
+ *	cracker: 捨てるクラッカー列
+ *
+ * 返り値:
+ *	なし
+ */
+static void removeCracker(CrackerColumn *cracker)
+{
+    CrackerColumn **p;
+
+    for (p = &crackerList; *p != NULL; p = &(*p)->next) {
+        if (*p == cracker) {
+            *p = cracker->next;
+            freeCracker(cracker);
+            return;
+        }
+    }
+}
+
+/*
+ * growEntries -- 要素の配列を、もう1つ要素を加えられる大きさにする
+ *
+ * 引数:
+ *	cracker: クラッカー列
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+static Result growEntries(CrackerColumn *cracker)
+{
+    CrackerEntry *entries;
+    int maxEntry;
+
+    if (cracker->numEntry < cracker->maxEntry) {
+        return OK;
+    }
+    maxEntry = cracker->maxEntry == 0 ? CRACK_INITIAL_ENTRIES : cracker->maxEntry * 2;
+    if ((entries = (CrackerEntry *) realloc(cracker->entries, maxEntry * sizeof(CrackerEntry))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    cracker->entries = entries;
+    cracker->maxEntry = maxEntry;
+    return OK;
+}
+
+/*
+ * buildCracker -- データファイルを読んでクラッカー列を作る
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *	field: フィールドの番号
+ *
+ * 返り値:
+ *	作ったクラッカー列(まだ1つもカットはない)。失敗した場合はNULLを返す。
+ */
+static CrackerColumn *buildCracker(char *tableName, File *file, int numPage, TableInfo *tableInfo, int field)
+{
+    CrackerColumn *cracker;
+    FieldData fieldData;
+    char page[PAGE_SIZE];
+    int i, j;
+
+    if ((cracker = (CrackerColumn *) calloc(1, sizeof(CrackerColumn))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    snprintf(cracker->tableName, MAX_FILENAME, "%s", tableName);
+    cracker->field = field;
+    cracker->numPage = numPage;
+
+    for (i = 0; i < numPage; i++) {
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            freeCracker(cracker);
+            return NULL;
+        }
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            if (readSlotField(page, j, tableInfo, field, &fieldData) != OK) {
+                continue;
+            }
+            if (growEntries(cracker) != OK) {
+                freeCracker(cracker);
+                return NULL;
+            }
+            cracker->entries[cracker->numEntry].value = fieldData.intValue;
+            cracker->entries[cracker->numEntry].rid.pageNum = i;
+            cracker->entries[cracker->numEntry].rid.slot = j;
+            cracker->numEntry++;
+        }
+    }
+    return cracker;
+}
+
+/*
+ * findCut -- 値以上のpivotを持つ最初のカットの番号を求める
+ *
+ * 引数:
+ *	cracker: クラッカー列
+ *	value: 値
+ *
+ * 返り値:
+ *	カットの番号(すべてのpivotが値より小さければnumCut)
+ */
+static int findCut(CrackerColumn *cracker, int value)
+{
+    int lo = 0;
+    int hi = cracker->numCut;
+    int mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (cracker->pivot[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+ * crackAt -- クラッカー列を値で分ける
+ *
+ * 引数:
+ *	cracker: クラッカー列
+ *	value: 分ける値
+ *	position: 値以上の最初の要素の番号を格納する場所
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * 値が入る区間の中だけを並べ直し、分けた位置を新しいカットとして覚える。
+ * すでにその値のカットがあれば、並べ直さずにその位置を返す。
+ */
+static Result crackAt(CrackerColumn *cracker, int value, int *position)
+{
+    CrackerEntry tmp;
+    int *pivot, *pos;
+    int maxCut;
+    int k;
+    int i, j;
+
+    k = findCut(cracker, value);
+    if (k < cracker->numCut && cracker->pivot[k] == value) {
+        *position = cracker->position[k];
+        return OK;
+    }
+
+    /* 区間[i, j]の要素を、値より小さいものと値以上のものに分ける */
+    i = k > 0 ? cracker->position[k - 1] : 0;
+    j = (k < cracker->numCut ? cracker->position[k] : cracker->numEntry) - 1;
+    while (i <= j) {
+        if (cracker->entries[i].value < value) {
+            i++;
+        } else {
+            tmp = cracker->entries[i];
+            cracker->entries[i] = cracker->entries[j];
+            cracker->entries[j] = tmp;
+            j--;
+        }
+    }
+    *position = i;
+
+    /* 分けた位置をカットとして覚える(覚えられなくても、分けた結果は正しい) */
+    if (cracker->numCut == cracker->maxCut) {
+        maxCut = cracker->maxCut == 0 ? 16 : cracker->maxCut * 2;
+        if ((pivot = (int *) realloc(cracker->pivot, maxCut * sizeof(int))) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            return OK;
+        }
+        cracker->pivot = pivot;
+        if ((pos = (int *) realloc(cracker->position, maxCut * sizeof(int))) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            return OK;
+        }
+        cracker->position = pos;
+        cracker->maxCut = maxCut;
+    }
+    memmove(&cracker->pivot[k + 1], &cracker->pivot[k], (cracker->numCut - k) * sizeof(int));
+    memmove(&cracker->position[k + 1], &cracker->position[k], (cracker->numCut - k) * sizeof(int));
+    cracker->pivot[k] = value;
+    cracker->position[k] = i;
+    cracker->numCut++;
+    return OK;
+}
+
+/*
+ * searchCracker -- クラッカー列を使った、条件に合うレコードがあるページの検索
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *	field: 条件のフィールドの番号(crackを指定した整数型のフィールド)
+ *	condition: 条件
+ *	numListed: 見つかったページの数を格納する場所
+ *
+ * 返り値:
+ *	条件に合うレコードがあるページの番号を昇順に並べた配列。使い終わったらfreeで解放すること。
+ *	クラッカー列を使えない条件(!=など)の場合やエラーの場合はNULLを返す。
+ *
+ * クラッカー列がまだなければ、ここでデータファイルを読んで作る。
+ * 条件の境界の値で配列を分け、条件に合う範囲の要素のページに印を付けて並べる。
+ */
+int *searchCracker(char *tableName, File *file, int numPage, TableInfo *tableInfo, int field,
+                   Condition *condition, int *numListed)
+{
+    CrackerColumn *cracker;
+    char *pages;
+    int *pageList;
+    int start, end;
+    int i;
+
+    if (!IS_CRACK_FIELD(tableInfo, field) || condition->dataType != TYPE_INTEGER
+        || (condition->operator != OPR_EQUAL && condition->operator != OPR_LESS_THAN
+            && condition->operator != OPR_GREATER_THAN)) {
+        return NULL;
+    }
+
+    /* クラッカー列がないか、データファイルと食い違っていれば作り直す */
+    if ((cracker = findCracker(tableName, field)) != NULL && cracker->numPage != numPage) {
+        removeCracker(cracker);
+        cracker = NULL;
+    }
+    if (cracker == NULL) {
+        if ((cracker = buildCracker(tableName, file, numPage, tableInfo, field)) == NULL) {
+            return NULL;
+        }
+        cracker->next = crackerList;
+        crackerList = cracker;
+    }
+
+    /* 条件に合う要素の範囲[start, end)を、境界の値で分けて求める */
+    start = 0;
+    end = cracker->numEntry;
+    switch (condition->operator) {
+    case OPR_LESS_THAN:
+        if (crackAt(cracker, condition->intValue, &end) != OK) {
+            return NULL;
+        }
+        break;
+    case OPR_GREATER_THAN:
+        if (condition->intValue == INT_MAX) {
+            start = end;
+        } else if (crackAt(cracker, condition->intValue + 1, &start) != OK) {
+            return NULL;
+        }
+        break;
+    default:
+        if (crackAt(cracker, condition->intValue, &start) != OK) {
+            return NULL;
+        }
+        if (condition->intValue != INT_MAX && crackAt(cracker, condition->intValue + 1, &end) != OK) {
+            return NULL;
+        }
+        break;
+    }
+
+    /* 範囲の要素のページに印を付けてから並べる */
+    if ((pages = (char *) calloc(numPage + 1, 1)) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    for (i = start; i < end; i++) {
+        pages[cracker->entries[i].rid.pageNum] = 1;
+    }
+    if ((pageList = (int *) malloc((numPage + 1) * sizeof(int))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        free(pages);
+        return NULL;
+    }
+    *numListed = 0;
+    for (i = 0; i < numPage; i++) {
+        if (pages[i]) {
+            pageList[(*numListed)++] = i;
+        }
+    }
+    free(pages);
+    return pageList;
+}
+
+/*
+ * insertCrackerEntry -- 挿入したレコードをテーブルのクラッカー列に加える
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	numPage: 挿入した後のデータファイルのページ数
+ *	recordData: 挿入したレコード(格納する前の値)
+ *	rid: 挿入したレコードの位置
+ *
+ * 返り値:
+ *	なし
+ *
+ * 後ろのカットから順に、次の区間の先頭の要素を区間の後ろへ移して空きを前へ送り、
+ * 値が入る区間の最後に新しい要素を置く。動かす要素の数はカットの数までで済む。
+ * 加えられなかったクラッカー列は捨てる。
+ */
+void insertCrackerEntry(char *tableName, int numPage, RecordData *recordData, RecordId *rid)
+{
+    CrackerColumn *cracker, *next;
+    int value;
+    int hole;
+    int k;
+
+    for (cracker = crackerList; cracker != NULL; cracker = next) {
+        next = cracker->next;
+        if (strcmp(cracker->tableName, tableName) != 0) {
+            continue;
+        }
+        if (growEntries(cracker) != OK) {
+            removeCracker(cracker);
+            continue;
+        }
+        value = recordData->fieldData[cracker->field].intValue;
+        hole = cracker->numEntry++;
+        for (k = cracker->numCut - 1; k >= 0 && cracker->pivot[k] > value; k--) {
+            cracker->entries[hole] = cracker->entries[cracker->position[k]];
+            hole = cracker->position[k];
+            cracker->position[k]++;
+        }
+        cracker->entries[hole].value = value;
+        cracker->entries[hole].rid = *rid;
+        cracker->numPage = numPage;
+    }
+}
+
+/*
+ * deleteCrackerEntry -- 削除したレコードをテーブルのクラッカー列から取り除く
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	recordData: 削除したレコード(格納されている値)
+ *	rid: 削除したレコードの位置
+ *
+ * 返り値:
+ *	なし
+ *
+ * 値が入る区間の中で要素を探し、区間の最後の要素で埋める。空いた場所は、
+ * 後ろのカットから1つずつ位置を前へずらし、次の区間の最後の要素で埋めていく。
+ * 区間が大きすぎて探せない場合や、要素が見つからない場合はクラッカー列を捨てる。
+ */
+void deleteCrackerEntry(char *tableName, RecordData *recordData, RecordId *rid)
+{
+    CrackerColumn *cracker, *next;
+    int value;
+    int start, end;
+    int hole;
+    int i, k;
+
+    for (cracker = crackerList; cracker != NULL; cracker = next) {
+        next = cracker->next;
+        if (strcmp(cracker->tableName, tableName) != 0) {
+            continue;
+        }
+
+        /* 値が入る区間[start, end)の中で要素を探す */
+        value = recordData->fieldData[cracker->field].intValue;
+        k = findCut(cracker, value);
+        if (k < cracker->numCut && cracker->pivot[k] == value) {
+            k++;
+        }
+        start = k > 0 ? cracker->position[k - 1] : 0;
+        end = k < cracker->numCut ? cracker->position[k] : cracker->numEntry;
+        if (end - start > CRACK_MAX_DELETE_SCAN) {
+            removeCracker(cracker);
+            continue;
+        }
+        for (i = start; i < end; i++) {
+            if (cracker->entries[i].rid.pageNum == rid->pageNum && cracker->entries[i].rid.slot == rid->slot) {
+                break;
+            }
+        }
+        if (i == end) {
+            removeCracker(cracker);
+            continue;
+        }
+
+        /* 区間の最後の要素で埋め、空きを後ろの区間の最後へ送る */
+        cracker->entries[i] = cracker->entries[end - 1];
+        hole = end - 1;
+        for (; k < cracker->numCut; k++) {
+            cracker->position[k]--;
+            end = k + 1 < cracker->numCut ? cracker->position[k + 1] : cracker->numEntry;
+            cracker->entries[hole] = cracker->entries[end - 1];
+            hole = end - 1;
+        }
+        cracker->numEntry--;
+    }
+}
+
+/*
+ * discardCracker -- テーブルのクラッカー列をすべて捨てる
+ *
+ * 引数:
+ *	tableName: テーブル名(NULLならすべてのテーブル)
+ *
+ * 返り値:
+ *	なし
+ */
+void discardCracker(char *tableName)
+{
+    CrackerColumn *cracker, *next;
+
+    for (cracker = crackerList; cracker != NULL; cracker = next) {
+        next = cracker->next;
+        if (tableName == NULL || strcmp(cracker->tableName, tableName) == 0) {
+            removeCracker(cracker);
+        }
+    }
+}
@@ -13,6 +13,32 @@
  */
 #define DEF_FILE_EXT ".def"
 
+/*
+ * DEF_OPTION_OFFSET -- データ定義ファイルの0ページ目の中で、TableOptionを記録する位置
+ *
+ * MAX_FIELD個のフィールド情報の後ろに置く。
+ * 古いデータ定義ファイルではこの位置はすべて0なので、デフォルトの設定になる。
+ */
+#define DEF_OPTION_OFFSET 1024
+
+/*
+ * DEF_STAT_PAGE -- データ定義ファイルの中で、テーブルの統計情報を記録するページ
+ */
+#define DEF_STAT_PAGE 1
+
+/*
+ * DEF_STAT_MAGIC -- 統計情報のページが初期化済みであることを示す値
+ */
+#define DEF_STAT_MAGIC 0x73746174
+
+/*
+ * makeDefFileName -- データ定義ファイルのファイル名を作る
+ */
+static void makeDefFileName(char *filename, char *tableName)
+{
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DEF_FILE_EXT);
+}
+
 /*
  * initializeDataDefModule -- データ定義モジュールの初期化
  *
@@ -51,20 +77,84 @@ Result finalizeDataDefModule()
  * 返り値:
  *	成功ならOK、失敗ならNGを返す
  *
+ * tableInfo->optionは使わず、デフォルトの設定でテーブルを作る。
+ */
+Result createTable(char *tableName, TableInfo *tableInfo)
+{
+    return createTableWithOption(tableName, tableInfo, NULL);
+}
+
+/*
+ * createTableWithOption -- 格納方法を指定した表(テーブル)の作成
+ *
+ * 引数:
+ *	tableName: 作成する表の名前
+ *	tableInfo: データ定義情報
+ *	option: テーブルの格納方法の設定(NULLならデフォルトの設定)
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
  * データ定義ファイルの構造(ファイル名: tableName.def)
  *   +-------------------+----------------------+-------------------+----
  *   |フィールド数       |フィールド名          |データ型           |
  *   |(sizeof(int)バイト)|(MAX_FIELD_NAMEバイト)|(sizeof(int)バイト)|
  *   +-------------------+----------------------+-------------------+----
  * 以降、フィールド名とデータ型が交互に続く。
+ * DEF_OPTION_OFFSETバイト目からは、TableOption構造体をそのまま記録する。
+ * DEF_STAT_PAGEページ目はテーブルのヘッダページで、DEF_STAT_MAGICに続けて
+ * TableStat構造体を記録する(closeTableStatを参照)。
+ * その後ろのページには、ゾーンマップを記録する(zonemap.cを参照)。
  */
-Result createTable(char *tableName, TableInfo *tableInfo)
+Result createTableWithOption(char *tableName, TableInfo *tableInfo, TableOption *option)
 {
     int i, len;
     char *filename;
     File *file;
     char page[PAGE_SIZE];
     char *p;
+    TableStat stat;
+    TableOption newOption;
+    TableOption tempOption;
+    char defFileName[MAX_FILENAME];
+    int found;
+
+    /*
+     * インメモリテーブルはファイルを作らず、定義もメモリ上にだけ置く
+     * (同じ名前のテーブルがファイルにもメモリ上にもできないようにする)
+     */
+    if (option != NULL && option->memory) {
+        makeDefFileName(defFileName, tableName);
+        if (getNumPages(defFileName) != -1 || isTempTable(tableName)) {
+            return NG;
+        }
+        return createMemoryTable(tableName, tableInfo);
+    }
+    if (isMemoryTable(tableName) || isTempTable(tableName)) {
+        return NG;
+    }
+
+    /*
+     * 一時テーブルは、一時ディレクトリ付きの名前でふつうのテーブルとして作る
+     * (パーティションは一時テーブル専用のものにする)
+     */
+    if (option != NULL && option->temp) {
+        makeDefFileName(defFileName, tableName);
+        if (getNumPages(defFileName) != -1) {
+            return NG;
+        }
+        tempOption = *option;
+        tempOption.temp = 0;
+        if ((tableName = createTempTable(tableName, &tempOption)) == NULL) {
+            return NG;
+        }
+        if (createTableWithOption(tableName, tableInfo, &tempOption) != OK) {
+            dropTable(tableName);
+            removeTempTable(tableName);
+            return NG;
+        }
+        return OK;
+    }
 
     /*[tableName].defと言う文字列を作る*/
     len = strlen(tableName) + strlen(DEF_FILE_EXT) + 1;
@@ -117,6 +207,94 @@ Result createTable(char *tableName, TableInfo *tableInfo)
 
     }
 
+    /*
+     * テーブルの格納方法の設定を記録する
+     * 新しく作るテーブルの固定長形式は、ビットマップを使う形式にする
+     */
+    memset(&newOption, 0, sizeof(TableOption));
+    if (option != NULL) {
+        newOption = *option;
+    }
+    if (newOption.layout == LAYOUT_FIXED_FLAG) {
+        newOption.layout = LAYOUT_FIXED;
+    }
+    /*
+     * 辞書圧縮は文字列型のフィールドにだけ、ビット詰めは列ごとの形式の整数型のフィールドにだけ、
+     * ブルームフィルタは辞書圧縮しない文字列型のフィールドにだけ、クラッキングは整数型のフィールドにだけ使う
+     */
+    for (i = 0; i < MAX_FIELD; i++) {
+        if (i >= tableInfo->numField || tableInfo->fieldInfo[i].dataType != TYPE_STRING) {
+            newOption.dictionary[i] = 0;
+        }
+        if (i >= tableInfo->numField || tableInfo->fieldInfo[i].dataType != TYPE_INTEGER
+            || newOption.layout != LAYOUT_PAX || newOption.packBits[i] < 0
+            || newOption.packBits[i] > MAX_PACK_BITS) {
+            newOption.packBits[i] = 0;
+        }
+        if (i >= tableInfo->numField || tableInfo->fieldInfo[i].dataType != TYPE_STRING
+            || newOption.dictionary[i] != 0) {
+            newOption.bloom[i] = 0;
+        }
+        if (i >= tableInfo->numField || tableInfo->fieldInfo[i].dataType != TYPE_INTEGER) {
+            newOption.crack[i] = 0;
+        }
+    }
+    /*
+     * ログ構造化テーブルのキーは、整数型か文字列型の最初の1つだけにする
+     * (レコードはデータファイルに置かないので、データファイルのページに関わる設定は使わない)
+     */
+    for (i = 0, found = 0; i < MAX_FIELD; i++) {
+        if (found || i >= tableInfo->numField
+            || (tableInfo->fieldInfo[i].dataType != TYPE_INTEGER
+                && tableInfo->fieldInfo[i].dataType != TYPE_STRING)) {
+            newOption.lsm[i] = 0;
+        }
+        found |= newOption.lsm[i] != 0;
+    }
+    if (found) {
+        memset(newOption.dictionary, 0, sizeof(newOption.dictionary));
+        memset(newOption.packBits, 0, sizeof(newOption.packBits));
+        memset(newOption.bloom, 0, sizeof(newOption.bloom));
+        memset(newOption.crack, 0, sizeof(newOption.crack));
+        memset(newOption.cluster, 0, sizeof(newOption.cluster));
+        memset(newOption.series, 0, sizeof(newOption.series));
+    }
+    /*
+     * 時系列テーブルの時刻は、整数型の最初の1つだけにする
+     * (レコードは挿入の順に末尾のページへ追記するので、クラスタ化はしない)
+     */
+    for (i = 0, found = 0; i < MAX_FIELD; i++) {
+        if (found || i >= tableInfo->numField || tableInfo->fieldInfo[i].dataType != TYPE_INTEGER) {
+            newOption.series[i] = 0;
+        }
+        found |= newOption.series[i] != 0;
+    }
+    if (found) {
+        memset(newOption.cluster, 0, sizeof(newOption.cluster));
+    }
+    /*
+     * クラスタ化テーブルのキーは、整数型か辞書圧縮しない文字列型の最初の1つだけにする
+     * (キーの順にページを分割するので、値がページの基準値からの差に収まらないことがある
+     * ビット詰めは使わない)
+     */
+    for (i = 0, found = 0; i < MAX_FIELD; i++) {
+        if (found || i >= tableInfo->numField || newOption.dictionary[i] != 0
+            || (tableInfo->fieldInfo[i].dataType != TYPE_INTEGER
+                && tableInfo->fieldInfo[i].dataType != TYPE_STRING)) {
+            newOption.cluster[i] = 0;
+        }
+        found |= newOption.cluster[i] != 0;
+    }
+    if (found) {
+        memset(newOption.packBits, 0, sizeof(newOption.packBits));
+    }
+    if (newOption.bloomRate < 0 || newOption.bloomRate > MAX_BLOOM_RATE) {
+        newOption.bloomRate = 0;
+    }
+    /*索引はテーブルを作った後にcreateIndexで作る*/
+    memset(newOption.index, 0, sizeof(newOption.index));
+    memcpy(page + DEF_OPTION_OFFSET, &newOption, sizeof(TableOption));
+
     /*出来上がったpageをwritePageでファイル[tableName].defの0ページめに記録する*/
     if((writePage(file, 0, page)) == NG){
         printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
@@ -129,6 +307,13 @@ Result createTable(char *tableName, TableInfo *tableInfo)
         return NG;
     }
 
+    /*空のテーブルの統計情報をヘッダページに記録する*/
+    memset(&stat, 0, sizeof(TableStat));
+    stat.lastInsertPage = -1;
+    if (setTableStat(tableName, &stat) != OK) {
+        return NG;
+    }
+
     /*OKを返す*/
 
     return OK;
@@ -150,6 +335,28 @@ Result dropTable(char *tableName)
     /*tableFileName.[DEF_FILE_EXT]という文字列を作る*/
     char tableFileName[260];
     int len = strlen(tableName) + strlen(DEF_FILE_EXT) + 1;
+    TableInfo *tableInfo;
+    int i;
+
+    /*インメモリテーブルなら、メモリ上の定義とレコードを捨てるだけ*/
+    if (dropMemoryTable(tableName) == OK) {
+        return OK;
+    }
+
+    /*一時テーブルなら、一時ディレクトリのファイルを削除する*/
+    tableName = resolveTableName(tableName);
+    len = strlen(tableName) + strlen(DEF_FILE_EXT) + 1;
+
+    /*データ定義ファイルを削除する前に、テーブルに作った索引の索引ファイルを削除する*/
+    if ((tableInfo = getTableInfo(tableName)) != NULL) {
+        for (i = 0; i < tableInfo->numField; i++) {
+            if (HAS_INDEX(tableInfo, i)) {
+                deleteIndexFile(tableInfo->option.index[i]);
+            }
+        }
+        freeTableInfo(tableInfo);
+    }
+
     memset(tableFileName, '\0', strlen(tableFileName));
     snprintf(tableFileName, len, "%s%s", tableName, DEF_FILE_EXT);
     /*tableFileNameという名前を持つファイルを削除する*/
@@ -162,6 +369,7 @@ Result dropTable(char *tableName)
         printErrorMessage(ERR_MSG_UNLINK, __func__, __LINE__);
         return NG;
     }
+    removeTempTable(tableName);
 
     /*okを返す*/
     return OK;
@@ -196,6 +404,15 @@ TableInfo *getTableInfo(char *tableName)
     char tableFileName[MAX_FILENAME+10];
     int len = strlen(tableName) + strlen(DEF_FILE_EXT) + 1;
 
+    /*インメモリテーブルなら、メモリ上の定義を返す*/
+    if (isMemoryTable(tableName)) {
+        return getMemoryTableInfo(tableName);
+    }
+
+    /*一時テーブルなら、一時ディレクトリのデータ定義ファイルを読む*/
+    tableName = resolveTableName(tableName);
+    len = strlen(tableName) + strlen(DEF_FILE_EXT) + 1;
+
     memset(tableFileName, '\0', strlen(tableFileName));
     snprintf(tableFileName, len, "%s%s", tableName, DEF_FILE_EXT);
 
@@ -239,6 +456,9 @@ TableInfo *getTableInfo(char *tableName)
         p += sizeof(int);
         tableinfo->fieldInfo[i].dataType = data;
     }
+
+    /*テーブルの格納方法の設定を取り出す*/
+    memcpy(&tableinfo->option, page + DEF_OPTION_OFFSET, sizeof(TableOption));
         
 
     /*ファイルをクローズする*/
@@ -252,6 +472,307 @@ TableInfo *getTableInfo(char *tableName)
     return tableinfo;
 }
 
+/*
+ * setTablePartition -- テーブルが使うバッファプールのパーティションの変更
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	partition: パーティション名(""なら"default")
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * 設定はデータ定義ファイルに記録され、次にテーブルのデータファイルを
+ * オープンしたときから使われる。
+ */
+Result setTablePartition(char *tableName, char *partition)
+{
+    File *file;
+    char page[PAGE_SIZE];
+    TableOption option;
+    char tableFileName[MAX_FILENAME+10];
+
+    if (strlen(partition) >= MAX_PARTITION_NAME) {
+        return NG;
+    }
+
+    snprintf(tableFileName, sizeof(tableFileName), "%s%s", resolveTableName(tableName), DEF_FILE_EXT);
+
+    /*データ定義ファイルの0ページ目を読み込む*/
+    if ((file = openFile(tableFileName)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+    if (readPage(file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        closeFile(file);
+        return NG;
+    }
+
+    /*パーティション名を書き換えて書き戻す*/
+    memcpy(&option, page + DEF_OPTION_OFFSET, sizeof(TableOption));
+    memset(option.partition, 0, MAX_PARTITION_NAME);
+    strcpy(option.partition, partition);
+    memcpy(page + DEF_OPTION_OFFSET, &option, sizeof(TableOption));
+
+    if (writePage(file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        closeFile(file);
+        return NG;
+    }
+
+    if (closeFile(file) != OK) {
+        printErrorMessage(ERR_MSG_CLOSE, __func__, __LINE__);
+        return NG;
+    }
+    return OK;
+}
+
+/*
+ * setTableIndex -- フィールドに作った索引の名前の記録
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	field: フィールドの番号
+ *	indexName: 索引名(""なら索引がないことを記録する)
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result setTableIndex(char *tableName, int field, char *indexName)
+{
+    File *file;
+    char page[PAGE_SIZE];
+    TableOption option;
+    char tableFileName[MAX_FILENAME+10];
+
+    if (strlen(indexName) >= MAX_INDEX_NAME || field < 0 || field >= MAX_FIELD) {
+        return NG;
+    }
+
+    snprintf(tableFileName, sizeof(tableFileName), "%s%s", resolveTableName(tableName), DEF_FILE_EXT);
+
+    /*データ定義ファイルの0ページ目を読み込む*/
+    if ((file = openFile(tableFileName)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+    if (readPage(file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        closeFile(file);
+        return NG;
+    }
+
+    /*索引名を書き換えて書き戻す*/
+    memcpy(&option, page + DEF_OPTION_OFFSET, sizeof(TableOption));
+    memset(option.index[field], 0, MAX_INDEX_NAME);
+    strcpy(option.index[field], indexName);
+    memcpy(page + DEF_OPTION_OFFSET, &option, sizeof(TableOption));
+
+    if (writePage(file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        closeFile(file);
+        return NG;
+    }
+
+    if (closeFile(file) != OK) {
+        printErrorMessage(ERR_MSG_CLOSE, __func__, __LINE__);
+        return NG;
+    }
+    return OK;
+}
+
+/*
+ * setTableCluster -- クラスタ化テーブルのキーの記録
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	field: キーにするフィールドの番号(-1ならクラスタ化しないことを記録する)
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * キーを決めるとビット詰めをやめるので、データファイルを作り直す
+ * clusterTableからだけ呼ぶこと。
+ */
+Result setTableCluster(char *tableName, int field)
+{
+    File *file;
+    char page[PAGE_SIZE];
+    TableOption option;
+    char tableFileName[MAX_FILENAME+10];
+
+    if (field < -1 || field >= MAX_FIELD) {
+        return NG;
+    }
+
+    snprintf(tableFileName, sizeof(tableFileName), "%s%s", resolveTableName(tableName), DEF_FILE_EXT);
+
+    /*データ定義ファイルの0ページ目を読み込む*/
+    if ((file = openFile(tableFileName)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+    if (readPage(file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        closeFile(file);
+        return NG;
+    }
+
+    /*キーを書き換えて書き戻す*/
+    memcpy(&option, page + DEF_OPTION_OFFSET, sizeof(TableOption));
+    memset(option.cluster, 0, sizeof(option.cluster));
+    if (field != -1) {
+        option.cluster[field] = 1;
+        memset(option.packBits, 0, sizeof(option.packBits));
+    }
+    memcpy(page + DEF_OPTION_OFFSET, &option, sizeof(TableOption));
+
+    if (writePage(file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        closeFile(file);
+        return NG;
+    }
+
+    if (closeFile(file) != OK) {
+        printErrorMessage(ERR_MSG_CLOSE, __func__, __LINE__);
+        return NG;
+    }
+    return OK;
+}
+
+/*
+ * openTableStat -- テーブルの統計情報のオープン
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	stat: 読み込んだ統計情報を格納する場所
+ *
+ * 返り値:
+ *	オープンしたデータ定義ファイル。失敗した場合はNULLを返す。
+ *	ヘッダページのない古いデータ定義ファイルの場合は、stat->numPageを-1にする。
+ *
+ * ***注意***
+ *	使い終わったら必ずcloseTableStatでクローズすること。
+ *	挿入や削除のように読んでから書き戻す場合に、ファイルのオープンを1回で済ませる。
+ */
+File *openTableStat(char *tableName, TableStat *stat)
+{
+    File *file;
+    char page[PAGE_SIZE];
+    char filename[MAX_FILENAME];
+    int magic;
+
+    makeDefFileName(filename, resolveTableName(tableName));
+    if ((file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NULL;
+    }
+
+    /* ヘッダページがなければ、読み込みに失敗するか、すべて0のページが読める */
+    memset(page, 0, PAGE_SIZE);
+    readPage(file, DEF_STAT_PAGE, page);
+    memcpy(&magic, page, sizeof(int));
+    if (magic == DEF_STAT_MAGIC) {
+        memcpy(stat, page + sizeof(int), sizeof(TableStat));
+    } else {
+        memset(stat, 0, sizeof(TableStat));
+        stat->numPage = -1;
+        stat->lastInsertPage = -1;
+    }
+    return file;
+}
+
+/*
+ * closeTableStat -- テーブルの統計情報のクローズ
+ *
+ * 引数:
+ *	file: openTableStatでオープンしたデータ定義ファイル
+ *	stat: 記録する統計情報(NULLなら記録しない)
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * ヘッダページの構造(データ定義ファイルのDEF_STAT_PAGEページ目)
+ *   +-------------------+------------------------+
+ *   |DEF_STAT_MAGIC     |TableStat構造体         |
+ *   |(sizeof(int)バイト)|(sizeof(TableStat)バイト)|
+ *   +-------------------+------------------------+
+ * ヘッダページのない古いデータ定義ファイルには、ここでヘッダページが追加される。
+ */
+Result closeTableStat(File *file, TableStat *stat)
+{
+    char page[PAGE_SIZE];
+    int magic = DEF_STAT_MAGIC;
+
+    if (stat != NULL) {
+        memset(page, 0, PAGE_SIZE);
+        memcpy(page, &magic, sizeof(int));
+        memcpy(page + sizeof(int), stat, sizeof(TableStat));
+        if (writePage(file, DEF_STAT_PAGE, page) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            closeFile(file);
+            return NG;
+        }
+    }
+
+    if (closeFile(file) != OK) {
+        printErrorMessage(ERR_MSG_CLOSE, __func__, __LINE__);
+        return NG;
+    }
+    return OK;
+}
+
+/*
+ * getTableStat -- テーブルの統計情報の取得
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	stat: 取得した統計情報を格納する場所
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *	ヘッダページのない古いデータ定義ファイルの場合もNGを返す
+ *
+ * 統計情報はデータ操作モジュールが挿入や削除のたびに更新するので、
+ * データファイルを読まずにレコード数などが分かる。
+ */
+Result getTableStat(char *tableName, TableStat *stat)
+{
+    File *file;
+
+    if ((file = openTableStat(tableName, stat)) == NULL) {
+        return NG;
+    }
+    if (closeTableStat(file, NULL) != OK) {
+        return NG;
+    }
+    return stat->numPage == -1 ? NG : OK;
+}
+
+/*
+ * setTableStat -- テーブルの統計情報の記録
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	stat: 記録する統計情報
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result setTableStat(char *tableName, TableStat *stat)
+{
+    File *file;
+    char filename[MAX_FILENAME];
+
+    makeDefFileName(filename, resolveTableName(tableName));
+    if ((file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+    return closeTableStat(file, stat);
+}
+
 /*
  * freeTableInfo -- データ定義情報を収めたメモリ領域の解放
  *
@@ -282,6 +803,7 @@ void freeTableInfo(TableInfo *tableInfo)
 void printTableInfo(char *tableName)
 {
     TableInfo *tableInfo;
+    Index *index;
     int i;
 
     /* テーブル名を出力 */
@@ -296,6 +818,44 @@ void printTableInfo(char *tableName)
     /* フィールド数を出力 */
     printf("number of fields = %d\n", tableInfo->numField);
 
+    /* インメモリテーブルにはページがない */
+    if (IS_MEMORY_TABLE(tableInfo)) {
+        printf("storage = memory\n");
+    } else {
+        /* 一時テーブルはセッションの終了時に削除される */
+        if (isTempTable(tableName)) {
+            printf("temporary (dropped at end of session)\n");
+        }
+
+        /* バッファプールのパーティションを出力 */
+        printf("buffer partition = %s\n",
+               tableInfo->option.partition[0] == '\0' ? DEFAULT_PARTITION_NAME : tableInfo->option.partition);
+
+        /* ページ形式を出力 */
+        switch (tableInfo->option.layout) {
+        case LAYOUT_SLOTTED:
+            printf("page layout = slotted\n");
+            break;
+        case LAYOUT_PAX:
+            printf("page layout = pax\n");
+            break;
+        case LAYOUT_FIXED_FLAG:
+            printf("page layout = fixed (flag per record)\n");
+            break;
+        default:
+            printf("page layout = fixed\n");
+        }
+        if ((i = getClusterField(tableInfo)) != -1) {
+            printf("clustered by %s\n", tableInfo->fieldInfo[i].name);
+        }
+        if ((i = getLsmField(tableInfo)) != -1) {
+            printf("log-structured (lsm), key = %s\n", tableInfo->fieldInfo[i].name);
+        }
+        if ((i = getSeriesField(tableInfo)) != -1) {
+            printf("append-only (series), time = %s\n", tableInfo->fieldInfo[i].name);
+        }
+    }
+
     /* フィールド情報を読み取って出力 */
     for (i = 0; i < tableInfo->numField; i++) {
     /* フィールド名の出力 */
@@ -305,16 +865,44 @@ void printTableInfo(char *tableName)
     printf("data type = ");
     switch (tableInfo->fieldInfo[i].dataType) {
     case TYPE_INTEGER:
-        printf("integer\n");
+        if (IS_PACKED_FIELD(tableInfo, i) && IS_CRACK_FIELD(tableInfo, i)) {
+            printf("integer (packed, %d bits, cracking)\n", tableInfo->option.packBits[i]);
+        } else if (IS_PACKED_FIELD(tableInfo, i)) {
+            printf("integer (packed, %d bits)\n", tableInfo->option.packBits[i]);
+        } else if (IS_CRACK_FIELD(tableInfo, i)) {
+            printf("integer (cracking)\n");
+        } else {
+            printf("integer\n");
+        }
         break;
     case TYPE_STRING:
-        printf("string\n");
+        if (IS_DICTIONARY_FIELD(tableInfo, i)) {
+            printf("string (dictionary)\n");
+        } else if (IS_BLOOM_FIELD(tableInfo, i)) {
+            printf("string (bloom filter, %d/1000 false positives)\n",
+                   tableInfo->option.bloomRate != 0 ? tableInfo->option.bloomRate : BLOOM_DEFAULT_RATE);
+        } else {
+            printf("string\n");
+        }
         break;
     default:
         printf("unknown\n");
     }
     }
 
+    /* 索引を出力 */
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (HAS_INDEX(tableInfo, i)) {
+            index = openIndex(tableInfo->option.index[i]);
+            printf("  index %s on %s (%s)\n", tableInfo->option.index[i], tableInfo->fieldInfo[i].name,
+                   index == NULL ? "missing" : index->type == INDEX_HASH ? "hash"
+                   : index->type == INDEX_BITMAP ? "bitmap" : index->type == INDEX_TRIGRAM ? "trigram" : "btree");
+            if (index != NULL) {
+                closeIndex(index);
+            }
+        }
+    }
+
     /* データ定義情報を解放する */
     freeTableInfo(tableInfo);
 
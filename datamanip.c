@@ -6,6 +6,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <stddef.h>
 #include "microdb.h"
 #include "error.h"
 /*
@@ -13,8 +14,33 @@
  */
 #define DATA_FILE_EXT ".dat"
 
+/*
+ * CLUSTER_FILE_EXT -- clusterTableでレコードを並べ直したデータファイルを作る間の拡張子
+ */
+#define CLUSTER_FILE_EXT ".clu"
+
+/*
+ * queryStat -- 直前の検索・削除の統計情報
+ */
+static QueryStat queryStat;
 
 Result checkDistinct(RecordSet *recordSet, RecordData *data, Condition *condition);
+static FreeSpaceMap *openTableFreeSpaceMap(char *tableName, File *file, int numPage, TableInfo *tableInfo);
+static ZoneMap *openTableZoneMap(File *file, int numPage, TableInfo *tableInfo, File *statFile, TableStat *stat);
+static BloomFilter *openTableBloomFilter(char *tableName, File *file, int numPage, TableInfo *tableInfo);
+static File *loadTableStat(char *tableName, File *file, int numPage, TableInfo *tableInfo, TableStat *stat);
+static int openTableIndexes(TableInfo *tableInfo, Index **indexes);
+static void updateTableIndexes(TableInfo *tableInfo, Index **indexes, RecordData *recordData, RecordId *rid, int insert);
+static void closeTableIndexes(char *tableName, TableInfo *tableInfo, Index **indexes);
+static File *openRecordPage(char *tableName, TableInfo *tableInfo, RecordId *rid, char *page, int *numPage);
+static int *searchTableIndex(char *tableName, File *file, TableInfo *tableInfo, int condField,
+                             Condition *condition, int numPage, int *numListed);
+static Result splitClusterPage(char *tableName, File *file, int numPage, TableInfo *tableInfo, FreeSpaceMap *fsm,
+                               File *statFile, TableStat *stat, int pageNum, char *page, FieldData *key);
+static Condition *makeCodeCondition(Dictionary *dict, TableInfo *tableInfo, int condField,
+                                    Condition *condition, Condition *codeCondition);
+static Result checkStoredCondition(Dictionary *dict, TableInfo *tableInfo, RecordData *recordData,
+                                   int condField, Condition *condition, Condition *codeCondition);
 
 /*
  * initializeDataManipModule -- データ操作モジュールの初期化
@@ -38,48 +64,17 @@ Result initializeDataManipModule()
  *
  * 返り値;
  *	成功ならOK、失敗ならNGを返す
- */
-Result finalizeDataManipModule()
-{
-    return OK;
-}
-
-/*
- * getRecordSize -- 1レコード分の保存に必要なバイト数の計算
  *
- * 引数:
- *	tableInfo: データ定義情報を収めた構造体
- *
- * 返り値:
- *	tableInfoのテーブルに収められた1つのレコードを保存するのに
- *	必要なバイト数
+ * インメモリテーブルと一時テーブルは、ここですべて削除される。
  */
-static int getRecordSize(TableInfo *tableInfo)
+Result finalizeDataManipModule()
 {
-    int total = 0;
-    int i;
-
-    for (i = 0; i < tableInfo->numField; i++) {
-        /* i番目のフィールドがINT型かSTRING型か調べる */
-        switch (tableInfo->fieldInfo[i].dataType) {
-            case TYPE_INTEGER:
-                /* INT型ならtotalにsizeof(int)を加算 */
-                total += sizeof(int);
-                break;
-            case TYPE_STRING:
-                /* STRING型ならtotalにMAX_STRINGを加算 */
-                total += MAX_STRING;
-                break;
-            case TYPE_UNKNOWN:
-                break;
-        }
-
-    }
-
-    /* フラグの分の1を足す */
-    total++;
-
-    return total;
+    dropTempTables();
+    discardCracker(NULL);
+    discardClusterFence(NULL);
+    discardSeries(NULL);
+    dropMemoryTables();
+    return closeLsmTables();
 }
 
 /*
@@ -96,15 +91,34 @@ Result insertRecord(char *tableName, RecordData *recordData)
 {
     TableInfo *tableInfo;
     int numPage;
-    char *record;
-    char *p;
     char page[PAGE_SIZE];
-    char *filename;
+    char filename[MAX_FILENAME];
     int i;
-    int j;
-    int recordSize;
-    int len;
+    int slot;
+    int required;
+    int numFreeSlot;
     File *file;
+    File *statFile;
+    FreeSpaceMap *fsm;
+    ZoneMap *zoneMap;
+    BloomFilter *bloom;
+    TableStat stat;
+    Dictionary *dict;
+    RecordData encoded;
+    Index *indexes[MAX_FIELD];
+    RecordId rid;
+    int appendPage = 0;
+    int clusterField;
+    int seriesField;
+    int lastTime;
+
+    /* インメモリテーブルなら、ファイルを使わずメモリ上の配列に加える */
+    if (isMemoryTable(tableName)) {
+        return insertMemoryRecord(tableName, recordData);
+    }
+
+    /* 一時テーブルなら、以降は一時ディレクトリ付きの名前でファイルを扱う */
+    tableName = resolveTableName(tableName);
 
     /* テーブルの情報を取得する */
     if ((tableInfo = getTableInfo(tableName)) == NULL) {
@@ -112,662 +126,3359 @@ Result insertRecord(char *tableName, RecordData *recordData)
         return NG;
     }
 
-    /* 1レコード分のデータをファイルに収めるのに必要なバイト数を計算する */
-    recordSize = getRecordSize(tableInfo);
-
-    /* 必要なバイト数分のメモリを確保する */
-    if ((record = (char *)malloc(recordSize)) == NULL) {
-        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
-    }
-    memset(record, 0, recordSize);
-    p = record;
-
-    /* 先頭に、「使用中」を意味するフラグを立てる */
-    memset(p, 1, 1);
-    p += 1;
-
-    /* 確保したメモリ領域に、フィールド数分だけ、順次データを埋め込む */
-    for (i = 0; i < tableInfo->numField; i++) {
-        switch (tableInfo->fieldInfo[i].dataType) {
-            case TYPE_INTEGER:
-                memcpy(p, &(recordData->fieldData[i].intValue), sizeof(int));
-                p += sizeof(int);
-                break;
-            case TYPE_STRING:
-                memcpy(p, &(recordData->fieldData[i].stringValue), sizeof(char)*MAX_STRING);
-                p += MAX_STRING;
-                break;
-            default:
-                /* ここにくることはないはず */
-                freeTableInfo(tableInfo);
-                free(record);
-                assert(0);
-                return NG;
-        }
+    /* ログ構造化テーブルなら、データファイルではなくメムテーブルに加える */
+    if (getLsmField(tableInfo) != -1) {
+        i = insertLsmRecord(tableName, tableInfo, recordData);
+        freeTableInfo(tableInfo);
+        return i;
     }
 
-    /* 使用済みのtableInfoデータのメモリを解放する */
-    freeTableInfo(tableInfo);
-
     /*
-     * ここまでで、挿入するレコードの情報を埋め込んだバイト列recordができあがる
+     * 辞書圧縮するフィールドの値を、辞書のコードに置き換えたレコードを格納する
+     * (フィールドはテーブルの定義順に並んでいるので、数もテーブルの情報から取る)
      */
+    if (hasDictionaryField(tableInfo)) {
+        memcpy(&encoded, recordData, RECORD_DATA_SIZE(tableInfo->numField));
+        encoded.numField = tableInfo->numField;
+        if ((dict = openDictionary(tableName)) == NULL) {
+            freeTableInfo(tableInfo);
+            return NG;
+        }
+        if (encodeDictionaryFields(dict, tableInfo, &encoded) != OK) {
+            printErrorMessage(ERR_MSG_RECORD_SIZE, __func__, __LINE__);
+            closeDictionary(dict);
+            freeTableInfo(tableInfo);
+            return NG;
+        }
+        if (closeDictionary(dict) != OK) {
+            freeTableInfo(tableInfo);
+            return NG;
+        }
+        recordData = &encoded;
+    }
 
-    /*[tableName].datという文字列を作る*/
-    len = strlen(tableName) + strlen(DATA_FILE_EXT) + 1;
-    if ((filename = malloc(len)) == NULL ){
-        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+    /* レコードの格納に必要な空き量を求める(格納できないレコードならエラー) */
+    if ((required = getRequiredFreeSpaceValue(tableInfo, recordData)) == -1) {
+        printErrorMessage(ERR_MSG_RECORD_SIZE, __func__, __LINE__);
+        freeTableInfo(tableInfo);
         return NG;
     }
-    snprintf(filename, len, "%s%s", tableName, DATA_FILE_EXT);
-
 
+    /*[tableName].datという文字列を作る*/
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DATA_FILE_EXT);
 
     /* [tableName].datというファイルがなかったら作る*/
     if(getNumPages(filename) == -1){
         if(createFile(filename) != OK){
             printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+            freeTableInfo(tableInfo);
             return NG;
         }
     }
 
     /* データファイルをオープンする */
     if((file = openFile(filename)) == NULL){
+        freeTableInfo(tableInfo);
         return NG;
     }
 
-
-
+    /* テーブルに割り当てられたバッファプールのパーティションを使う */
+    setFilePartition(file, tableInfo->option.partition);
 
     /* データファイルのページ数を調べる */
     numPage = getNumPages(filename);
 
-    free(filename);
+    /* 空き領域マップをオープンする */
+    if ((fsm = openTableFreeSpaceMap(tableName, file, numPage, tableInfo)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return NG;
+    }
 
+    /* テーブルの統計情報を読み込む */
+    if ((statFile = loadTableStat(tableName, file, numPage, tableInfo, &stat)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
 
-    /*pageの初期化 */
-    memset(page, 0, PAGE_SIZE);
+    /*
+     * 時系列テーブルなら、メモリ上の末尾ページを取り出す
+     * (時刻が最後に挿入したレコードより前のレコードは挿入できない)
+     */
+    seriesField = getSeriesField(tableInfo);
+    if (seriesField != -1) {
+        i = getSeriesTail(tableName, file, numPage, tableInfo, stat.numRecord, page, &lastTime);
+        if (i == -2 || recordData->fieldData[seriesField].intValue < lastTime) {
+            freeTableInfo(tableInfo);
+            closeTableStat(statFile, NULL);
+            closeFreeSpaceMap(fsm);
+            closeFile(file);
+            return NG;
+        }
+    }
 
-    /* レコードを挿入できる場所を探す */
-    for (i = 0; i < numPage; i++) {
-        /* 1ページ分のデータを読み込む */
-        if (readPage(file, i, page) != OK) {
-            free(record);
+    /*
+     * レコードを挿入できる場所を探す
+     * 空き領域マップで空きのあるページを見つけ、そのページだけを読み込む
+     * (クラスタ化テーブルでは、キーが入る範囲のページをフェンスキーで探す。
+     * 時系列テーブルでは、末尾ページに入らなければ新しいページに格納する)
+     */
+    clusterField = getClusterField(tableInfo);
+    for (;;) {
+        if (clusterField != -1) {
+            i = findClusterPage(tableName, file, numPage, tableInfo, &recordData->fieldData[clusterField]);
+        }
+        if (appendPage || (clusterField != -1 || seriesField != -1 ? i == -1
+                           : (i = findFreePage(fsm, required)) == -1)) {
+            /*
+             * 空きのあるページがなかったら
+             * ファイルの最後に新しく空のページを用意し、そこに書き込む
+             */
+            i = numPage;
+            initializePage(page, tableInfo);
+            numFreeSlot = 0;
+        } else if (seriesField != -1) {
+            /* 末尾ページはgetSeriesTailでpageに取り出してある */
+            numFreeSlot = countFreeSlots(page, tableInfo);
+        } else if (readPage(file, i, page) != OK) {
+            /* 1ページ分のデータを読み込む */
+            freeTableInfo(tableInfo);
+            closeTableStat(statFile, NULL);
+            closeFreeSpaceMap(fsm);
             closeFile(file);
             printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
             return NG;
+        } else {
+            numFreeSlot = countFreeSlots(page, tableInfo);
         }
 
-        /* pageの先頭からrecordSizeバイトずつ飛びながら、先頭のフラグが「0」(未使用)の場所を探す */
-        for (j = 0; j < (PAGE_SIZE / recordSize); j++) {
-            char *q;
-            q = page+(j*recordSize);
-            if (*q == 0) {
-                /* 見つけた空き領域に上で用意したバイト列recordを埋め込む */
-                memcpy(q, record, recordSize);
-
-                /* ファイルに書き戻す */
-                if (writePage(file, i, page) != OK) {
-                    free(record);
-                    closeFile(file);
-                    printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
-                    return NG;
-                }
+        /* 見つけたページにレコードを格納する */
+        if ((slot = insertIntoPage(page, tableInfo, recordData)) != -1) {
+            break;
+        }
+
+        if (i == numPage) {
+            /* 空のページにも入らなかった(ここには来ないはず) */
+            freeTableInfo(tableInfo);
+            closeTableStat(statFile, NULL);
+            closeFreeSpaceMap(fsm);
+            closeFile(file);
+            return NG;
+        }
+
+        /* 時系列テーブルでは、末尾ページに入らなければ新しいページを加える */
+        if (seriesField != -1) {
+            appendPage = 1;
+            continue;
+        }
+
+        /* クラスタ化テーブルでは、いっぱいのページを2つに分けてから探し直す */
+        if (clusterField != -1) {
+            if (splitClusterPage(tableName, file, numPage, tableInfo, fsm, statFile, &stat, i, page,
+                                 &recordData->fieldData[clusterField]) != OK) {
+                freeTableInfo(tableInfo);
+                closeTableStat(statFile, NULL);
+                closeFreeSpaceMap(fsm);
                 closeFile(file);
-                free(record);
-                return OK;
+                return NG;
             }
+            numPage++;
+            continue;
         }
+
+        /*
+         * 空きがあるのに入らなかったのは、ビット詰めするフィールドの値がページの
+         * 基準値からの差に収まらなかったため。新しいページに格納する
+         */
+        if (getPageFreeSpaceValue(page, tableInfo) >= required) {
+            appendPage = 1;
+            continue;
+        }
+
+        /* 空き領域マップが実際と食い違っていたので、直してから探し直す */
+        setPageFreeSpace(fsm, i, getPageFreeSpaceValue(page, tableInfo));
+    }
+
+    /* ファイルに書き戻す */
+    if (writePage(file, i, page) != OK) {
+        freeTableInfo(tableInfo);
+        closeTableStat(statFile, NULL);
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+
+    /* 書き込んだページの残りの空きを空き領域マップに記録する */
+    setPageFreeSpace(fsm, i, getPageFreeSpaceValue(page, tableInfo));
+
+    /*
+     * 格納した値をゾーンマップの最小値と最大値に反映する
+     * (記録できなかったら、次に使うときに作り直すようゾーンマップを無効にする)
+     */
+    if ((zoneMap = openTableZoneMap(file, numPage, tableInfo, statFile, &stat)) != NULL) {
+        stat.numZoneMapPage = addToZoneMap(zoneMap, i, recordData) == OK ? zoneMap->numPage : -1;
+        closeZoneMap(zoneMap);
+    } else {
+        stat.numZoneMapPage = -1;
     }
 
     /*
-     * ファイルの最後まで探しても未使用の場所が見つからなかったら
-     * ファイルの最後に新しく空のページを用意し、そこに書き込む
+     * 格納した値をブルームフィルタに加える
+     * (記録できなかったら、次に使うときに作り直すようブルームフィルタを捨てる)
      */
+    if (hasBloomField(tableInfo)) {
+        if ((bloom = openTableBloomFilter(tableName, file, numPage, tableInfo)) == NULL) {
+            deleteBloomFilter(tableName);
+        } else if (addToBloomFilter(bloom, i, recordData) != OK) {
+            closeBloomFilter(bloom);
+            deleteBloomFilter(tableName);
+        } else if (closeBloomFilter(bloom) != OK) {
+            deleteBloomFilter(tableName);
+        }
+    }
 
-    /* PAGE_SIZEバイト分の大きさを持つ配列pageを初期化*/
-    memset(page, 0, PAGE_SIZE);
-    /* recordを埋め込む */
-    memcpy(page, record, recordSize);
-    /* ファイルに書き込む */
-    writePage(file, numPage, page);
+    /*
+     * 格納したレコードの位置をテーブルのすべての索引に加える
+     * (加えられなかった索引は、検索に使われないよう捨てる)
+     */
+    rid.pageNum = i;
+    rid.slot = slot;
+    openTableIndexes(tableInfo, indexes);
+    updateTableIndexes(tableInfo, indexes, recordData, &rid, 1);
+    closeTableIndexes(tableName, tableInfo, indexes);
+
+    /* 作ってあるクラッカー列にも加える */
+    insertCrackerEntry(tableName, i == numPage ? numPage + 1 : numPage, recordData, &rid);
+
+    /* クラスタ化テーブルの最初のページなら、フェンスキーを加える */
+    if (clusterField != -1 && i == numPage) {
+        addClusterFence(tableName, numPage + 1, -1, &recordData->fieldData[clusterField], i);
+    }
 
+    /* 統計情報を更新する */
+    if (i == numPage) {
+        stat.numPage = numPage + 1;
+    }
+    stat.numRecord++;
+    stat.numDeadSlot += countFreeSlots(page, tableInfo) - numFreeSlot;
+    stat.lastInsertPage = i;
 
-    closeFile(file);
-    free(record);
-    return OK;
-}
+    /* 時系列テーブルなら、末尾ページと最初の時刻の索引に反映する */
+    if (seriesField != -1) {
+        addSeriesRecord(tableName, i, page, recordData->fieldData[seriesField].intValue, stat.numRecord);
+    }
 
+    /* 使用済みのtableInfoデータのメモリを解放する */
+    freeTableInfo(tableInfo);
 
+    if (closeTableStat(statFile, &stat) != OK) {
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
+    if (closeFreeSpaceMap(fsm) != OK) {
+        closeFile(file);
+        return NG;
+    }
+    if (closeFile(file) != OK) {
+        return NG;
+    }
+    return OK;
+}
 
 /*
- * checkCondition -- レコードが条件を満足するかどうかのチェック
+ * openTableFreeSpaceMap -- テーブルの空き領域マップのオープン
  *
  * 引数:
- *	recordData: チェックするレコード
- *	condition: チェックする条件
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
  *
  * 返り値:
- *	レコードrecordが条件conditionを満足すればOK、満足しなければNGを返す
+ *	オープンした空き領域マップ。失敗した場合はNULLを返す。
+ *
+ * 空き領域マップがない場合(古い形式のテーブル)や、データファイルと
+ * ページ数が食い違っている場合は、データファイルを1回だけ読んで作り直す。
  */
-Result checkCondition(RecordData *recordData, Condition *condition)
+static FreeSpaceMap *openTableFreeSpaceMap(char *tableName, File *file, int numPage, TableInfo *tableInfo)
 {
-    /*フィールド名の確認*/
-    int i=0;
-    while(1){
-        if(strcmp(recordData->fieldData[i].name, condition->name)==0){
-            break;
+    FreeSpaceMap *fsm;
+    char page[PAGE_SIZE];
+    int i;
+
+    if ((fsm = openFreeSpaceMap(tableName)) != NULL) {
+        if (fsm->numPage == numPage) {
+            return fsm;
         }
-        i++;
+        closeFreeSpaceMap(fsm);
     }
 
+    /* 空き領域マップを作り直す */
+    if (createFreeSpaceMap(tableName) != OK || (fsm = openFreeSpaceMap(tableName)) == NULL) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        return NULL;
+    }
+    for (i = 0; i < numPage; i++) {
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            closeFreeSpaceMap(fsm);
+            return NULL;
+        }
+        setPageFreeSpace(fsm, i, getPageFreeSpaceValue(page, tableInfo));
+    }
 
-    /*比較演算子を確認*/
-    switch(condition->operator){
-        case OPR_EQUAL:
-            if(condition->dataType == TYPE_INTEGER){
-                if(condition->intValue == recordData->fieldData[i].intValue){
-                    return OK;
-                }
-                else return NG;
-            }
-            else{
-                if(strcmp(condition->stringValue, recordData->fieldData[i].stringValue)==0){
-                    return OK;
-                }
-                else return NG;
-            }
-            break;
-
-        case OPR_NOT_EQUAL:
-
-            if(condition->dataType == TYPE_INTEGER){
-                if(condition->intValue != recordData->fieldData[i].intValue){
-                    return OK;
-                }
-                else return NG;
-            }
-            else{
-                if(strcmp(condition->stringValue, recordData->fieldData[i].stringValue)!=0){
-                    return OK;
-                }
-                else return NG;
-            }
-            break;
-
-
-        case OPR_GREATER_THAN:
-
-            if(condition->dataType == TYPE_INTEGER){
-
-                if(condition->intValue < recordData->fieldData[i].intValue){
-                    return OK;
-                }
-                else return NG;
-            }
-            else{
-
-                if(strcmp(condition->stringValue, recordData->fieldData[i].stringValue)<0){
-                    return OK;
-                }
-                else return NG;
-            }
+    return fsm;
+}
 
-        case OPR_LESS_THAN:
+/*
+ * openTableZoneMap -- テーブルのゾーンマップのオープン
+ *
+ * 引数:
+ *	file: オープン中のデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *	statFile: loadTableStatでオープンしたデータ定義ファイル
+ *	stat: loadTableStatで読み込んだ統計情報
+ *
+ * 返り値:
+ *	オープンしたゾーンマップ。整数型のフィールドがないテーブルや、
+ *	エラーの場合はNULLを返す
+ *
+ * 統計情報に記録された有効なページ数がデータファイルと合わない場合
+ * (古いテーブル、統計情報を作り直したとき)は、データファイルを読んで作り直す。
+ * 使い終わったら、zoneMap->numPageをstat->numZoneMapPageに記録してからクローズすること。
+ */
+static ZoneMap *openTableZoneMap(File *file, int numPage, TableInfo *tableInfo, File *statFile, TableStat *stat)
+{
+    ZoneMap *zoneMap;
+    RecordData record;
+    char page[PAGE_SIZE];
+    int i, j;
 
-            if(condition->dataType == TYPE_INTEGER){
+    if (stat->numZoneMapPage == numPage) {
+        return openZoneMap(statFile, numPage, tableInfo);
+    }
 
-                if(condition->intValue > recordData->fieldData[i].intValue){
-                    return OK;
-                }
-                else return NG;
-            }
-            else{
-                if(strcmp(condition->stringValue, recordData->fieldData[i].stringValue)>0){
-                    return OK;
-                }
-                else return NG;
+    /* ゾーンマップを作り直す */
+    if ((zoneMap = openZoneMap(statFile, 0, tableInfo)) == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < numPage; i++) {
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            closeZoneMap(zoneMap);
+            return NULL;
+        }
+        /* 空のページも、空として記録しておく */
+        record.numField = 0;
+        if (addToZoneMap(zoneMap, i, &record) != OK) {
+            closeZoneMap(zoneMap);
+            return NULL;
+        }
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            if (readSlot(page, j, tableInfo, &record) == OK && addToZoneMap(zoneMap, i, &record) != OK) {
+                closeZoneMap(zoneMap);
+                return NULL;
             }
-            break;
-    }        
-
-
-
+        }
+    }
 
+    return zoneMap;
 }
 
 /*
- * selectRecord -- レコードの検索
+ * openTableBloomFilter -- テーブルのブルームフィルタのオープン
  *
  * 引数:
- *	tableName: レコードを検索するテーブルの名前
- *	condition: 検索するレコードの条件
+ *	tableName: テーブル名
+ *	file: オープン中のデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
  *
  * 返り値:
- *	検索に成功したら検索されたレコード(の集合)へのポインタを返し、
- *	検索に失敗したらNULLを返す。
- *	検索した結果、該当するレコードが1つもなかった場合も、レコードの
- *	集合へのポインタを返す。
+ *	オープンしたブルームフィルタ。失敗した場合はNULLを返す。
  *
- * ***注意***
- *	この関数が返すレコードの集合を収めたメモリ領域は、不要になったら
- *	必ずfreeRecordSetで解放すること。
+ * ブルームフィルタファイルがない場合(最初の挿入、記録に失敗して捨てたとき)や、
+ * 記録しているページ数がデータファイルと合わない場合は、データファイルを読んで作り直す。
  */
-RecordSet *selectRecord(char *tableName, Condition *condition)
-{   
-
-    File *file;
-    int len;
-    char* filename;
-    TableInfo *tableInfo;
+static BloomFilter *openTableBloomFilter(char *tableName, File *file, int numPage, TableInfo *tableInfo)
+{
+    BloomFilter *bloom;
+    RecordData record;
     char page[PAGE_SIZE];
-    int numPage;
-    int i, j, k;
-    int recordSize;
-    RecordData *recordData;
-    RecordSet *recordSet;
+    int i, j;
 
+    if ((bloom = openBloomFilter(tableName, tableInfo)) != NULL) {
+        if (bloom->numPage == numPage) {
+            return bloom;
+        }
+        closeBloomFilter(bloom);
+    }
 
-    /*レコードセットの初期化*/
-    if((recordSet = (RecordSet *)malloc(sizeof(RecordSet))) == NULL){
-        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+    /* ブルームフィルタを作り直す */
+    if (createBloomFilter(tableName, tableInfo) != OK || (bloom = openBloomFilter(tableName, tableInfo)) == NULL) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
         return NULL;
     }
-    recordSet->numRecord=0;
-    recordSet->recordData=NULL;
-    /*[tableName].datという文字列を作る*/
-    len = strlen(tableName) + strlen(DATA_FILE_EXT) + 1;
-    if ((filename = malloc(len)) == NULL ){
-        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
-        return NULL;
+    for (i = 0; i < numPage; i++) {
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            closeBloomFilter(bloom);
+            return NULL;
+        }
+        /* 空のページも、空として記録しておく */
+        record.numField = 0;
+        if (addToBloomFilter(bloom, i, &record) != OK) {
+            closeBloomFilter(bloom);
+            return NULL;
+        }
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            if (readSlot(page, j, tableInfo, &record) == OK && addToBloomFilter(bloom, i, &record) != OK) {
+                closeBloomFilter(bloom);
+                return NULL;
+            }
+        }
     }
-    snprintf(filename, len, "%s%s", tableName, DATA_FILE_EXT);
-
 
-    /*データファイルをオープン*/
-    if((file = openFile(filename)) == NULL){
-        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
-        free(filename);
-        return NULL;
-    }
+    return bloom;
+}
 
-    /*データ構造を読み取る*/
-    if((tableInfo = getTableInfo(tableName)) == NULL){
-        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
-        closeFile(file);
-        free(tableInfo);
-        return NULL;
-    }
+/*
+ * openTableIndexes -- テーブルのすべての索引のオープン
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *	indexes: フィールドの番号ごとにオープンした索引を格納する配列(索引がなければNULL)
+ *
+ * 返り値:
+ *	オープンした索引の数
+ *
+ * 索引があるのにオープンできなかったフィールドもNULLになり、closeTableIndexesで捨てられる。
+ */
+static int openTableIndexes(TableInfo *tableInfo, Index **indexes)
+{
+    int numIndex = 0;
+    int i;
 
-    /*ページ数を取得*/
-    if((numPage = getNumPages(filename)) == -1){
-        printErrorMessage(ERR_MSG_STAT, __func__, __LINE__);
-        closeFile(file);
-        free(filename);
-        return NULL;
+    for (i = 0; i < MAX_FIELD; i++) {
+        indexes[i] = NULL;
+        if (i < tableInfo->numField && HAS_INDEX(tableInfo, i)
+            && (indexes[i] = openIndex(tableInfo->option.index[i])) != NULL) {
+            numIndex++;
+        }
     }
+    return numIndex;
+}
 
-    /*レコードサイズの取得*/
-    recordSize = getRecordSize(tableInfo);
-    free(filename);
-    /*ページ数分だけループ*/
-    for(i=0; i<numPage; i++){
+/*
+ * updateTableIndexes -- テーブルのすべての索引へのレコードの位置の挿入・削除
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *	indexes: openTableIndexesでオープンした索引
+ *	recordData: 挿入・削除したレコード
+ *	rid: 挿入・削除したレコードの位置
+ *	insert: 挿入なら1、削除なら0
+ *
+ * 返り値:
+ *	なし
+ *
+ * 更新できなかった索引はクローズしてNULLにし、closeTableIndexesで捨てられるようにする。
+ */
+static void updateTableIndexes(TableInfo *tableInfo, Index **indexes, RecordData *recordData, RecordId *rid, int insert)
+{
+    Result result;
+    int i;
 
-        /*一ページ読みこむ*/
-        if(readPage(file, i, page)){
-            closeFile(file);
-            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
-            return NULL;
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (indexes[i] == NULL) {
+            continue;
         }
+        if (insert) {
+            result = insertIndexEntry(indexes[i], &recordData->fieldData[i], rid);
+        } else {
+            result = deleteIndexEntry(indexes[i], &recordData->fieldData[i], rid);
+        }
+        if (result != OK) {
+            closeIndex(indexes[i]);
+            indexes[i] = NULL;
+        }
+    }
+}
 
+/*
+ * closeTableIndexes -- テーブルのすべての索引のクローズ
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	tableInfo: テーブルのデータ定義情報
+ *	indexes: openTableIndexesでオープンした索引
+ *
+ * 返り値:
+ *	なし
+ *
+ * オープンや更新ができなかった索引は、データファイルと食い違った内容で
+ * 検索に使われないよう、索引ファイルを削除してデータ定義ファイルからも取り除く。
+ */
+static void closeTableIndexes(char *tableName, TableInfo *tableInfo, Index **indexes)
+{
+    int i;
 
-        /*recordSizeごとに処理*/
-        for(j=0; j < (PAGE_SIZE/recordSize); j++){
-            char *p;
-            p = page + recordSize * j;
-
-            /*先頭のフラグを調べる*/
-            if(*p == 1){
-                p++;
-                /*recordDataのメモリ確保*/
-                if((recordData = (RecordData *)malloc(sizeof(RecordData))) == NULL){
-                    printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
-                    freeTableInfo(tableInfo);
-                    closeFile(file);
-                    return NULL;
-                }
-                /*レコードのデータをRecordDataへ*/
-                recordData -> numField = tableInfo -> numField;
-                recordData -> next = NULL;
-                for(k=0; k < (tableInfo -> numField); k++){
-                    strcpy(recordData->fieldData[k].name, tableInfo->fieldInfo[k].name);
-                    recordData -> fieldData[k].dataType = tableInfo -> fieldInfo[k].dataType;
-                    switch (tableInfo -> fieldInfo[k].dataType){
-                        case TYPE_INTEGER:
-                            memcpy(&(recordData -> fieldData[k].intValue), p, sizeof(int));
-                            p += sizeof(int);
-                            break;
-                        case TYPE_STRING:
-                            memcpy(&(recordData -> fieldData[k].stringValue), p, MAX_STRING);
-                            p += MAX_STRING;
-                            break;
-                        default:
-                            /*ここには来ない*/
-                            freeTableInfo(tableInfo);
-                            free(recordData);
-                            closeFile(file);
-                            return NULL;
-                    }
-                }
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (!HAS_INDEX(tableInfo, i) || (indexes[i] != NULL && closeIndex(indexes[i]) == OK)) {
+            continue;
+        }
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        deleteIndexFile(tableInfo->option.index[i]);
+        setTableIndex(tableName, i, "");
+    }
+}
 
+/*
+ * searchTableIndex -- 索引を使った、条件に合うレコードがあるページの検索
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	tableInfo: テーブルのデータ定義情報
+ *	condField: 条件のフィールドの番号(-1なら条件のフィールドがない)
+ *	condition: 条件
+ *	numPage: データファイルのページ数
+ *	numListed: 見つかったページの数を格納する場所
+ *
+ * 返り値:
+ *	条件に合うレコードがあるページの番号を昇順に並べた配列。使い終わったらfreeで解放すること。
+ *	条件のフィールドに索引がない場合や、索引を使えない条件(B+木での!=など)の場合はNULLを返す。
+ *
+ * 索引がなければ、クラスタ化テーブルのキーのフィールドならフェンスキーを、
+ * crackを指定したフィールドならクラッカー列を、時系列テーブルの時刻のフィールドなら
+ * ページごとの最初の時刻の索引を、索引の代わりに使う。時系列テーブルのほかの条件でも、
+ * 捨てたページは読まない。
+ * ページの中では改めてすべてのレコードを条件と比べるので、検索結果の順序は
+ * 索引を使わない場合と変わらない。
+ */
+static int *searchTableIndex(char *tableName, File *file, TableInfo *tableInfo, int condField,
+                             Condition *condition, int numPage, int *numListed)
+{
+    Index *index;
+    int *pageList;
 
-                /*条件に合ったらRecordSetに挿入*/
-                if(checkCondition(recordData, condition) == OK && checkDistinct(recordSet, recordData, condition) == OK){
-                    RecordData *r;
-                    r = recordSet->recordData;
-                    if(r==NULL){
-                        recordSet->recordData=recordData;
-                        recordSet->numRecord=1;
-                    }
-                    else{
-                        while(r->next!=NULL){
-                            /*終わりを見つける*/
-                            r=r->next;
-                        }
-                        r->next = recordData;
-                        recordSet->numRecord++;
-                    }
-                }
-            }
+    if (condField == -1 || !HAS_INDEX(tableInfo, condField)) {
+        if (condField != -1 && IS_CLUSTER_FIELD(tableInfo, condField)) {
+            return searchClusterPages(tableName, file, numPage, tableInfo, condition, numListed);
+        }
+        if (condField != -1 && !IS_SERIES_FIELD(tableInfo, condField)
+            && (pageList = searchCracker(tableName, file, numPage, tableInfo, condField, condition,
+                                         numListed)) != NULL) {
+            return pageList;
         }
+        if (getSeriesField(tableInfo) != -1) {
+            return searchSeriesPages(tableName, file, numPage, tableInfo, condField, condition, numListed);
+        }
+        return NULL;
     }
-    freeTableInfo(tableInfo);
-    if((closeFile(file) != OK)){
-        printErrorMessage(ERR_MSG_STAT, __func__, __LINE__);
+    if ((index = openIndex(tableInfo->option.index[condField])) == NULL) {
         return NULL;
     }
+    pageList = searchIndexPages(index, condition, numPage, numListed);
+    closeIndex(index);
+    return pageList;
+}
 
-    return recordSet;
+/*
+ * ClusterEntry -- クラスタ化テーブルのページの分割や作り直しで、キーの順に並べるレコード
+ */
+typedef struct ClusterEntry ClusterEntry;
+struct ClusterEntry {
+    DataType keyType;                   /*キーのデータ型*/
+    int intValue;                       /*キーの値(整数型)*/
+    char *stringValue;                  /*キーの値(文字列型、mallocした領域)*/
+    RecordId rid;                       /*レコードの位置*/
+};
 
+/*
+ * compareClusterEntry -- qsortに渡す、ClusterEntryの比較関数(キーが同じなら元の位置の順)
+ */
+static int compareClusterEntry(const void *a, const void *b)
+{
+    const ClusterEntry *x = a;
+    const ClusterEntry *y = b;
+    int c;
+
+    if (x->keyType == TYPE_STRING) {
+        c = strcmp(x->stringValue, y->stringValue);
+    } else {
+        c = x->intValue < y->intValue ? -1 : x->intValue > y->intValue ? 1 : 0;
+    }
+    if (c == 0) {
+        c = x->rid.pageNum != y->rid.pageNum ? x->rid.pageNum - y->rid.pageNum : x->rid.slot - y->rid.slot;
+    }
+    return c;
 }
+
 /*
- * fieldDataCmp
- *
- * フィールドデータを比較
- * 同じならOK
+ * freeClusterEntries -- ClusterEntryの配列の解放
+ */
+static void freeClusterEntries(ClusterEntry *entries, int numEntry)
+{
+    int i;
+
+    for (i = 0; i < numEntry; i++) {
+        free(entries[i].stringValue);
+    }
+    free(entries);
+}
+
+/*
+ * readClusterEntry -- スロットのレコードのキーをClusterEntryに読み出す
  *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
  */
-Result fieldDataCmp(FieldData a, FieldData b){
-    if(a.dataType != b.dataType){
+static Result readClusterEntry(char *page, int pageNum, int slot, TableInfo *tableInfo, int field, ClusterEntry *entry)
+{
+    FieldData fieldData;
+
+    if (readSlotField(page, slot, tableInfo, field, &fieldData) != OK) {
         return NG;
     }
-    if(strcmp(a.name, b.name) != 0){
+    entry->keyType = tableInfo->fieldInfo[field].dataType;
+    entry->intValue = fieldData.intValue;
+    entry->stringValue = NULL;
+    if (entry->keyType == TYPE_STRING && (entry->stringValue = strdup(fieldData.stringValue)) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
         return NG;
     }
-    if(a.dataType == TYPE_STRING){
-        if(strcmp(a.stringValue, b.stringValue) != 0){
+    entry->rid.pageNum = pageNum;
+    entry->rid.slot = slot;
+    return OK;
+}
+
+/*
+ * splitClusterPage -- クラスタ化テーブルのいっぱいになったページの分割
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数(分割で作るページの番号になる)
+ *	tableInfo: テーブルのデータ定義情報
+ *	fsm: オープン済みの空き領域マップ
+ *	statFile: loadTableStatでオープンしたデータ定義ファイル
+ *	stat: loadTableStatで読み込んだ統計情報(ページ数などを更新する)
+ *	pageNum: 分割するページの番号
+ *	page: 分割するページの内容
+ *	key: 挿入しようとしているレコードのキーの値
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * ページのレコードをキーの順に並べ、後ろ半分をファイルの最後に作る新しいページへ移し、
+ * 移した中で最小のキーを新しいページのフェンスキーにする。移したレコードの位置は
+ * 変わるので、索引とクラッカー列の位置を付け替え、ゾーンマップとブルームフィルタには
+ * 新しいページの値として加える(元のページの記録は広いまま残るが、検索の結果は変わらない)。
+ * レコードが1つだけで、挿入するキーがそれ以上の場合は、何も移さずに
+ * 挿入するキーをフェンスキーとする空のページを作る。
+ */
+static Result splitClusterPage(char *tableName, File *file, int numPage, TableInfo *tableInfo, FreeSpaceMap *fsm,
+                               File *statFile, TableStat *stat, int pageNum, char *page, FieldData *key)
+{
+    ClusterEntry *entries;
+    ClusterEntry keyEntry;
+    RecordData record;
+    RecordId rid;
+    FieldData splitKey;
+    ZoneMap *zoneMap;
+    BloomFilter *bloom = NULL;
+    Index *indexes[MAX_FIELD];
+    char newPage[PAGE_SIZE];
+    int field = getClusterField(tableInfo);
+    int numFreeSlot;
+    int numEntry = 0;
+    int split;
+    int i, j;
+
+    /* ページのレコードのキーをキーの順に並べる */
+    if ((entries = (ClusterEntry *) malloc(getMaxRecordsPerPage(tableInfo) * sizeof(ClusterEntry))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+        if (readClusterEntry(page, pageNum, j, tableInfo, field, &entries[numEntry]) != OK) {
+            freeClusterEntries(entries, numEntry);
             return NG;
         }
+        numEntry++;
     }
-    else if(a.dataType == TYPE_INTEGER){
-        if(a.intValue != b.intValue){
-            return NG;
+    qsort(entries, numEntry, sizeof(ClusterEntry), compareClusterEntry);
+
+    /* 後ろ半分を移す。移すものがなければ、挿入するキーのための空のページを作る */
+    split = numEntry / 2;
+    keyEntry.keyType = tableInfo->fieldInfo[field].dataType;
+    keyEntry.intValue = key->intValue;
+    keyEntry.stringValue = key->stringValue;
+    keyEntry.rid.pageNum = numPage;
+    keyEntry.rid.slot = 0;
+    if (numEntry == 0 || (split == 0 && compareClusterEntry(&keyEntry, &entries[0]) >= 0)) {
+        split = numEntry;
+        splitKey = *key;
+    } else {
+        splitKey.intValue = entries[split].intValue;
+        if (entries[split].keyType == TYPE_STRING) {
+            strcpy(splitKey.stringValue, entries[split].stringValue);
         }
     }
 
-    return OK;
-}
-    
+    /* 移すレコードを記録するため、ゾーンマップ、ブルームフィルタ、索引をオープンする */
+    zoneMap = openTableZoneMap(file, numPage, tableInfo, statFile, stat);
+    if (hasBloomField(tableInfo) && (bloom = openTableBloomFilter(tableName, file, numPage, tableInfo)) == NULL) {
+        deleteBloomFilter(tableName);
+    }
+    openTableIndexes(tableInfo, indexes);
+
+    numFreeSlot = countFreeSlots(page, tableInfo);
+    initializePage(newPage, tableInfo);
+    record.numField = 0;
+    if (zoneMap != NULL && addToZoneMap(zoneMap, numPage, &record) != OK) {
+        closeZoneMap(zoneMap);
+        zoneMap = NULL;
+    }
+    if (bloom != NULL && addToBloomFilter(bloom, numPage, &record) != OK) {
+        closeBloomFilter(bloom);
+        bloom = NULL;
+        deleteBloomFilter(tableName);
+    }
+    for (i = split; i < numEntry; i++) {
+        j = entries[i].rid.slot;
+        readSlot(page, j, tableInfo, &record);
+        if ((rid.slot = insertIntoPage(newPage, tableInfo, &record)) == -1) {
+            /* 元のページに入っていたレコードなので、ここには来ないはず */
+            break;
+        }
+        rid.pageNum = numPage;
+        deleteFromPage(page, j, tableInfo);
+        updateTableIndexes(tableInfo, indexes, &record, &entries[i].rid, 0);
+        updateTableIndexes(tableInfo, indexes, &record, &rid, 1);
+        deleteCrackerEntry(tableName, &record, &entries[i].rid);
+        insertCrackerEntry(tableName, numPage + 1, &record, &rid);
+        if (zoneMap != NULL && addToZoneMap(zoneMap, numPage, &record) != OK) {
+            closeZoneMap(zoneMap);
+            zoneMap = NULL;
+        }
+        if (bloom != NULL && addToBloomFilter(bloom, numPage, &record) != OK) {
+            closeBloomFilter(bloom);
+            bloom = NULL;
+            deleteBloomFilter(tableName);
+        }
+    }
+    freeClusterEntries(entries, numEntry);
 
+    /* 2つのページを書き、空き領域と統計情報を記録する */
+    if (writePage(file, pageNum, page) != OK || writePage(file, numPage, newPage) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        if (zoneMap != NULL) {
+            closeZoneMap(zoneMap);
+        }
+        if (bloom != NULL) {
+            closeBloomFilter(bloom);
+        }
+        closeTableIndexes(tableName, tableInfo, indexes);
+        return NG;
+    }
+    setPageFreeSpace(fsm, pageNum, getPageFreeSpaceValue(page, tableInfo));
+    setPageFreeSpace(fsm, numPage, getPageFreeSpaceValue(newPage, tableInfo));
+    stat->numPage = numPage + 1;
+    stat->numDeadSlot += countFreeSlots(page, tableInfo) - numFreeSlot + countFreeSlots(newPage, tableInfo);
+    if (zoneMap != NULL) {
+        stat->numZoneMapPage = zoneMap->numPage;
+        closeZoneMap(zoneMap);
+    } else {
+        stat->numZoneMapPage = -1;
+    }
+    if (bloom != NULL && closeBloomFilter(bloom) != OK) {
+        deleteBloomFilter(tableName);
+    }
+    closeTableIndexes(tableName, tableInfo, indexes);
 
+    /* 新しいページのフェンスキーを、分割したページのすぐ後ろに加える */
+    addClusterFence(tableName, numPage + 1, pageNum, &splitKey, numPage);
+    return OK;
+}
 
 /*
- * checkDistinct
+ * loadTableStat -- テーブルの統計情報の読み込み
  *
- * 重複確認
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *	stat: 読み込んだ統計情報を格納する場所
  *
- * 重複しなければ OK
+ * 返り値:
+ *	統計情報をオープンしたデータ定義ファイル。失敗した場合はNULLを返す。
+ *	使い終わったらcloseTableStatで更新した統計情報を書き戻すこと。
+ *
+ * ヘッダページがない場合(古い形式のテーブル)や、データファイルと
+ * ページ数が食い違っている場合は、データファイルを1回だけ読んで作り直す。
  */
-Result checkDistinct(RecordSet *recordSet, RecordData *data, Condition *condition){
-    RecordData *r;
-    r = recordSet->recordData;
+static File *loadTableStat(char *tableName, File *file, int numPage, TableInfo *tableInfo, TableStat *stat)
+{
+    File *statFile;
+    char page[PAGE_SIZE];
     int i;
-    int num = data->numField;
 
-    if(condition->distinct == NOT_DISTINCT){
-        return OK;
+    if ((statFile = openTableStat(tableName, stat)) == NULL) {
+        return NULL;
     }
-    //rがnullなら重複するはずなし
-    if(r == NULL){
-        return OK;
+    if (stat->numPage == numPage) {
+        return statFile;
     }
-    while(r!=NULL){
-       if(r->numField==data->numField){
-           for(i=0;i<num;i++){
-              if(fieldDataCmp(r->fieldData[i], data->fieldData[i]) != OK){
-                 break; 
-              }
-           }
-       }
-       r=r->next;
+
+    /* 統計情報を作り直す */
+    stat->numRecord = 0;
+    stat->numPage = numPage;
+    stat->numDeadSlot = 0;
+    stat->lastInsertPage = -1;
+    stat->numZoneMapPage = -1;
+    for (i = 0; i < numPage; i++) {
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            closeTableStat(statFile, NULL);
+            return NULL;
+        }
+        stat->numRecord += countUsedSlots(page, tableInfo);
+        stat->numDeadSlot += countFreeSlots(page, tableInfo);
     }
-    if(i==num){
-        return NG;
+
+    return statFile;
+}
+
+/*
+ * countRecord -- テーブルのレコード数の取得
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *
+ * 返り値:
+ *	テーブルのレコード数。失敗した場合は-1を返す。
+ *
+ * ヘッダページに記録された統計情報を返すので、データファイルは読まない。
+ * 統計情報が使えない場合だけ、データファイルを読んで作り直す。
+ */
+int countRecord(char *tableName)
+{
+    TableInfo *tableInfo;
+    TableStat stat;
+    File *file;
+    File *statFile;
+    char filename[MAX_FILENAME];
+    int numPage;
+    int numRecord;
+
+    /* インメモリテーブルなら、メモリ上の配列のレコード数 */
+    if (isMemoryTable(tableName)) {
+        return countMemoryRecord(tableName);
+    }
+    tableName = resolveTableName(tableName);
+
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DATA_FILE_EXT);
+    if ((numPage = getNumPages(filename)) == -1) {
+        return -1;
+    }
+
+    /* ログ構造化テーブルなら、ランとメムテーブルの件数から求める */
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        return -1;
+    }
+    if (getLsmField(tableInfo) != -1) {
+        numRecord = countLsmRecord(tableName, tableInfo);
+        freeTableInfo(tableInfo);
+        return numRecord;
+    }
+    freeTableInfo(tableInfo);
+
+    /* 統計情報がデータファイルと一致していれば、それをそのまま使う */
+    if (getTableStat(tableName, &stat) == OK && stat.numPage == numPage) {
+        return stat.numRecord;
+    }
+
+    /* 統計情報を作り直す */
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        return -1;
+    }
+    if ((file = openFile(filename)) == NULL) {
+        freeTableInfo(tableInfo);
+        return -1;
+    }
+    setFilePartition(file, tableInfo->option.partition);
+
+    statFile = loadTableStat(tableName, file, numPage, tableInfo, &stat);
+    freeTableInfo(tableInfo);
+    if (statFile == NULL) {
+        closeFile(file);
+        return -1;
+    }
+    if (closeTableStat(statFile, &stat) != OK) {
+        closeFile(file);
+        return -1;
+    }
+    if (closeFile(file) != OK) {
+        return -1;
+    }
+    return stat.numRecord;
+}
+
+/*
+ * getQueryStat -- 直前の検索・削除の統計情報の取得
+ *
+ * 引数:
+ *	stat: 統計情報を格納する場所
+ *
+ * 返り値:
+ *	なし
+ */
+void getQueryStat(QueryStat *stat)
+{
+    *stat = queryStat;
+}
+
+/*
+ * printQueryStat -- 直前の検索・削除の統計情報の表示
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ */
+void printQueryStat()
+{
+    printf("pages = %d, read = %d, skipped = %d\n",
+           queryStat.numPage, queryStat.numPageRead, queryStat.numPageSkipped);
+}
+
+/*
+ * checkCondition -- レコードが条件を満足するかどうかのチェック
+ *
+ * 引数:
+ *	recordData: チェックするレコード
+ *	condition: チェックする条件
+ *
+ * 返り値:
+ *	レコードrecordが条件conditionを満足すればOK、満足しなければNGを返す
+ */
+Result checkCondition(RecordData *recordData, Condition *condition)
+{
+    /*フィールド名の確認*/
+    int i=0;
+    while(1){
+        if(strcmp(recordData->fieldData[i].name, condition->name)==0){
+            break;
+        }
+        i++;
+    }
+
+
+    /*比較演算子を確認*/
+    switch(condition->operator){
+        case OPR_EQUAL:
+            if(condition->dataType == TYPE_INTEGER){
+                if(condition->intValue == recordData->fieldData[i].intValue){
+                    return OK;
+                }
+                else return NG;
+            }
+            else{
+                if(strcmp(condition->stringValue, recordData->fieldData[i].stringValue)==0){
+                    return OK;
+                }
+                else return NG;
+            }
+            break;
+
+        case OPR_NOT_EQUAL:
+
+            if(condition->dataType == TYPE_INTEGER){
+                if(condition->intValue != recordData->fieldData[i].intValue){
+                    return OK;
+                }
+                else return NG;
+            }
+            else{
+                if(strcmp(condition->stringValue, recordData->fieldData[i].stringValue)!=0){
+                    return OK;
+                }
+                else return NG;
+            }
+            break;
+
+
+        case OPR_GREATER_THAN:
+
+            if(condition->dataType == TYPE_INTEGER){
+
+                if(condition->intValue < recordData->fieldData[i].intValue){
+                    return OK;
+                }
+                else return NG;
+            }
+            else{
+
+                if(strcmp(condition->stringValue, recordData->fieldData[i].stringValue)<0){
+                    return OK;
+                }
+                else return NG;
+            }
+
+        case OPR_LESS_THAN:
+
+            if(condition->dataType == TYPE_INTEGER){
+
+                if(condition->intValue > recordData->fieldData[i].intValue){
+                    return OK;
+                }
+                else return NG;
+            }
+            else{
+                if(strcmp(condition->stringValue, recordData->fieldData[i].stringValue)>0){
+                    return OK;
+                }
+                else return NG;
+            }
+            break;
+
+        case OPR_LIKE:
+
+            /*likeは文字列のフィールドにだけ使える*/
+            if(condition->dataType == TYPE_STRING && recordData->fieldData[i].dataType == TYPE_STRING
+               && matchLike(recordData->fieldData[i].stringValue, condition->stringValue)){
+                return OK;
+            }
+            else return NG;
+    }        
+
+
+
+
+}
+
+/*
+ * applyAssignments -- レコードのフィールドの値の書き換え
+ *
+ * 引数:
+ *	assignments: 書き換えるフィールドと値
+ *	recordData: 書き換えるレコード
+ *
+ * 返り値:
+ *	なし
+ *
+ * assignmentsのフィールドと同じ名前のフィールドの値を、その値にする。
+ */
+void applyAssignments(RecordData *assignments, RecordData *recordData)
+{
+    int i, k;
+
+    for (k = 0; k < assignments->numField; k++) {
+        for (i = 0; i < recordData->numField; i++) {
+            if (strcmp(recordData->fieldData[i].name, assignments->fieldData[k].name) != 0) {
+                continue;
+            }
+            if (recordData->fieldData[i].dataType == TYPE_INTEGER) {
+                recordData->fieldData[i].intValue = assignments->fieldData[k].intValue;
+            } else {
+                strcpy(recordData->fieldData[i].stringValue, assignments->fieldData[k].stringValue);
+            }
+            break;
+        }
+    }
+}
+
+/*
+ * matchLike -- 文字列がlikeのパターンに合うかどうかの判定
+ *
+ * 引数:
+ *	value: 文字列
+ *	pattern: パターン(%は0文字以上の任意の文字列、_は任意の1文字)
+ *
+ * 返り値:
+ *	合えば1、合わなければ0を返す
+ *
+ * パターンの中で%も_も含まない一番長い部分は、合う文字列のどこかに必ず現れるので、
+ * まずそれをstrstrで探し、なければ1文字ずつ照合せずに0を返す。strstrは
+ * ライブラリの中で複数のバイトをまとめて比べるので、ほとんどの値が合わない
+ * 走査ではこれが効く。照合では最後の%の位置だけを覚えておき、そこからやり直す。
+ */
+int matchLike(char *value, char *pattern)
+{
+    char literal[MAX_VARSTRING];
+    char *star = NULL;
+    char *mark = NULL;
+    int longest = 0;
+    int longestStart = 0;
+    int start;
+    int i;
+
+    /* %と_を含まない一番長い部分を探す */
+    for (i = 0; pattern[i] != '\0'; ) {
+        if (pattern[i] == '%' || pattern[i] == '_') {
+            i++;
+            continue;
+        }
+        start = i;
+        while (pattern[i] != '\0' && pattern[i] != '%' && pattern[i] != '_') {
+            i++;
+        }
+        if (i - start > longest) {
+            longest = i - start;
+            longestStart = start;
+        }
+    }
+    if (longest > 0) {
+        memcpy(literal, pattern + longestStart, longest);
+        literal[longest] = '\0';
+        if (strstr(value, literal) == NULL) {
+            return 0;
+        }
+    }
+
+    /* 1文字ずつ照合し、合わなければ最後の%が1文字多く読み飛ばしたことにしてやり直す */
+    while (*value != '\0') {
+        if (*pattern == '%') {
+            star = pattern++;
+            mark = value;
+        } else if (*pattern != '\0' && (*pattern == '_' || *pattern == *value)) {
+            pattern++;
+            value++;
+        } else if (star != NULL) {
+            pattern = star + 1;
+            value = ++mark;
+        } else {
+            return 0;
+        }
+    }
+    while (*pattern == '%') {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
+
+/*
+ * makeCodeCondition -- 辞書のコードどうしを比べる条件の作成
+ *
+ * 引数:
+ *	dict: 辞書
+ *	tableInfo: テーブルのデータ定義情報
+ *	condField: 条件のフィールドの番号(-1なら見つからなかった)
+ *	condition: 条件
+ *	codeCondition: 作った条件を格納する場所
+ *
+ * 返り値:
+ *	辞書圧縮するフィールドの「=」「!=」の条件なら、値の代わりに辞書のコードを
+ *	整数として比べる条件をcodeConditionに作って返す。それ以外はNULLを返す
+ *
+ * 辞書にない値のコードは-1にする(-1のコードを持つレコードはない)。
+ */
+static Condition *makeCodeCondition(Dictionary *dict, TableInfo *tableInfo, int condField,
+                                    Condition *condition, Condition *codeCondition)
+{
+    if (dict == NULL || condField == -1 || !IS_DICTIONARY_FIELD(tableInfo, condField)
+        || (condition->operator != OPR_EQUAL && condition->operator != OPR_NOT_EQUAL)) {
+        return NULL;
+    }
+
+    *codeCondition = *condition;
+    codeCondition->dataType = TYPE_INTEGER;
+    codeCondition->intValue = lookupDictionaryCode(dict, condField, condition->stringValue);
+    return codeCondition;
+}
+
+/*
+ * checkStoredCondition -- ページから読み出したままのレコードが条件を満たすかどうか
+ *
+ * 引数:
+ *	dict: 辞書(辞書圧縮するフィールドがなければNULL)
+ *	tableInfo: テーブルのデータ定義情報
+ *	recordData: readSlotやreadSlotFieldで読み出したレコード(条件のフィールドの値だけでもよい)
+ *	condField: 条件のフィールドの番号
+ *	condition: 条件
+ *	codeCondition: makeCodeConditionで作った条件(NULLでもよい)
+ *
+ * 返り値:
+ *	条件を満たせばOK、満たさなければNGを返す
+ *
+ * 辞書圧縮するフィールドは、コードどうしを比べられればそうし、
+ * そうでなければ条件のフィールドの値だけを辞書から戻して比べる。
+ */
+static Result checkStoredCondition(Dictionary *dict, TableInfo *tableInfo, RecordData *recordData,
+                                   int condField, Condition *condition, Condition *codeCondition)
+{
+    if (codeCondition != NULL) {
+        return checkCondition(recordData, codeCondition);
+    }
+    if (dict != NULL && condField != -1 && IS_DICTIONARY_FIELD(tableInfo, condField)) {
+        strcpy(recordData->fieldData[condField].stringValue,
+               getDictionaryValue(dict, condField, recordData->fieldData[condField].intValue));
+    }
+    return checkCondition(recordData, condition);
+}
+
+/*
+ * addRecordList -- 検索で見つけたレコードのリストを、レコードの集合に加える
+ *
+ * 引数:
+ *	recordSet: レコードを加えるレコードの集合
+ *	list: mallocしたレコードのリスト
+ *	condition: 検索の条件(重複除去フラグだけを使う)
+ *
+ * 返り値:
+ *	なし
+ *
+ * 重複除去を指定した検索では、すでに集合にあるレコードと同じレコードは解放する。
+ */
+static void addRecordList(RecordSet *recordSet, RecordData *list, Condition *condition)
+{
+    RecordData *next;
+    RecordData **tail = &recordSet->recordData;
+
+    for (; list != NULL; list = next) {
+        next = list->next;
+        list->next = NULL;
+        if (checkDistinct(recordSet, list, condition) != OK) {
+            free(list);
+            continue;
+        }
+        *tail = list;
+        tail = &list->next;
+        recordSet->numRecord++;
+    }
+}
+
+/*
+ * selectLsmRecord -- ログ構造化テーブルのレコードの検索
+ *
+ * 引数:
+ *	tableName: レコードを検索するテーブルの名前
+ *	tableInfo: テーブルのデータ定義情報
+ *	condition: 検索するレコードの条件
+ *	recordSet: 見つけたレコードを加えるレコードの集合
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+static Result selectLsmRecord(char *tableName, TableInfo *tableInfo, Condition *condition, RecordSet *recordSet)
+{
+    RecordData *list;
+
+    if (searchLsmTable(tableName, tableInfo, condition, &queryStat, &list) != OK) {
+        return NG;
+    }
+    addRecordList(recordSet, list, condition);
+    return OK;
+}
+
+/*
+ * selectRecord -- レコードの検索
+ *
+ * 引数:
+ *	tableName: レコードを検索するテーブルの名前
+ *	condition: 検索するレコードの条件
+ *
+ * 返り値:
+ *	検索に成功したら検索されたレコード(の集合)へのポインタを返し、
+ *	検索に失敗したらNULLを返す。
+ *	検索した結果、該当するレコードが1つもなかった場合も、レコードの
+ *	集合へのポインタを返す。
+ *
+ * ***注意***
+ *	この関数が返すレコードの集合を収めたメモリ領域は、不要になったら
+ *	必ずfreeRecordSetで解放すること。
+ */
+RecordSet *selectRecord(char *tableName, Condition *condition)
+{   
+
+    File *file;
+    int len;
+    char* filename;
+    TableInfo *tableInfo;
+    char page[PAGE_SIZE];
+    int numPage;
+    int i, j;
+    int condField;
+    char *column;
+    int stride;
+    int packed;
+    char match[MAX_SLOT_PER_PAGE];
+    Dictionary *dict = NULL;
+    ZoneMap *zoneMap = NULL;
+    BloomFilter *bloom;
+    File *statFile;
+    TableStat stat;
+    Condition codeConditionData;
+    Condition *codeCondition;
+    RecordData record;
+    RecordData *recordData;
+    RecordSet *recordSet;
+    RecordData *list;
+    int *pageList;
+    int numListed;
+    int n;
+
+
+    /*レコードセットの初期化*/
+    if((recordSet = (RecordSet *)malloc(sizeof(RecordSet))) == NULL){
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    recordSet->numRecord=0;
+    recordSet->recordData=NULL;
+
+    /*インメモリテーブルなら、ファイルを使わずメモリ上の配列から検索する*/
+    if(isMemoryTable(tableName)){
+        if(searchMemoryTable(tableName, condition, &queryStat, &list) != OK){
+            freeRecordSet(recordSet);
+            return NULL;
+        }
+        addRecordList(recordSet, list, condition);
+        return recordSet;
+    }
+    tableName = resolveTableName(tableName);
+
+    /*[tableName].datという文字列を作る*/
+    len = strlen(tableName) + strlen(DATA_FILE_EXT) + 1;
+    if ((filename = malloc(len)) == NULL ){
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    snprintf(filename, len, "%s%s", tableName, DATA_FILE_EXT);
+
+
+    /*データファイルをオープン*/
+    if((file = openFile(filename)) == NULL){
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        free(filename);
+        return NULL;
+    }
+
+    /*データ構造を読み取る*/
+    if((tableInfo = getTableInfo(tableName)) == NULL){
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        closeFile(file);
+        free(tableInfo);
+        return NULL;
+    }
+    setFilePartition(file, tableInfo->option.partition);
+
+    /*ログ構造化テーブルなら、メムテーブルとランから検索する*/
+    if(getLsmField(tableInfo) != -1){
+        free(filename);
+        closeFile(file);
+        if(selectLsmRecord(tableName, tableInfo, condition, recordSet) != OK){
+            freeRecordSet(recordSet);
+            recordSet = NULL;
+        }
+        freeTableInfo(tableInfo);
+        return recordSet;
+    }
+
+    /*ページ数を取得*/
+    if((numPage = getNumPages(filename)) == -1){
+        printErrorMessage(ERR_MSG_STAT, __func__, __LINE__);
+        closeFile(file);
+        free(filename);
+        return NULL;
+    }
+
+    free(filename);
+
+    /*
+     * 条件のフィールドの番号を調べ、recordにフィールド名とデータ型を設定しておく
+     * (条件の判定にはそのフィールドの値だけを読み、条件に合ったレコードだけを全部読む)
+     */
+    condField = -1;
+    record.numField = tableInfo->numField;
+    for(i=0; i<tableInfo->numField; i++){
+        strcpy(record.fieldData[i].name, tableInfo->fieldInfo[i].name);
+        record.fieldData[i].dataType = tableInfo->fieldInfo[i].dataType;
+        if(strcmp(tableInfo->fieldInfo[i].name, condition->name) == 0){
+            condField = i;
+        }
+    }
+
+    /*辞書圧縮するフィールドがあれば辞書を読み込み、できれば条件をコードどうしの比較にする*/
+    if(hasDictionaryField(tableInfo)){
+        if((dict = openDictionary(tableName)) == NULL){
+            freeTableInfo(tableInfo);
+            closeFile(file);
+            return NULL;
+        }
+    }
+    codeCondition = makeCodeCondition(dict, tableInfo, condField, condition, &codeConditionData);
+
+    /*ゾーンマップがデータファイルと一致していれば、条件に合うレコードがないページを読み飛ばす*/
+    if((statFile = openTableStat(tableName, &stat)) != NULL
+       && stat.numPage == numPage && stat.numZoneMapPage == numPage){
+        zoneMap = openZoneMap(statFile, numPage, tableInfo);
+    }
+
+    /*ブルームフィルタがデータファイルと一致していれば、検索する値がないページを読み飛ばす*/
+    if((bloom = openBloomFilter(tableName, tableInfo)) != NULL && bloom->numPage != numPage){
+        closeBloomFilter(bloom);
+        bloom = NULL;
+    }
+    memset(&queryStat, 0, sizeof(queryStat));
+    queryStat.numPage = numPage;
+
+    /*条件のフィールドに索引があれば、条件に合うレコードがあるページだけを読む*/
+    if((pageList = searchTableIndex(tableName, file, tableInfo, condField, condition, numPage, &numListed)) != NULL){
+        queryStat.numPageSkipped = numPage - numListed;
+    }
+
+    /*ページ数分だけループ*/
+    for(n=0; n<(pageList != NULL ? numListed : numPage); n++){
+        i = pageList != NULL ? pageList[n] : n;
+        if((zoneMap != NULL && checkZoneMap(zoneMap, i, condField, condition) == 0)
+           || (bloom != NULL && checkBloomFilter(bloom, i, condField, condition) == 0)){
+            queryStat.numPageSkipped++;
+            continue;
+        }
+
+        /*一ページ読みこむ*/
+        if(readPage(file, i, page)){
+            if(dict != NULL){
+                closeDictionary(dict);
+            }
+            if(zoneMap != NULL){
+                closeZoneMap(zoneMap);
+            }
+            if(statFile != NULL){
+                closeTableStat(statFile, NULL);
+            }
+            if(bloom != NULL){
+                closeBloomFilter(bloom);
+            }
+            free(pageList);
+            closeFile(file);
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return NULL;
+        }
+        queryStat.numPageRead++;
+
+
+        /*
+         * 条件のフィールドがビット詰めしたものなら、詰めたままページ全体を判定する
+         * 値が等間隔に並ぶ形式なら、その並びを直接読む
+         */
+        column = NULL;
+        packed = 0;
+        if(condField != -1){
+            packed = matchPackedField(page, tableInfo, condField, condition, match) == OK;
+            column = getFieldColumn(page, tableInfo, condField, &stride);
+        }
+
+        /*使用中のスロットごとに処理*/
+        for(j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)){
+            /*条件のフィールドの値だけを読んで判定する*/
+            if(packed){
+                if(!match[j]){
+                    continue;
+                }
+            }
+            else if(condField != -1){
+                if(column == NULL){
+                    readSlotField(page, j, tableInfo, condField, &record.fieldData[condField]);
+                }
+                else if(record.fieldData[condField].dataType == TYPE_INTEGER
+                        || IS_DICTIONARY_FIELD(tableInfo, condField)){
+                    memcpy(&record.fieldData[condField].intValue, column + j * stride, sizeof(int));
+                }
+                else{
+                    memcpy(record.fieldData[condField].stringValue, column + j * stride, MAX_STRING);
+                    record.fieldData[condField].stringValue[MAX_STRING] = '\0';
+                }
+                if(checkStoredCondition(dict, tableInfo, &record, condField, condition, codeCondition) != OK){
+                    continue;
+                }
+            }
+
+            /*レコードのデータをRecordDataへ*/
+            if(readSlot(page, j, tableInfo, &record) == OK){
+                if(dict != NULL){
+                    decodeDictionaryFields(dict, tableInfo, &record);
+                }
+                /*条件に合ったらRecordSetに挿入*/
+                if(checkCondition(&record, condition) == OK && checkDistinct(recordSet, &record, condition) == OK){
+                    RecordData *r;
+
+                    /*recordDataのメモリ確保(フィールド数の分だけ)*/
+                    if((recordData = (RecordData *)malloc(RECORD_DATA_SIZE(record.numField))) == NULL){
+                        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+                        if(dict != NULL){
+                            closeDictionary(dict);
+                        }
+                        if(zoneMap != NULL){
+                            closeZoneMap(zoneMap);
+                        }
+                        if(statFile != NULL){
+                            closeTableStat(statFile, NULL);
+                        }
+                        if(bloom != NULL){
+                            closeBloomFilter(bloom);
+                        }
+                        free(pageList);
+                        freeTableInfo(tableInfo);
+                        closeFile(file);
+                        return NULL;
+                    }
+                    record.rid.pageNum = i;
+                    record.rid.slot = j;
+                    memcpy(recordData, &record, RECORD_DATA_SIZE(record.numField));
+                    recordData -> next = NULL;
+
+                    r = recordSet->recordData;
+                    if(r==NULL){
+                        recordSet->recordData=recordData;
+                        recordSet->numRecord=1;
+                    }
+                    else{
+                        while(r->next!=NULL){
+                            /*終わりを見つける*/
+                            r=r->next;
+                        }
+                        r->next = recordData;
+                        recordSet->numRecord++;
+                    }
+                }
+            }
+        }
+    }
+    freeTableInfo(tableInfo);
+    if(dict != NULL){
+        closeDictionary(dict);
+    }
+    if(zoneMap != NULL){
+        closeZoneMap(zoneMap);
+    }
+    if(statFile != NULL){
+        closeTableStat(statFile, NULL);
+    }
+    if(bloom != NULL){
+        closeBloomFilter(bloom);
+    }
+    free(pageList);
+    if((closeFile(file) != OK)){
+        printErrorMessage(ERR_MSG_STAT, __func__, __LINE__);
+        return NULL;
+    }
+
+    return recordSet;
+
+}
+/*
+ * fieldDataCmp
+ *
+ * フィールドデータを比較
+ * 同じならOK
+ *
+ */
+Result fieldDataCmp(FieldData a, FieldData b){
+    if(a.dataType != b.dataType){
+        return NG;
+    }
+    if(strcmp(a.name, b.name) != 0){
+        return NG;
+    }
+    if(a.dataType == TYPE_STRING){
+        if(strcmp(a.stringValue, b.stringValue) != 0){
+            return NG;
+        }
+    }
+    else if(a.dataType == TYPE_INTEGER){
+        if(a.intValue != b.intValue){
+            return NG;
+        }
+    }
+
+    return OK;
+}
+    
+
+
+
+/*
+ * checkDistinct
+ *
+ * 重複確認
+ *
+ * 重複しなければ OK
+ */
+Result checkDistinct(RecordSet *recordSet, RecordData *data, Condition *condition){
+    RecordData *r;
+    r = recordSet->recordData;
+    int i;
+    int num = data->numField;
+
+    if(condition->distinct == NOT_DISTINCT){
+        return OK;
+    }
+    //rがnullなら重複するはずなし
+    if(r == NULL){
+        return OK;
+    }
+    while(r!=NULL){
+       if(r->numField==data->numField){
+           for(i=0;i<num;i++){
+              if(fieldDataCmp(r->fieldData[i], data->fieldData[i]) != OK){
+                 break; 
+              }
+           }
+       }
+       r=r->next;
+    }
+    if(i==num){
+        return NG;
+    }
+    return OK;
+}
+
+
+/*
+ * openRecordPage -- レコードの位置のページの読み込み
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	tableInfo: テーブルのデータ定義情報
+ *	rid: レコードの位置
+ *	page: 読み込んだページを格納する場所
+ *	numPage: データファイルのページ数を格納する場所
+ *
+ * 返り値:
+ *	オープンしたデータファイル。位置が範囲外か、そのスロットが空きなら、
+ *	あるいはエラーの場合はNULLを返す。
+ *
+ * 読んだページ数をqueryStatに記録する。
+ */
+static File *openRecordPage(char *tableName, TableInfo *tableInfo, RecordId *rid, char *page, int *numPage)
+{
+    File *file;
+    char filename[MAX_FILENAME];
+
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DATA_FILE_EXT);
+    if ((*numPage = getNumPages(filename)) == -1 || (file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NULL;
+    }
+    setFilePartition(file, tableInfo->option.partition);
+
+    memset(&queryStat, 0, sizeof(queryStat));
+    queryStat.numPage = *numPage;
+    if (rid->pageNum < 0 || rid->pageNum >= *numPage || rid->slot < 0) {
+        closeFile(file);
+        return NULL;
+    }
+    if (readPage(file, rid->pageNum, page) != OK) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        closeFile(file);
+        return NULL;
+    }
+    queryStat.numPageRead = 1;
+    queryStat.numPageSkipped = *numPage - 1;
+    if (getNextSlot(page, rid->slot, tableInfo) != rid->slot) {
+        closeFile(file);
+        return NULL;
+    }
+    return file;
+}
+
+/*
+ * fetchRecord -- 位置を指定したレコードの取り出し
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	rid: レコードの位置(selectRecordの結果のレコードのrid)
+ *	recordData: 取り出したレコードを格納する場所
+ *
+ * 返り値:
+ *	成功ならOK、失敗(その位置にレコードがない場合を含む)ならNGを返す
+ *
+ * レコードがあるページだけを読む。インメモリテーブルとログ構造化テーブルの
+ * レコードは位置を持たないので、取り出せない。
+ */
+Result fetchRecord(char *tableName, RecordId *rid, RecordData *recordData)
+{
+    TableInfo *tableInfo;
+    Dictionary *dict;
+    File *file;
+    char page[PAGE_SIZE];
+    int numPage;
+    Result result;
+
+    if (isMemoryTable(tableName)) {
+        return NG;
+    }
+    tableName = resolveTableName(tableName);
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        return NG;
+    }
+    if (getLsmField(tableInfo) != -1 || (file = openRecordPage(tableName, tableInfo, rid, page, &numPage)) == NULL) {
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+
+    result = readSlot(page, rid->slot, tableInfo, recordData);
+    if (result == OK && hasDictionaryField(tableInfo)) {
+        if ((dict = openDictionary(tableName)) == NULL) {
+            result = NG;
+        } else {
+            decodeDictionaryFields(dict, tableInfo, recordData);
+            closeDictionary(dict);
+        }
+    }
+    recordData->next = NULL;
+    recordData->rid = *rid;
+
+    freeTableInfo(tableInfo);
+    if (closeFile(file) != OK) {
+        return NG;
+    }
+    return result;
+}
+
+/*
+ * deleteRecordByRid -- 位置を指定したレコードの削除
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	rid: レコードの位置(selectRecordの結果のレコードのrid)
+ *
+ * 返り値:
+ *	成功ならOK、失敗(その位置にレコードがない場合を含む)ならNGを返す
+ *
+ * レコードがあるページだけを読み書きし、deleteRecordと同じように索引、
+ * クラッカー列、空き領域マップ、統計情報、ゾーンマップ、ブルームフィルタにも反映する。
+ * インメモリテーブルとログ構造化テーブル、時系列テーブルのレコードは削除できない。
+ */
+Result deleteRecordByRid(char *tableName, RecordId *rid)
+{
+    TableInfo *tableInfo;
+    File *file;
+    File *statFile;
+    FreeSpaceMap *fsm;
+    ZoneMap *zoneMap;
+    BloomFilter *bloom;
+    TableStat stat;
+    Index *indexes[MAX_FIELD];
+    RecordData recordData;
+    char page[PAGE_SIZE];
+    int numPage;
+    int numFreeSlot;
+
+    if (isMemoryTable(tableName)) {
+        return NG;
+    }
+    tableName = resolveTableName(tableName);
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        return NG;
+    }
+    if (getLsmField(tableInfo) != -1 || getSeriesField(tableInfo) != -1
+        || (file = openRecordPage(tableName, tableInfo, rid, page, &numPage)) == NULL) {
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+
+    if ((fsm = openTableFreeSpaceMap(tableName, file, numPage, tableInfo)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return NG;
+    }
+    if ((statFile = loadTableStat(tableName, file, numPage, tableInfo, &stat)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
+
+    /* 索引とクラッカー列から取り除いてから削除する */
+    readSlot(page, rid->slot, tableInfo, &recordData);
+    openTableIndexes(tableInfo, indexes);
+    updateTableIndexes(tableInfo, indexes, &recordData, rid, 0);
+    closeTableIndexes(tableName, tableInfo, indexes);
+    deleteCrackerEntry(tableName, &recordData, rid);
+
+    numFreeSlot = countFreeSlots(page, tableInfo);
+    deleteFromPage(page, rid->slot, tableInfo);
+    if (writePage(file, rid->pageNum, page) != OK) {
+        freeTableInfo(tableInfo);
+        closeTableStat(statFile, NULL);
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    setPageFreeSpace(fsm, rid->pageNum, getPageFreeSpaceValue(page, tableInfo));
+    stat.numDeadSlot += countFreeSlots(page, tableInfo) - numFreeSlot;
+    stat.numRecord--;
+
+    /* 空になったページは、ゾーンマップとブルームフィルタにも空として記録する */
+    if (countUsedSlots(page, tableInfo) == 0) {
+        if ((zoneMap = openTableZoneMap(file, numPage, tableInfo, statFile, &stat)) != NULL) {
+            stat.numZoneMapPage = clearZoneMap(zoneMap, rid->pageNum) == OK ? zoneMap->numPage : -1;
+            closeZoneMap(zoneMap);
+        }
+        if ((bloom = openBloomFilter(tableName, tableInfo)) != NULL) {
+            if (bloom->numPage != numPage) {
+                closeBloomFilter(bloom);
+            } else if (clearBloomFilter(bloom, rid->pageNum) != OK) {
+                closeBloomFilter(bloom);
+                deleteBloomFilter(tableName);
+            } else if (closeBloomFilter(bloom) != OK) {
+                deleteBloomFilter(tableName);
+            }
+        }
+    }
+
+    freeTableInfo(tableInfo);
+    if (closeTableStat(statFile, &stat) != OK) {
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
+    if (closeFreeSpaceMap(fsm) != OK) {
+        closeFile(file);
+        return NG;
+    }
+    return closeFile(file);
+}
+
+/*
+ * freeRecordSet -- レコード集合の情報を収めたメモリ領域の解放
+ *
+ * 引数:
+ *	recordSet: 解放するメモリ領域
+ *
+ * 返り値:
+ *	なし
+ *
+ * ***注意***
+ *	関数selectRecordが返すレコードの集合を収めたメモリ領域は、
+ *	不要になったら必ずこの関数で解放すること。
+ */
+void freeRecordSet(RecordSet *recordSet)
+{
+    RecordData *p, *n;
+    p = recordSet ->recordData;
+
+    while(p != NULL){
+        n = p->next;
+        free(p);
+        p = n;
+    }
+
+    free(recordSet);
+
+}
+
+/*
+ * deleteRecord -- レコードの削除
+ *
+ * 引数:
+ *	tableName: レコードを削除するテーブルの名前
+ *	condition: 削除するレコードの条件
+ *
+ * 返り値:
+ *	削除に成功したらOK、失敗したらNGを返す
+ */
+Result deleteRecord(char *tableName, Condition *condition)
+{
+    int numPage;
+    int numFreeSlot;
+    int i, j;
+    File *file;
+    TableInfo *tableInfo;
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    RecordData recordData;
+    int delcatch = 0;
+    int numDeleted = 0;
+    FreeSpaceMap *fsm;
+    File *statFile;
+    TableStat stat;
+    Dictionary *dict = NULL;
+    Condition codeConditionData;
+    Condition *codeCondition;
+    int condField;
+    int packed;
+    char match[MAX_SLOT_PER_PAGE];
+    ZoneMap *zoneMap;
+    BloomFilter *bloom;
+    Index *indexes[MAX_FIELD];
+    int numIndex;
+    RecordId rid;
+    int *pageList;
+    int numListed;
+    int n;
+    int crack;
+
+
+    /*インメモリテーブルなら、メモリ上の配列から取り除く*/
+    if (isMemoryTable(tableName)) {
+        return deleteMemoryRecord(tableName, condition, &queryStat);
+    }
+    tableName = resolveTableName(tableName);
+
+    /*[tableName].datという文字列をつくる*/
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DATA_FILE_EXT);
+
+    /*tableInfoを取得*/
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        return NG;
+    }
+
+    /*ログ構造化テーブルなら、条件に合うレコードの墓標を書く*/
+    if (getLsmField(tableInfo) != -1) {
+        n = deleteLsmRecord(tableName, tableInfo, condition, &queryStat);
+        freeTableInfo(tableInfo);
+        return n;
+    }
+
+    /*時系列テーブルは追記専用なので、レコードを削除できない(truncateSeriesTableで古いページを捨てる)*/
+    if (getSeriesField(tableInfo) != -1) {
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+
+    /*条件のフィールドと、クラッキングするフィールドがあるかどうかを調べる*/
+    condField = -1;
+    crack = 0;
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (strcmp(tableInfo->fieldInfo[i].name, condition->name) == 0) {
+            condField = i;
+        }
+        if (IS_CRACK_FIELD(tableInfo, i)) {
+            crack = 1;
+        }
+    }
+
+    if((file=openFile(filename)) == NULL){
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+    setFilePartition(file, tableInfo->option.partition);
+
+    /*ページ数を取得*/
+    numPage = getNumPages(filename);
+
+    /*削除で空いた領域を記録するため、空き領域マップをオープンする*/
+    if ((fsm = openTableFreeSpaceMap(tableName, file, numPage, tableInfo)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return NG;
+    }
+
+    /*テーブルの統計情報を読み込む*/
+    if ((statFile = loadTableStat(tableName, file, numPage, tableInfo, &stat)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
+
+    /*辞書圧縮するフィールドがあれば辞書を読み込み、できれば条件をコードどうしの比較にする*/
+    if (hasDictionaryField(tableInfo)) {
+        if ((dict = openDictionary(tableName)) == NULL) {
+            freeTableInfo(tableInfo);
+            closeTableStat(statFile, NULL);
+            closeFreeSpaceMap(fsm);
+            closeFile(file);
+            return NG;
+        }
+    }
+    codeCondition = makeCodeCondition(dict, tableInfo, condField, condition, &codeConditionData);
+
+    /*条件に合うレコードがないページを読み飛ばし、空になったページを記録するため、ゾーンマップをオープンする*/
+    zoneMap = openTableZoneMap(file, numPage, tableInfo, statFile, &stat);
+    if ((bloom = openBloomFilter(tableName, tableInfo)) != NULL && bloom->numPage != numPage) {
+        closeBloomFilter(bloom);
+        bloom = NULL;
+    }
+    memset(&queryStat, 0, sizeof(queryStat));
+    queryStat.numPage = numPage;
+
+    /*条件のフィールドに索引があれば、条件に合うレコードがあるページだけを読む*/
+    if ((pageList = searchTableIndex(tableName, file, tableInfo, condField, condition, numPage, &numListed)) != NULL) {
+        queryStat.numPageSkipped = numPage - numListed;
+    }
+
+    /*削除したレコードを索引から取り除くため、すべての索引をオープンする*/
+    numIndex = openTableIndexes(tableInfo, indexes);
+
+    /*レコードを一つずつ取り出し、条件を満足するかどうかチェックする*/
+    for (n = 0; n < (pageList != NULL ? numListed : numPage); n++) {
+        i = pageList != NULL ? pageList[n] : n;
+        if ((zoneMap != NULL && checkZoneMap(zoneMap, i, condField, condition) == 0)
+            || (bloom != NULL && checkBloomFilter(bloom, i, condField, condition) == 0)) {
+            queryStat.numPageSkipped++;
+            continue;
+        }
+
+        /*1ページぶんのデータを読み込む*/
+        delcatch = 0;
+        if (readPage(file, i, page) != OK){
+            if (dict != NULL) {
+                closeDictionary(dict);
+            }
+            if (zoneMap != NULL) {
+                closeZoneMap(zoneMap);
+            }
+            if (bloom != NULL) {
+                closeBloomFilter(bloom);
+            }
+            closeTableIndexes(tableName, tableInfo, indexes);
+            free(pageList);
+            freeTableInfo(tableInfo);
+            closeTableStat(statFile, NULL);
+            closeFreeSpaceMap(fsm);
+            closeFile(file);
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return NG;
+        }
+        queryStat.numPageRead++;
+        numFreeSlot = countFreeSlots(page, tableInfo);
+
+        /*条件のフィールドがビット詰めしたものなら、詰めたままページ全体を判定する*/
+        packed = condField != -1 && matchPackedField(page, tableInfo, condField, condition, match) == OK;
+
+        /*使用中のスロットを一つずつ取り出して処理する*/
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)){
+            if (packed) {
+                if (!match[j]) {
+                    continue;
+                }
+            } else if (readSlot(page, j, tableInfo, &recordData) != OK
+                       || checkStoredCondition(dict, tableInfo, &recordData, condField, condition, codeCondition) != OK) {
+                continue;
+            }
+
+            /*条件を満たしたレコードを、索引とクラッカー列から取り除いてから削除*/
+            if (numIndex > 0 || crack) {
+                if (packed) {
+                    readSlot(page, j, tableInfo, &recordData);
+                }
+                rid.pageNum = i;
+                rid.slot = j;
+                updateTableIndexes(tableInfo, indexes, &recordData, &rid, 0);
+                if (crack) {
+                    deleteCrackerEntry(tableName, &recordData, &rid);
+                }
+            }
+            deleteFromPage(page, j, tableInfo);
+            delcatch = 1;
+            numDeleted++;
+        }
+
+        /*delcatchの値が1の場合、ページの内容を書き戻し、空いた領域を記録する*/
+        if(delcatch == 1){
+            if(writePage(file, i, page) != OK){
+                if (dict != NULL) {
+                    closeDictionary(dict);
+                }
+                if (zoneMap != NULL) {
+                    closeZoneMap(zoneMap);
+                }
+                if (bloom != NULL) {
+                    closeBloomFilter(bloom);
+                }
+                closeTableIndexes(tableName, tableInfo, indexes);
+                free(pageList);
+                freeTableInfo(tableInfo);
+                closeTableStat(statFile, NULL);
+                closeFreeSpaceMap(fsm);
+                closeFile(file);
+                printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+                return NG;
+            }
+            setPageFreeSpace(fsm, i, getPageFreeSpaceValue(page, tableInfo));
+            stat.numDeadSlot += countFreeSlots(page, tableInfo) - numFreeSlot;
+
+            /*最小値と最大値は狭めないが、空になったページは空として記録する*/
+            if (zoneMap != NULL && countUsedSlots(page, tableInfo) == 0
+                && clearZoneMap(zoneMap, i) != OK) {
+                /*記録できなかったら、次に使うときに作り直すようゾーンマップを無効にする*/
+                closeZoneMap(zoneMap);
+                zoneMap = NULL;
+                stat.numZoneMapPage = -1;
+            }
+            /*ブルームフィルタも、空になったページのビットだけを落とす*/
+            if (bloom != NULL && countUsedSlots(page, tableInfo) == 0
+                && clearBloomFilter(bloom, i) != OK) {
+                closeBloomFilter(bloom);
+                bloom = NULL;
+                deleteBloomFilter(tableName);
+            }
+        }
+    }
+
+    if (dict != NULL) {
+        closeDictionary(dict);
+    }
+    if (zoneMap != NULL) {
+        stat.numZoneMapPage = zoneMap->numPage;
+        closeZoneMap(zoneMap);
+    }
+    if (bloom != NULL && closeBloomFilter(bloom) != OK) {
+        deleteBloomFilter(tableName);
+    }
+    closeTableIndexes(tableName, tableInfo, indexes);
+    free(pageList);
+    freeTableInfo(tableInfo);
+
+    /*統計情報を更新する*/
+    stat.numRecord -= numDeleted;
+    if (closeTableStat(statFile, &stat) != OK) {
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
+
+    /*ファイルを閉じる*/
+    if (closeFreeSpaceMap(fsm) != OK) {
+        closeFile(file);
+        return NG;
+    }
+    if((closeFile(file)) != OK){
+        return NG;
+    }
+    return OK;
+}
+
+/*
+ * getMaxStringLength -- 文字列型のフィールドに格納できる文字列の長さの上限(バイト数)
+ *
+ * insertRecordと同じ規則で、固定長で格納するフィールドはMAX_STRINGバイトまで、
+ * スロット形式、辞書圧縮するフィールド、ログ構造化テーブルはMAX_VARSTRING - 1バイトまで
+ * 格納できる(スロット形式では、さらにレコード全体が1ページに収まる必要がある)。
+ */
+static int getMaxStringLength(TableInfo *tableInfo, int field)
+{
+    if (tableInfo->option.layout == LAYOUT_SLOTTED || IS_DICTIONARY_FIELD(tableInfo, field)
+        || getLsmField(tableInfo) != -1) {
+        return MAX_VARSTRING - 1;
+    }
+    return MAX_STRING;
+}
+
+/*
+ * updateRecord -- レコードの更新
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	assignments: 書き換えるフィールドと値(フィールド名、データ型、値をnumField個並べる)
+ *	condition: 更新するレコードの条件
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * 1回の走査で、条件に合うレコードをそのスロットのまま書き換え、書き換えたページを
+ * 1回だけ書き戻す(レコードの位置は変わらないので、索引は書き換えたフィールドの分だけ変わる)。
+ * そのページに収まらなくなったレコード(スロット形式で長くなったもの、ビット詰めする
+ * フィールドの値が収まらないもの)と、クラスタ化テーブルのキーを書き換えたレコードは、
+ * 走査の後で削除して挿入し直す。
+ * 文字列の長さの上限は挿入と同じで、格納できないレコードになる更新はNGにする。
+ * 時系列テーブルの時刻のフィールドは書き換えられない。インメモリテーブルは
+ * 配列の値を書き換え(文字列の長さに上限はない)、ログ構造化テーブルは墓標と
+ * 新しいレコードを書く。
+ */
+Result updateRecord(char *tableName, RecordData *assignments, Condition *condition)
+{
+    int numPage;
+    int numFreeSlot;
+    int i, j, k;
+    File *file;
+    TableInfo *tableInfo;
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    RecordData oldRecord;
+    RecordData newRecord;
+    RecordData *moved = NULL;
+    RecordData *recordData;
+    int modified;
+    int numUpdated = 0;
+    int numMoved = 0;
+    FreeSpaceMap *fsm;
+    File *statFile;
+    TableStat stat;
+    Dictionary *dict = NULL;
+    Condition codeConditionData;
+    Condition *codeCondition;
+    int condField;
+    int clusterField;
+    int seriesField;
+    int packed;
+    char match[MAX_SLOT_PER_PAGE];
+    ZoneMap *zoneMap;
+    BloomFilter *bloom = NULL;
+    Index *indexes[MAX_FIELD];
+    RecordId rid;
+    int *pageList;
+    int numListed;
+    int n;
+    int crack;
+    Result result = OK;
+
+    /*
+     * 書き換えるフィールドが、どれもテーブルにあってデータ型が合い、
+     * 文字列がそのテーブルに格納できる長さか確かめる
+     */
+    if ((tableInfo = getTableInfo(resolveTableName(tableName))) == NULL) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        return NG;
+    }
+    for (k = 0; k < assignments->numField; k++) {
+        for (i = 0; i < tableInfo->numField; i++) {
+            if (strcmp(tableInfo->fieldInfo[i].name, assignments->fieldData[k].name) == 0) {
+                break;
+            }
+        }
+        if (i == tableInfo->numField || tableInfo->fieldInfo[i].dataType != assignments->fieldData[k].dataType
+            || (assignments->fieldData[k].dataType == TYPE_STRING && !isMemoryTable(tableName)
+                && strlen(assignments->fieldData[k].stringValue) > (size_t) getMaxStringLength(tableInfo, i))) {
+            printErrorMessage(ERR_MSG_RECORD_SIZE, __func__, __LINE__);
+            freeTableInfo(tableInfo);
+            return NG;
+        }
+    }
+
+    /*インメモリテーブルなら、メモリ上の配列を書き換える*/
+    if (isMemoryTable(tableName)) {
+        freeTableInfo(tableInfo);
+        return updateMemoryRecord(tableName, assignments, condition, &queryStat);
+    }
+    tableName = resolveTableName(tableName);
+
+    /*ログ構造化テーブルなら、条件に合うレコードの墓標と書き換えたレコードを書く*/
+    if (getLsmField(tableInfo) != -1) {
+        memset(&queryStat, 0, sizeof(queryStat));
+        result = updateLsmRecord(tableName, tableInfo, assignments, condition, &queryStat);
+        freeTableInfo(tableInfo);
+        return result;
+    }
+
+    /*時系列テーブルでは、時刻の順に並べてあるので、時刻は書き換えられない*/
+    seriesField = getSeriesField(tableInfo);
+    clusterField = getClusterField(tableInfo);
+    for (k = 0; k < assignments->numField; k++) {
+        if (seriesField != -1 && strcmp(tableInfo->fieldInfo[seriesField].name, assignments->fieldData[k].name) == 0) {
+            freeTableInfo(tableInfo);
+            return NG;
+        }
+    }
+
+    /*条件のフィールドと、クラッキングするフィールドがあるかどうかを調べる*/
+    condField = -1;
+    crack = 0;
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (strcmp(tableInfo->fieldInfo[i].name, condition->name) == 0) {
+            condField = i;
+        }
+        if (IS_CRACK_FIELD(tableInfo, i)) {
+            crack = 1;
+        }
+    }
+
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DATA_FILE_EXT);
+    if ((file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+    setFilePartition(file, tableInfo->option.partition);
+    numPage = getNumPages(filename);
+
+    if ((fsm = openTableFreeSpaceMap(tableName, file, numPage, tableInfo)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return NG;
+    }
+    if ((statFile = loadTableStat(tableName, file, numPage, tableInfo, &stat)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
+
+    /*辞書圧縮するフィールドがあれば、条件の判定と書き換えた値の符号化に辞書を使う*/
+    if (hasDictionaryField(tableInfo)) {
+        if ((dict = openDictionary(tableName)) == NULL) {
+            freeTableInfo(tableInfo);
+            closeTableStat(statFile, NULL);
+            closeFreeSpaceMap(fsm);
+            closeFile(file);
+            return NG;
+        }
+    }
+    codeCondition = makeCodeCondition(dict, tableInfo, condField, condition, &codeConditionData);
+
+    /*読み飛ばすページを決め、書き換えた値を記録するため、ゾーンマップとブルームフィルタをオープンする*/
+    zoneMap = openTableZoneMap(file, numPage, tableInfo, statFile, &stat);
+    if (hasBloomField(tableInfo) && (bloom = openTableBloomFilter(tableName, file, numPage, tableInfo)) == NULL) {
+        deleteBloomFilter(tableName);
+    }
+    memset(&queryStat, 0, sizeof(queryStat));
+    queryStat.numPage = numPage;
+
+    /*条件のフィールドに索引があれば、条件に合うレコードがあるページだけを読む*/
+    if ((pageList = searchTableIndex(tableName, file, tableInfo, condField, condition, numPage, &numListed)) != NULL) {
+        queryStat.numPageSkipped = numPage - numListed;
+    }
+    openTableIndexes(tableInfo, indexes);
+
+    for (n = 0; n < (pageList != NULL ? numListed : numPage); n++) {
+        i = pageList != NULL ? pageList[n] : n;
+        if ((zoneMap != NULL && checkZoneMap(zoneMap, i, condField, condition) == 0)
+            || (bloom != NULL && checkBloomFilter(bloom, i, condField, condition) == 0)) {
+            queryStat.numPageSkipped++;
+            continue;
+        }
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            result = NG;
+            break;
+        }
+        queryStat.numPageRead++;
+        numFreeSlot = countFreeSlots(page, tableInfo);
+        packed = condField != -1 && matchPackedField(page, tableInfo, condField, condition, match) == OK;
+        modified = 0;
+
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            if (packed) {
+                if (!match[j]) {
+                    continue;
+                }
+                readSlot(page, j, tableInfo, &oldRecord);
+            } else if (readSlot(page, j, tableInfo, &oldRecord) != OK
+                       || checkStoredCondition(dict, tableInfo, &oldRecord, condField, condition, codeCondition) != OK) {
+                continue;
+            }
+
+            /*書き換えたレコードを作る(辞書圧縮するフィールドは、値に戻してから符号化し直す)*/
+            memcpy(&newRecord, &oldRecord, sizeof(RecordData));
+            if (dict != NULL) {
+                decodeDictionaryFields(dict, tableInfo, &newRecord);
+            }
+            applyAssignments(assignments, &newRecord);
+            if ((recordData = (RecordData *) malloc(sizeof(RecordData))) == NULL) {
+                printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+                result = NG;
+                break;
+            }
+            memcpy(recordData, &newRecord, sizeof(RecordData));
+
+            /*挿入と同じく、符号化できないか1ページにも収まらないレコードは格納できない*/
+            if ((dict != NULL && encodeDictionaryFields(dict, tableInfo, &newRecord) != OK)
+                || getRequiredFreeSpaceValue(tableInfo, &newRecord) == -1) {
+                printErrorMessage(ERR_MSG_RECORD_SIZE, __func__, __LINE__);
+                free(recordData);
+                result = NG;
+                break;
+            }
+
+            /*クラスタ化テーブルのキーが変わったか、そのスロットに収まらなければ、挿入し直す*/
+            if ((clusterField != -1
+                 && (newRecord.fieldData[clusterField].intValue != oldRecord.fieldData[clusterField].intValue
+                     || strcmp(newRecord.fieldData[clusterField].stringValue,
+                               oldRecord.fieldData[clusterField].stringValue) != 0))
+                || updateSlot(page, j, tableInfo, &newRecord) != OK) {
+                recordData->next = moved;
+                moved = recordData;
+                deleteFromPage(page, j, tableInfo);
+                numMoved++;
+            } else {
+                free(recordData);
+                recordData = NULL;
+            }
+            modified = 1;
+            numUpdated++;
+
+            /*元の値を索引とクラッカー列から取り除く*/
+            rid.pageNum = i;
+            rid.slot = j;
+            updateTableIndexes(tableInfo, indexes, &oldRecord, &rid, 0);
+            if (crack) {
+                deleteCrackerEntry(tableName, &oldRecord, &rid);
+            }
+            if (recordData != NULL) {
+                continue;
+            }
+
+            /*書き換えた値を索引、クラッカー列、ゾーンマップ、ブルームフィルタに加える*/
+            updateTableIndexes(tableInfo, indexes, &newRecord, &rid, 1);
+            if (crack) {
+                insertCrackerEntry(tableName, numPage, &newRecord, &rid);
+            }
+            if (zoneMap != NULL && addToZoneMap(zoneMap, i, &newRecord) != OK) {
+                closeZoneMap(zoneMap);
+                zoneMap = NULL;
+                stat.numZoneMapPage = -1;
+            }
+            if (bloom != NULL && addToBloomFilter(bloom, i, &newRecord) != OK) {
+                closeBloomFilter(bloom);
+                bloom = NULL;
+                deleteBloomFilter(tableName);
+            }
+        }
+
+        /*書き換えたページは、まとめて1回だけ書き戻す*/
+        if (modified) {
+            if (writePage(file, i, page) != OK) {
+                printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+                result = NG;
+                break;
+            }
+            setPageFreeSpace(fsm, i, getPageFreeSpaceValue(page, tableInfo));
+            stat.numDeadSlot += countFreeSlots(page, tableInfo) - numFreeSlot;
+            if (countUsedSlots(page, tableInfo) == 0) {
+                if (zoneMap != NULL && clearZoneMap(zoneMap, i) != OK) {
+                    closeZoneMap(zoneMap);
+                    zoneMap = NULL;
+                    stat.numZoneMapPage = -1;
+                }
+                if (bloom != NULL && clearBloomFilter(bloom, i) != OK) {
+                    closeBloomFilter(bloom);
+                    bloom = NULL;
+                    deleteBloomFilter(tableName);
+                }
+            }
+        }
+        if (result != OK) {
+            break;
+        }
+    }
+
+    if (dict != NULL) {
+        closeDictionary(dict);
+    }
+    if (zoneMap != NULL) {
+        stat.numZoneMapPage = zoneMap->numPage;
+        closeZoneMap(zoneMap);
+    }
+    if (bloom != NULL && closeBloomFilter(bloom) != OK) {
+        deleteBloomFilter(tableName);
+    }
+    closeTableIndexes(tableName, tableInfo, indexes);
+    free(pageList);
+    freeTableInfo(tableInfo);
+
+    /*時系列テーブルのメモリ上の末尾ページは古くなったので、読み直させる*/
+    if (seriesField != -1 && numUpdated > 0) {
+        discardSeries(tableName);
+    }
+
+    stat.numRecord -= numMoved;
+    if (closeTableStat(statFile, &stat) != OK) {
+        result = NG;
+    }
+    if (closeFreeSpaceMap(fsm) != OK) {
+        result = NG;
+    }
+    if (closeFile(file) != OK) {
+        result = NG;
+    }
+
+    /*収まらなかったレコードを挿入し直す*/
+    while (moved != NULL) {
+        recordData = moved;
+        moved = moved->next;
+        if (insertRecord(tableName, recordData) != OK) {
+            result = NG;
+        }
+        free(recordData);
+    }
+    return result;
+}
+
+/*
+ * createDataFile -- データファイルの作成
+ *
+ * 引数:
+ *	tableName: 作成するテーブルの名前
+ *
+ * 返り値:
+ *	作成に成功したらOK、失敗したらNGを返す
+ */
+Result createDataFile(char *tableName)
+{
+    int len;
+    char *filename;
+
+    /*[tableName].datという文字列をつくる*/
+    len = (int)strlen(tableName) + strlen(DATA_FILE_EXT) + 1;
+    if((filename = malloc(len)) == NULL){
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    snprintf(filename, len, "%s%s", tableName, DATA_FILE_EXT);
+
+    if((createFile(filename)) == NG){
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        free(filename);
+        return NG;
+    }
+    free(filename);
+
+    /*空き領域マップファイルをつくる*/
+    if (createFreeSpaceMap(tableName) != OK) {
+        return NG;
+    }
+
+    /*
+     * 同じ名前の前のテーブルのクラッカー列やフェンスキー、ログ構造化テーブルのファイル、
+     * 時系列テーブルの索引が残っていれば捨てる
+     */
+    discardCracker(tableName);
+    discardClusterFence(tableName);
+    deleteLsmTable(tableName);
+    deleteSeriesIndex(tableName);
+    return OK;
+}
+
+/*
+ * deleteDataFile -- データファイルの削除
+ *
+ * 引数:
+ *	tableName: 削除するテーブルの名前
+ *
+ * 返り値:
+ *	削除に成功したらOK、失敗したらNGを返す
+ */
+Result deleteDataFile(char *tableName)
+{
+
+    int len;
+    char *filename;
+
+    /*[tableName].datという文字列をつくる*/
+    len = (int)strlen(tableName) + strlen(DATA_FILE_EXT) + 1;
+    if((filename = malloc(len)) == NULL){
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    snprintf(filename, len, "%s%s", tableName, DATA_FILE_EXT);
+
+    if((deleteFile(filename)) == NG){
+        printErrorMessage(ERR_MSG_UNLINK, __func__, __LINE__);
+        free(filename);
+        return NG;
+    }
+    free(filename);
+
+    /*空き領域マップファイルを削除する(古い形式のテーブルにはないこともある)*/
+    deleteFreeSpaceMap(tableName);
+
+    /*辞書ファイルを削除する(辞書圧縮するフィールドがなければ作られない)*/
+    deleteDictionary(tableName);
+
+    /*ブルームフィルタファイルを削除する(ブルームフィルタを作るフィールドがなければ作られない)*/
+    deleteBloomFilter(tableName);
+
+    /*メモリ上のクラッカー列とフェンスキーを捨てる*/
+    discardCracker(tableName);
+    discardClusterFence(tableName);
+
+    /*ログ構造化テーブルのラン、マニフェスト、ログファイルを削除する(なければ何もしない)*/
+    deleteLsmTable(tableName);
+
+    /*時系列テーブルの最初の時刻の索引を削除する(なければ何もしない)*/
+    deleteSeriesIndex(tableName);
+    return OK;
+}
+
+/*
+ * createIndex -- 索引(B+木)の作成
+ *
+ * 引数:
+ *	indexName: 作成する索引の名前
+ *	tableName: 索引を作るテーブルの名前
+ *	fieldName: 索引を作るフィールドの名前
+ *
+ * 返り値:
+ *	作成に成功したらOK、失敗したらNGを返す
+ */
+Result createIndex(char *indexName, char *tableName, char *fieldName)
+{
+    return createIndexWithType(indexName, tableName, fieldName, INDEX_BTREE);
+}
+
+/*
+ * createIndexWithType -- 種類を指定した索引の作成
+ *
+ * 引数:
+ *	indexName: 作成する索引の名前
+ *	tableName: 索引を作るテーブルの名前
+ *	fieldName: 索引を作るフィールドの名前
+ *	type: 索引の種類
+ *
+ * 返り値:
+ *	作成に成功したらOK、失敗したらNGを返す
+ *
+ * データファイルを1回読んで、すでにあるレコードをすべて索引に加える。
+ * 辞書圧縮するフィールドと、すでに索引があるフィールドには作れない。
+ */
+Result createIndexWithType(char *indexName, char *tableName, char *fieldName, IndexType type)
+{
+    TableInfo *tableInfo;
+    Index *index;
+    File *file;
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    RecordData record;
+    RecordId rid;
+    int numPage;
+    int field;
+    int i, j;
+
+    if (strlen(indexName) >= MAX_INDEX_NAME) {
+        return NG;
+    }
+
+    /* 同じ名前の索引があれば作らない */
+    if ((index = openIndex(indexName)) != NULL) {
+        closeIndex(index);
+        return NG;
+    }
+
+    /* 索引を作るフィールドを探す */
+    tableName = resolveTableName(tableName);
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        return NG;
+    }
+    for (field = 0; field < tableInfo->numField; field++) {
+        if (strcmp(tableInfo->fieldInfo[field].name, fieldName) == 0) {
+            break;
+        }
+    }
+    if (field == tableInfo->numField || IS_DICTIONARY_FIELD(tableInfo, field) || HAS_INDEX(tableInfo, field)
+        || getLsmField(tableInfo) != -1 || IS_MEMORY_TABLE(tableInfo)
+        || (type == INDEX_TRIGRAM && tableInfo->fieldInfo[field].dataType != TYPE_STRING)) {
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+
+    /* データファイルをオープンする */
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DATA_FILE_EXT);
+    if ((numPage = getNumPages(filename)) == -1 || (file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+    setFilePartition(file, tableInfo->option.partition);
+
+    /* 空の索引を作り、すべてのレコードを加える */
+    if (createIndexFile(indexName, tableName, tableInfo, field, type) != OK
+        || (index = openIndex(indexName)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return NG;
+    }
+    for (i = 0; i < numPage; i++) {
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            break;
+        }
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            rid.pageNum = i;
+            rid.slot = j;
+            if (readSlotField(page, j, tableInfo, field, &record.fieldData[field]) != OK
+                || insertIndexEntry(index, &record.fieldData[field], &rid) != OK) {
+                break;
+            }
+        }
+        if (j != -1) {
+            break;
+        }
+    }
+
+    /* 最後まで加えられたら、データ定義ファイルに記録する */
+    if (i < numPage || closeIndex(index) != OK || setTableIndex(tableName, field, indexName) != OK) {
+        if (i < numPage) {
+            closeIndex(index);
+        }
+        deleteIndexFile(indexName);
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return NG;
+    }
+
+    freeTableInfo(tableInfo);
+    return closeFile(file);
+}
+
+/*
+ * dropIndex -- 索引の削除
+ *
+ * 引数:
+ *	indexName: 削除する索引の名前
+ *
+ * 返り値:
+ *	削除に成功したらOK、失敗したらNGを返す
+ */
+Result dropIndex(char *indexName)
+{
+    TableInfo *tableInfo;
+    Index *index;
+    char tableName[MAX_FILENAME];
+    int field;
+
+    /* 索引ファイルのヘッダから、索引を作ったテーブルとフィールドを調べる */
+    if ((index = openIndex(indexName)) == NULL) {
+        return NG;
+    }
+    strcpy(tableName, index->tableName);
+    field = index->field;
+    closeIndex(index);
+
+    /* テーブルのデータ定義ファイルから取り除いてから、索引ファイルを削除する */
+    if ((tableInfo = getTableInfo(tableName)) != NULL) {
+        if (field < tableInfo->numField && strcmp(tableInfo->option.index[field], indexName) == 0
+            && setTableIndex(tableName, field, "") != OK) {
+            freeTableInfo(tableInfo);
+            return NG;
+        }
+        freeTableInfo(tableInfo);
+    }
+    return deleteIndexFile(indexName);
+}
+
+/*
+ * clusterTable -- テーブルのレコードをキーの順に並べ直す
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	fieldName: キーにするフィールドの名前(NULLなら、今のクラスタ化テーブルのキー)
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * すべてのレコードのキーと位置を読んで1回だけ並べ替え、その順にレコードを
+ * 新しいデータファイルのページに詰めていく。その後は、テーブルはそのキーの
+ * クラスタ化テーブルになる(clustered byを指定して作ったのと同じ)。
+ * レコードの位置がすべて変わるので、索引は作り直し、空き領域マップ、統計情報、
+ * ゾーンマップ、ブルームフィルタもデータファイルを読んで作り直す。
+ * キーにできるのは整数型か辞書圧縮しない文字列型のフィールドで、
+ * ビット詰めするフィールドは詰めないで格納し直す。
+ */
+Result clusterTable(char *tableName, char *fieldName)
+{
+    TableInfo *tableInfo;
+    TableInfo newInfo;
+    ClusterEntry *entries = NULL;
+    ClusterEntry *grown;
+    int numEntry = 0;
+    int maxEntry = 0;
+    File *file;
+    File *newFile;
+    File *statFile;
+    FreeSpaceMap *fsm;
+    ZoneMap *zoneMap;
+    BloomFilter *bloom;
+    TableStat stat;
+    char filename[MAX_FILENAME];
+    char newFilename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    char newPage[PAGE_SIZE];
+    char indexNames[MAX_FIELD][MAX_INDEX_NAME];
+    IndexType indexTypes[MAX_FIELD];
+    Index *index;
+    RecordData record;
+    int numPage;
+    int newNumPage;
+    int currentPage;
+    int field;
+    int i, j;
+
+    /* キーのフィールドを決める */
+    tableName = resolveTableName(tableName);
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        return NG;
+    }
+    if (fieldName == NULL) {
+        field = getClusterField(tableInfo);
+    } else {
+        for (field = 0; field < tableInfo->numField; field++) {
+            if (strcmp(tableInfo->fieldInfo[field].name, fieldName) == 0) {
+                break;
+            }
+        }
+    }
+    if (field == -1 || field == tableInfo->numField || IS_DICTIONARY_FIELD(tableInfo, field)
+        || getLsmField(tableInfo) != -1 || getSeriesField(tableInfo) != -1 || IS_MEMORY_TABLE(tableInfo)
+        || (tableInfo->fieldInfo[field].dataType != TYPE_INTEGER
+            && tableInfo->fieldInfo[field].dataType != TYPE_STRING)) {
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+    newInfo = *tableInfo;
+    memset(newInfo.option.cluster, 0, sizeof(newInfo.option.cluster));
+    memset(newInfo.option.packBits, 0, sizeof(newInfo.option.packBits));
+    newInfo.option.cluster[field] = 1;
+
+    /* すべてのレコードのキーと位置を読み、キーの順に並べる */
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DATA_FILE_EXT);
+    if ((numPage = getNumPages(filename)) == -1 || (file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+    setFilePartition(file, tableInfo->option.partition);
+    for (i = 0; i < numPage; i++) {
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            break;
+        }
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            if (numEntry == maxEntry) {
+                maxEntry = maxEntry == 0 ? 1024 : maxEntry * 2;
+                if ((grown = (ClusterEntry *) realloc(entries, maxEntry * sizeof(ClusterEntry))) == NULL) {
+                    printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+                    break;
+                }
+                entries = grown;
+            }
+            if (readClusterEntry(page, i, j, tableInfo, field, &entries[numEntry]) != OK) {
+                break;
+            }
+            numEntry++;
+        }
+        if (j != -1) {
+            break;
+        }
+    }
+    if (i < numPage) {
+        freeClusterEntries(entries, numEntry);
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return NG;
+    }
+    if (numEntry > 0) {
+        qsort(entries, numEntry, sizeof(ClusterEntry), compareClusterEntry);
+    }
+
+    /* その順に、新しいデータファイルのページに詰めていく */
+    snprintf(newFilename, MAX_FILENAME, "%s%s", tableName, CLUSTER_FILE_EXT);
+    if (getNumPages(newFilename) != -1) {
+        deleteFile(newFilename);
+    }
+    if (createFile(newFilename) != OK || (newFile = openFile(newFilename)) == NULL) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        freeClusterEntries(entries, numEntry);
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return NG;
+    }
+    setFilePartition(newFile, tableInfo->option.partition);
+    initializePage(newPage, &newInfo);
+    newNumPage = 0;
+    currentPage = -1;
+    for (i = 0; i < numEntry; i++) {
+        if (entries[i].rid.pageNum != currentPage) {
+            currentPage = entries[i].rid.pageNum;
+            if (readPage(file, currentPage, page) != OK) {
+                printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+                break;
+            }
+        }
+        readSlot(page, entries[i].rid.slot, tableInfo, &record);
+        if (insertIntoPage(newPage, &newInfo, &record) != -1) {
+            continue;
+        }
+        if (writePage(newFile, newNumPage, newPage) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            break;
+        }
+        newNumPage++;
+        initializePage(newPage, &newInfo);
+        if (insertIntoPage(newPage, &newInfo, &record) == -1) {
+            break;
+        }
+    }
+    if (i < numEntry || (numEntry > 0 && writePage(newFile, newNumPage, newPage) != OK)) {
+        freeClusterEntries(entries, numEntry);
+        freeTableInfo(tableInfo);
+        closeFile(newFile);
+        deleteFile(newFilename);
+        closeFile(file);
+        return NG;
+    }
+    freeClusterEntries(entries, numEntry);
+    closeFile(newFile);
+    closeFile(file);
+
+    /* 索引の名前と種類を覚えておく(位置が変わるので作り直す) */
+    for (i = 0; i < tableInfo->numField; i++) {
+        indexNames[i][0] = '\0';
+        if (HAS_INDEX(tableInfo, i) && (index = openIndex(tableInfo->option.index[i])) != NULL) {
+            strcpy(indexNames[i], tableInfo->option.index[i]);
+            indexTypes[i] = index->type;
+            closeIndex(index);
+        }
+    }
+
+    /* 新しいデータファイルに置き換え、キーを記録する */
+    if (deleteFile(filename) != OK || rename(newFilename, filename) != 0) {
+        printErrorMessage(ERR_MSG_UNLINK, __func__, __LINE__);
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+    if (setTableCluster(tableName, field) != OK) {
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+    discardCracker(tableName);
+    discardClusterFence(tableName);
+
+    /* 空き領域マップ、統計情報、ゾーンマップ、ブルームフィルタを作り直す */
+    deleteFreeSpaceMap(tableName);
+    deleteBloomFilter(tableName);
+    if ((statFile = openTableStat(tableName, &stat)) != NULL) {
+        stat.numPage = -1;
+        stat.numZoneMapPage = -1;
+        closeTableStat(statFile, &stat);
+    }
+    if ((numPage = getNumPages(filename)) == -1 || (file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+    setFilePartition(file, newInfo.option.partition);
+    if ((fsm = openTableFreeSpaceMap(tableName, file, numPage, &newInfo)) != NULL) {
+        closeFreeSpaceMap(fsm);
+    }
+    if ((statFile = loadTableStat(tableName, file, numPage, &newInfo, &stat)) != NULL) {
+        if ((zoneMap = openTableZoneMap(file, numPage, &newInfo, statFile, &stat)) != NULL) {
+            stat.numZoneMapPage = zoneMap->numPage;
+            closeZoneMap(zoneMap);
+        }
+        closeTableStat(statFile, &stat);
+    }
+    if (hasBloomField(&newInfo) && (bloom = openTableBloomFilter(tableName, file, numPage, &newInfo)) != NULL) {
+        closeBloomFilter(bloom);
+    }
+    closeFile(file);
+
+    /* 索引を作り直す */
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (indexNames[i][0] != '\0'
+            && (dropIndex(indexNames[i]) != OK
+                || createIndexWithType(indexNames[i], tableName, tableInfo->fieldInfo[i].name, indexTypes[i]) != OK)) {
+            freeTableInfo(tableInfo);
+            return NG;
+        }
     }
+
+    freeTableInfo(tableInfo);
     return OK;
 }
 
-
 /*
- * freeRecordSet -- レコード集合の情報を収めたメモリ領域の解放
+ * truncateSeriesTable -- 時系列テーブルの古いレコードを捨てる
  *
  * 引数:
- *	recordSet: 解放するメモリ領域
+ *	tableName: テーブルの名前
+ *	before: この時刻より前のレコードを捨てる
  *
  * 返り値:
- *	なし
+ *	成功ならOK、失敗(時系列テーブルでない場合を含む)ならNGを返す
  *
- * ***注意***
- *	関数selectRecordが返すレコードの集合を収めたメモリ領域は、
- *	不要になったら必ずこの関数で解放すること。
+ * 先頭からSERIES_EXTENT_PAGESページずつのエクステントのうち、すべてのレコードが
+ * beforeより前のものだけを捨てる(beforeより前のレコードが少し残ることがある)。
+ * 捨てたページはデータファイルから解放するが、ほかのページの番号は変わらないので、
+ * 残ったレコードの位置と索引はそのまま使える。捨てたレコードは索引から取り除く。
  */
-void freeRecordSet(RecordSet *recordSet)
+Result truncateSeriesTable(char *tableName, int before)
 {
-    RecordData *p, *n;
-    p = recordSet ->recordData;
+    TableInfo *tableInfo;
+    File *file;
+    File *statFile;
+    FreeSpaceMap *fsm;
+    TableStat stat;
+    Index *indexes[MAX_FIELD];
+    RecordData record;
+    RecordId rid;
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    char emptyPage[PAGE_SIZE];
+    int numPage;
+    int firstPage;
+    int endPage;
+    int i, j;
 
-    while(p != NULL){
-        n = p->next;
-        free(p);
-        p = n;
+    tableName = resolveTableName(tableName);
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        return NG;
+    }
+    if (getSeriesField(tableInfo) == -1) {
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DATA_FILE_EXT);
+    if ((numPage = getNumPages(filename)) == -1 || (file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        freeTableInfo(tableInfo);
+        return NG;
     }
+    setFilePartition(file, tableInfo->option.partition);
 
-    free(recordSet);
+    /* 捨てるページの範囲[firstPage, endPage)を求める */
+    if ((endPage = findSeriesExtents(tableName, file, numPage, tableInfo, before, &firstPage)) == -1) {
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return NG;
+    }
+    if (endPage == firstPage) {
+        freeTableInfo(tableInfo);
+        return closeFile(file);
+    }
+    if ((fsm = openTableFreeSpaceMap(tableName, file, numPage, tableInfo)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return NG;
+    }
+    if ((statFile = loadTableStat(tableName, file, numPage, tableInfo, &stat)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
+
+    /* 捨てるレコードを索引から取り除き、統計情報と空き領域マップを捨てた後の値にする */
+    memset(emptyPage, 0, PAGE_SIZE);
+    openTableIndexes(tableInfo, indexes);
+    for (i = firstPage; i < endPage; i++) {
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            break;
+        }
+        rid.pageNum = i;
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            readSlot(page, j, tableInfo, &record);
+            rid.slot = j;
+            updateTableIndexes(tableInfo, indexes, &record, &rid, 0);
+        }
+        stat.numRecord -= countUsedSlots(page, tableInfo);
+        stat.numDeadSlot += countFreeSlots(emptyPage, tableInfo) - countFreeSlots(page, tableInfo);
+        setPageFreeSpace(fsm, i, getPageFreeSpaceValue(emptyPage, tableInfo));
+    }
+    closeTableIndexes(tableName, tableInfo, indexes);
+    if (i < endPage) {
+        freeTableInfo(tableInfo);
+        closeTableStat(statFile, NULL);
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
+
+    /* ページを解放し、最初の有効なページを記録する(クラッカー列は作り直す) */
+    if (discardPages(file, firstPage, endPage - firstPage) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        freeTableInfo(tableInfo);
+        closeTableStat(statFile, NULL);
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
+    discardCracker(tableName);
+    if (setSeriesFirstPage(tableName, endPage) != OK) {
+        deleteSeriesIndex(tableName);
+    }
 
+    freeTableInfo(tableInfo);
+    if (closeTableStat(statFile, &stat) != OK) {
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return NG;
+    }
+    if (closeFreeSpaceMap(fsm) != OK) {
+        closeFile(file);
+        return NG;
+    }
+    return closeFile(file);
 }
 
 /*
- * deleteRecord -- レコードの削除
+ * vacuumTable -- 削除で空いた領域の回収
  *
  * 引数:
- *	tableName: レコードを削除するテーブルの名前
- *	condition: 削除するレコードの条件
+ *	tableName: テーブルの名前
+ *	maxPage: 1回の呼び出しで調べる末尾のページ数の上限(0なら上限なし)
  *
  * 返り値:
- *	削除に成功したらOK、失敗したらNGを返す
+ *	まだ回収できる領域が残っているかもしれなければ1、回収し終わったら0、
+ *	失敗したら-1を返す
+ *
+ * データファイルの末尾のページから順に、レコードを空き領域マップで見つけた前の方の
+ * ページの空きに移し、空になった末尾のページを切り詰める。前の方のページに空きが
+ * なくなったら終わる。maxPageを指定すると、そのページ数を調べたところで返るので、
+ * 繰り返し呼び出せば、間にほかの検索や更新をはさみながら少しずつ回収できる。
+ * どの呼び出しの後でも、空き領域マップ、統計情報、ゾーンマップ、ブルームフィルタ、
+ * 索引はデータファイルと食い違わない(移したレコードの位置は索引で付け替え、
+ * クラッカー列は捨てて作り直させる)。
+ * ログ構造化テーブルはcompactLsmTableで、クラスタ化テーブルはclusterTableで
+ * 1回で詰め直す。時系列テーブル(古いページはtruncateSeriesTableで捨てる)と
+ * インメモリテーブルには回収する領域はない。
  */
-Result deleteRecord(char *tableName, Condition *condition)
+int vacuumTable(char *tableName, int maxPage)
 {
-    int len;
-    int recordSize;
-    int numPage;
-    int i, j, k;
-    File *file;
     TableInfo *tableInfo;
-    char *filename;
+    File *file;
+    File *statFile;
+    FreeSpaceMap *fsm;
+    ZoneMap *zoneMap;
+    BloomFilter *bloom = NULL;
+    TableStat stat;
+    Index *indexes[MAX_FIELD];
+    RecordData record;
+    RecordId rid;
+    RecordId newRid;
+    char filename[MAX_FILENAME];
     char page[PAGE_SIZE];
-    int delcatch = 0;
+    char target[PAGE_SIZE];
+    int numPage;
+    int newNumPage;
+    int numChecked = 0;
+    int numMoved = 0;
+    int numFreeSlot;
+    int targetFreeSlot;
+    int required;
+    int result = 1;
+    int j;
 
+    if (isMemoryTable(tableName)) {
+        return 0;
+    }
+    tableName = resolveTableName(tableName);
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        return -1;
+    }
 
-    /*[tableName].datという文字列をつくる*/
-    len = strlen(tableName) + strlen(DATA_FILE_EXT) + 1;
-    if((filename = malloc(len)) == NULL){
-        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
-        return NG;
+    /* ページを並べ直すテーブルは、それぞれの方法で1回で詰め直す */
+    if (getSeriesField(tableInfo) != -1) {
+        freeTableInfo(tableInfo);
+        return 0;
+    }
+    if (getLsmField(tableInfo) != -1) {
+        freeTableInfo(tableInfo);
+        return compactLsmTable(tableName) == OK ? 0 : -1;
+    }
+    if (getClusterField(tableInfo) != -1) {
+        freeTableInfo(tableInfo);
+        return clusterTable(tableName, NULL) == OK ? 0 : -1;
     }
-    snprintf(filename, len, "%s%s", tableName, DATA_FILE_EXT);
 
-    if((file=openFile(filename)) == NULL){
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DATA_FILE_EXT);
+    if ((numPage = getNumPages(filename)) == -1 || (file = openFile(filename)) == NULL) {
         printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
-        free(filename);
-        return NG;
+        freeTableInfo(tableInfo);
+        return -1;
     }
+    setFilePartition(file, tableInfo->option.partition);
+    if ((fsm = openTableFreeSpaceMap(tableName, file, numPage, tableInfo)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return -1;
+    }
+    if ((statFile = loadTableStat(tableName, file, numPage, tableInfo, &stat)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFreeSpaceMap(fsm);
+        closeFile(file);
+        return -1;
+    }
+    zoneMap = openTableZoneMap(file, numPage, tableInfo, statFile, &stat);
+    if (hasBloomField(tableInfo) && (bloom = openTableBloomFilter(tableName, file, numPage, tableInfo)) == NULL) {
+        deleteBloomFilter(tableName);
+    }
+    openTableIndexes(tableInfo, indexes);
 
-    /*ページ数、tableInfo、レコードのサイズを取得*/
-    numPage = getNumPages(filename);
-    tableInfo = getTableInfo(tableName);
-    recordSize = getRecordSize(tableInfo);
-
-
-    free(filename);
-
-    /*レコードを一つずつ取り出し、条件を満足するかどうかチェックする*/
-    for (i=0; i<numPage; i++){
-        /*1ページぶんのデータを読み込む*/
-        if (readPage(file, i, page) != OK){
-            closeFile(file);
+    /* 末尾のページのレコードを、前の方のページの空きに移していく */
+    newNumPage = numPage;
+    while (result == 1 && newNumPage > 0 && (maxPage <= 0 || numChecked < maxPage)) {
+        rid.pageNum = newNumPage - 1;
+        if (readPage(file, rid.pageNum, page) != OK) {
             printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
-            return NG;
+            result = -1;
+            break;
         }
+        numChecked++;
+        numFreeSlot = countFreeSlots(page, tableInfo);
 
-        /*pageの先頭からrecord_sizeバイトずつ切り取って処理する*/
-        for (j=0; j<(PAGE_SIZE/recordSize); j++){
-            RecordData *recordData;
-            char *p;
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            readSlot(page, j, tableInfo, &record);
+            required = getRequiredFreeSpaceValue(tableInfo, &record);
 
-            /*先頭フラグが0なら読み飛ばす*/
-            p = &page[recordSize * j];
-            if(*p == 0){
-                continue;
+            /* 移す先のページを探す(空き領域マップが実際と食い違っていたら直して探し直す) */
+            for (;;) {
+                if ((newRid.pageNum = findFreePage(fsm, required)) == -1 || newRid.pageNum >= rid.pageNum) {
+                    newRid.pageNum = -1;
+                    break;
+                }
+                if (readPage(file, newRid.pageNum, target) != OK) {
+                    printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+                    result = -1;
+                    break;
+                }
+                targetFreeSlot = countFreeSlots(target, tableInfo);
+                if ((newRid.slot = insertIntoPage(target, tableInfo, &record)) != -1) {
+                    break;
+                }
+                /* ビット詰めするフィールドの値が収まらなかったら、このレコードは移さない */
+                if (getPageFreeSpaceValue(target, tableInfo) >= required) {
+                    newRid.pageNum = -1;
+                    break;
+                }
+                setPageFreeSpace(fsm, newRid.pageNum, getPageFreeSpaceValue(target, tableInfo));
             }
-
-            /*RecordData構造体のためのメモリを確保する*/
-            if((recordData = (RecordData *)malloc(sizeof(RecordData))) == NULL){
-                closeFile(file);
-                printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
-                return NG;
+            if (result == -1) {
+                break;
             }
-
-            /*フラグぶんだけポインタを進める*/
-            p++;
-
-
-            /*レコードのデータをRecordDataへ*/
-            recordData -> numField = tableInfo -> numField;
-            recordData -> next = NULL;
-            for(k=0; k < (tableInfo -> numField); k++){
-                strcpy(recordData->fieldData[k].name, tableInfo->fieldInfo[k].name);
-                recordData -> fieldData[k].dataType = tableInfo -> fieldInfo[k].dataType;
-                switch (tableInfo -> fieldInfo[k].dataType){
-                    case TYPE_INTEGER:
-                        memcpy(&(recordData -> fieldData[k].intValue), p, sizeof(int));
-                        p += sizeof(int);
-                        break;
-                    case TYPE_STRING:
-                        memcpy(&(recordData -> fieldData[k].stringValue), p, MAX_STRING);
-                        p += MAX_STRING;
-                        break;
-                    default:
-                        /*ここには来ない*/
-                        freeTableInfo(tableInfo);
-                        closeFile(file);
-                        free(recordData);
-                        return NG;
-                }
+            if (newRid.pageNum == -1) {
+                /* 前の方のページに移せなくなったら終わり */
+                result = 0;
+                break;
             }
 
-            /*条件を満たしたレコードを削除*/
-            if(checkCondition(recordData, condition) == OK){
-                page[recordSize * j] = 0;
-                delcatch = 1;
+            if (writePage(file, newRid.pageNum, target) != OK) {
+                printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+                result = -1;
+                break;
+            }
+            setPageFreeSpace(fsm, newRid.pageNum, getPageFreeSpaceValue(target, tableInfo));
+            stat.numDeadSlot += countFreeSlots(target, tableInfo) - targetFreeSlot;
+            if (zoneMap != NULL && addToZoneMap(zoneMap, newRid.pageNum, &record) != OK) {
+                closeZoneMap(zoneMap);
+                zoneMap = NULL;
+                stat.numZoneMapPage = -1;
             }
-            free(recordData);
+            if (bloom != NULL && addToBloomFilter(bloom, newRid.pageNum, &record) != OK) {
+                closeBloomFilter(bloom);
+                bloom = NULL;
+                deleteBloomFilter(tableName);
+            }
+
+            /* 索引のレコードの位置を付け替えてから、元の位置のレコードを削除する */
+            rid.slot = j;
+            updateTableIndexes(tableInfo, indexes, &record, &rid, 0);
+            updateTableIndexes(tableInfo, indexes, &record, &newRid, 1);
+            deleteFromPage(page, j, tableInfo);
+            numMoved++;
         }
 
-        /*delcatchの値が1の場合、ページの内容を書き戻す*/
-        if(delcatch == 1){
-            if(writePage(file, i, page) != OK){
-                closeFile(file);
+        if (countUsedSlots(page, tableInfo) == 0) {
+            /* 空になった末尾のページは切り詰める(後で追加するときのため、ゾーンマップなどは空にしておく) */
+            stat.numDeadSlot -= numFreeSlot;
+            if (zoneMap != NULL && clearZoneMap(zoneMap, rid.pageNum) != OK) {
+                closeZoneMap(zoneMap);
+                zoneMap = NULL;
+                stat.numZoneMapPage = -1;
+            }
+            if (bloom != NULL && clearBloomFilter(bloom, rid.pageNum) != OK) {
+                closeBloomFilter(bloom);
+                bloom = NULL;
+                deleteBloomFilter(tableName);
+            }
+            newNumPage--;
+        } else if (countFreeSlots(page, tableInfo) != numFreeSlot) {
+            /* 一部のレコードだけを移したページは書き戻す */
+            if (writePage(file, rid.pageNum, page) != OK) {
                 printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
-                return NG;
+                result = -1;
+                break;
             }
+            setPageFreeSpace(fsm, rid.pageNum, getPageFreeSpaceValue(page, tableInfo));
+            stat.numDeadSlot += countFreeSlots(page, tableInfo) - numFreeSlot;
         }
     }
-
-    /*ファイルを閉じる*/
-    if((closeFile(file)) != OK){
-        return NG;
+    if (newNumPage == 0 && result == 1) {
+        result = 0;
     }
-    return OK;
-}
-
-/*
- * createDataFile -- データファイルの作成
- *
- * 引数:
- *	tableName: 作成するテーブルの名前
- *
- * 返り値:
- *	作成に成功したらOK、失敗したらNGを返す
- */
-Result createDataFile(char *tableName)
-{
-    int len;
-    char *filename;
 
-    /*[tableName].datという文字列をつくる*/
-    len = (int)strlen(tableName) + strlen(DATA_FILE_EXT) + 1;
-    if((filename = malloc(len)) == NULL){
-        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
-        return NG;
+    /* 空になったページを切り詰め、データファイルのページ数を記録し直す */
+    if (newNumPage < numPage) {
+        if (truncatePages(file, newNumPage) == OK) {
+            truncateFreeSpaceMap(fsm, newNumPage);
+            if (zoneMap != NULL) {
+                truncateZoneMap(zoneMap, newNumPage);
+            }
+            if (bloom != NULL) {
+                truncateBloomFilter(bloom, newNumPage);
+            }
+            stat.numPage = newNumPage;
+            if (stat.lastInsertPage >= newNumPage) {
+                stat.lastInsertPage = -1;
+            }
+        } else {
+            /* 切り詰められなかったページは空のページとして残る */
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            for (j = newNumPage; j < numPage; j++) {
+                initializePage(page, tableInfo);
+                writePage(file, j, page);
+                setPageFreeSpace(fsm, j, getPageFreeSpaceValue(page, tableInfo));
+                stat.numDeadSlot += countFreeSlots(page, tableInfo);
+            }
+            result = -1;
+        }
+    }
+    if (numMoved > 0) {
+        discardCracker(tableName);
     }
-    snprintf(filename, len, "%s%s", tableName, DATA_FILE_EXT);
 
-    if((createFile(filename)) == NG){
-        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
-        return NG;
+    closeTableIndexes(tableName, tableInfo, indexes);
+    if (zoneMap != NULL) {
+        stat.numZoneMapPage = zoneMap->numPage;
+        closeZoneMap(zoneMap);
     }
-    return OK;
+    if (bloom != NULL && closeBloomFilter(bloom) != OK) {
+        deleteBloomFilter(tableName);
+    }
+    freeTableInfo(tableInfo);
+    if (closeTableStat(statFile, &stat) != OK) {
+        result = -1;
+    }
+    if (closeFreeSpaceMap(fsm) != OK) {
+        result = -1;
+    }
+    if (closeFile(file) != OK) {
+        result = -1;
+    }
+    return result;
 }
 
 /*
- * deleteDataFile -- データファイルの削除
- *
- * 引数:
- *	tableName: 削除するテーブルの名前
- *
- * 返り値:
- *	削除に成功したらOK、失敗したらNGを返す
+ * printRecordFields -- 1レコード分のデータの表示
  */
-Result deleteDataFile(char *tableName)
+static void printRecordFields(RecordData *recordData)
 {
+    int k;
 
-    int len;
-    char *filename;
+    for (k = 0; k < recordData->numField; k++) {
+        printf("Field %s = ", recordData->fieldData[k].name);
 
-    /*[tableName].datという文字列をつくる*/
-    len = (int)strlen(tableName) + strlen(DATA_FILE_EXT) + 1;
-    if((filename = malloc(len)) == NULL){
-        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
-        return NG;
+        switch (recordData->fieldData[k].dataType) {
+            case TYPE_INTEGER:
+                printf("%d\n", recordData->fieldData[k].intValue);
+                break;
+            case TYPE_STRING:
+                printf("%s\n", recordData->fieldData[k].stringValue);
+                break;
+            default:
+                /* ここに来ることはないはず */
+                break;
+        }
     }
-    snprintf(filename, len, "%s%s", tableName, DATA_FILE_EXT);
 
-    if((deleteFile(filename)) == NG){
-        printErrorMessage(ERR_MSG_UNLINK, __func__, __LINE__);
-        return NG;
-    }
-    return OK;
+    printf("\n");
 }
 
 /*
@@ -780,86 +3491,95 @@ void printTableData(char *tableName)
 {
     TableInfo *tableInfo;
     File *file;
-    int len;
-    int i, j, k;
-    int recordSize;
+    int i, j;
     int numPage;
-    char *filename;
+    char filename[MAX_FILENAME];
     char page[PAGE_SIZE];
+    RecordData recordData;
+    RecordData *list;
+    RecordData *next;
+    QueryStat stat;
+    Dictionary *dict;
 
     /* テーブルのデータ定義情報を取得する */
+    tableName = resolveTableName(tableName);
     if ((tableInfo = getTableInfo(tableName)) == NULL) {
         return;
     }
 
-    /* 1レコード分のデータをファイルに収めるのに必要なバイト数を計算する */
-    recordSize = getRecordSize(tableInfo);
+    /* インメモリテーブルなら、メモリ上の配列のすべてのレコードを出力する */
+    if (IS_MEMORY_TABLE(tableInfo)) {
+        if (searchMemoryTable(tableName, NULL, &stat, &list) == OK) {
+            for (; list != NULL; list = next) {
+                next = list->next;
+                printRecordFields(list);
+                free(list);
+            }
+        }
+        freeTableInfo(tableInfo);
+        return;
+    }
 
-    /* データファイルのファイル名を保存するメモリ領域の確保 */
-    len = strlen(tableName) + strlen(DATA_FILE_EXT) + 1;
-    if ((filename = malloc(len)) == NULL) {
+    /* ログ構造化テーブルなら、メムテーブルとランのすべてのレコードをキーの順に出力する */
+    if (getLsmField(tableInfo) != -1) {
+        if (searchLsmTable(tableName, tableInfo, NULL, &stat, &list) == OK) {
+            for (; list != NULL; list = next) {
+                next = list->next;
+                printRecordFields(list);
+                free(list);
+            }
+        }
         freeTableInfo(tableInfo);
         return;
     }
 
     /* ファイル名の作成 */
-    snprintf(filename, len, "%s%s", tableName, DATA_FILE_EXT);
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DATA_FILE_EXT);
 
     /* データファイルのページ数を求める */
     numPage = getNumPages(filename);
 
     /* データファイルをオープンする */
     if ((file = openFile(filename)) == NULL) {
-        free(filename);
         freeTableInfo(tableInfo);
         return;
     }
+    setFilePartition(file, tableInfo->option.partition);
 
-    free(filename);
+    /* 辞書圧縮するフィールドがあれば辞書を読み込む */
+    dict = NULL;
+    if (hasDictionaryField(tableInfo) && (dict = openDictionary(tableName)) == NULL) {
+        freeTableInfo(tableInfo);
+        closeFile(file);
+        return;
+    }
 
     /* レコードを1つずつ取りだし、表示する */
     for (i = 0; i < numPage; i++) {
         /* 1ページ分のデータを読み込む */
-        readPage(file, i, page);
+        if (readPage(file, i, page) != OK) {
+            break;
+        }
 
-        /* pageの先頭からrecord_sizeバイトずつ切り取って処理する */
-        for (j = 0; j < (PAGE_SIZE / recordSize); j++) {
-            /* 先頭の「使用中」のフラグが0だったら読み飛ばす */
-            char *p = &page[recordSize * j];
-            if (*p == 0) {
+        /* 使用中のスロットを1つずつ処理する */
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            if (readSlot(page, j, tableInfo, &recordData) != OK) {
                 continue;
             }
-
-            /* フラグの分だけポインタを進める */
-            p++;
-
-            /* 1レコード分のデータを出力する */
-            for (k = 0; k < tableInfo->numField; k++) {
-                int intValue;
-                char stringValue[MAX_STRING];
-
-                printf("Field %s = ", tableInfo->fieldInfo[k].name);
-
-                switch (tableInfo->fieldInfo[k].dataType) {
-                    case TYPE_INTEGER:
-                        memcpy(&intValue, p, sizeof(int));
-                        p += sizeof(int);
-                        printf("%d\n", intValue);
-                        break;
-                    case TYPE_STRING:
-                        memcpy(stringValue, p, MAX_STRING);
-                        p += MAX_STRING;
-                        printf("%s\n", stringValue);
-                        break;
-                    default:
-                        /* ここに来ることはないはず */
-                        return;
-                }
+            if (dict != NULL) {
+                decodeDictionaryFields(dict, tableInfo, &recordData);
             }
 
-            printf("\n");
+            /* 1レコード分のデータを出力する */
+            printRecordFields(&recordData);
         }
     }
+
+    if (dict != NULL) {
+        closeDictionary(dict);
+    }
+    freeTableInfo(tableInfo);
+    closeFile(file);
 }
 
 /*
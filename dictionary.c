@@ -0,0 +1,490 @@
+/*
+ * dictionary.c -- 文字列辞書モジュール
+ *
+ * 辞書圧縮を指定した文字列型のフィールド(TableOptionのdictionary)について、
+ * 値ごとに整数のコードを割り当て、レコードにはコードだけを格納する。
+ * 値とコードの対応は辞書ファイル(ファイル名: tableName.dic)に記録し、
+ * 新しい値が挿入されるたびに末尾に追加していく。コードは辞書ファイルの中での
+ * 項目の番号(すべてのフィールドで通し番号)なので、コードから値はすぐに引ける。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * DICTIONARY_FILE_EXT -- 辞書ファイルの拡張子
+ */
+#define DICTIONARY_FILE_EXT ".dic"
+
+/*
+ * DICTIONARY_MAGIC -- 辞書ファイルであることを示す値
+ */
+#define DICTIONARY_MAGIC 0x64696331
+
+/*
+ * DICTIONARY_HASH_SIZE -- 値からコードを引くためのハッシュ表の大きさ
+ */
+#define DICTIONARY_HASH_SIZE 1024
+
+/*
+ * DICTIONARY_PAGE_HEADER_SIZE -- 項目を記録するページの先頭の、項目数を記録する領域の大きさ
+ */
+#define DICTIONARY_PAGE_HEADER_SIZE 2
+
+/*
+ * 辞書ファイルの構造
+ *
+ * 0ページ目(ヘッダ):
+ *   +-------------------+-------------------+--------------------+
+ *   |DICTIONARY_MAGIC   |項目数             |項目を記録したページ数|
+ *   |(sizeof(int)バイト)|(sizeof(int)バイト)|(sizeof(int)バイト) |
+ *   +-------------------+-------------------+--------------------+
+ * 1ページ目以降:
+ *   +----------+----------+--------+--------+----------+----
+ *   |ページ内の|フィールド|値の長さ|値      |フィールド|
+ *   |項目数    |の番号    |        |        |の番号    | ...
+ *   |(2バイト) |(1バイト) |(1バイト)|(長さ分)|          |
+ *   +----------+----------+--------+--------+----------+----
+ *   項目を番号の順に詰めて並べる。1つの項目が2つのページにまたがることはない。
+ */
+
+/*
+ * makeDictionaryFileName -- 辞書ファイルのファイル名を作る
+ */
+static void makeDictionaryFileName(char *filename, char *tableName)
+{
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, DICTIONARY_FILE_EXT);
+}
+
+/*
+ * hashDictionaryValue -- フィールドの番号と値のハッシュ値
+ */
+static unsigned int hashDictionaryValue(int field, char *value)
+{
+    unsigned int h = 2166136261u + field;
+
+    while (*value != '\0') {
+        h = (h ^ (unsigned char) *value++) * 16777619u;
+    }
+    return h % DICTIONARY_HASH_SIZE;
+}
+
+/*
+ * growArray -- 配列をnewCapacity個の要素の大きさに広げる
+ */
+static void *growArray(void *array, int newCapacity, size_t size)
+{
+    void *newArray;
+
+    if ((newArray = realloc(array, newCapacity * size)) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+    }
+    return newArray;
+}
+
+/*
+ * addEntry -- メモリ上の辞書に項目を追加する
+ */
+static Result addEntry(Dictionary *dict, int field, char *value, int len)
+{
+    int newCapacity;
+    char *newPool;
+    int *p;
+    unsigned int h;
+
+    /* 項目ごとの配列が足りなければ2倍に広げる */
+    if (dict->numEntry == dict->capacity) {
+        newCapacity = dict->capacity == 0 ? 64 : dict->capacity * 2;
+        if ((p = growArray(dict->field, newCapacity, sizeof(int))) == NULL) {
+            return NG;
+        }
+        dict->field = p;
+        if ((p = growArray(dict->offset, newCapacity, sizeof(int))) == NULL) {
+            return NG;
+        }
+        dict->offset = p;
+        if ((p = growArray(dict->next, newCapacity, sizeof(int))) == NULL) {
+            return NG;
+        }
+        dict->next = p;
+        dict->capacity = newCapacity;
+    }
+
+    /* 値を収める領域が足りなければ広げる */
+    if (dict->poolUsed + len + 1 > dict->poolSize) {
+        newCapacity = dict->poolSize == 0 ? PAGE_SIZE : dict->poolSize * 2;
+        while (dict->poolUsed + len + 1 > newCapacity) {
+            newCapacity *= 2;
+        }
+        if ((newPool = growArray(dict->pool, newCapacity, 1)) == NULL) {
+            return NG;
+        }
+        dict->pool = newPool;
+        dict->poolSize = newCapacity;
+    }
+
+    dict->field[dict->numEntry] = field;
+    dict->offset[dict->numEntry] = dict->poolUsed;
+    memcpy(dict->pool + dict->poolUsed, value, len);
+    dict->pool[dict->poolUsed + len] = '\0';
+    dict->poolUsed += len + 1;
+
+    h = hashDictionaryValue(field, dict->pool + dict->offset[dict->numEntry]);
+    dict->next[dict->numEntry] = dict->bucket[h];
+    dict->bucket[h] = dict->numEntry;
+    dict->numEntry++;
+    return OK;
+}
+
+/*
+ * freeDictionary -- 辞書ファイルをクローズし、メモリ上の辞書を解放する
+ */
+static Result freeDictionary(Dictionary *dict)
+{
+    Result result;
+
+    result = closeFile(dict->file);
+    free(dict->field);
+    free(dict->offset);
+    free(dict->next);
+    free(dict->bucket);
+    free(dict->pool);
+    free(dict);
+    return result;
+}
+
+/*
+ * deleteDictionary -- 辞書ファイルの削除
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result deleteDictionary(char *tableName)
+{
+    char filename[MAX_FILENAME];
+
+    makeDictionaryFileName(filename, tableName);
+    return deleteFile(filename);
+}
+
+/*
+ * openDictionary -- 辞書のオープン
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *
+ * 返り値:
+ *	オープンした辞書。辞書ファイルがなければ空の辞書を作って返す。
+ *	エラーの場合はNULLを返す
+ *
+ * 辞書ファイルのすべての項目をメモリに読み込む。
+ *
+ * ***注意***
+ *	使い終わったら必ずcloseDictionaryでクローズすること。
+ */
+Dictionary *openDictionary(char *tableName)
+{
+    char filename[MAX_FILENAME];
+    int header[3];
+    unsigned short count;
+    char *p;
+    Dictionary *dict;
+    int pageNum;
+    int i;
+
+    if ((dict = (Dictionary *) malloc(sizeof(Dictionary))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    memset(dict, 0, sizeof(Dictionary));
+    if ((dict->bucket = (int *) malloc(DICTIONARY_HASH_SIZE * sizeof(int))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        free(dict);
+        return NULL;
+    }
+    for (i = 0; i < DICTIONARY_HASH_SIZE; i++) {
+        dict->bucket[i] = -1;
+    }
+
+    /* 辞書ファイルがなければ作る */
+    makeDictionaryFileName(filename, tableName);
+    if (getNumPages(filename) < 1) {
+        if (createFile(filename) != OK || (dict->file = openFile(filename)) == NULL) {
+            printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+            free(dict->bucket);
+            free(dict);
+            return NULL;
+        }
+        dict->headerModified = 1;
+        return dict;
+    }
+
+    if ((dict->file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        free(dict->bucket);
+        free(dict);
+        return NULL;
+    }
+
+    /* ヘッダを読む */
+    if (readPage(dict->file, 0, dict->lastPage) != OK) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        freeDictionary(dict);
+        return NULL;
+    }
+    memcpy(header, dict->lastPage, sizeof(header));
+    if (header[0] != DICTIONARY_MAGIC) {
+        freeDictionary(dict);
+        return NULL;
+    }
+    dict->numPage = header[2];
+
+    /* 項目を順にメモリ上の辞書に加える(最後のページの内容は、追加に備えて残しておく) */
+    for (pageNum = 1; pageNum <= dict->numPage; pageNum++) {
+        if (readPage(dict->file, pageNum, dict->lastPage) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            freeDictionary(dict);
+            return NULL;
+        }
+        memcpy(&count, dict->lastPage, DICTIONARY_PAGE_HEADER_SIZE);
+        p = dict->lastPage + DICTIONARY_PAGE_HEADER_SIZE;
+        for (i = 0; i < count; i++) {
+            if (addEntry(dict, (unsigned char) p[0], p + 2, (unsigned char) p[1]) != OK) {
+                freeDictionary(dict);
+                return NULL;
+            }
+            p += 2 + (unsigned char) p[1];
+        }
+        dict->lastPageUsed = p - dict->lastPage;
+    }
+    dict->numSaved = dict->numEntry;
+
+    return dict;
+}
+
+/*
+ * closeDictionary -- 辞書のクローズ
+ *
+ * 引数:
+ *	dict: クローズする辞書
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * オープンしてから追加した項目を、辞書ファイルの最後のページに続けて書き出す。
+ */
+Result closeDictionary(Dictionary *dict)
+{
+    char page[PAGE_SIZE];
+    int header[3];
+    unsigned short count;
+    int len;
+    int i;
+    Result result = OK;
+
+    if (dict->numSaved < dict->numEntry) {
+        /* 最後のページ(なければ新しいページ)に項目を詰め、入りきらなければ次のページへ */
+        if (dict->numPage == 0) {
+            memset(dict->lastPage, 0, PAGE_SIZE);
+            dict->lastPageUsed = DICTIONARY_PAGE_HEADER_SIZE;
+            dict->numPage = 1;
+        }
+        memcpy(&count, dict->lastPage, DICTIONARY_PAGE_HEADER_SIZE);
+        for (i = dict->numSaved; i < dict->numEntry; i++) {
+            len = strlen(dict->pool + dict->offset[i]);
+            if (dict->lastPageUsed + 2 + len > PAGE_SIZE) {
+                memcpy(dict->lastPage, &count, DICTIONARY_PAGE_HEADER_SIZE);
+                if (writePage(dict->file, dict->numPage, dict->lastPage) != OK) {
+                    result = NG;
+                }
+                memset(dict->lastPage, 0, PAGE_SIZE);
+                dict->lastPageUsed = DICTIONARY_PAGE_HEADER_SIZE;
+                dict->numPage++;
+                count = 0;
+            }
+            dict->lastPage[dict->lastPageUsed] = (char) dict->field[i];
+            dict->lastPage[dict->lastPageUsed + 1] = (char) len;
+            memcpy(dict->lastPage + dict->lastPageUsed + 2, dict->pool + dict->offset[i], len);
+            dict->lastPageUsed += 2 + len;
+            count++;
+        }
+        memcpy(dict->lastPage, &count, DICTIONARY_PAGE_HEADER_SIZE);
+        if (writePage(dict->file, dict->numPage, dict->lastPage) != OK) {
+            result = NG;
+        }
+        dict->headerModified = 1;
+    }
+
+    /* 項目数をヘッダに書き出す */
+    if (dict->headerModified && result == OK) {
+        memset(page, 0, PAGE_SIZE);
+        header[0] = DICTIONARY_MAGIC;
+        header[1] = dict->numEntry;
+        header[2] = dict->numPage;
+        memcpy(page, header, sizeof(header));
+        if (writePage(dict->file, 0, page) != OK) {
+            result = NG;
+        }
+    }
+    if (result != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+    }
+
+    if (freeDictionary(dict) != OK) {
+        result = NG;
+    }
+    return result;
+}
+
+/*
+ * lookupDictionaryCode -- 値に割り当てたコードを調べる
+ *
+ * 引数:
+ *	dict: 辞書
+ *	field: フィールドの番号
+ *	value: 値
+ *
+ * 返り値:
+ *	valueのコード。辞書にない値なら-1を返す
+ */
+int lookupDictionaryCode(Dictionary *dict, int field, char *value)
+{
+    int i;
+
+    for (i = dict->bucket[hashDictionaryValue(field, value)]; i != -1; i = dict->next[i]) {
+        if (dict->field[i] == field && strcmp(dict->pool + dict->offset[i], value) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * getDictionaryCode -- 値のコードの取得(なければ新しく割り当てる)
+ *
+ * 引数:
+ *	dict: 辞書
+ *	field: フィールドの番号
+ *	value: 値
+ *
+ * 返り値:
+ *	valueのコード。エラーの場合は-1を返す
+ */
+int getDictionaryCode(Dictionary *dict, int field, char *value)
+{
+    int code;
+    int len;
+
+    if ((code = lookupDictionaryCode(dict, field, value)) != -1) {
+        return code;
+    }
+    if ((len = strlen(value)) >= MAX_VARSTRING) {
+        return -1;
+    }
+
+    code = dict->numEntry;
+    if (addEntry(dict, field, value, len) != OK) {
+        return -1;
+    }
+    return code;
+}
+
+/*
+ * getDictionaryValue -- コードに対応する値の取得
+ *
+ * 引数:
+ *	dict: 辞書
+ *	field: フィールドの番号
+ *	code: コード
+ *
+ * 返り値:
+ *	codeに対応する値。辞書にないコードなら空文字列を返す
+ *	(辞書に項目を追加すると無効になることがあるので、すぐに写すこと)
+ */
+char *getDictionaryValue(Dictionary *dict, int field, int code)
+{
+    if (code < 0 || code >= dict->numEntry || dict->field[code] != field) {
+        return "";
+    }
+    return dict->pool + dict->offset[code];
+}
+
+/*
+ * hasDictionaryField -- 辞書圧縮するフィールドがあるかどうか
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	辞書圧縮するフィールドが1つでもあれば1、なければ0を返す
+ */
+int hasDictionaryField(TableInfo *tableInfo)
+{
+    int i;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (IS_DICTIONARY_FIELD(tableInfo, i)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * encodeDictionaryFields -- 辞書圧縮するフィールドの値をコードに置き換える
+ *
+ * 引数:
+ *	dict: 辞書
+ *	tableInfo: テーブルのデータ定義情報
+ *	recordData: レコード
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * 辞書圧縮するフィールドのintValueに、stringValueのコードを設定する。
+ */
+Result encodeDictionaryFields(Dictionary *dict, TableInfo *tableInfo, RecordData *recordData)
+{
+    int code;
+    int i;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (!IS_DICTIONARY_FIELD(tableInfo, i)) {
+            continue;
+        }
+        if ((code = getDictionaryCode(dict, i, recordData->fieldData[i].stringValue)) == -1) {
+            return NG;
+        }
+        recordData->fieldData[i].intValue = code;
+    }
+    return OK;
+}
+
+/*
+ * decodeDictionaryFields -- 辞書圧縮したフィールドのコードを値に戻す
+ *
+ * 引数:
+ *	dict: 辞書
+ *	tableInfo: テーブルのデータ定義情報
+ *	recordData: readSlotで読み出したレコード
+ *
+ * 返り値:
+ *	なし
+ */
+void decodeDictionaryFields(Dictionary *dict, TableInfo *tableInfo, RecordData *recordData)
+{
+    int i;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (IS_DICTIONARY_FIELD(tableInfo, i)) {
+            strcpy(recordData->fieldData[i].stringValue,
+                   getDictionaryValue(dict, i, recordData->fieldData[i].intValue));
+        }
+    }
+}
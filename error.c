@@ -13,6 +13,7 @@ char *errorMessage[] = {
     "ファイルの存在のチェックに失敗しました。",         /* ERR_MSG_ACCESS */
     "ファイルの大きさのチェックに失敗しました。",       /* ERR_MSG_STAT */
     "メモリの確保に失敗しました",                       /* ERR_MSG_MALLOC */
+    "レコードが長すぎるため格納できません。",           /* ERR_MSG_RECORD_SIZE */
 };
 /*
  * printErrorMessage -- エラーメッセージの表示
@@ -14,6 +14,7 @@ typedef enum ErrorMessageNo{
     ERR_MSG_ACCESS = 7,
     ERR_MSG_STAT = 8,
     ERR_MSG_MALLOC = 9,
+    ERR_MSG_RECORD_SIZE = 10,
 }ErrorMessageNo;
 
 
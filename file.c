@@ -1,12 +1,17 @@
 /*
- * file.c -- ファイルアクセスモジュール 
+ * file.c -- ファイルアクセスモジュール
  */
 
+#define _GNU_SOURCE
 #include "microdb.h"
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <limits.h>
+#include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,33 +26,201 @@
 typedef enum { UNMODIFIED = 0, MODIFIED = 1 } modifyFlag;
 
 /*
- * Buffer -- 1ページ分のバッファを記憶する構造体
+ * NIL_BUFFER -- リストの終端を表すバッファ番号
+ */
+#define NIL_BUFFER -1
+
+/*
+ * POOL_MAGIC -- 共有メモリ上のバッファプールの初期化が終わったことを示す値
+ */
+#define POOL_MAGIC 0x6d646270
+
+/*
+ * POOL_ATTACH_RETRY -- 他のプロセスによるバッファプールの初期化を待つ回数(1回1ミリ秒)
+ */
+#define POOL_ATTACH_RETRY 5000
+
+/*
+ * Buffer -- 1ページ分のバッファの記述子
+ *
+ * バッファプールは共有メモリに置かれることがあり、プロセスごとにマップされる
+ * 番地が異なるので、リストのつながりはポインタではなくバッファ番号で表す。
+ * また、File構造体はプロセスごとのものなので、どのファイルのページかは
+ * デバイス番号とiノード番号で識別する。
+ *
+ * ページの内容(フレーム)と出どころの情報は別の配列に置き、探索のたびに
+ * 触る項目だけを32バイトに詰める。記述子の配列はキャッシュライン境界から
+ * 始まるので、1つの記述子が2本のキャッシュラインにまたがることはない。
  */
 typedef struct Buffer Buffer;
 struct Buffer {
-    File *file;				/* バッファの内容が格納されたファイル */
-					/* file == NULLならこのバッファは未使用 */
     int pageNum;			/* ページ番号 */
-    char page[PAGE_SIZE];		/* ページの内容を格納する配列 */
-    struct Buffer *prev;		/* 一つ前のバッファへのポインタ */
-    struct Buffer *next;		/* 一つ後ろのバッファへのポインタ */
-    modifyFlag modified;		/* ページの内容が更新されたかどうかを示すフラグ */
+					/* pageNum == -1ならこのバッファは未使用 */
+    int prev;				/* 一つ前のバッファの番号 */
+    int next;				/* 一つ後ろのバッファの番号 */
+    short partition;			/* バッファが属するパーティションの番号 */
+    char modified;			/* ページの内容が更新されたかどうかを示すフラグ(modifyFlag) */
+    dev_t dev;				/* バッファの内容が格納されたファイルのデバイス番号 */
+    ino_t ino;				/* バッファの内容が格納されたファイルのiノード番号 */
+};
+
+/*
+ * BufferSource -- バッファの内容の出どころ(探索では使わない項目)
+ */
+typedef struct BufferSource BufferSource;
+struct BufferSource {
+    struct timespec mtime;		/* ページを読み込んだ時点のファイルの更新時刻 */
+    char path[MAX_PATHNAME];		/* 書き戻しに使うファイルの絶対パス */
+};
+
+/*
+ * BufferPartition -- バッファプールのパーティション
+ *
+ * パーティションに属するファイルのページは、minFrames枚までは他の
+ * パーティションのために追い出されることがなく、maxFrames枚を超えて
+ * バッファを使うこともない。
+ */
+typedef struct BufferPartition BufferPartition;
+struct BufferPartition {
+    char name[MAX_PARTITION_NAME];	/* パーティション名(""なら未使用) */
+    int minFrames;			/* 保証するフレーム数 */
+    int maxFrames;			/* 使えるフレーム数の上限 */
+    int numFrames;			/* 現在使っているフレーム数 */
+    long hits;				/* バッファにページがあった回数 */
+    long misses;			/* バッファにページがなかった回数 */
+};
+
+/*
+ * DEFAULT_PARTITION -- パーティションを指定されていないファイルが使うパーティション
+ */
+#define DEFAULT_PARTITION 0
+
+/*
+ * CACHE_LINE_SIZE -- 記述子の配列をそろえる境界(バイト数)
+ */
+#define CACHE_LINE_SIZE 64
+
+/*
+ * BufferPool -- バッファプール全体を表す構造体
+ *
+ * 共有モードのときは、この構造体全体がPOSIX共有メモリ上に置かれ、
+ * latchで複数プロセスからのアクセスを排他制御する。numAttachedはマップしている
+ * プロセスの数で、最後のプロセスが切り離すときに0にして共有メモリを削除する。
+ * 構造体の後ろには、記述子の配列、出どころの配列、フレームの配列がこの順に並ぶ。
+ * プロセスごとに番地が異なるので、それぞれの位置は先頭からのオフセットで持つ。
+ *
+ *   +--------+------------------+----------------+------------------------+
+ *   |ヘッダ  |記述子×numBuffer  |出どころ×       |フレーム×numBuffer      |
+ *   |        |(64バイト境界)    |numBuffer       |(PAGE_SIZEバイト境界)   |
+ *   +--------+------------------+----------------+------------------------+
+ */
+typedef struct BufferPool BufferPool;
+struct BufferPool {
+    volatile int initialized;		/* 初期化済みならPOOL_MAGIC */
+    int numBuffer;			/* バッファの数 */
+    int head;				/* LRUリストの先頭のバッファ番号 */
+    int tail;				/* LRUリストの最後のバッファ番号 */
+    size_t descOffset;			/* 記述子の配列のオフセット */
+    size_t sourceOffset;		/* 出どころの配列のオフセット */
+    size_t frameOffset;			/* フレームの配列のオフセット */
+    pthread_mutex_t latch;		/* プロセス間で共有するラッチ */
+    int numAttached;			/* マップしているプロセスの数(0なら削除済み) */
+    BufferPartition partition[MAX_PARTITION]; /* パーティションの表 */
 };
 
 /*
- * bufferListHead -- LRUリストの先頭へのポインタ
+ * bufferPool -- バッファプールへのポインタ
  */
-static Buffer *bufferListHead = NULL;
+static BufferPool *bufferPool = NULL;
 
 /*
- * bufferListTail -- LRUリストの最後へのポインタ
+ * bufferTable -- バッファの記述子の配列
  */
-static Buffer *bufferListTail = NULL;
+static Buffer *bufferTable = NULL;
 
+/*
+ * sourceTable -- バッファの内容の出どころの配列
+ */
+static BufferSource *sourceTable = NULL;
+
+/*
+ * frameArena -- ページの内容を格納するフレームの配列
+ */
+static char *frameArena = NULL;
+
+/*
+ * bufferPoolSize -- バッファプールの大きさ(バイト数)
+ */
+static size_t bufferPoolSize = 0;
+
+/*
+ * sharedMode -- バッファプールが共有メモリ上にあれば1
+ */
+static int sharedMode = 0;
+
+/*
+ * openFileList -- このプロセスでオープン中のファイルのリスト
+ */
+static File *openFileList = NULL;
+
+/*
+ * temporaryPath -- 一時ファイルを置くディレクトリの絶対パス(""なら設定していない)
+ */
+static char temporaryPath[MAX_PATHNAME] = "";
+
+/*
+ * sharedPoolName -- マップしている共有メモリの名前(共有モードのとき)
+ */
+static char sharedPoolName[MAX_PATHNAME] = "";
 
 static void moveBufferToListHead(Buffer *buf);
-static Result initializeBufferList();
+static Result initializeBufferList(int numBuffer);
 static Result finalizeBufferList();
+static Result attachSharedBufferPool(char *shmName, int numBuffer);
+static void lockBufferPool();
+static void unlockBufferPool();
+static Buffer *findBuffer(dev_t dev, ino_t ino, int pageNum, Buffer **emptyBuf);
+static Buffer *getEmptyBuffer(Buffer *emptyBuf, int partition);
+static Buffer *findVictim(int partition, int ownOnly);
+static void assignBuffer(Buffer *buf, File *file, int pageNum);
+static void releaseBuffer(Buffer *buf);
+static void initializePartitions(BufferPool *pool, int numBuffer);
+static int findPartition(char *name);
+static Result writeBackBuffer(Buffer *buf);
+static void invalidateBuffers(char *filename);
+static void discardStaleBuffers(File *file);
+static void setPoolLayout(BufferPool *pool, int numBuffer);
+static void attachPoolLayout(BufferPool *pool);
+
+/*
+ * BUFFER -- バッファ番号からバッファへのポインタを求める
+ */
+#define BUFFER(n) ((n) == NIL_BUFFER ? NULL : &bufferTable[(n)])
+
+/*
+ * BUFFER_NUM -- バッファへのポインタからバッファ番号を求める
+ */
+#define BUFFER_NUM(buf) ((buf) == NULL ? NIL_BUFFER : (int)((buf) - bufferTable))
+
+/*
+ * FRAME -- バッファのページの内容を格納するフレーム
+ */
+#define FRAME(buf) (frameArena + (size_t)BUFFER_NUM(buf) * PAGE_SIZE)
+
+/*
+ * PATH -- バッファの書き戻しに使う絶対パス
+ */
+#define PATH(buf) (sourceTable[BUFFER_NUM(buf)].path)
+
+/*
+ * MTIME -- バッファのページを読み込んだ時点のファイルの更新時刻
+ */
+#define MTIME(buf) (sourceTable[BUFFER_NUM(buf)].mtime)
+
+/*
+ * ALIGN -- sizeをalignの倍数に切り上げる
+ */
+#define ALIGN(size, align) (((size) + (align) - 1) / (align) * (align))
 
 /*
  * initializeFileModule -- ファイルアクセスモジュールの初期化処理
@@ -60,8 +233,41 @@ static Result finalizeBufferList();
  */
 Result initializeFileModule()
 {
+    return initializeFileModuleWithOption(NUM_BUFFER, NULL);
+}
+
+/*
+ * initializeFileModuleWithOption -- バッファ数と共有メモリを指定した初期化処理
+ *
+ * 引数:
+ *	numBuffer: バッファの数(ページ数)
+ *	shmName: バッファプールを置くPOSIX共有メモリの名前("/microdb"など)
+ *	         NULLならプロセス専用のバッファプールを使う
+ *
+ * 返り値:
+ *	成功の場合OK、失敗の場合NG
+ *
+ * 同じshmNameを指定したプロセスどうしは一つのバッファプールを共有するので、
+ * 他のプロセスが書き込んだページをディスクを経由せずに読み出せる。
+ * 共有メモリが既に存在する場合、numBufferは無視され、既存のバッファ数が使われる。
+ * 共有メモリは、マップしている最後のプロセスがfinalizeFileModuleを呼んだときに
+ * 削除される。
+ */
+Result initializeFileModuleWithOption(int numBuffer, char *shmName)
+{
+    if (numBuffer <= 0) {
+        return NG;
+    }
+
+    if (shmName != NULL) {
+        if (attachSharedBufferPool(shmName, numBuffer) == NG) {
+            printf("共有バッファプールの初期化に失敗しました");
+            return NG;
+        }
+        return OK;
+    }
 
-    if(initializeBufferList() == NG){
+    if(initializeBufferList(numBuffer) == NG){
         printf("BufferListの初期化に失敗しました");
         return NG;
     }
@@ -86,6 +292,27 @@ Result finalizeFileModule()
     return OK;
 }
 
+/*
+ * removeSharedBufferPool -- 共有バッファプールの削除
+ *
+ * 引数:
+ *	shmName: 削除する共有メモリの名前
+ *
+ * 返り値:
+ *	成功の場合OK、失敗の場合NG
+ *
+ * 既にマップしているプロセスは、終了処理まで引き続きそのバッファプールを使える。
+ * 共有メモリは最後のプロセスの終了処理で削除されるので、これを使うのは、
+ * finalizeFileModuleを呼ばずに終了したプロセスが残したものを消すときだけでよい。
+ */
+Result removeSharedBufferPool(char *shmName)
+{
+    if (shm_unlink(shmName) == -1) {
+        return NG;
+    }
+    return OK;
+}
+
 /*
  * createFile -- ファイルの作成
  *
@@ -97,10 +324,16 @@ Result finalizeFileModule()
  */
 Result createFile(char *filename)
 {
-    if((creat(filename, S_IREAD | S_IWRITE)) == -1){
+    int desc;
+
+    /* 既存のファイルを切り詰める場合に備えて、古いページをバッファから捨てる */
+    invalidateBuffers(filename);
+
+    if((desc = creat(filename, S_IREAD | S_IWRITE)) == -1){
         //ERROR
         return NG;
     }
+    close(desc);
     return OK;
 }
 
@@ -115,6 +348,9 @@ Result createFile(char *filename)
  */
 Result deleteFile(char *filename)
 {
+    /* iノード番号が再利用されたときに古いページが見えないよう、バッファから捨てる */
+    invalidateBuffers(filename);
+
     if(unlink(filename) == -1){
         //ERROR
         return NG;
@@ -135,6 +371,9 @@ Result deleteFile(char *filename)
 File *openFile(char *filename)
 {
     File *file;
+    struct stat statBuffer;
+    char path[PATH_MAX];
+
     file = malloc(sizeof(File));
     if(file == NULL){
         //ERROR
@@ -145,7 +384,36 @@ File *openFile(char *filename)
         free(file);
         return NULL;
     }
+
+    /* バッファの識別に使うデバイス番号とiノード番号を調べる */
+    if (fstat(file->desc, &statBuffer) == -1 || realpath(filename, path) == NULL
+        || strlen(path) >= MAX_PATHNAME) {
+        close(file->desc);
+        free(file);
+        return NULL;
+    }
+    file->dev = statBuffer.st_dev;
+    file->ino = statBuffer.st_ino;
+    strcpy(file->path, path);
     strcpy(file->name, filename);
+    file->partition = DEFAULT_PARTITION;
+    file->mtime = statBuffer.st_mtim;
+    file->temporary = temporaryPath[0] != '\0'
+        && strncmp(path, temporaryPath, strlen(temporaryPath)) == 0 && path[strlen(temporaryPath)] == '/';
+
+    /*
+     * 前回クローズした後に他のプロセスがファイルを書き換えていれば、
+     * バッファに残っている古いページを捨てる
+     * (共有モードでは、他のプロセスの書き込みもバッファに反映されているので不要。
+     * 一時ファイルはこのプロセスしか書かないので、調べなくてよい)
+     */
+    if (bufferPool != NULL && !sharedMode && !file->temporary) {
+        discardStaleBuffers(file);
+    }
+
+    /* オープン中のファイルのリストにつなぐ */
+    file->next = openFileList;
+    openFileList = file;
     return file;
 }
 
@@ -157,40 +425,68 @@ File *openFile(char *filename)
  *
  * 返り値:
  *	成功の場合OK、失敗の場合NG
+ *
+ * 変更されたページはファイルに書き戻すが、バッファからは消さない。
+ * 一時ファイルの変更されたページは書き戻さずにバッファに残し、追い出されるときにだけ書く
+ * (書く前にファイルが削除されれば、ページはそのまま捨てられる)。
  */
 Result closeFile(File *file)
 {
     Buffer *buf = NULL;
+    File **f;
+    struct stat statBuffer;
+
+    lockBufferPool();
+
     /* バッファ探し*/
     /* 見つけたらファイルに書き込む*/
-    for (buf = bufferListHead; buf != NULL; buf = buf->next) {
+    for (buf = BUFFER(bufferPool->head); buf != NULL; buf = BUFFER(buf->next)) {
         /* 要求されたページがリストの中にあるかどうかチェックする */
-        if (buf->file == file) {
+        if (buf->pageNum != -1 && buf->dev == file->dev && buf->ino == file->ino && !file->temporary) {
             if(buf->modified == MODIFIED){
                 /* 要求されたページがバッファにあったので、その内容をファイルに書き込む */
-                if(lseek(buf->file->desc, buf->pageNum*PAGE_SIZE, SEEK_SET) == -1){
+                if(lseek(file->desc, (off_t)buf->pageNum*PAGE_SIZE, SEEK_SET) == -1){
                     /* エラー*/
                     printf("close失敗");
+                    unlockBufferPool();
                     return NG;
                 }
-                if (write(buf->file->desc, buf->page, PAGE_SIZE) < PAGE_SIZE) {
+                if (write(file->desc, FRAME(buf), PAGE_SIZE) < PAGE_SIZE) {
                     /* エラー処理 */
                     printf("クローズシッパイ");
+                    unlockBufferPool();
                     return NG;
                 }
+                buf->modified = UNMODIFIED;
 	    }
+        }
+    }
 
-	    /* アクセスされたバッファを、空にする */
-	    buf->file = NULL;
-	    buf->pageNum = -1;
-	    buf->modified = UNMODIFIED;
-	    memset(buf->page, 0, PAGE_SIZE);
+    /*
+     * 書き戻したページは、次にオープンされたときのためにバッファに残しておく
+     * 書き戻しで変わった更新時刻を記録し、他のプロセスによる変更と区別する
+     */
+    if (fstat(file->desc, &statBuffer) == 0) {
+        for (buf = BUFFER(bufferPool->head); buf != NULL; buf = BUFFER(buf->next)) {
+            if (buf->pageNum != -1 && buf->dev == file->dev && buf->ino == file->ino) {
+                MTIME(buf) = statBuffer.st_mtim;
+            }
         }
     }
 
+    unlockBufferPool();
+
+    /* オープン中のファイルのリストから外す */
+    for (f = &openFileList; *f != NULL; f = &(*f)->next) {
+        if (*f == file) {
+            *f = file->next;
+            break;
+        }
+    }
 
     if(close(file->desc) == -1) {
         //ERROR
+        free(file);
         return NG;
     }
     free(file);
@@ -209,53 +505,36 @@ Result closeFile(File *file)
  */
 Result readPage(File *file, int pageNum, char *page)
 {
-    Buffer *buf = NULL;;
+    Buffer *buf = NULL;
     Buffer *emptyBuf = NULL;
 
+    lockBufferPool();
+
     /*
      * 読み出しを要求されたページがバッファに保存されているかどうか、
      * リストの先頭から順に探す
      */
-    for (buf = bufferListHead; buf != NULL; buf = buf->next) {
-        /* 要求されたページがリストの中にあるかどうかチェックする */
-        if (buf->file == file && buf->pageNum == pageNum) {
-            /* 要求されたページがバッファにあったので、その内容を引数のpageにコピーする */
-            memcpy(page, buf->page, PAGE_SIZE);
+    if ((buf = findBuffer(file->dev, file->ino, pageNum, &emptyBuf)) != NULL) {
+        /* 要求されたページがバッファにあったので、その内容を引数のpageにコピーする */
+        memcpy(page, FRAME(buf), PAGE_SIZE);
+        bufferPool->partition[file->partition].hits++;
+        assignBuffer(buf, file, pageNum);
 
-            /* アクセスされたバッファを、リストの先頭に移動させる */
-            moveBufferToListHead(buf);
+        /* アクセスされたバッファを、リストの先頭に移動させる */
+        moveBufferToListHead(buf);
 
-            return OK;
-        }
-        if(buf->file == NULL){
-            /* bufの中身が空だったら保存 */
-            emptyBuf = buf;
-        }
+        unlockBufferPool();
+        return OK;
     }
 
     /*
      * emptyBuf==NULLなら空きなし
      * 一番最後のバッファを開ける
      */
-
-    if(emptyBuf == NULL){
-        //もし変更フラグが立っていたら書き込む
-        if(bufferListTail->modified == MODIFIED){
-            if(lseek(bufferListTail->file->desc, PAGE_SIZE*bufferListTail->pageNum, SEEK_SET) == -1){
-                //ERROR
-                return NG;
-            }
-            if(write(bufferListTail->file->desc, bufferListTail->page, PAGE_SIZE) == -1){
-                //ERROR
-                return NG;
-            }
-            bufferListTail->modified = UNMODIFIED;
-        }
-        /*初期化してempty*/
-        bufferListTail->file = NULL;
-        bufferListTail->pageNum = -1;
-        memset(bufferListTail->page, 0, PAGE_SIZE);
-        emptyBuf = bufferListTail;
+    bufferPool->partition[file->partition].misses++;
+    if ((emptyBuf = getEmptyBuffer(emptyBuf, file->partition)) == NULL) {
+        unlockBufferPool();
+        return NG;
     }
 
     /*
@@ -264,29 +543,29 @@ Result readPage(File *file, int pageNum, char *page)
      */
 
     /* 読み出し位置の設定 */
-    if (lseek(file->desc, pageNum * PAGE_SIZE, SEEK_SET) == -1) {
+    if (lseek(file->desc, (off_t)pageNum * PAGE_SIZE, SEEK_SET) == -1) {
+        unlockBufferPool();
         return NG;
     }
 
     /* 1ページ分のデータの読み出し */
     if (read(file->desc, page, PAGE_SIZE) < PAGE_SIZE) {
+        unlockBufferPool();
         return NG;
     }
 
     /* バッファの内容を引数のpageにコピー */
-    memcpy(emptyBuf->page, page, PAGE_SIZE);
+    memcpy(FRAME(emptyBuf), page, PAGE_SIZE);
 
     /* Buffer構造体(emptyBuf)への各種情報の設定 */
-    emptyBuf->file = file;
-    emptyBuf->pageNum = pageNum;
-    
+    assignBuffer(emptyBuf, file, pageNum);
+    emptyBuf->modified = UNMODIFIED;
 
     /* アクセスされたバッファ(emptyBuf)を、リストの先頭に移動させる */
     moveBufferToListHead(emptyBuf);
 
+    unlockBufferPool();
     return OK;
-
-
 }
 
 /*
@@ -302,79 +581,144 @@ Result readPage(File *file, int pageNum, char *page)
  */
 Result writePage(File *file, int pageNum, char *page)
 {
-    Buffer *buf = NULL;;
+    Buffer *buf = NULL;
     Buffer *emptyBuf = NULL;
 
-    
+    lockBufferPool();
 
     /*
      * 書き出しを要求されたページがバッファに保存されているかどうか、
      * リストの先頭から順に探す
      */
-    for (buf = bufferListHead; buf != NULL; buf = buf->next) {
-        /* 要求されたページがリストの中にあるかどうかチェックする */
-        if (buf->file == file && buf->pageNum == pageNum) {
-            /* 要求されたページがバッファにあったので、その内容を引数のpageからコピーする */
-            memcpy(buf->page, page, PAGE_SIZE);
+    if ((buf = findBuffer(file->dev, file->ino, pageNum, &emptyBuf)) != NULL) {
+        /* 要求されたページがバッファにあったので、その内容を引数のpageからコピーする */
+        memcpy(FRAME(buf), page, PAGE_SIZE);
+        bufferPool->partition[file->partition].hits++;
+        assignBuffer(buf, file, pageNum);
 
-            /*フラグを書き換える*/
-            buf->modified = MODIFIED;
+        /*フラグを書き換える*/
+        buf->modified = MODIFIED;
 
-            /* アクセスされたバッファを、リストの先頭に移動させる */
-            moveBufferToListHead(buf);
-
-            return OK;
-        }
+        /* アクセスされたバッファを、リストの先頭に移動させる */
+        moveBufferToListHead(buf);
 
-        //ついでに空きを見つける
-        if(buf->file == NULL){
-            emptyBuf = buf;
-        }
-        
+        unlockBufferPool();
+        return OK;
     }
 
-
-
     /*
      * emptuBuf=NUlLなら空きなし
      * 一番最後のバッファを開ける
      */
-
-    if(emptyBuf == NULL){
-        //もし変更フラグが立っていたら書き込む
-        if(bufferListTail->modified == MODIFIED){
-            if(lseek(bufferListTail->file->desc, PAGE_SIZE*bufferListTail->pageNum, SEEK_SET) == -1){
-                //ERROR
-                return NG;
-            }
-            if(write(bufferListTail->file->desc, bufferListTail->page, PAGE_SIZE) == -1){
-                //ERROR
-                return NG;
-            }
-            bufferListTail->modified = UNMODIFIED;
-
-        }
-        /*初期化してemptyに*/
-        bufferListTail->file = NULL;
-        bufferListTail->pageNum = -1;
-        memset(bufferListTail->page, 0, PAGE_SIZE);
-        emptyBuf = bufferListTail;
-        
+    bufferPool->partition[file->partition].misses++;
+    if ((emptyBuf = getEmptyBuffer(emptyBuf, file->partition)) == NULL) {
+        unlockBufferPool();
+        return NG;
     }
 
     /*あきバッファに変更内容を保存*/
-    memcpy(emptyBuf->page, page, PAGE_SIZE);
-    
+    memcpy(FRAME(emptyBuf), page, PAGE_SIZE);
+
     /*各種情報の設定*/
-    emptyBuf->file = file;
-    emptyBuf->pageNum = pageNum;
+    assignBuffer(emptyBuf, file, pageNum);
     emptyBuf->modified = MODIFIED;
 
     /*アクセスされたバッファをリストの先頭に*/
     moveBufferToListHead(emptyBuf);
 
+    unlockBufferPool();
+    return OK;
+}
+
+/*
+ * discardPages -- 連続したページの解放
+ *
+ * 引数:
+ *	file: アクセスするファイルのFile構造体
+ *	pageNum: 解放する最初のページの番号
+ *	numPage: 解放するページの数
+ *
+ * 返り値:
+ *	成功の場合OK、失敗の場合NG
+ *
+ * ページをバッファから消し(変更されていても書き戻さない)、ファイルのその部分に穴を空けて
+ * ディスクの領域を返す。ファイルの大きさとほかのページの番号は変わらない。
+ * 解放したページは、すべて0のページとして読める。穴を空けられないファイルシステムでは、
+ * 0のページを書き込む。
+ */
+Result discardPages(File *file, int pageNum, int numPage)
+{
+    Buffer *buf;
+    char zero[PAGE_SIZE];
+    int i;
+
+    if (numPage <= 0) {
+        return OK;
+    }
+
+    lockBufferPool();
+    for (buf = BUFFER(bufferPool->head); buf != NULL; buf = BUFFER(buf->next)) {
+        if (buf->pageNum >= pageNum && buf->pageNum < pageNum + numPage
+            && buf->dev == file->dev && buf->ino == file->ino) {
+            releaseBuffer(buf);
+        }
+    }
+
+    if (fallocate(file->desc, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                  (off_t)pageNum * PAGE_SIZE, (off_t)numPage * PAGE_SIZE) == 0) {
+        unlockBufferPool();
+        return OK;
+    }
+
+    /* 穴を空けられなければ、0のページで上書きする */
+    memset(zero, 0, PAGE_SIZE);
+    if (lseek(file->desc, (off_t)pageNum * PAGE_SIZE, SEEK_SET) == -1) {
+        unlockBufferPool();
+        return NG;
+    }
+    for (i = 0; i < numPage; i++) {
+        if (write(file->desc, zero, PAGE_SIZE) < PAGE_SIZE) {
+            unlockBufferPool();
+            return NG;
+        }
+    }
+    unlockBufferPool();
+    return OK;
+}
+
+/*
+ * truncatePages -- ファイルの末尾のページの切り詰め
+ *
+ * 引数:
+ *	file: アクセスするファイルのFile構造体
+ *	numPage: 切り詰めた後のページ数
+ *
+ * 返り値:
+ *	成功の場合OK、失敗の場合NG
+ *
+ * numPageページ目以降のページをバッファから消し(変更されていても書き戻さない)、
+ * ファイルをnumPageページの大きさにする。
+ */
+Result truncatePages(File *file, int numPage)
+{
+    Buffer *buf;
 
+    if (numPage < 0) {
+        return NG;
+    }
 
+    /* 切り詰めに失敗したら、バッファのページは消さない(ファイルに古い内容が残るため) */
+    lockBufferPool();
+    if (ftruncate(file->desc, (off_t)numPage * PAGE_SIZE) == -1) {
+        unlockBufferPool();
+        return NG;
+    }
+    for (buf = BUFFER(bufferPool->head); buf != NULL; buf = BUFFER(buf->next)) {
+        if (buf->pageNum >= numPage && buf->dev == file->dev && buf->ino == file->ino) {
+            releaseBuffer(buf);
+        }
+    }
+    unlockBufferPool();
     return OK;
 }
 
@@ -387,20 +731,63 @@ Result writePage(File *file, int pageNum, char *page)
  * 返り値:
  *	引数で指定されたファイルの大きさ(ページ数)
  *	エラーの場合には-1を返す
+ *
+ * まだファイルに書き戻されていない(バッファ上にしかない)ページも数える。
  */
 int getNumPages(char *filename)
 {
     struct stat statBuffer;
+    Buffer *buf;
+    int numPage;
 
     if(stat(filename, &statBuffer) == -1){
         //ERROR
         return -1;
     }
-    return (int)statBuffer.st_size/PAGE_SIZE;
-    
+    numPage = (int)(statBuffer.st_size/PAGE_SIZE);
+
+    /* ファイルの末尾より後ろのページがバッファにあれば、それも含める */
+    if (bufferPool == NULL) {
+        return numPage;
+    }
+    lockBufferPool();
+    for (buf = BUFFER(bufferPool->head); buf != NULL; buf = BUFFER(buf->next)) {
+        if (buf->pageNum >= numPage && buf->dev == statBuffer.st_dev
+            && buf->ino == statBuffer.st_ino) {
+            numPage = buf->pageNum + 1;
+        }
+    }
+    unlockBufferPool();
+
+    return numPage;
 }
 
+/*
+ * setTemporaryDirectory -- 一時ファイルを置くディレクトリの設定
+ *
+ * 引数:
+ *	dirname: ディレクトリ名(NULLなら設定を取り消す)
+ *
+ * 返り値:
+ *	成功の場合OK、失敗の場合NG
+ *
+ * 以降にオープンする、このディレクトリの中のファイルを一時ファイルとして扱う
+ * (closeFileを参照)。一時ファイルは、このプロセスだけが使うものとする。
+ */
+Result setTemporaryDirectory(char *dirname)
+{
+    char path[PATH_MAX];
 
+    if (dirname == NULL) {
+        temporaryPath[0] = '\0';
+        return OK;
+    }
+    if (realpath(dirname, path) == NULL || strlen(path) >= MAX_PATHNAME) {
+        return NG;
+    }
+    strcpy(temporaryPath, path);
+    return OK;
+}
 
 
 
@@ -416,122 +803,912 @@ int getNumPages(char *filename)
  *	(initializeFileModule()から呼び出すこと。)
  *
  * 引数:
- *	なし
+ *	numBuffer: バッファの数
  *
  * 返り値:
  *	初期化に成功すればOK、失敗すればNGを返す。
  */
-static Result initializeBufferList()
+static Result initializeBufferList(int numBuffer)
 {
-    Buffer *oldBuf = NULL;
+    BufferPool *pool;
     Buffer *buf;
     int i;
 
     /*
-     * NUM_BUFFER個分のバッファを用意し、
-     * ポインタをつないで両方向リストにする
+     * numBuffer個分のバッファのメモリ領域をまとめて確保する
+     * フレームがページ境界にそろうよう、領域全体もページ境界から始める
      */
-    for (i = 0; i < NUM_BUFFER; i++) {
-	/* 1個分のバッファ(Buffer構造体)のメモリ領域の確保 */
-	if ((buf = (Buffer *) malloc(sizeof(Buffer))) == NULL) {
-	    /* メモリ不足なのでエラーを返す */
-	    return NG;
-	}
+    bufferPoolSize = 0;
+    setPoolLayout(NULL, numBuffer);
+    if (posix_memalign((void **) &pool, PAGE_SIZE, bufferPoolSize) != 0) {
+	/* メモリ不足なのでエラーを返す */
+	return NG;
+    }
+    setPoolLayout(pool, numBuffer);
+    attachPoolLayout(pool);
+    sharedMode = 0;
+
+    /*
+     * バッファを初期化し、
+     * 番号をつないで両方向リストにする
+     */
+    for (i = 0; i < numBuffer; i++) {
+	buf = BUFFER(i);
 
 	/* Buffer構造体の初期化 */
-	buf->file = NULL;
+	buf->dev = 0;
+	buf->ino = 0;
 	buf->pageNum = -1;
 	buf->modified = UNMODIFIED;
-	memset(buf->page, 0, PAGE_SIZE);
-	buf->prev = NULL;
-	buf->next = NULL;
-
-	/* ポインタをつないで両方向リストにする */
-	if (oldBuf != NULL) {
-	    oldBuf->next = buf;
-	}
-	buf->prev = oldBuf;
+	buf->partition = DEFAULT_PARTITION;
+	PATH(buf)[0] = '\0';
+	memset(FRAME(buf), 0, PAGE_SIZE);
 
-	/* リストの一番最初の要素へのポインタを保存 */
-	if (buf->prev == NULL) {
-	    bufferListHead = buf;
-	}
-
-	/* リストの一番最後の要素へのポインタを保存 */
-	if (i == NUM_BUFFER - 1) {
-	    bufferListTail = buf;
-	}
-
-	/* 次のループのために保存 */
-	oldBuf = buf;
+	/* 番号をつないで両方向リストにする */
+	buf->prev = i - 1;
+	buf->next = (i == numBuffer - 1) ? NIL_BUFFER : i + 1;
     }
 
+    /* リストの一番最初と一番最後の要素の番号を保存 */
+    pool->head = 0;
+    pool->tail = numBuffer - 1;
+    initializePartitions(pool, numBuffer);
+    pool->initialized = POOL_MAGIC;
+
     return OK;
 }
 
 /*
- * finalizeBufferList -- バッファリストの終了処理
- *
- * **注意**
- *	この関数は、ファイルアクセスモジュールの使用後に必ず一度だけ呼び出すこと。
- *	(finalizeFileModule()から呼び出すこと。)
+ * setPoolLayout -- バッファプール内の各配列の配置の決定
  *
  * 引数:
- *	なし
+ *	pool: 配置を書き込むバッファプール(NULLなら大きさの計算だけをする)
+ *	numBuffer: バッファの数
  *
  * 返り値:
- *	終了処理に成功すればOK、失敗すればNGを返す。
+ *	なし
+ *
+ * バッファプール全体の大きさをbufferPoolSizeに設定する。
  */
-static Result finalizeBufferList()
+static void setPoolLayout(BufferPool *pool, int numBuffer)
 {
-    return OK;
+    size_t descOffset, sourceOffset, frameOffset;
+
+    descOffset = ALIGN(sizeof(BufferPool), CACHE_LINE_SIZE);
+    sourceOffset = descOffset + ALIGN(sizeof(Buffer) * numBuffer, CACHE_LINE_SIZE);
+    frameOffset = ALIGN(sourceOffset + sizeof(BufferSource) * numBuffer, PAGE_SIZE);
+    bufferPoolSize = frameOffset + (size_t)PAGE_SIZE * numBuffer;
+
+    if (pool != NULL) {
+	pool->numBuffer = numBuffer;
+	pool->descOffset = descOffset;
+	pool->sourceOffset = sourceOffset;
+	pool->frameOffset = frameOffset;
+    }
 }
 
 /*
- * moveBufferToListHead -- バッファをリストの先頭へ移動
+ * attachPoolLayout -- バッファプール内の各配列へのポインタの設定
  *
  * 引数:
- *	buf: リストの先頭に移動させるバッファへのポインタ
+ *	pool: このプロセスにマップされたバッファプール
  *
  * 返り値:
  *	なし
  */
-static void moveBufferToListHead(Buffer *buf)
+static void attachPoolLayout(BufferPool *pool)
 {
+    bufferPool = pool;
+    bufferTable = (Buffer *) ((char *) pool + pool->descOffset);
+    sourceTable = (BufferSource *) ((char *) pool + pool->sourceOffset);
+    frameArena = (char *) pool + pool->frameOffset;
+}
 
-    if(bufferListHead == buf){
-    //bufが先頭の場合(何もしない)
-    }
-    else if(bufferListTail == buf){    
-    //bufが最後尾の場合
-        //bufのprevのnextをnullに
-        buf->prev->next = NULL;
-        //tailをbufのprevに
-        bufferListTail = buf->prev;
-        //bufのnextを現在のheadに
-        buf->next = bufferListHead;
-        //現在のheadのprevをbufに
-        bufferListHead->prev = buf;
-        //headをbufに
-        bufferListHead = buf;
-    }
+/*
+ * mapSharedBufferPool -- 共有メモリのオープンとマップ
+ *
+ * 引数:
+ *	shmName: 共有メモリの名前
+ *	numBuffer: 共有メモリを新しく作る場合のバッファの数
+ *	creator: 新しく作った場合に1、既存のものをオープンした場合に0を返す場所
+ *
+ * 返り値:
+ *	マップしたバッファプール。失敗すればNULLを返す。
+ *
+ * 共有メモリがまだなければ作成し、既にあればそれをオープンする。
+ * bufferPoolSizeにマップした大きさを設定する。
+ */
+static BufferPool *mapSharedBufferPool(char *shmName, int numBuffer, int *creator)
+{
+    int desc;
+    int i;
+    struct stat statBuffer;
+    BufferPool *pool;
+
+    /* まず新規作成を試み、既にあればそれをオープンする */
+    *creator = 0;
+    if ((desc = shm_open(shmName, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR)) != -1) {
+        *creator = 1;
+        setPoolLayout(NULL, numBuffer);
+        if (ftruncate(desc, bufferPoolSize) == -1) {
+            close(desc);
+            shm_unlink(shmName);
+            return NULL;
+        }
+    } else if (errno == EEXIST) {
+        if ((desc = shm_open(shmName, O_RDWR, 0)) == -1) {
+            return NULL;
+        }
+
+        /* 作成したプロセスがftruncateし終わるのを待つ */
+        for (i = 0; i < POOL_ATTACH_RETRY; i++) {
+            if (fstat(desc, &statBuffer) == -1) {
+                close(desc);
+                return NULL;
+            }
+            if (statBuffer.st_size > (off_t)sizeof(BufferPool)) {
+                break;
+            }
+            usleep(1000);
+        }
+        if (i == POOL_ATTACH_RETRY) {
+            close(desc);
+            return NULL;
+        }
+        bufferPoolSize = statBuffer.st_size;
+    } else {
+        return NULL;
+    }
+
+    pool = mmap(NULL, bufferPoolSize, PROT_READ | PROT_WRITE, MAP_SHARED, desc, 0);
+    close(desc);
+    if (pool == MAP_FAILED) {
+        if (*creator) {
+            shm_unlink(shmName);
+        }
+        return NULL;
+    }
+    return pool;
+}
+
+/*
+ * attachSharedBufferPool -- 共有メモリ上のバッファプールへの接続
+ *
+ * 引数:
+ *	shmName: 共有メモリの名前
+ *	numBuffer: 共有メモリを新しく作る場合のバッファの数
+ *
+ * 返り値:
+ *	成功すればOK、失敗すればNGを返す。
+ *
+ * 共有メモリがまだなければ作成して初期化し、既にあればそれをマップして、
+ * マップしているプロセスの数を1増やす。
+ */
+static Result attachSharedBufferPool(char *shmName, int numBuffer)
+{
+    int creator = 0;
+    int retry;
+    int i;
+    pthread_mutexattr_t attr;
+    BufferPool *pool;
+
+    if (strlen(shmName) >= MAX_PATHNAME) {
+        return NG;
+    }
+    strcpy(sharedPoolName, shmName);
+
+    for (retry = 0; retry < POOL_ATTACH_RETRY; retry++) {
+        if ((pool = mapSharedBufferPool(shmName, numBuffer, &creator)) == NULL) {
+            return NG;
+        }
+        sharedMode = 1;
+        if (creator) {
+            break;
+        }
+
+        /* 作成したプロセスが初期化し終わるのを待つ */
+        for (i = 0; i < POOL_ATTACH_RETRY && pool->initialized != POOL_MAGIC; i++) {
+            usleep(1000);
+        }
+        if (pool->initialized != POOL_MAGIC || pool->frameOffset + (size_t)PAGE_SIZE
+            * pool->numBuffer != bufferPoolSize) {
+            munmap(pool, bufferPoolSize);
+            sharedMode = 0;
+            return NG;
+        }
+        attachPoolLayout(pool);
+
+        /*
+         * 最後のプロセスが切り離して削除した共有メモリをオープンしていたら、
+         * マップを外し、新しく作り直してやり直す
+         */
+        lockBufferPool();
+        if (pool->numAttached > 0) {
+            pool->numAttached++;
+            unlockBufferPool();
+            return OK;
+        }
+        unlockBufferPool();
+        munmap(pool, bufferPoolSize);
+        bufferPool = NULL;
+        sharedMode = 0;
+        usleep(1000);
+    }
+    if (!creator) {
+        return NG;
+    }
+
+    /*
+     * プロセス間で共有するラッチを作る
+     * ラッチを持ったままプロセスが死んでも回復できるよう、robust属性をつける
+     */
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    if (pthread_mutex_init(&pool->latch, &attr) != 0) {
+        pthread_mutexattr_destroy(&attr);
+        munmap(pool, bufferPoolSize);
+        sharedMode = 0;
+        shm_unlink(shmName);
+        return NG;
+    }
+    pthread_mutexattr_destroy(&attr);
+
+    /* バッファを初期化し、番号をつないで両方向リストにする */
+    setPoolLayout(pool, numBuffer);
+    attachPoolLayout(pool);
+    for (i = 0; i < numBuffer; i++) {
+        BUFFER(i)->pageNum = -1;
+        BUFFER(i)->modified = UNMODIFIED;
+        BUFFER(i)->partition = DEFAULT_PARTITION;
+        BUFFER(i)->prev = i - 1;
+        BUFFER(i)->next = (i == numBuffer - 1) ? NIL_BUFFER : i + 1;
+    }
+    pool->head = 0;
+    pool->tail = numBuffer - 1;
+    pool->numAttached = 1;
+    initializePartitions(pool, numBuffer);
+
+    /* 初期化が終わったことを他のプロセスに知らせる */
+    __sync_synchronize();
+    pool->initialized = POOL_MAGIC;
+
+    return OK;
+}
+
+/*
+ * finalizeBufferList -- バッファリストの終了処理
+ *
+ * **注意**
+ *	この関数は、ファイルアクセスモジュールの使用後に必ず一度だけ呼び出すこと。
+ *	(finalizeFileModule()から呼び出すこと。)
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	終了処理に成功すればOK、失敗すればNGを返す。
+ */
+static Result finalizeBufferList()
+{
+    Buffer *buf;
+    Result result = OK;
+
+    if (bufferPool == NULL) {
+        return OK;
+    }
+
+    /*
+     * 書き戻されていないページが残っていれば書き戻す。共有モードでは、
+     * 他のプロセスが終了処理をせずに終了していてもページが失われないように、
+     * そのプロセスが書き込んだページも書き戻してから切り離す
+     */
+    lockBufferPool();
+    for (buf = BUFFER(bufferPool->head); buf != NULL; buf = BUFFER(buf->next)) {
+        if (buf->pageNum != -1 && buf->modified == MODIFIED) {
+            if (writeBackBuffer(buf) == NG) {
+                result = NG;
+            }
+        }
+    }
+
+    if (sharedMode) {
+        /* 最後のプロセスなら、共有メモリを削除する */
+        if (--bufferPool->numAttached == 0) {
+            shm_unlink(sharedPoolName);
+        }
+        unlockBufferPool();
+        munmap(bufferPool, bufferPoolSize);
+    } else {
+        free(bufferPool);
+    }
+
+    bufferPool = NULL;
+    bufferTable = NULL;
+    sourceTable = NULL;
+    frameArena = NULL;
+    sharedMode = 0;
+    return result;
+}
+
+/*
+ * lockBufferPool -- バッファプールのラッチの獲得
+ *
+ * プロセス専用のバッファプールのときは何もしない。
+ */
+static void lockBufferPool()
+{
+    if (sharedMode) {
+        /* ラッチを持ったまま終了したプロセスがいれば、状態を回復して使い続ける */
+        if (pthread_mutex_lock(&bufferPool->latch) == EOWNERDEAD) {
+            pthread_mutex_consistent(&bufferPool->latch);
+        }
+    }
+}
+
+/*
+ * unlockBufferPool -- バッファプールのラッチの解放
+ */
+static void unlockBufferPool()
+{
+    if (sharedMode) {
+        pthread_mutex_unlock(&bufferPool->latch);
+    }
+}
+
+/*
+ * findBuffer -- ページを保持しているバッファを探す
+ *
+ * 引数:
+ *	dev, ino: ファイルのデバイス番号とiノード番号
+ *	pageNum: ページ番号
+ *	emptyBuf: 探す途中で見つけた空きバッファを返す場所
+ *
+ * 返り値:
+ *	ページを保持しているバッファ。なければNULLを返す。
+ */
+static Buffer *findBuffer(dev_t dev, ino_t ino, int pageNum, Buffer **emptyBuf)
+{
+    Buffer *buf;
+    Buffer *end = bufferTable + bufferPool->numBuffer;
+
+    /*
+     * LRUリストをたどるとアクセスが飛び飛びになるので、
+     * 記述子の配列を先頭から順に調べる
+     */
+    for (buf = bufferTable; buf < end; buf++) {
+        /* 要求されたページがバッファの中にあるかどうかチェックする */
+        if (buf->pageNum == pageNum && buf->dev == dev && buf->ino == ino) {
+            return buf;
+        }
+
+        //ついでに空きを見つける
+        if (buf->pageNum == -1) {
+            *emptyBuf = buf;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * getEmptyBuffer -- 空きバッファの確保
+ *
+ * 引数:
+ *	emptyBuf: findBufferで見つかった空きバッファ(なければNULL)
+ *	partition: バッファを使うパーティションの番号
+ *
+ * 返り値:
+ *	使用できるバッファ。書き戻しに失敗した場合や、追い出せるバッファが
+ *	ない場合はNULLを返す。
+ *
+ * パーティションがフレーム数の上限に達していれば、自分のパーティションの
+ * 一番古いバッファを追い出す。そうでなければ空きバッファを使い、空きが
+ * なければ、保証されたフレーム数を超えているパーティションのバッファのうち
+ * 一番古いものを追い出す。どのパーティションも保証されたフレーム数しか
+ * 使っていなければ、保証を破って追い出すことはせず、NULLを返す。
+ */
+static Buffer *getEmptyBuffer(Buffer *emptyBuf, int partition)
+{
+    BufferPartition *part = &bufferPool->partition[partition];
+    Buffer *victim;
+
+    if (part->numFrames >= part->maxFrames) {
+        victim = findVictim(partition, 1);
+    } else if (emptyBuf != NULL) {
+        return emptyBuf;
+    } else {
+        victim = findVictim(partition, 0);
+    }
+
+    /* 条件に合うバッファがなければ、他のパーティションの保証を守ってエラーにする */
+    if (victim == NULL) {
+        printf("パーティション%sに割り当てられるバッファがありません\n", part->name);
+        return NULL;
+    }
+
+    if (victim->pageNum == -1) {
+        return victim;
+    }
+
+    //もし変更フラグが立っていたら書き込む
+    if (victim->modified == MODIFIED) {
+        if (writeBackBuffer(victim) == NG) {
+            //ERROR
+            return NULL;
+        }
+    }
+
+    /*
+     * 初期化してemptyに
+     * フレームの内容は呼び出し側ですぐに上書きするので、クリアはしない
+     */
+    releaseBuffer(victim);
+
+    return victim;
+}
+
+/*
+ * findVictim -- 追い出すバッファを探す
+ *
+ * 引数:
+ *	partition: バッファを必要としているパーティションの番号
+ *	ownOnly: 1なら自分のパーティションのバッファだけを候補にする
+ *
+ * 返り値:
+ *	追い出すバッファ。候補がなければNULLを返す。
+ *
+ * LRUリストを最後から順にたどり、最初に見つかった候補を返す。
+ */
+static Buffer *findVictim(int partition, int ownOnly)
+{
+    Buffer *buf;
+    BufferPartition *owner;
+
+    for (buf = BUFFER(bufferPool->tail); buf != NULL; buf = BUFFER(buf->prev)) {
+        if (buf->pageNum == -1) {
+            continue;
+        }
+        if (buf->partition == partition) {
+            return buf;
+        }
+        owner = &bufferPool->partition[buf->partition];
+        if (!ownOnly && owner->numFrames > owner->minFrames) {
+            return buf;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * assignBuffer -- バッファにファイルのページを割り当てる
+ *
+ * 引数:
+ *	buf: 割り当てるバッファ
+ *	file: ページを持つファイル
+ *	pageNum: ページ番号
+ *
+ * 返り値:
+ *	なし
+ *
+ * 既にページを持っているバッファなら、パーティションの付け替えだけを行う。
+ */
+static void assignBuffer(Buffer *buf, File *file, int pageNum)
+{
+    if (buf->pageNum != -1) {
+        if (buf->partition == file->partition) {
+            return;
+        }
+        bufferPool->partition[buf->partition].numFrames--;
+    } else {
+        buf->dev = file->dev;
+        buf->ino = file->ino;
+        buf->pageNum = pageNum;
+        strcpy(PATH(buf), file->path);
+        MTIME(buf) = file->mtime;
+    }
+    buf->partition = file->partition;
+    bufferPool->partition[buf->partition].numFrames++;
+}
+
+/*
+ * releaseBuffer -- バッファを空にする
+ *
+ * 引数:
+ *	buf: 空にするバッファ
+ *
+ * 返り値:
+ *	なし
+ */
+static void releaseBuffer(Buffer *buf)
+{
+    if (buf->pageNum != -1) {
+        bufferPool->partition[buf->partition].numFrames--;
+    }
+    buf->pageNum = -1;
+    buf->modified = UNMODIFIED;
+}
+
+/*
+ * writeBackBuffer -- バッファの内容のファイルへの書き戻し
+ *
+ * 引数:
+ *	buf: 書き戻すバッファ
+ *
+ * 返り値:
+ *	成功の場合OK、失敗の場合NG
+ *
+ * 共有モードでは、他のプロセスが書いたページを書き戻すことがあるので、
+ * このプロセスでオープンしていないファイルは絶対パスで開き直して書く。
+ */
+static Result writeBackBuffer(Buffer *buf)
+{
+    File *file;
+    int desc;
+
+    /* このプロセスでオープン中のファイルなら、そのディスクリプタを使う */
+    for (file = openFileList; file != NULL; file = file->next) {
+        if (file->dev == buf->dev && file->ino == buf->ino) {
+            break;
+        }
+    }
+
+    if (file != NULL) {
+        desc = file->desc;
+    } else if ((desc = open(PATH(buf), O_WRONLY)) == -1) {
+        /* ファイルが既に削除されていれば、書き戻す必要はない */
+        if (errno == ENOENT) {
+            buf->modified = UNMODIFIED;
+            return OK;
+        }
+        return NG;
+    }
+
+    if (lseek(desc, (off_t)PAGE_SIZE * buf->pageNum, SEEK_SET) == -1
+        || write(desc, FRAME(buf), PAGE_SIZE) < PAGE_SIZE) {
+        if (file == NULL) {
+            close(desc);
+        }
+        return NG;
+    }
+
+    if (file == NULL) {
+        close(desc);
+    }
+    buf->modified = UNMODIFIED;
+    return OK;
+}
+
+/*
+ * invalidateBuffers -- ファイルのページをすべてバッファから捨てる
+ *
+ * 引数:
+ *	filename: ファイル名
+ *
+ * 返り値:
+ *	なし
+ *
+ * 変更フラグが立っていても書き戻さない。(削除や切り詰めの直前に使う)
+ */
+static void invalidateBuffers(char *filename)
+{
+    struct stat statBuffer;
+    Buffer *buf;
+
+    if (bufferPool == NULL || stat(filename, &statBuffer) == -1) {
+        return;
+    }
+
+    lockBufferPool();
+    for (buf = BUFFER(bufferPool->head); buf != NULL; buf = BUFFER(buf->next)) {
+        if (buf->pageNum != -1 && buf->dev == statBuffer.st_dev && buf->ino == statBuffer.st_ino) {
+            releaseBuffer(buf);
+        }
+    }
+    unlockBufferPool();
+}
+
+/*********パーティション*/
+
+
+
+/*
+ * initializePartitions -- パーティションの表の初期化
+ *
+ * 引数:
+ *	pool: 初期化するバッファプール
+ *	numBuffer: バッファの数
+ *
+ * 返り値:
+ *	なし
+ *
+ * 最初はすべてのバッファを使える"default"パーティションだけがある。
+ */
+static void initializePartitions(BufferPool *pool, int numBuffer)
+{
+    memset(pool->partition, 0, sizeof(pool->partition));
+    strcpy(pool->partition[DEFAULT_PARTITION].name, DEFAULT_PARTITION_NAME);
+    pool->partition[DEFAULT_PARTITION].minFrames = 0;
+    pool->partition[DEFAULT_PARTITION].maxFrames = numBuffer;
+}
+
+/*
+ * findPartition -- 名前からパーティションの番号を求める
+ *
+ * 引数:
+ *	name: パーティション名
+ *
+ * 返り値:
+ *	パーティションの番号。見つからなければ-1を返す。
+ */
+static int findPartition(char *name)
+{
+    int i;
+
+    for (i = 0; i < MAX_PARTITION; i++) {
+        if (bufferPool->partition[i].name[0] != '\0'
+            && strcmp(bufferPool->partition[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * createBufferPartition -- パーティションの作成(または設定の変更)
+ *
+ * 引数:
+ *	name: パーティション名
+ *	minFrames: 他のパーティションに追い出されないことを保証するフレーム数
+ *	maxFrames: 使えるフレーム数の上限
+ *
+ * 返り値:
+ *	成功の場合OK、失敗の場合NG
+ *
+ * すべてのパーティションのminFramesの合計は、バッファ数を超えられない。
+ * 同じ名前のパーティションが既にあれば、minFramesとmaxFramesを変更する。
+ */
+Result createBufferPartition(char *name, int minFrames, int maxFrames)
+{
+    int i, n;
+    int totalMin = 0;
+
+    if (name == NULL || name[0] == '\0' || strlen(name) >= MAX_PARTITION_NAME
+        || minFrames < 0 || maxFrames < 1 || minFrames > maxFrames
+        || maxFrames > bufferPool->numBuffer) {
+        return NG;
+    }
+
+    lockBufferPool();
+
+    /* 同じ名前のパーティションか、空いている場所を探す */
+    if ((n = findPartition(name)) == -1) {
+        for (i = 0; i < MAX_PARTITION; i++) {
+            if (bufferPool->partition[i].name[0] == '\0') {
+                n = i;
+                break;
+            }
+        }
+    }
+    if (n == -1 || n == DEFAULT_PARTITION) {
+        unlockBufferPool();
+        return NG;
+    }
+
+    /* 保証するフレーム数の合計がバッファ数を超えないかチェックする */
+    for (i = 0; i < MAX_PARTITION; i++) {
+        if (i != n && bufferPool->partition[i].name[0] != '\0') {
+            totalMin += bufferPool->partition[i].minFrames;
+        }
+    }
+    if (totalMin + minFrames > bufferPool->numBuffer) {
+        unlockBufferPool();
+        return NG;
+    }
+
+    if (bufferPool->partition[n].name[0] == '\0') {
+        memset(&bufferPool->partition[n], 0, sizeof(BufferPartition));
+        strcpy(bufferPool->partition[n].name, name);
+    }
+    bufferPool->partition[n].minFrames = minFrames;
+    bufferPool->partition[n].maxFrames = maxFrames;
+
+    unlockBufferPool();
+    return OK;
+}
+
+/*
+ * dropBufferPartition -- パーティションの削除
+ *
+ * 引数:
+ *	name: 削除するパーティション名
+ *
+ * 返り値:
+ *	成功の場合OK、失敗の場合NG
+ *
+ * 削除したパーティションのバッファは"default"パーティションに移る。
+ * "default"パーティションは削除できない。
+ */
+Result dropBufferPartition(char *name)
+{
+    Buffer *buf;
+    int n;
+
+    lockBufferPool();
+
+    if ((n = findPartition(name)) == -1 || n == DEFAULT_PARTITION) {
+        unlockBufferPool();
+        return NG;
+    }
+
+    for (buf = BUFFER(bufferPool->head); buf != NULL; buf = BUFFER(buf->next)) {
+        if (buf->pageNum != -1 && buf->partition == n) {
+            buf->partition = DEFAULT_PARTITION;
+            bufferPool->partition[DEFAULT_PARTITION].numFrames++;
+        }
+    }
+    bufferPool->partition[n].name[0] = '\0';
+    bufferPool->partition[n].numFrames = 0;
+
+    unlockBufferPool();
+    return OK;
+}
+
+/*
+ * setFilePartition -- ファイルが使うパーティションの設定
+ *
+ * 引数:
+ *	file: 設定するファイル
+ *	name: パーティション名(NULLまたは""なら"default")
+ *
+ * 返り値:
+ *	成功の場合OK
+ *	パーティションが見つからない場合は"default"を設定し、NGを返す
+ */
+Result setFilePartition(File *file, char *name)
+{
+    int n;
+
+    file->partition = DEFAULT_PARTITION;
+    if (name == NULL || name[0] == '\0') {
+        return OK;
+    }
+
+    lockBufferPool();
+    n = findPartition(name);
+    unlockBufferPool();
+
+    if (n == -1) {
+        return NG;
+    }
+    file->partition = n;
+    return OK;
+}
+
+/*
+ * getBufferPartitionStat -- パーティションの統計情報の取得
+ *
+ * 引数:
+ *	name: パーティション名
+ *	stat: 統計情報を格納する構造体
+ *
+ * 返り値:
+ *	成功の場合OK、パーティションが見つからない場合NG
+ */
+Result getBufferPartitionStat(char *name, BufferPartitionStat *stat)
+{
+    BufferPartition *part;
+    int n;
+
+    lockBufferPool();
+    if ((n = findPartition(name)) == -1) {
+        unlockBufferPool();
+        return NG;
+    }
+    part = &bufferPool->partition[n];
+    strcpy(stat->name, part->name);
+    stat->minFrames = part->minFrames;
+    stat->maxFrames = part->maxFrames;
+    stat->numFrames = part->numFrames;
+    stat->hits = part->hits;
+    stat->misses = part->misses;
+    unlockBufferPool();
+
+    return OK;
+}
+
+/*
+ * printBufferPartitionStats -- すべてのパーティションの統計情報の表示
+ */
+void printBufferPartitionStats()
+{
+    BufferPartition *part;
+    int i;
+
+    lockBufferPool();
+
+    printf("%-20s %6s %6s %6s %10s %10s %7s\n",
+           "partition", "min", "max", "frames", "hits", "misses", "hit(%)");
+    for (i = 0; i < MAX_PARTITION; i++) {
+        part = &bufferPool->partition[i];
+        if (part->name[0] == '\0') {
+            continue;
+        }
+        printf("%-20s %6d %6d %6d %10ld %10ld %7.1f\n",
+               part->name, part->minFrames, part->maxFrames, part->numFrames,
+               part->hits, part->misses,
+               part->hits + part->misses == 0 ? 0.0
+               : 100.0 * part->hits / (part->hits + part->misses));
+    }
+
+    unlockBufferPool();
+}
+
+
+/*
+ * discardStaleBuffers -- 他のプロセスに書き換えられた可能性のあるページを捨てる
+ *
+ * 引数:
+ *	file: オープンしたファイル
+ *
+ * 返り値:
+ *	なし
+ *
+ * ページを読み込んだ時点(またはクローズした時点)の更新時刻が、
+ * 現在のファイルの更新時刻と異なるページをバッファから捨てる。
+ * 変更フラグが立っているページはこのプロセスが書いた最新の内容なので残す。
+ */
+static void discardStaleBuffers(File *file)
+{
+    Buffer *buf;
+
+    for (buf = BUFFER(bufferPool->head); buf != NULL; buf = BUFFER(buf->next)) {
+        if (buf->pageNum != -1 && buf->modified == UNMODIFIED
+            && buf->dev == file->dev && buf->ino == file->ino
+            && (MTIME(buf).tv_sec != file->mtime.tv_sec
+                || MTIME(buf).tv_nsec != file->mtime.tv_nsec)) {
+            releaseBuffer(buf);
+        }
+    }
+}
+
+/*
+ * moveBufferToListHead -- バッファをリストの先頭へ移動
+ *
+ * 引数:
+ *	buf: リストの先頭に移動させるバッファへのポインタ
+ *
+ * 返り値:
+ *	なし
+ */
+static void moveBufferToListHead(Buffer *buf)
+{
+    int n = BUFFER_NUM(buf);
+
+    if(bufferPool->head == n){
+    //bufが先頭の場合(何もしない)
+        return;
+    }
+
+    //bufをリストから外す
+    BUFFER(buf->prev)->next = buf->next;
+    if(bufferPool->tail == n){
+        //bufが最後尾の場合、tailをbufのprevに
+        bufferPool->tail = buf->prev;
+    }
     else{
-    //その他場合
-        //bufのprevのnextをbufのnextに
-        buf->prev->next = buf->next;
         //bufのnextのprevをbufのprevに
-        buf->next->prev = buf->prev;
-        //bufのnextを現在のheadに
-        buf->next = bufferListHead;
-        //現在のheadのprevをbufに
-        bufferListHead->prev = buf;
-        //headをbufに
-        bufferListHead = buf;
-    }    
-    //headのprevとtailのnextをnullに
-    bufferListHead->prev = NULL;
-    bufferListTail->next = NULL;
+        BUFFER(buf->next)->prev = buf->prev;
+    }
 
+    //bufのnextを現在のheadに
+    buf->next = bufferPool->head;
+    //現在のheadのprevをbufに
+    BUFFER(bufferPool->head)->prev = n;
+    //headをbufに
+    buf->prev = NIL_BUFFER;
+    bufferPool->head = n;
 }
 
 
@@ -544,15 +1721,19 @@ void printBufferList()
 
     printf("Buffer List:");
 
+    lockBufferPool();
+
     /* それぞれのバッファの最初の3バイトだけ出力する */
-    for (buf = bufferListHead; buf != NULL; buf = buf->next) {
-	if (buf->file == NULL) {
+    for (buf = BUFFER(bufferPool->head); buf != NULL; buf = BUFFER(buf->next)) {
+	if (buf->pageNum == -1) {
 	    printf("(empty) ");
 	} else {
-	    printf("    %c%c%c ", buf->page[0], buf->page[1], buf->page[2]);
+	    printf("    %c%c%c ", FRAME(buf)[0], FRAME(buf)[1], FRAME(buf)[2]);
 	}
     }
 
+    unlockBufferPool();
+
     printf("\n");
 }
 
@@ -569,5 +1750,3 @@ Result writePage2(File *file, int pageNum, char *page){
     write(file->desc, page, PAGE_SIZE);
     return OK;
 }
-
-
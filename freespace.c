@@ -0,0 +1,377 @@
+/*
+ * freespace.c -- 空き領域管理モジュール
+ *
+ * データファイルの各ページにどれだけ空きがあるかを、空き領域マップファイル
+ * (ファイル名: tableName.fsm)に1ページあたり1バイトで記録する。
+ * 挿入のたびにデータファイルを先頭から読まなくても、空きのあるページが見つかる。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * FSM_FILE_EXT -- 空き領域マップファイルの拡張子
+ */
+#define FSM_FILE_EXT ".fsm"
+
+/*
+ * FSM_MAGIC -- 空き領域マップファイルであることを示す値
+ */
+#define FSM_MAGIC 0x66736d31
+
+/*
+ * FSM_MAX_FREE_SPACE -- 1バイトに記録できる空き量の最大値
+ */
+#define FSM_MAX_FREE_SPACE 255
+
+/*
+ * 空き領域マップファイルの構造
+ *
+ * 0ページ目(ヘッダ):
+ *   +-------------------+-------------------+-------------------+
+ *   |FSM_MAGIC          |データページ数     |最初の空きページ   |
+ *   |(sizeof(int)バイト)|(sizeof(int)バイト)|(sizeof(int)バイト)|
+ *   +-------------------+-------------------+-------------------+
+ * 1ページ目以降:
+ *   データファイルのnページ目の空き量を、(1 + n / PAGE_SIZE)ページ目の
+ *   (n % PAGE_SIZE)バイト目に記録する。空き量の単位はページの形式によって
+ *   データ操作モジュールが決める(0なら空きなし)。
+ *
+ * 「最初の空きページ」より前のページには空きがないことを保証する。
+ */
+
+/*
+ * FSMHeader -- 空き領域マップファイルのヘッダ
+ */
+typedef struct FSMHeader FSMHeader;
+struct FSMHeader {
+    int magic;                  /* FSM_MAGIC */
+    int numPage;                /* 記録しているデータページ数 */
+    int firstFreePage;          /* 最初の空きページの番号 */
+};
+
+/*
+ * makeFSMFileName -- 空き領域マップファイルのファイル名を作る
+ */
+static void makeFSMFileName(char *filename, char *tableName)
+{
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, FSM_FILE_EXT);
+}
+
+/*
+ * writeFSMHeader -- ヘッダを0ページ目に書き出す
+ */
+static Result writeFSMHeader(FreeSpaceMap *fsm)
+{
+    char page[PAGE_SIZE];
+    FSMHeader header;
+
+    memset(page, 0, PAGE_SIZE);
+    header.magic = FSM_MAGIC;
+    header.numPage = fsm->numPage;
+    header.firstFreePage = fsm->firstFreePage;
+    memcpy(page, &header, sizeof(header));
+
+    if (writePage(fsm->file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    fsm->headerModified = 0;
+    return OK;
+}
+
+/*
+ * readFSMPage -- 空き量を記録したページの読み出し
+ *
+ * まだファイルに存在しないページなら、すべて0(空きなし)のページを返す。
+ */
+static void readFSMPage(FreeSpaceMap *fsm, int fsmPageNum, char *page)
+{
+    if (fsmPageNum >= fsm->numFSMPage || readPage(fsm->file, fsmPageNum, page) != OK) {
+        memset(page, 0, PAGE_SIZE);
+    }
+}
+
+/*
+ * createFreeSpaceMap -- 空き領域マップファイルの作成
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result createFreeSpaceMap(char *tableName)
+{
+    char filename[MAX_FILENAME];
+    FreeSpaceMap fsm;
+
+    makeFSMFileName(filename, tableName);
+    if (createFile(filename) != OK) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        return NG;
+    }
+
+    if ((fsm.file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+    fsm.numPage = 0;
+    fsm.firstFreePage = 0;
+    if (writeFSMHeader(&fsm) != OK) {
+        closeFile(fsm.file);
+        return NG;
+    }
+
+    return closeFile(fsm.file);
+}
+
+/*
+ * deleteFreeSpaceMap -- 空き領域マップファイルの削除
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result deleteFreeSpaceMap(char *tableName)
+{
+    char filename[MAX_FILENAME];
+
+    makeFSMFileName(filename, tableName);
+    return deleteFile(filename);
+}
+
+/*
+ * openFreeSpaceMap -- 空き領域マップのオープン
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *
+ * 返り値:
+ *	オープンした空き領域マップ
+ *	ファイルがない場合や壊れている場合はNULLを返す
+ *
+ * ***注意***
+ *	使い終わったら必ずcloseFreeSpaceMapでクローズすること。
+ */
+FreeSpaceMap *openFreeSpaceMap(char *tableName)
+{
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    FSMHeader header;
+    FreeSpaceMap *fsm;
+
+    makeFSMFileName(filename, tableName);
+    if ((fsm = (FreeSpaceMap *) malloc(sizeof(FreeSpaceMap))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    if ((fsm->numFSMPage = getNumPages(filename)) < 1
+        || (fsm->file = openFile(filename)) == NULL) {
+        free(fsm);
+        return NULL;
+    }
+
+    /* ヘッダを読み込む */
+    if (readPage(fsm->file, 0, page) != OK) {
+        closeFile(fsm->file);
+        free(fsm);
+        return NULL;
+    }
+    memcpy(&header, page, sizeof(header));
+    if (header.magic != FSM_MAGIC) {
+        closeFile(fsm->file);
+        free(fsm);
+        return NULL;
+    }
+
+    fsm->numPage = header.numPage;
+    fsm->firstFreePage = header.firstFreePage;
+    fsm->headerModified = 0;
+    return fsm;
+}
+
+/*
+ * closeFreeSpaceMap -- 空き領域マップのクローズ
+ *
+ * 引数:
+ *	fsm: クローズする空き領域マップ
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result closeFreeSpaceMap(FreeSpaceMap *fsm)
+{
+    Result result = OK;
+
+    if (fsm->headerModified) {
+        result = writeFSMHeader(fsm);
+    }
+    if (closeFile(fsm->file) != OK) {
+        result = NG;
+    }
+    free(fsm);
+    return result;
+}
+
+/*
+ * getPageFreeSpace -- データページの空き量の取得
+ *
+ * 引数:
+ *	fsm: 空き領域マップ
+ *	pageNum: データページの番号
+ *
+ * 返り値:
+ *	記録されている空き量(記録がなければ0)
+ */
+int getPageFreeSpace(FreeSpaceMap *fsm, int pageNum)
+{
+    char page[PAGE_SIZE];
+
+    if (pageNum < 0 || pageNum >= fsm->numPage) {
+        return 0;
+    }
+    readFSMPage(fsm, 1 + pageNum / PAGE_SIZE, page);
+    return (unsigned char) page[pageNum % PAGE_SIZE];
+}
+
+/*
+ * setPageFreeSpace -- データページの空き量の記録
+ *
+ * 引数:
+ *	fsm: 空き領域マップ
+ *	pageNum: データページの番号
+ *	freeSpace: 空き量(FSM_MAX_FREE_SPACEを超える値はFSM_MAX_FREE_SPACEとして記録する)
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * データファイルの末尾にページを追加したときも、この関数で記録する。
+ */
+Result setPageFreeSpace(FreeSpaceMap *fsm, int pageNum, int freeSpace)
+{
+    char page[PAGE_SIZE];
+    int fsmPageNum;
+
+    if (freeSpace > FSM_MAX_FREE_SPACE) {
+        freeSpace = FSM_MAX_FREE_SPACE;
+    }
+    if (freeSpace < 0) {
+        freeSpace = 0;
+    }
+
+    /* 該当するバイトを書き換えて書き戻す */
+    fsmPageNum = 1 + pageNum / PAGE_SIZE;
+    readFSMPage(fsm, fsmPageNum, page);
+    if (pageNum < fsm->numPage && (unsigned char) page[pageNum % PAGE_SIZE] == freeSpace) {
+        return OK;
+    }
+    page[pageNum % PAGE_SIZE] = (char) freeSpace;
+    if (writePage(fsm->file, fsmPageNum, page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    if (fsmPageNum >= fsm->numFSMPage) {
+        fsm->numFSMPage = fsmPageNum + 1;
+    }
+
+    /* ヘッダの情報を更新する */
+    if (pageNum >= fsm->numPage) {
+        fsm->numPage = pageNum + 1;
+        fsm->headerModified = 1;
+    }
+    if (freeSpace > 0 && pageNum < fsm->firstFreePage) {
+        fsm->firstFreePage = pageNum;
+        fsm->headerModified = 1;
+    }
+
+    return OK;
+}
+
+/*
+ * truncateFreeSpaceMap -- データファイルを切り詰めたことの記録
+ *
+ * 引数:
+ *	fsm: 空き領域マップ
+ *	numPage: 切り詰めた後のデータファイルのページ数
+ *
+ * 返り値:
+ *	なし
+ *
+ * numPageページ目以降の空き量は、ページを追加したときにsetPageFreeSpaceで記録し直す。
+ */
+void truncateFreeSpaceMap(FreeSpaceMap *fsm, int numPage)
+{
+    if (numPage >= fsm->numPage) {
+        return;
+    }
+    fsm->numPage = numPage;
+    if (fsm->firstFreePage > numPage) {
+        fsm->firstFreePage = numPage;
+    }
+    fsm->headerModified = 1;
+}
+
+/*
+ * findFreePage -- 空きのあるデータページを探す
+ *
+ * 引数:
+ *	fsm: 空き領域マップ
+ *	minFreeSpace: 必要な空き量(1以上)
+ *
+ * 返り値:
+ *	空き量がminFreeSpace以上のページの番号
+ *	見つからなければ-1を返す
+ *
+ * 「最初の空きページ」から順に探し、途中で見つけた最初の空きページを
+ * 新しい「最初の空きページ」にする。空きのないページを読み飛ばすのは
+ * 1回だけなので、挿入1回あたりの探索の手間は平均すると一定になる。
+ */
+int findFreePage(FreeSpaceMap *fsm, int minFreeSpace)
+{
+    char page[PAGE_SIZE];
+    int pageNum;
+    int fsmPageNum = -1;
+    int firstFree = -1;
+    unsigned char freeSpace;
+
+    /* 1バイトに記録できる値を超える空きは、どのページにも記録されていない */
+    if (minFreeSpace > FSM_MAX_FREE_SPACE) {
+        return -1;
+    }
+
+    for (pageNum = fsm->firstFreePage; pageNum < fsm->numPage; pageNum++) {
+        /* 空き量を記録したページが変わったら読み込む */
+        if (1 + pageNum / PAGE_SIZE != fsmPageNum) {
+            fsmPageNum = 1 + pageNum / PAGE_SIZE;
+            readFSMPage(fsm, fsmPageNum, page);
+        }
+
+        freeSpace = (unsigned char) page[pageNum % PAGE_SIZE];
+        if (freeSpace == 0) {
+            continue;
+        }
+        if (firstFree == -1) {
+            firstFree = pageNum;
+        }
+        if (freeSpace >= minFreeSpace) {
+            break;
+        }
+    }
+
+    /* 空きのないページを次回から読み飛ばせるよう、「最初の空きページ」を進める */
+    if (firstFree == -1) {
+        firstFree = fsm->numPage;
+    }
+    if (firstFree != fsm->firstFreePage) {
+        fsm->firstFreePage = firstFree;
+        fsm->headerModified = 1;
+    }
+
+    return pageNum < fsm->numPage ? pageNum : -1;
+}
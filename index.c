@@ -0,0 +1,1800 @@
+/*
+ * index.c -- 索引モジュール
+ *
+ * テーブルの1つのフィールドについて、値からレコードの位置(RecordId)を引く
+ * 索引を、索引ファイル(ファイル名: indexName.idx)に作る。
+ * 同じ値のレコードが複数あってもよいよう、(値, RecordId)の組をキーにする。
+ *
+ * 索引の種類は4つある。
+ * B+木(INDEX_BTREE)は値の順にキーを並べ、=、<、>の条件に使える。
+ * 削除ではキーを葉から取り除くだけで、ノードの併合はしない(空の葉も残る)。
+ * 挿入と削除が混ざっても木の高さは挿入した件数だけで決まり、検索は正しく動く。
+ * 線形ハッシュ(INDEX_HASH)は値のハッシュ値でバケットを決め、=の条件にだけ使える。
+ * キーが増えるとバケットを1つずつ分割するので、1回の検索で読むバケットのページは
+ * 表の大きさによらずほぼ1ページで済む。
+ * ビットマップ(INDEX_BITMAP)は値の種類が少ないフィールド向けで、値ごとに、その値を
+ * 持つレコードのビットを立てたビットマップを持つ。=、!=、<、>のどの条件でも、合う値の
+ * ビットマップを合わせて、読むべきデータファイルのページを直接求める。
+ * トライグラム(INDEX_TRIGRAM)は文字列の中の連続する3文字ごとに、その3文字を値とする
+ * キーをB+木に入れる。likeの条件では、パターンの固定部分の3文字の並びすべてを含む
+ * レコードの位置を、並びごとのキーの列(ポスティングリスト)の共通部分として求める。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * INDEX_FILE_EXT -- 索引ファイルの拡張子
+ */
+#define INDEX_FILE_EXT ".idx"
+
+/*
+ * INDEX_MAGIC -- 索引ファイルであることを示す値
+ */
+#define INDEX_MAGIC 0x69647831
+
+/*
+ * INDEX_NODE_HEADER_SIZE -- ノードのページの先頭の、ノードの情報を置く部分の大きさ
+ */
+#define INDEX_NODE_HEADER_SIZE 8
+
+/*
+ * 索引ファイルの構造
+ *
+ * 0ページ目(ヘッダ): IndexHeader構造体
+ * 1ページ目以降(ノード):
+ *   +----------+----------+-------------------+----------+----------+----
+ *   |葉なら1   |キーの数  |リンク             |キー0     |キー1     |
+ *   |(2バイト) |(2バイト) |(sizeof(int)バイト)|          |          | ...
+ *   +----------+----------+-------------------+----------+----------+----
+ *   葉のキーは[値(keySizeバイト)][ページ番号][スロット番号]で、リンクは右隣の葉
+ *   (なければ-1)。内部ノードのキーはその後ろに右側の子のページ番号が続き、
+ *   リンクは一番左の子。子iには、キーi-1以上キーi未満のキーが入っている。
+ *
+ * ハッシュ索引のバケットのページも葉と同じ形で、リンクはオーバーフローページ
+ * (なければ-1)。バケットbの最初のページは 1 + b + spares[分割点(b)] ページ目にある。
+ * 分割点kのバケット(2^(k-1)以上2^k未満の番号)のページは、その最初のバケットを
+ * 作るときにまとめて確保するので、バケットとページの対応表は要らない。
+ *
+ * ビットマップ索引では、rootPageから始まる葉と同じ形のページの並びが値の一覧で、
+ * キーは[値][その値のディレクトリのページ番号][未使用]になる(値の順ではなく、現れた順)。
+ * レコードのビットの番号は ページ番号 * bitsPerPage + スロット番号 で、
+ * ビットはCHUNK_BITSずつのチャンクに分け、チャンクごとに1ページのコンテナに入れる。
+ * ディレクトリ:
+ *   +----------+-------------------+----------------+----------------+----
+ *   |未使用    |リンク             |チャンク0の     |チャンク1の     |
+ *   |(4バイト) |(sizeof(int)バイト)|コンテナ       |コンテナ       | ...
+ *   +----------+-------------------+----------------+----------------+----
+ *   コンテナのページ番号はなければ-1で、入りきらなければリンクで次のディレクトリにつなぐ。
+ * コンテナ:
+ *   +-------------------+-------------------+---------------------------------
+ *   |種類               |立っているビットの数|データ
+ *   |(sizeof(int)バイト)|(sizeof(int)バイト)|
+ *   +-------------------+-------------------+---------------------------------
+ *   ビットが少ないうちはチャンクの中でのビットの番号(unsigned short)を昇順に並べた
+ *   配列にし、配列が一杯になったらビットマップに変える(Roaringビットマップと同じ考え方)。
+ *   削除でビットが配列の上限の半分より少なくなったら配列に戻す。
+ */
+
+/*
+ * TRIGRAM_KEY_SIZE -- トライグラム索引の値の大きさ(3文字と終端文字)
+ */
+#define TRIGRAM_KEY_SIZE 4
+
+/*
+ * HASH_FILL_PERCENT -- ハッシュ索引のバケットを分割する、キーの数の割合(%)
+ *
+ * キーの数が、全バケットの最初のページに入る数のこの割合を超えたら分割する。
+ */
+#define HASH_FILL_PERCENT 75
+
+/*
+ * IndexHeader -- 索引ファイルのヘッダ
+ */
+typedef struct IndexHeader IndexHeader;
+struct IndexHeader {
+    int magic;                          /* INDEX_MAGIC */
+    int rootPage;                       /* 根のノードのページ番号 */
+    int numPage;                        /* 索引ファイルのページ数 */
+    int field;                          /* 索引を作ったフィールドの番号 */
+    DataType keyType;                   /* 値のデータ型 */
+    int keySize;                        /* 値の大きさ(バイト数) */
+    char tableName[MAX_FILENAME];       /* 索引を作ったテーブルの名前 */
+    IndexType type;                     /* 索引の種類 */
+    int numBucket;                      /* バケット数(ハッシュ) */
+    int numEntry;                       /* キーの数(ハッシュ) */
+    int freePage;                       /* 空いたオーバーフローページのリストの先頭(ハッシュ) */
+    int spares[MAX_HASH_SPLITPOINT];    /* 分割点ごとの、それより前のオーバーフローページ数(ハッシュ) */
+    int bitsPerPage;                    /* データファイルの1ページあたりのビット数(ビットマップ) */
+};
+
+/*
+ * ビットマップ索引のコンテナの情報を読み書きするマクロ
+ */
+#define BITMAP_CONTAINER_HEADER_SIZE 8
+#define CONTAINER_TYPE(page) (((int *) (page))[0])
+#define CONTAINER_CARD(page) (((int *) (page))[1])
+#define CONTAINER_DATA(page) ((page) + BITMAP_CONTAINER_HEADER_SIZE)
+
+/*
+ * CONTAINER_ARRAY, CONTAINER_BITMAP -- コンテナの種類
+ */
+#define CONTAINER_ARRAY 0
+#define CONTAINER_BITMAP 1
+
+/*
+ * CHUNK_BITS -- 1つのコンテナに入るビットの数(1ページのビットマップの大きさ)
+ * ARRAY_MAX_VALUES -- 配列のコンテナに入るビットの番号の数
+ */
+#define CHUNK_BITS ((PAGE_SIZE - BITMAP_CONTAINER_HEADER_SIZE) * 8)
+#define ARRAY_MAX_VALUES ((int) ((PAGE_SIZE - BITMAP_CONTAINER_HEADER_SIZE) / sizeof(unsigned short)))
+
+/*
+ * BITMAP_DIR_ENTRIES -- 1ページのディレクトリに入るコンテナのページ番号の数
+ * DIR_ENTRY -- ディレクトリのi番目のコンテナのページ番号
+ */
+#define BITMAP_DIR_ENTRIES ((int) ((PAGE_SIZE - INDEX_NODE_HEADER_SIZE) / sizeof(int)))
+#define DIR_ENTRY(node, i) (((int *) ((node) + INDEX_NODE_HEADER_SIZE))[i])
+
+static Result insertHashEntry(Index *index, char *key, RecordId *rid);
+static Result deleteHashEntry(Index *index, char *key, RecordId *rid);
+static RecordId *searchHash(Index *index, char *key, int *numRid);
+static Result setBitmapBit(Index *index, char *key, RecordId *rid, int value);
+static Result searchBitmap(Index *index, Condition *condition, char *key, char *pages, int numPage);
+static int makeTrigrams(char *value, char *trigrams);
+static RecordId *searchTrigram(Index *index, char *pattern, int *numRid);
+
+/*
+ * ノードのページの情報を読み書きするマクロ
+ */
+#define NODE_IS_LEAF(node) (((short *) (node))[0])
+#define NODE_NUM_KEY(node) (((short *) (node))[1])
+#define NODE_LINK(node) (((int *) (node))[1])
+
+/*
+ * LEAF_ENTRY_SIZE, INNER_ENTRY_SIZE -- 葉と内部ノードのキー1つの大きさ
+ */
+#define LEAF_ENTRY_SIZE(index) ((index)->keySize + 2 * sizeof(int))
+#define INNER_ENTRY_SIZE(index) ((index)->keySize + 3 * sizeof(int))
+
+/*
+ * NODE_ENTRY -- ノードのi番目のキーの番地
+ */
+#define NODE_ENTRY(index, node, i) \
+    ((node) + INDEX_NODE_HEADER_SIZE \
+     + (i) * (NODE_IS_LEAF(node) ? LEAF_ENTRY_SIZE(index) : INNER_ENTRY_SIZE(index)))
+
+/*
+ * makeIndexFileName -- 索引ファイルのファイル名を作る
+ */
+static void makeIndexFileName(char *filename, char *indexName)
+{
+    snprintf(filename, MAX_FILENAME, "%s%s", indexName, INDEX_FILE_EXT);
+}
+
+/*
+ * getMaxKeys -- ノードに入るキーの数の上限
+ */
+static int getMaxKeys(Index *index, char *node)
+{
+    return (PAGE_SIZE - INDEX_NODE_HEADER_SIZE)
+        / (NODE_IS_LEAF(node) ? LEAF_ENTRY_SIZE(index) : INNER_ENTRY_SIZE(index));
+}
+
+/*
+ * makeKey -- フィールドの値から、キーの値の部分を作る
+ */
+static void makeKey(Index *index, FieldData *fieldData, char *key)
+{
+    memset(key, 0, index->keySize);
+    if (index->keyType == TYPE_INTEGER) {
+        memcpy(key, &fieldData->intValue, sizeof(int));
+    } else {
+        strncpy(key, fieldData->stringValue, index->keySize - 1);
+    }
+}
+
+/*
+ * compareKey -- キーの値の部分どうしの比較
+ */
+static int compareKey(Index *index, char *a, char *b)
+{
+    int x, y;
+
+    if (index->keyType == TYPE_INTEGER) {
+        memcpy(&x, a, sizeof(int));
+        memcpy(&y, b, sizeof(int));
+        return x < y ? -1 : x > y;
+    }
+    return strncmp(a, b, index->keySize);
+}
+
+/*
+ * compareEntry -- (値, RecordId)の組と、ノードのキーとの比較
+ */
+static int compareEntry(Index *index, char *key, RecordId *rid, char *entry)
+{
+    int cmp;
+    int n;
+
+    if ((cmp = compareKey(index, key, entry)) != 0) {
+        return cmp;
+    }
+    memcpy(&n, entry + index->keySize, sizeof(int));
+    if (rid->pageNum != n) {
+        return rid->pageNum < n ? -1 : 1;
+    }
+    memcpy(&n, entry + index->keySize + sizeof(int), sizeof(int));
+    return rid->slot < n ? -1 : rid->slot > n;
+}
+
+/*
+ * setEntry -- ノードのキーに(値, RecordId)の組を書き込む
+ */
+static void setEntry(Index *index, char *entry, char *key, RecordId *rid)
+{
+    memcpy(entry, key, index->keySize);
+    memcpy(entry + index->keySize, &rid->pageNum, sizeof(int));
+    memcpy(entry + index->keySize + sizeof(int), &rid->slot, sizeof(int));
+}
+
+/*
+ * getEntryRid -- ノードのキーのRecordIdの部分を取り出す
+ */
+static void getEntryRid(Index *index, char *entry, RecordId *rid)
+{
+    memcpy(&rid->pageNum, entry + index->keySize, sizeof(int));
+    memcpy(&rid->slot, entry + index->keySize + sizeof(int), sizeof(int));
+}
+
+/*
+ * getChild -- 内部ノードのi番目の子のページ番号
+ */
+static int getChild(Index *index, char *node, int i)
+{
+    int child;
+
+    if (i == 0) {
+        return NODE_LINK(node);
+    }
+    memcpy(&child, NODE_ENTRY(index, node, i - 1) + index->keySize + 2 * sizeof(int), sizeof(int));
+    return child;
+}
+
+/*
+ * findPosition -- ノードの中で、(値, RecordId)の組より大きい最初のキーの位置
+ *
+ * 内部ノードでは、この位置の子に組が入っている。
+ */
+static int findPosition(Index *index, char *node, char *key, RecordId *rid)
+{
+    int low = 0;
+    int high = NODE_NUM_KEY(node);
+    int mid;
+
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (compareEntry(index, key, rid, NODE_ENTRY(index, node, mid)) >= 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/*
+ * allocateNode -- 索引ファイルの末尾に新しいノードのページを割り当てる
+ */
+static int allocateNode(Index *index)
+{
+    index->headerModified = 1;
+    return index->numPage++;
+}
+
+/*
+ * writeIndexHeader -- ヘッダを0ページ目に書き出す
+ */
+static Result writeIndexHeader(Index *index)
+{
+    char page[PAGE_SIZE];
+    IndexHeader header;
+
+    memset(page, 0, PAGE_SIZE);
+    memset(&header, 0, sizeof(header));
+    header.magic = INDEX_MAGIC;
+    header.rootPage = index->rootPage;
+    header.numPage = index->numPage;
+    header.field = index->field;
+    header.keyType = index->keyType;
+    header.keySize = index->keySize;
+    strcpy(header.tableName, index->tableName);
+    header.type = index->type;
+    header.numBucket = index->numBucket;
+    header.numEntry = index->numEntry;
+    header.freePage = index->freePage;
+    memcpy(header.spares, index->spares, sizeof(header.spares));
+    header.bitsPerPage = index->bitsPerPage;
+    memcpy(page, &header, sizeof(header));
+
+    if (writePage(index->file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    index->headerModified = 0;
+    return OK;
+}
+
+/*
+ * createIndexFile -- 空の索引ファイルの作成
+ *
+ * 引数:
+ *	indexName: 索引名
+ *	tableName: 索引を作るテーブルの名前
+ *	tableInfo: テーブルのデータ定義情報
+ *	field: 索引を作るフィールドの番号
+ *	type: 索引の種類
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result createIndexFile(char *indexName, char *tableName, TableInfo *tableInfo, int field, IndexType type)
+{
+    char filename[MAX_FILENAME];
+    char node[PAGE_SIZE];
+    Index index;
+
+    makeIndexFileName(filename, indexName);
+    if (createFile(filename) != OK) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        return NG;
+    }
+    if ((index.file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+
+    /* 文字列は、テーブルに格納できる最大の長さと終端文字の分を値の大きさにする */
+    index.field = field;
+    index.keyType = tableInfo->fieldInfo[field].dataType;
+    if (index.keyType == TYPE_INTEGER) {
+        index.keySize = sizeof(int);
+    } else if (type == INDEX_TRIGRAM) {
+        index.keySize = TRIGRAM_KEY_SIZE;
+    } else if (tableInfo->option.layout == LAYOUT_SLOTTED) {
+        index.keySize = MAX_VARSTRING;
+    } else {
+        index.keySize = MAX_STRING + 1;
+    }
+    snprintf(index.tableName, MAX_FILENAME, "%s", tableName);
+
+    /* B+木とトライグラムなら根は空の葉、ハッシュなら1ページ目が空のバケット0、ビットマップなら空の値の一覧 */
+    memset(node, 0, PAGE_SIZE);
+    NODE_IS_LEAF(node) = 1;
+    NODE_NUM_KEY(node) = 0;
+    NODE_LINK(node) = -1;
+    index.type = type;
+    index.rootPage = 1;
+    index.numPage = 2;
+    index.numBucket = 1;
+    index.numEntry = 0;
+    index.freePage = -1;
+    memset(index.spares, 0, sizeof(index.spares));
+    index.bitsPerPage = getMaxRecordsPerPage(tableInfo);
+    if (writePage(index.file, 1, node) != OK || writeIndexHeader(&index) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        closeFile(index.file);
+        return NG;
+    }
+
+    return closeFile(index.file);
+}
+
+/*
+ * deleteIndexFile -- 索引ファイルの削除
+ *
+ * 引数:
+ *	indexName: 索引名
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result deleteIndexFile(char *indexName)
+{
+    char filename[MAX_FILENAME];
+
+    makeIndexFileName(filename, indexName);
+    return deleteFile(filename);
+}
+
+/*
+ * openIndex -- 索引のオープン
+ *
+ * 引数:
+ *	indexName: 索引名
+ *
+ * 返り値:
+ *	オープンした索引
+ *	ファイルがない場合や壊れている場合はNULLを返す
+ *
+ * ***注意***
+ *	使い終わったら必ずcloseIndexでクローズすること。
+ */
+Index *openIndex(char *indexName)
+{
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    IndexHeader header;
+    Index *index;
+
+    makeIndexFileName(filename, indexName);
+    if (getNumPages(filename) < 2) {
+        return NULL;
+    }
+    if ((index = (Index *) malloc(sizeof(Index))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    if ((index->file = openFile(filename)) == NULL) {
+        free(index);
+        return NULL;
+    }
+
+    /* ヘッダを読み込む */
+    if (readPage(index->file, 0, page) != OK) {
+        closeFile(index->file);
+        free(index);
+        return NULL;
+    }
+    memcpy(&header, page, sizeof(header));
+    if (header.magic != INDEX_MAGIC) {
+        closeFile(index->file);
+        free(index);
+        return NULL;
+    }
+
+    index->rootPage = header.rootPage;
+    index->numPage = header.numPage;
+    index->field = header.field;
+    index->keyType = header.keyType;
+    index->keySize = header.keySize;
+    memcpy(index->tableName, header.tableName, MAX_FILENAME);
+    index->tableName[MAX_FILENAME - 1] = '\0';
+    index->type = header.type;
+    index->numBucket = header.numBucket;
+    index->numEntry = header.numEntry;
+    index->freePage = header.freePage;
+    memcpy(index->spares, header.spares, sizeof(index->spares));
+    index->bitsPerPage = header.bitsPerPage;
+    index->headerModified = 0;
+    return index;
+}
+
+/*
+ * closeIndex -- 索引のクローズ
+ *
+ * 引数:
+ *	index: クローズする索引
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result closeIndex(Index *index)
+{
+    Result result = OK;
+
+    if (index->headerModified) {
+        result = writeIndexHeader(index);
+    }
+    if (closeFile(index->file) != OK) {
+        result = NG;
+    }
+    free(index);
+    return result;
+}
+
+/*
+ * insertIntoNode -- pageNumのノードを根とする部分木への(値, RecordId)の組の挿入
+ *
+ * 返り値:
+ *	ノードが分割されなければ0、分割されたら1、エラーなら-1を返す
+ *	分割されたときは、新しい右側のノードの最小のキーをupKeyとupRidに、
+ *	そのページ番号をupChildに設定する。
+ */
+static int insertIntoNode(Index *index, int pageNum, char *key, RecordId *rid,
+                          char *upKey, RecordId *upRid, int *upChild)
+{
+    char node[PAGE_SIZE];
+    char right[PAGE_SIZE];
+    char work[2 * PAGE_SIZE];
+    char childKey[MAX_VARSTRING];
+    RecordId childRid;
+    int child;
+    int entrySize;
+    int numKey;
+    int pos;
+    int half;
+    int result;
+
+    if (readPage(index->file, pageNum, node) != OK) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        return -1;
+    }
+    pos = findPosition(index, node, key, rid);
+
+    if (!NODE_IS_LEAF(node)) {
+        /* 子に挿入し、子が分割されなければ終わり */
+        result = insertIntoNode(index, getChild(index, node, pos), key, rid, childKey, &childRid, &child);
+        if (result != 1) {
+            return result;
+        }
+        key = childKey;
+        rid = &childRid;
+    }
+
+    /* 作業領域に、pos番目に新しいキーを入れたキーの並びを作る */
+    entrySize = NODE_IS_LEAF(node) ? LEAF_ENTRY_SIZE(index) : INNER_ENTRY_SIZE(index);
+    numKey = NODE_NUM_KEY(node);
+    memcpy(work, NODE_ENTRY(index, node, 0), pos * entrySize);
+    setEntry(index, work + pos * entrySize, key, rid);
+    if (!NODE_IS_LEAF(node)) {
+        memcpy(work + pos * entrySize + index->keySize + 2 * sizeof(int), &child, sizeof(int));
+    }
+    memcpy(work + (pos + 1) * entrySize, NODE_ENTRY(index, node, pos), (numKey - pos) * entrySize);
+    numKey++;
+
+    /* ノードに収まれば書き戻して終わり */
+    if (numKey <= getMaxKeys(index, node)) {
+        memcpy(NODE_ENTRY(index, node, 0), work, numKey * entrySize);
+        NODE_NUM_KEY(node) = numKey;
+        if (writePage(index->file, pageNum, node) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            return -1;
+        }
+        return 0;
+    }
+
+    /*
+     * 収まらなければ半分ずつに分ける
+     * 葉では右側の最小のキーを親にコピーし、内部ノードでは真ん中のキーを親に移す
+     */
+    half = numKey / 2;
+    memset(right, 0, PAGE_SIZE);
+    NODE_IS_LEAF(right) = NODE_IS_LEAF(node);
+    *upChild = allocateNode(index);
+    memcpy(upKey, work + half * entrySize, index->keySize);
+    getEntryRid(index, work + half * entrySize, upRid);
+    if (NODE_IS_LEAF(node)) {
+        NODE_NUM_KEY(right) = numKey - half;
+        memcpy(NODE_ENTRY(index, right, 0), work + half * entrySize, (numKey - half) * entrySize);
+        NODE_LINK(right) = NODE_LINK(node);
+        NODE_LINK(node) = *upChild;
+    } else {
+        NODE_NUM_KEY(right) = numKey - half - 1;
+        memcpy(NODE_ENTRY(index, right, 0), work + (half + 1) * entrySize, (numKey - half - 1) * entrySize);
+        memcpy(&NODE_LINK(right), work + half * entrySize + index->keySize + 2 * sizeof(int), sizeof(int));
+    }
+    NODE_NUM_KEY(node) = half;
+    memcpy(NODE_ENTRY(index, node, 0), work, half * entrySize);
+
+    if (writePage(index->file, pageNum, node) != OK || writePage(index->file, *upChild, right) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return -1;
+    }
+    return 1;
+}
+
+/*
+ * insertBtreeEntry -- B+木への(値, RecordId)の組の挿入
+ */
+static Result insertBtreeEntry(Index *index, char *key, RecordId *rid)
+{
+    char upKey[MAX_VARSTRING];
+    char node[PAGE_SIZE];
+    RecordId upRid;
+    int upChild;
+    int result;
+
+    if ((result = insertIntoNode(index, index->rootPage, key, rid, upKey, &upRid, &upChild)) == -1) {
+        return NG;
+    }
+
+    /* 根が分割されたら、2つの子を持つ新しい根を作る */
+    if (result == 1) {
+        memset(node, 0, PAGE_SIZE);
+        NODE_IS_LEAF(node) = 0;
+        NODE_NUM_KEY(node) = 1;
+        NODE_LINK(node) = index->rootPage;
+        setEntry(index, NODE_ENTRY(index, node, 0), upKey, &upRid);
+        memcpy(NODE_ENTRY(index, node, 0) + index->keySize + 2 * sizeof(int), &upChild, sizeof(int));
+        index->rootPage = allocateNode(index);
+        if (writePage(index->file, index->rootPage, node) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            return NG;
+        }
+    }
+    return OK;
+}
+
+/*
+ * insertIndexEntry -- 索引へのキーの挿入
+ *
+ * 引数:
+ *	index: 索引
+ *	fieldData: レコードの索引を作ったフィールドの値
+ *	rid: レコードの位置
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result insertIndexEntry(Index *index, FieldData *fieldData, RecordId *rid)
+{
+    char key[MAX_VARSTRING];
+    char trigrams[MAX_VARSTRING * TRIGRAM_KEY_SIZE];
+    int numTrigram;
+    int i;
+
+    if (index->type == INDEX_TRIGRAM) {
+        numTrigram = makeTrigrams(fieldData->stringValue, trigrams);
+        for (i = 0; i < numTrigram; i++) {
+            if (insertBtreeEntry(index, trigrams + i * TRIGRAM_KEY_SIZE, rid) != OK) {
+                return NG;
+            }
+        }
+        return OK;
+    }
+    makeKey(index, fieldData, key);
+    if (index->type == INDEX_HASH) {
+        return insertHashEntry(index, key, rid);
+    }
+    if (index->type == INDEX_BITMAP) {
+        return setBitmapBit(index, key, rid, 1);
+    }
+    return insertBtreeEntry(index, key, rid);
+}
+
+/*
+ * findLeaf -- (値, RecordId)の組が入るはずの葉を読み込む
+ *
+ * 返り値:
+ *	葉のページ番号。エラーなら-1を返す。
+ */
+static int findLeaf(Index *index, char *key, RecordId *rid, char *node)
+{
+    int pageNum = index->rootPage;
+
+    for (;;) {
+        if (readPage(index->file, pageNum, node) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return -1;
+        }
+        if (NODE_IS_LEAF(node)) {
+            return pageNum;
+        }
+        pageNum = getChild(index, node, findPosition(index, node, key, rid));
+    }
+}
+
+/*
+ * deleteBtreeEntry -- B+木からの(値, RecordId)の組の削除
+ */
+static Result deleteBtreeEntry(Index *index, char *key, RecordId *rid)
+{
+    char node[PAGE_SIZE];
+    int entrySize = LEAF_ENTRY_SIZE(index);
+    int pageNum;
+    int pos;
+
+    if ((pageNum = findLeaf(index, key, rid, node)) == -1) {
+        return NG;
+    }
+
+    /* 組より大きい最初のキーの1つ前が、組と同じキーのはず */
+    pos = findPosition(index, node, key, rid) - 1;
+    if (pos < 0 || compareEntry(index, key, rid, NODE_ENTRY(index, node, pos)) != 0) {
+        return OK;
+    }
+    memmove(NODE_ENTRY(index, node, pos), NODE_ENTRY(index, node, pos + 1),
+            (NODE_NUM_KEY(node) - pos - 1) * entrySize);
+    NODE_NUM_KEY(node)--;
+    if (writePage(index->file, pageNum, node) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    return OK;
+}
+
+/*
+ * deleteIndexEntry -- 索引からのキーの削除
+ *
+ * 引数:
+ *	index: 索引
+ *	fieldData: 削除したレコードの索引を作ったフィールドの値
+ *	rid: 削除したレコードの位置
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す(キーがなくてもOKを返す)
+ */
+Result deleteIndexEntry(Index *index, FieldData *fieldData, RecordId *rid)
+{
+    char key[MAX_VARSTRING];
+    char trigrams[MAX_VARSTRING * TRIGRAM_KEY_SIZE];
+    int numTrigram;
+    int i;
+
+    if (index->type == INDEX_TRIGRAM) {
+        numTrigram = makeTrigrams(fieldData->stringValue, trigrams);
+        for (i = 0; i < numTrigram; i++) {
+            if (deleteBtreeEntry(index, trigrams + i * TRIGRAM_KEY_SIZE, rid) != OK) {
+                return NG;
+            }
+        }
+        return OK;
+    }
+    makeKey(index, fieldData, key);
+    if (index->type == INDEX_HASH) {
+        return deleteHashEntry(index, key, rid);
+    }
+    if (index->type == INDEX_BITMAP) {
+        return setBitmapBit(index, key, rid, 0);
+    }
+    return deleteBtreeEntry(index, key, rid);
+}
+
+/*
+ * searchBtree -- B+木の、値が条件(=、<、>)に合うキーの検索
+ *
+ * 返り値:
+ *	見つかったキーのレコードの位置の配列(値の順、同じ値の中では位置の順)。エラーならNULLを返す。
+ */
+static RecordId *searchBtree(Index *index, OperatorType operator, char *key, int *numRid)
+{
+    char node[PAGE_SIZE];
+    RecordId bound;
+    RecordId *rids = NULL;
+    RecordId *p;
+    int capacity = 0;
+    int pageNum;
+    int pos;
+    int cmp;
+
+    /*
+     * 探し始める葉と位置を決める
+     * =なら値が同じ最初のキー、>なら値が大きい最初のキー、<なら一番左のキーから
+     */
+    bound.pageNum = bound.slot = operator == OPR_GREATER_THAN ? INT_MAX : -1;
+    if (operator == OPR_LESS_THAN) {
+        for (pageNum = index->rootPage; ; pageNum = NODE_LINK(node)) {
+            if (readPage(index->file, pageNum, node) != OK) {
+                printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+                return NULL;
+            }
+            if (NODE_IS_LEAF(node)) {
+                break;
+            }
+        }
+        pos = 0;
+    } else {
+        if (findLeaf(index, key, &bound, node) == -1) {
+            return NULL;
+        }
+        pos = findPosition(index, node, key, &bound);
+    }
+
+    /* 葉を右にたどりながら、条件に合うキーを集める */
+    *numRid = 0;
+    for (;;) {
+        for (; pos < NODE_NUM_KEY(node); pos++) {
+            cmp = compareKey(index, NODE_ENTRY(index, node, pos), key);
+            if ((operator == OPR_EQUAL && cmp != 0) || (operator == OPR_LESS_THAN && cmp >= 0)) {
+                return rids != NULL ? rids : (RecordId *) malloc(sizeof(RecordId));
+            }
+            if (*numRid == capacity) {
+                capacity = capacity == 0 ? 16 : capacity * 2;
+                if ((p = (RecordId *) realloc(rids, capacity * sizeof(RecordId))) == NULL) {
+                    printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+                    free(rids);
+                    return NULL;
+                }
+                rids = p;
+            }
+            getEntryRid(index, NODE_ENTRY(index, node, pos), &rids[(*numRid)++]);
+        }
+
+        if ((pageNum = NODE_LINK(node)) == -1) {
+            break;
+        }
+        if (readPage(index->file, pageNum, node) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            free(rids);
+            return NULL;
+        }
+        pos = 0;
+    }
+
+    return rids != NULL ? rids : (RecordId *) malloc(sizeof(RecordId));
+}
+
+/*
+ * searchIndex -- 条件に合うレコードの位置の検索
+ *
+ * 引数:
+ *	index: 索引
+ *	condition: 索引を作ったフィールドについての条件
+ *	numRid: 見つかったレコードの数を格納する場所
+ *
+ * 返り値:
+ *	条件に合うレコードの位置の配列(値の順、同じ値の中では位置の順)。
+ *	使い終わったらfreeで解放すること。
+ *	索引を使えない条件(!=やlike、データ型が違う、文字列が長すぎる、ハッシュ索引で=でない)や
+ *	ビットマップ索引とトライグラム索引の場合、エラーの場合はNULLを返す。
+ */
+RecordId *searchIndex(Index *index, Condition *condition, int *numRid)
+{
+    char key[MAX_VARSTRING];
+    FieldData fieldData;
+
+    if (index->type == INDEX_BITMAP || index->type == INDEX_TRIGRAM || condition->dataType != index->keyType
+        || (condition->operator != OPR_EQUAL && condition->operator != OPR_GREATER_THAN
+            && condition->operator != OPR_LESS_THAN)
+        || (condition->dataType == TYPE_STRING && strlen(condition->stringValue) >= (size_t)index->keySize)) {
+        /* 値の大きさに収まらない文字列は、切り詰めると大小関係が変わることがある */
+        return NULL;
+    }
+    fieldData.intValue = condition->intValue;
+    strcpy(fieldData.stringValue, condition->stringValue);
+    makeKey(index, &fieldData, key);
+    if (index->type == INDEX_HASH) {
+        return condition->operator == OPR_EQUAL ? searchHash(index, key, numRid) : NULL;
+    }
+    return searchBtree(index, condition->operator, key, numRid);
+}
+
+/*
+ * comparePageNum -- レコードの位置のページ番号の比較(qsort用)
+ */
+static int comparePageNum(const void *a, const void *b)
+{
+    return ((RecordId *) a)->pageNum - ((RecordId *) b)->pageNum;
+}
+
+/*
+ * makePageList -- レコードの位置の配列から、ページ番号を昇順に並べた配列を作る
+ *
+ * ridsは並べ替えてから解放する。
+ */
+static int *makePageList(RecordId *rids, int numRid, int numPage, int *numListed)
+{
+    int *pageList;
+    int i;
+
+    /* レコードの位置をページ番号の順に並べ、同じページを1つにまとめる */
+    qsort(rids, numRid, sizeof(RecordId), comparePageNum);
+    if ((pageList = (int *) malloc((numRid + 1) * sizeof(int))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        free(rids);
+        return NULL;
+    }
+    *numListed = 0;
+    for (i = 0; i < numRid; i++) {
+        if (rids[i].pageNum < numPage
+            && (*numListed == 0 || pageList[*numListed - 1] != rids[i].pageNum)) {
+            pageList[(*numListed)++] = rids[i].pageNum;
+        }
+    }
+    free(rids);
+    return pageList;
+}
+
+/*
+ * searchIndexPages -- 条件に合うレコードがあるデータファイルのページの検索
+ *
+ * 引数:
+ *	index: 索引
+ *	condition: 索引を作ったフィールドについての条件
+ *	numPage: データファイルのページ数(これ以上の番号のページは返さない)
+ *	numListed: 見つかったページの数を格納する場所
+ *
+ * 返り値:
+ *	条件に合うレコードがあるページの番号を昇順に並べた配列。使い終わったらfreeで解放すること。
+ *	索引を使えない条件の場合やエラーの場合はNULLを返す。
+ *
+ * B+木とハッシュ索引ではsearchIndexで見つけたレコードの位置をページ番号にまとめ、
+ * ビットマップ索引では合う値のビットマップから直接ページを求める(!=やlikeにも使える)。
+ * トライグラム索引ではlikeの条件に合うかもしれないレコードのページを返すので、
+ * ページの中で改めて条件と比べること。
+ */
+int *searchIndexPages(Index *index, Condition *condition, int numPage, int *numListed)
+{
+    char key[MAX_VARSTRING];
+    FieldData fieldData;
+    RecordId *rids;
+    char *pages;
+    int *pageList;
+    int numRid;
+    int i;
+
+    if (index->type == INDEX_TRIGRAM) {
+        if (condition->operator != OPR_LIKE || condition->dataType != TYPE_STRING
+            || (rids = searchTrigram(index, condition->stringValue, &numRid)) == NULL) {
+            return NULL;
+        }
+        return makePageList(rids, numRid, numPage, numListed);
+    }
+    if (index->type != INDEX_BITMAP) {
+        if ((rids = searchIndex(index, condition, &numRid)) == NULL) {
+            return NULL;
+        }
+        return makePageList(rids, numRid, numPage, numListed);
+    }
+
+    /* ビットマップ索引では、データファイルのページごとに印を付けてから並べる */
+    if (condition->dataType != index->keyType
+        || (condition->dataType == TYPE_STRING && strlen(condition->stringValue) >= (size_t)index->keySize)) {
+        return NULL;
+    }
+    fieldData.intValue = condition->intValue;
+    strcpy(fieldData.stringValue, condition->stringValue);
+    makeKey(index, &fieldData, key);
+    if ((pages = (char *) calloc(numPage + 1, 1)) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    if (searchBitmap(index, condition, key, pages, numPage) != OK) {
+        free(pages);
+        return NULL;
+    }
+    if ((pageList = (int *) malloc((numPage + 1) * sizeof(int))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        free(pages);
+        return NULL;
+    }
+    *numListed = 0;
+    for (i = 0; i < numPage; i++) {
+        if (pages[i]) {
+            pageList[(*numListed)++] = i;
+        }
+    }
+    free(pages);
+    return pageList;
+}
+
+/*
+ * hashKey -- キーの値の部分のハッシュ値(FNV-1a)
+ */
+static unsigned int hashKey(Index *index, char *key)
+{
+    unsigned int hash = 2166136261u;
+    int n;
+    int i;
+
+    n = index->keyType == TYPE_INTEGER ? (int) sizeof(int) : (int) strnlen(key, index->keySize);
+    for (i = 0; i < n; i++) {
+        hash = (hash ^ (unsigned char) key[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * getSplitpoint -- バケットの番号の分割点(番号を表すのに必要なビット数)
+ */
+static int getSplitpoint(int bucket)
+{
+    int k = 0;
+
+    while (bucket > 0) {
+        bucket >>= 1;
+        k++;
+    }
+    return k;
+}
+
+/*
+ * getBucket -- ハッシュ値からバケットの番号を求める
+ *
+ * 最後のバケットの番号を表せるビット数で切り取り、まだないバケットになったら
+ * 1ビット少なく切り取る(分割前のバケット)。
+ */
+static int getBucket(Index *index, unsigned int hash)
+{
+    unsigned int highMask = (1u << getSplitpoint(index->numBucket - 1)) - 1;
+    unsigned int bucket = hash & highMask;
+
+    if (bucket >= (unsigned int) index->numBucket) {
+        bucket = hash & (highMask >> 1);
+    }
+    return bucket;
+}
+
+/*
+ * getBucketPage -- バケットの最初のページの番号
+ */
+static int getBucketPage(Index *index, int bucket)
+{
+    return 1 + bucket + index->spares[getSplitpoint(bucket)];
+}
+
+/*
+ * allocateOverflowPage -- オーバーフローページの割り当て
+ *
+ * 分割で空いたページがあればそれを使い、なければ索引ファイルの末尾に割り当てる。
+ */
+static int allocateOverflowPage(Index *index)
+{
+    char node[PAGE_SIZE];
+    int pageNum;
+
+    if ((pageNum = index->freePage) == -1) {
+        return allocateNode(index);
+    }
+    if (readPage(index->file, pageNum, node) != OK) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        return -1;
+    }
+    index->freePage = NODE_LINK(node);
+    index->headerModified = 1;
+    return pageNum;
+}
+
+/*
+ * writeBucket -- キーの並びを、バケットのページとオーバーフローページに書き込む
+ *
+ * spareにある使い回せるページを先に使い、足りなければ新しく割り当てる。
+ */
+static Result writeBucket(Index *index, int pageNum, char *entries, int numEntry, int *spare, int *numSpare)
+{
+    char node[PAGE_SIZE];
+    int entrySize = LEAF_ENTRY_SIZE(index);
+    int maxKeys;
+    int n;
+
+    memset(node, 0, PAGE_SIZE);
+    NODE_IS_LEAF(node) = 1;
+    maxKeys = getMaxKeys(index, node);
+    for (;;) {
+        n = numEntry < maxKeys ? numEntry : maxKeys;
+        NODE_NUM_KEY(node) = n;
+        memcpy(NODE_ENTRY(index, node, 0), entries, n * entrySize);
+        entries += n * entrySize;
+        numEntry -= n;
+        if (numEntry == 0) {
+            NODE_LINK(node) = -1;
+        } else if (*numSpare > 0) {
+            NODE_LINK(node) = spare[--(*numSpare)];
+        } else if ((NODE_LINK(node) = allocateOverflowPage(index)) == -1) {
+            return NG;
+        }
+        if (writePage(index->file, pageNum, node) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            return NG;
+        }
+        if (numEntry == 0) {
+            return OK;
+        }
+        pageNum = NODE_LINK(node);
+    }
+}
+
+/*
+ * splitHashBucket -- バケットを1つ増やし、分割前のバケットのキーを振り分ける
+ */
+static Result splitHashBucket(Index *index)
+{
+    char node[PAGE_SIZE];
+    char *entries = NULL;
+    char *moved;
+    char *p;
+    int *spare = NULL;
+    int *q;
+    int numSpare = 0;
+    int entrySize = LEAF_ENTRY_SIZE(index);
+    int newBucket = index->numBucket;
+    int oldBucket;
+    int numEntry = 0;
+    int numMoved = 0;
+    int numKept = 0;
+    int splitpoint = getSplitpoint(newBucket);
+    int pageNum;
+    int i;
+
+    if (splitpoint >= MAX_HASH_SPLITPOINT) {
+        return OK;
+    }
+
+    /* 分割前のバケットのキーをすべて読み込む(オーバーフローページは使い回す) */
+    oldBucket = newBucket & ((1 << (splitpoint - 1)) - 1);
+    for (pageNum = getBucketPage(index, oldBucket); pageNum != -1; pageNum = NODE_LINK(node)) {
+        if (readPage(index->file, pageNum, node) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            free(entries);
+            free(spare);
+            return NG;
+        }
+        if ((p = (char *) realloc(entries, (numEntry + NODE_NUM_KEY(node)) * entrySize + 1)) == NULL
+            || (q = (int *) realloc(spare, (numSpare + 1) * sizeof(int))) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            free(p != NULL ? p : entries);
+            free(spare);
+            return NG;
+        }
+        entries = p;
+        spare = q;
+        memcpy(entries + numEntry * entrySize, NODE_ENTRY(index, node, 0), NODE_NUM_KEY(node) * entrySize);
+        numEntry += NODE_NUM_KEY(node);
+        if (pageNum != getBucketPage(index, oldBucket)) {
+            spare[numSpare++] = pageNum;
+        }
+    }
+    if ((moved = (char *) malloc(numEntry * entrySize + 1)) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        free(entries);
+        free(spare);
+        return NG;
+    }
+
+    /* 分割点の最初のバケットなら、その分割点のバケットのページをまとめて確保する */
+    if (newBucket == 1 << (splitpoint - 1)) {
+        index->spares[splitpoint] = index->numPage - 1 - newBucket;
+        index->numPage += newBucket;
+    }
+    index->numBucket++;
+    index->headerModified = 1;
+
+    /* 新しいバケットに移るキーをmovedに、残るキーをentriesの前に詰める */
+    for (i = 0; i < numEntry; i++) {
+        p = entries + i * entrySize;
+        if (getBucket(index, hashKey(index, p)) == newBucket) {
+            memcpy(moved + numMoved++ * entrySize, p, entrySize);
+        } else {
+            memmove(entries + numKept++ * entrySize, p, entrySize);
+        }
+    }
+
+    if (writeBucket(index, getBucketPage(index, oldBucket), entries, numKept, spare, &numSpare) != OK
+        || writeBucket(index, getBucketPage(index, newBucket), moved, numMoved, spare, &numSpare) != OK) {
+        free(entries);
+        free(moved);
+        free(spare);
+        return NG;
+    }
+    free(entries);
+    free(moved);
+
+    /* 使い回さなかったオーバーフローページは、空いたページのリストにつなぐ */
+    while (numSpare > 0) {
+        memset(node, 0, PAGE_SIZE);
+        NODE_IS_LEAF(node) = 1;
+        NODE_LINK(node) = index->freePage;
+        index->freePage = spare[--numSpare];
+        if (writePage(index->file, index->freePage, node) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            free(spare);
+            return NG;
+        }
+    }
+    free(spare);
+    return OK;
+}
+
+/*
+ * insertHashEntry -- ハッシュ索引へのキーの挿入
+ *
+ * バケットの最初のページか、その次のオーバーフローページに空きがあれば入れ、
+ * なければ最初のページの次に新しいオーバーフローページをつなぐ。
+ */
+static Result insertHashEntry(Index *index, char *key, RecordId *rid)
+{
+    char node[PAGE_SIZE];
+    char next[PAGE_SIZE];
+    int pageNum;
+    int nextPage;
+    int maxKeys;
+
+    pageNum = getBucketPage(index, getBucket(index, hashKey(index, key)));
+    if (readPage(index->file, pageNum, node) != OK) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        return NG;
+    }
+    maxKeys = getMaxKeys(index, node);
+
+    if (NODE_NUM_KEY(node) >= maxKeys) {
+        nextPage = NODE_LINK(node);
+        if (nextPage != -1 && readPage(index->file, nextPage, next) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return NG;
+        }
+        if (nextPage == -1 || NODE_NUM_KEY(next) >= maxKeys) {
+            /* 新しいオーバーフローページを最初のページの次につなぐ */
+            if ((nextPage = allocateOverflowPage(index)) == -1) {
+                return NG;
+            }
+            memset(next, 0, PAGE_SIZE);
+            NODE_IS_LEAF(next) = 1;
+            NODE_LINK(next) = NODE_LINK(node);
+            NODE_LINK(node) = nextPage;
+            if (writePage(index->file, pageNum, node) != OK) {
+                printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+                return NG;
+            }
+        }
+        pageNum = nextPage;
+        memcpy(node, next, PAGE_SIZE);
+    }
+
+    setEntry(index, NODE_ENTRY(index, node, NODE_NUM_KEY(node)), key, rid);
+    NODE_NUM_KEY(node)++;
+    if (writePage(index->file, pageNum, node) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    index->numEntry++;
+    index->headerModified = 1;
+
+    /* キーが増えたらバケットを1つ分割する */
+    if ((long) index->numEntry * 100 > (long) index->numBucket * maxKeys * HASH_FILL_PERCENT) {
+        return splitHashBucket(index);
+    }
+    return OK;
+}
+
+/*
+ * deleteHashEntry -- ハッシュ索引からのキーの削除
+ *
+ * 見つけたキーの場所には、同じページの最後のキーを移す。
+ */
+static Result deleteHashEntry(Index *index, char *key, RecordId *rid)
+{
+    char node[PAGE_SIZE];
+    int entrySize = LEAF_ENTRY_SIZE(index);
+    int pageNum;
+    int i;
+
+    pageNum = getBucketPage(index, getBucket(index, hashKey(index, key)));
+    for (; pageNum != -1; pageNum = NODE_LINK(node)) {
+        if (readPage(index->file, pageNum, node) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return NG;
+        }
+        for (i = 0; i < NODE_NUM_KEY(node); i++) {
+            if (compareEntry(index, key, rid, NODE_ENTRY(index, node, i)) != 0) {
+                continue;
+            }
+            NODE_NUM_KEY(node)--;
+            memmove(NODE_ENTRY(index, node, i), NODE_ENTRY(index, node, NODE_NUM_KEY(node)), entrySize);
+            if (writePage(index->file, pageNum, node) != OK) {
+                printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+                return NG;
+            }
+            index->numEntry--;
+            index->headerModified = 1;
+            return OK;
+        }
+    }
+    return OK;
+}
+
+/*
+ * searchHash -- ハッシュ索引の、値が同じキーの検索
+ */
+static RecordId *searchHash(Index *index, char *key, int *numRid)
+{
+    char node[PAGE_SIZE];
+    RecordId *rids = NULL;
+    RecordId *p;
+    int capacity = 0;
+    int pageNum;
+    int i;
+
+    *numRid = 0;
+    pageNum = getBucketPage(index, getBucket(index, hashKey(index, key)));
+    for (; pageNum != -1; pageNum = NODE_LINK(node)) {
+        if (readPage(index->file, pageNum, node) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            free(rids);
+            return NULL;
+        }
+        for (i = 0; i < NODE_NUM_KEY(node); i++) {
+            if (compareKey(index, NODE_ENTRY(index, node, i), key) != 0) {
+                continue;
+            }
+            if (*numRid == capacity) {
+                capacity = capacity == 0 ? 16 : capacity * 2;
+                if ((p = (RecordId *) realloc(rids, capacity * sizeof(RecordId))) == NULL) {
+                    printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+                    free(rids);
+                    return NULL;
+                }
+                rids = p;
+            }
+            getEntryRid(index, NODE_ENTRY(index, node, i), &rids[(*numRid)++]);
+        }
+    }
+
+    return rids != NULL ? rids : (RecordId *) malloc(sizeof(RecordId));
+}
+
+/*
+ * initDirectory -- 空のビットマップのディレクトリを作る
+ */
+static void initDirectory(char *dir)
+{
+    int i;
+
+    memset(dir, 0, PAGE_SIZE);
+    NODE_LINK(dir) = -1;
+    for (i = 0; i < BITMAP_DIR_ENTRIES; i++) {
+        DIR_ENTRY(dir, i) = -1;
+    }
+}
+
+/*
+ * findBitmapValue -- ビットマップ索引の値の一覧から、値のディレクトリを探す
+ *
+ * 返り値:
+ *	ディレクトリのページ番号。値がなければ、createが1なら値を一覧の最後に加えて
+ *	そのディレクトリを、0なら0を返す。エラーなら-1を返す。
+ */
+static int findBitmapValue(Index *index, char *key, int create)
+{
+    char node[PAGE_SIZE];
+    char dir[PAGE_SIZE];
+    RecordId entry;
+    int pageNum;
+    int lastPage = -1;
+    int i;
+
+    for (pageNum = index->rootPage; pageNum != -1; pageNum = NODE_LINK(node)) {
+        if (readPage(index->file, pageNum, node) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return -1;
+        }
+        for (i = 0; i < NODE_NUM_KEY(node); i++) {
+            if (compareKey(index, NODE_ENTRY(index, node, i), key) == 0) {
+                getEntryRid(index, NODE_ENTRY(index, node, i), &entry);
+                return entry.pageNum;
+            }
+        }
+        lastPage = pageNum;
+    }
+    if (!create) {
+        return 0;
+    }
+
+    /* 空のディレクトリを作り、一覧の最後のページ(一杯なら新しいページ)に値を加える */
+    initDirectory(dir);
+    entry.pageNum = allocateNode(index);
+    entry.slot = 0;
+    if (writePage(index->file, entry.pageNum, dir) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return -1;
+    }
+    if (NODE_NUM_KEY(node) >= getMaxKeys(index, node)) {
+        pageNum = allocateNode(index);
+        NODE_LINK(node) = pageNum;
+        if (writePage(index->file, lastPage, node) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            return -1;
+        }
+        memset(node, 0, PAGE_SIZE);
+        NODE_IS_LEAF(node) = 1;
+        NODE_LINK(node) = -1;
+        lastPage = pageNum;
+    }
+    setEntry(index, NODE_ENTRY(index, node, NODE_NUM_KEY(node)), key, &entry);
+    NODE_NUM_KEY(node)++;
+    if (writePage(index->file, lastPage, node) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return -1;
+    }
+    return entry.pageNum;
+}
+
+/*
+ * getContainerPage -- チャンクのコンテナのページ番号
+ *
+ * 返り値:
+ *	コンテナのページ番号。なければ、createが1なら空の配列のコンテナを作って
+ *	そのページ番号を、0なら0を返す。エラーなら-1を返す。
+ */
+static int getContainerPage(Index *index, int dirPage, int chunk, int create)
+{
+    char dir[PAGE_SIZE];
+    char container[PAGE_SIZE];
+    int pageNum = dirPage;
+    int containerPage;
+
+    /* チャンクの番号が入っているディレクトリのページまでたどる */
+    for (;;) {
+        if (readPage(index->file, pageNum, dir) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return -1;
+        }
+        if (chunk < BITMAP_DIR_ENTRIES) {
+            break;
+        }
+        chunk -= BITMAP_DIR_ENTRIES;
+        if (NODE_LINK(dir) == -1) {
+            if (!create) {
+                return 0;
+            }
+            NODE_LINK(dir) = allocateNode(index);
+            if (writePage(index->file, pageNum, dir) != OK) {
+                printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+                return -1;
+            }
+            pageNum = NODE_LINK(dir);
+            initDirectory(dir);
+            if (writePage(index->file, pageNum, dir) != OK) {
+                printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+                return -1;
+            }
+            continue;
+        }
+        pageNum = NODE_LINK(dir);
+    }
+
+    if ((containerPage = DIR_ENTRY(dir, chunk)) != -1) {
+        return containerPage;
+    }
+    if (!create) {
+        return 0;
+    }
+    containerPage = allocateNode(index);
+    memset(container, 0, PAGE_SIZE);
+    CONTAINER_TYPE(container) = CONTAINER_ARRAY;
+    CONTAINER_CARD(container) = 0;
+    DIR_ENTRY(dir, chunk) = containerPage;
+    if (writePage(index->file, containerPage, container) != OK
+        || writePage(index->file, pageNum, dir) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return -1;
+    }
+    return containerPage;
+}
+
+/*
+ * convertToBitmap -- 配列のコンテナをビットマップに変える
+ */
+static void convertToBitmap(char *container)
+{
+    unsigned short values[ARRAY_MAX_VALUES];
+    unsigned char *bits = (unsigned char *) CONTAINER_DATA(container);
+    int i;
+
+    memcpy(values, CONTAINER_DATA(container), CONTAINER_CARD(container) * sizeof(unsigned short));
+    memset(bits, 0, PAGE_SIZE - BITMAP_CONTAINER_HEADER_SIZE);
+    for (i = 0; i < CONTAINER_CARD(container); i++) {
+        bits[values[i] / 8] |= 1 << (values[i] % 8);
+    }
+    CONTAINER_TYPE(container) = CONTAINER_BITMAP;
+}
+
+/*
+ * convertToArray -- ビットマップのコンテナを配列に変える
+ */
+static void convertToArray(char *container)
+{
+    unsigned short values[ARRAY_MAX_VALUES];
+    unsigned char *bits = (unsigned char *) CONTAINER_DATA(container);
+    int n = 0;
+    int i;
+
+    for (i = 0; i < CHUNK_BITS && n < ARRAY_MAX_VALUES; i++) {
+        if (bits[i / 8] & (1 << (i % 8))) {
+            values[n++] = i;
+        }
+    }
+    memset(bits, 0, PAGE_SIZE - BITMAP_CONTAINER_HEADER_SIZE);
+    memcpy(CONTAINER_DATA(container), values, n * sizeof(unsigned short));
+    CONTAINER_TYPE(container) = CONTAINER_ARRAY;
+    CONTAINER_CARD(container) = n;
+}
+
+/*
+ * setBitmapBit -- ビットマップ索引の、値のビットマップのレコードのビットを立てる(valueが1)か消す(0)
+ *
+ * ビットを消したコンテナやディレクトリは空になっても残す。
+ */
+static Result setBitmapBit(Index *index, char *key, RecordId *rid, int value)
+{
+    char container[PAGE_SIZE];
+    unsigned short *values = (unsigned short *) CONTAINER_DATA(container);
+    unsigned char *bits = (unsigned char *) CONTAINER_DATA(container);
+    long bit;
+    int offset;
+    int dirPage;
+    int containerPage;
+    int card;
+    int low, high, mid;
+
+    /* スロット番号がページあたりのビット数に収まらないレコードは表せない */
+    if (rid->slot < 0 || rid->slot >= index->bitsPerPage) {
+        return NG;
+    }
+    bit = (long) rid->pageNum * index->bitsPerPage + rid->slot;
+    offset = bit % CHUNK_BITS;
+
+    if ((dirPage = findBitmapValue(index, key, value)) <= 0) {
+        return dirPage == 0 ? OK : NG;
+    }
+    if ((containerPage = getContainerPage(index, dirPage, bit / CHUNK_BITS, value)) <= 0) {
+        return containerPage == 0 ? OK : NG;
+    }
+    if (readPage(index->file, containerPage, container) != OK) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        return NG;
+    }
+    card = CONTAINER_CARD(container);
+
+    if (CONTAINER_TYPE(container) == CONTAINER_ARRAY) {
+        /* 配列の中でビットの番号以上の最初の位置を探す */
+        low = 0;
+        high = card;
+        while (low < high) {
+            mid = (low + high) / 2;
+            if (values[mid] < offset) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if ((low < card && values[low] == offset) == value) {
+            return OK;
+        }
+        if (!value) {
+            memmove(&values[low], &values[low + 1], (card - low - 1) * sizeof(unsigned short));
+            CONTAINER_CARD(container)--;
+        } else if (card < ARRAY_MAX_VALUES) {
+            memmove(&values[low + 1], &values[low], (card - low) * sizeof(unsigned short));
+            values[low] = offset;
+            CONTAINER_CARD(container)++;
+        } else {
+            convertToBitmap(container);
+            bits[offset / 8] |= 1 << (offset % 8);
+            CONTAINER_CARD(container)++;
+        }
+    } else {
+        if (((bits[offset / 8] >> (offset % 8)) & 1) == value) {
+            return OK;
+        }
+        if (value) {
+            bits[offset / 8] |= 1 << (offset % 8);
+            CONTAINER_CARD(container)++;
+        } else {
+            bits[offset / 8] &= ~(1 << (offset % 8));
+            if (--CONTAINER_CARD(container) < ARRAY_MAX_VALUES / 2) {
+                convertToArray(container);
+            }
+        }
+    }
+
+    if (writePage(index->file, containerPage, container) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    return OK;
+}
+
+/*
+ * markBitmapPages -- 値のビットマップでビットが立っているデータファイルのページに印を付ける
+ */
+static Result markBitmapPages(Index *index, int dirPage, char *pages, int numPage)
+{
+    char dir[PAGE_SIZE];
+    char container[PAGE_SIZE];
+    unsigned short *values = (unsigned short *) CONTAINER_DATA(container);
+    unsigned char *bits = (unsigned char *) CONTAINER_DATA(container);
+    long base;
+    long offset;
+    long dataPage;
+    int chunk = 0;
+    int pageNum;
+    int i;
+    int j;
+
+    for (pageNum = dirPage; pageNum != -1; pageNum = NODE_LINK(dir)) {
+        if (readPage(index->file, pageNum, dir) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return NG;
+        }
+        for (i = 0; i < BITMAP_DIR_ENTRIES; i++, chunk++) {
+            if (DIR_ENTRY(dir, i) == -1) {
+                continue;
+            }
+            if (readPage(index->file, DIR_ENTRY(dir, i), container) != OK) {
+                printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+                return NG;
+            }
+            base = (long) chunk * CHUNK_BITS;
+
+            if (CONTAINER_TYPE(container) == CONTAINER_ARRAY) {
+                for (j = 0; j < CONTAINER_CARD(container); j++) {
+                    if ((dataPage = (base + values[j]) / index->bitsPerPage) < numPage) {
+                        pages[dataPage] = 1;
+                    }
+                }
+                continue;
+            }
+
+            /* ビットマップは0のバイトを飛ばし、ビットを見つけたらそのページの残りも飛ばす */
+            for (offset = 0; offset < CHUNK_BITS; ) {
+                if (offset % 8 == 0 && bits[offset / 8] == 0) {
+                    offset += 8;
+                } else if (bits[offset / 8] & (1 << (offset % 8))) {
+                    if ((dataPage = (base + offset) / index->bitsPerPage) < numPage) {
+                        pages[dataPage] = 1;
+                    }
+                    offset = (dataPage + 1) * index->bitsPerPage - base;
+                } else {
+                    offset++;
+                }
+            }
+        }
+    }
+    return OK;
+}
+
+/*
+ * searchBitmap -- ビットマップ索引の、条件に合う値のビットマップを合わせてページに印を付ける
+ *
+ * likeの条件は、値の一覧の値ごとに1回だけパターンと照合する。
+ */
+static Result searchBitmap(Index *index, Condition *condition, char *key, char *pages, int numPage)
+{
+    char node[PAGE_SIZE];
+    RecordId entry;
+    int pageNum;
+    int cmp;
+    int i;
+
+    for (pageNum = index->rootPage; pageNum != -1; pageNum = NODE_LINK(node)) {
+        if (readPage(index->file, pageNum, node) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return NG;
+        }
+        for (i = 0; i < NODE_NUM_KEY(node); i++) {
+            cmp = compareKey(index, NODE_ENTRY(index, node, i), key);
+            if ((condition->operator == OPR_EQUAL && cmp != 0)
+                || (condition->operator == OPR_NOT_EQUAL && cmp == 0)
+                || (condition->operator == OPR_GREATER_THAN && cmp <= 0)
+                || (condition->operator == OPR_LESS_THAN && cmp >= 0)
+                || (condition->operator == OPR_LIKE
+                    && (index->keyType != TYPE_STRING
+                        || !matchLike(NODE_ENTRY(index, node, i), condition->stringValue)))) {
+                continue;
+            }
+            getEntryRid(index, NODE_ENTRY(index, node, i), &entry);
+            if (markBitmapPages(index, entry.pageNum, pages, numPage) != OK) {
+                return NG;
+            }
+        }
+    }
+    return OK;
+}
+
+/*
+ * compareTrigram -- トライグラムの比較(qsort用)
+ */
+static int compareTrigram(const void *a, const void *b)
+{
+    return memcmp(a, b, TRIGRAM_KEY_SIZE);
+}
+
+/*
+ * makeTrigrams -- 文字列の中の連続する3文字の並びを、重複を除いて取り出す
+ *
+ * 返り値:
+ *	並びの数。trigramsにTRIGRAM_KEY_SIZEバイトずつ(3文字と終端文字)格納する。
+ */
+static int makeTrigrams(char *value, char *trigrams)
+{
+    int len = strnlen(value, MAX_VARSTRING - 1);
+    int n = 0;
+    int i;
+
+    for (i = 0; i + 3 <= len; i++) {
+        memcpy(trigrams + n * TRIGRAM_KEY_SIZE, value + i, 3);
+        trigrams[n * TRIGRAM_KEY_SIZE + 3] = '\0';
+        n++;
+    }
+    if (n == 0) {
+        return 0;
+    }
+    qsort(trigrams, n, TRIGRAM_KEY_SIZE, compareTrigram);
+    len = n;
+    n = 1;
+    for (i = 1; i < len; i++) {
+        if (memcmp(trigrams + i * TRIGRAM_KEY_SIZE, trigrams + (n - 1) * TRIGRAM_KEY_SIZE, TRIGRAM_KEY_SIZE) != 0) {
+            memcpy(trigrams + n++ * TRIGRAM_KEY_SIZE, trigrams + i * TRIGRAM_KEY_SIZE, TRIGRAM_KEY_SIZE);
+        }
+    }
+    return n;
+}
+
+/*
+ * compareRid -- レコードの位置の比較
+ */
+static int compareRid(RecordId *a, RecordId *b)
+{
+    if (a->pageNum != b->pageNum) {
+        return a->pageNum < b->pageNum ? -1 : 1;
+    }
+    return a->slot < b->slot ? -1 : a->slot > b->slot;
+}
+
+/*
+ * searchTrigram -- likeのパターンに合うかもしれないレコードの位置の検索
+ *
+ * 返り値:
+ *	パターンの%と_を含まない部分の、3文字の並びをすべて含むレコードの位置の配列(位置の順)。
+ *	3文字以上の部分がないパターンやエラーの場合はNULLを返す。
+ *
+ * 並びごとのキーの列は位置の順に並んでいるので、順に突き合わせて共通部分を残す。
+ */
+static RecordId *searchTrigram(Index *index, char *pattern, int *numRid)
+{
+    char literal[MAX_VARSTRING];
+    char trigrams[MAX_VARSTRING * TRIGRAM_KEY_SIZE];
+    char all[MAX_VARSTRING * TRIGRAM_KEY_SIZE];
+    RecordId *result = NULL;
+    RecordId *rids;
+    int numTrigram = 0;
+    int numResult = 0;
+    int numFound;
+    int n;
+    int len;
+    int i, j, k;
+
+    /* パターンを%と_で区切った部分ごとに、3文字の並びを集める */
+    for (i = 0; pattern[i] != '\0'; ) {
+        for (len = 0; pattern[i] != '\0' && pattern[i] != '%' && pattern[i] != '_'; i++) {
+            literal[len++] = pattern[i];
+        }
+        literal[len] = '\0';
+        n = makeTrigrams(literal, trigrams);
+        memcpy(all + numTrigram * TRIGRAM_KEY_SIZE, trigrams, n * TRIGRAM_KEY_SIZE);
+        numTrigram += n;
+        if (pattern[i] != '\0') {
+            i++;
+        }
+    }
+    if (numTrigram == 0) {
+        return NULL;
+    }
+
+    /* 並びごとのキーの列の共通部分を求める */
+    for (k = 0; k < numTrigram; k++) {
+        if ((rids = searchBtree(index, OPR_EQUAL, all + k * TRIGRAM_KEY_SIZE, &numFound)) == NULL) {
+            free(result);
+            return NULL;
+        }
+        if (result == NULL) {
+            result = rids;
+            numResult = numFound;
+        } else {
+            for (i = j = n = 0; i < numResult && j < numFound; ) {
+                if (compareRid(&result[i], &rids[j]) < 0) {
+                    i++;
+                } else if (compareRid(&result[i], &rids[j]) > 0) {
+                    j++;
+                } else {
+                    result[n++] = result[i];
+                    i++;
+                    j++;
+                }
+            }
+            numResult = n;
+            free(rids);
+        }
+        if (numResult == 0) {
+            break;
+        }
+    }
+
+    *numRid = numResult;
+    return result;
+}
@@ -0,0 +1,2224 @@
+/*
+ * lsm.c -- ログ構造化(LSM)テーブルのモジュール
+ *
+ * lsm (フィールド名)を指定したテーブル(ログ構造化テーブル)では、挿入のたびに
+ * データファイルのページを読んで書き換える代わりに、レコードをメモリ上の
+ * メムテーブルに、キー(指定したフィールド)の順に並べて持つ。メムテーブルが
+ * LSM_MEMTABLE_SIZEバイトを超えたら、キーの順に並べたまま、書き換えないファイル
+ * (ラン)に先頭から順に書き出す。ランには段があり、メムテーブルから書き出したランは
+ * 0段目になる。同じ段のランがLSM_FANOUT個たまったら、それらを併合して1つ下の段の
+ * 1つのランにする(段階型の併合)。
+ *
+ * レコードには挿入の順に通し番号を付ける。削除では、削除するレコードと同じ
+ * 通し番号とキーを持つ墓標を書き、ランは書き換えない。同じ通し番号のレコードと
+ * 墓標は並べたときに隣り合うので、併合で出会ったら両方とも捨てる。
+ * メムテーブルの中のレコードを削除するときは、墓標を作らずにメムテーブルから取り除く。
+ * 検索では、メムテーブルとすべてのランを読み、墓標のないレコードのうち条件に合う
+ * ものを、キーの順に返す。キーのフィールドの=、<、>の条件では、ランのキーの範囲と、
+ * データページごとの先頭のキー(フェンスキー)で読むページを絞り、=ではさらに
+ * ランごとのブルームフィルタで、値がないランを読み飛ばす。
+ *
+ * メムテーブルに加えた項目は、ログファイルにも追記しておく。メムテーブルを
+ * 持っていないプロセスが最初にテーブルを使うときは、ログファイルを読み直して
+ * メムテーブルを作る。ランを書き出したら、ログファイルは空にする。
+ * 同じテーブルを複数のプロセスから同時に変更することは考えない。
+ *
+ * 併合は別のスレッドではなく、メムテーブルを書き出した直後に行う
+ * (ファイルアクセスモジュールのオープン中のファイルのリストは、同じプロセスの
+ * 複数のスレッドから使えないため)。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * LSM_MANIFEST_EXT -- ランの一覧を記録するファイル(マニフェスト)の拡張子
+ */
+#define LSM_MANIFEST_EXT ".lsm"
+
+/*
+ * LSM_LOG_EXT -- メムテーブルの内容を記録するログファイルの拡張子
+ */
+#define LSM_LOG_EXT ".lsl"
+
+/*
+ * LSM_RUN_EXT -- ランのファイルの拡張子(後ろにランの番号を付ける)
+ */
+#define LSM_RUN_EXT ".run"
+
+/*
+ * LSM_MAGIC, LSM_RUN_MAGIC -- マニフェスト、ランのファイルであることを示す値
+ */
+#define LSM_MAGIC 0x6c736d31
+#define LSM_RUN_MAGIC 0x6c737231
+
+/*
+ * LSM_MEMTABLE_SIZE -- メムテーブルをランに書き出す大きさ(符号化した項目のバイト数)
+ */
+#define LSM_MEMTABLE_SIZE (64 * 1024)
+
+/*
+ * LSM_FANOUT -- 1つの段にたまったら併合するランの数
+ */
+#define LSM_FANOUT 4
+
+/*
+ * LSM_MAX_RUN -- 1つのテーブルのランの数の上限
+ */
+#define LSM_MAX_RUN 256
+
+/*
+ * LSM_PUT, LSM_TOMBSTONE -- 項目の種類(レコード、墓標)
+ *
+ * 同じキーと通し番号なら、レコードが墓標より前に並ぶ。
+ */
+#define LSM_PUT 0
+#define LSM_TOMBSTONE 1
+
+/*
+ * LSM_ENTRY_HEADER -- 項目の見出しのバイト数
+ *
+ * 通し番号(sizeof(int)バイト)、項目全体のバイト数(2バイト)、種類(1バイト)の順に並ぶ。
+ */
+#define LSM_ENTRY_HEADER 7
+
+/*
+ * LSM_MAX_ENTRY -- 1つの項目のバイト数の上限(1ページに収まる大きさ)
+ */
+#define LSM_MAX_ENTRY (PAGE_SIZE - (int) sizeof(int))
+
+/*
+ * LSM_MAX_HASH, LSM_BITS_PER_HASH -- ランのブルームフィルタの立てるビットの数の上限と、
+ * 立てるビット1つあたりに用意する、項目1つあたりのビット数の1000倍(bloom.cと同じ)
+ */
+#define LSM_MAX_HASH 16
+#define LSM_BITS_PER_HASH 1443
+
+/*
+ * ファイルの構造
+ *
+ * 項目:
+ *   +--------+------+----+----------+---------------------------------+
+ *   |通し番号|大きさ|種類|キーの値  |キー以外のフィールドの値(順に)   |
+ *   +--------+------+----+----------+---------------------------------+
+ *   値は、整数型ならsizeof(int)バイト、文字列型なら長さ(1バイト)と文字列(終端文字なし)。
+ *   墓標にはキー以外のフィールドの値はない。
+ *
+ * ランのファイル(tableName.runN):
+ *   0ページ目: LsmRunHeaderと、その後ろに最大のキーの値
+ *   1ページ目から: ブルームフィルタ(bloomSizeバイト)
+ *   firstDataPageページ目から: データページ。先頭に項目の数(sizeof(int)バイト)、
+ *     続けて項目をキーの順(同じキーなら通し番号の順)に詰める。項目はページをまたがない。
+ *   firstFencePageページ目から: フェンスキーのページ。先頭にキーの数、続けて
+ *     データページごとの先頭の項目のキーの値を詰める。
+ *
+ * ログファイル(tableName.lsl):
+ *   データページと同じ形式のページに、メムテーブルに加えた順に項目を記録する。
+ *
+ * マニフェスト(tableName.lsm):
+ *   0ページ目に、LsmManifestと、ランごとのランの番号と段(sizeof(int)バイトずつ)を記録する。
+ */
+
+/*
+ * LsmRunHeader -- ランのファイルのヘッダ
+ */
+typedef struct LsmRunHeader LsmRunHeader;
+struct LsmRunHeader {
+    int magic;                          /*LSM_RUN_MAGIC*/
+    int numEntry;                       /*項目の数*/
+    int numPut;                         /*レコードの数*/
+    int numTombstone;                   /*墓標の数*/
+    int numDataPage;                    /*データページの数*/
+    int firstDataPage;                  /*最初のデータページの番号*/
+    int firstFencePage;                 /*最初のフェンスキーのページの番号*/
+    int numHash;                        /*ブルームフィルタで1つのキーについて立てるビットの数*/
+    int bloomSize;                      /*ブルームフィルタのバイト数*/
+};
+
+/*
+ * LsmManifest -- マニフェストのヘッダ
+ */
+typedef struct LsmManifest LsmManifest;
+struct LsmManifest {
+    int magic;                          /*LSM_MAGIC*/
+    int nextSeq;                        /*次に挿入するレコードの通し番号*/
+    int nextRunId;                      /*次に作るランの番号*/
+    int numRun;                         /*ランの数*/
+};
+
+/*
+ * LsmKey -- キーの値
+ */
+typedef struct LsmKey LsmKey;
+struct LsmKey {
+    int intValue;                       /*整数型のキーの値*/
+    char *stringValue;                  /*文字列型のキーの値(終端文字なし)*/
+    int length;                         /*文字列型のキーの長さ*/
+};
+
+/*
+ * LsmRun -- メモリ上に読み込んだランの情報
+ */
+typedef struct LsmRun LsmRun;
+struct LsmRun {
+    int runId;                          /*ランの番号*/
+    int level;                          /*段*/
+    int numEntry;                       /*項目の数*/
+    int numPut;                         /*レコードの数*/
+    int numTombstone;                   /*墓標の数*/
+    int numDataPage;                    /*データページの数*/
+    int firstDataPage;                  /*最初のデータページの番号*/
+    int numHash;                        /*ブルームフィルタで1つのキーについて立てるビットの数*/
+    int bloomSize;                      /*ブルームフィルタのバイト数*/
+    unsigned char *bloom;               /*ブルームフィルタ*/
+    LsmKey *fences;                     /*データページごとの先頭のキー(numDataPage個)*/
+    LsmKey maxKey;                      /*最大のキー*/
+};
+
+/*
+ * LsmTable -- メモリ上のログ構造化テーブルの情報
+ */
+typedef struct LsmTable LsmTable;
+struct LsmTable {
+    char tableName[MAX_FILENAME];       /*テーブル名*/
+    int keyField;                       /*キーのフィールドの番号*/
+    DataType keyType;                   /*キーのデータ型*/
+    int numHash;                        /*新しく作るランのブルームフィルタで立てるビットの数*/
+    int nextSeq;                        /*次に挿入するレコードの通し番号*/
+    int nextRunId;                      /*次に作るランの番号*/
+    LsmRun *runs[LSM_MAX_RUN];          /*ラン(作った順)*/
+    int numRun;                         /*ランの数*/
+    char **entries;                     /*メムテーブルの項目(キー、通し番号、種類の順)*/
+    int numEntry;                       /*メムテーブルの項目の数*/
+    int maxEntry;                       /*entriesの大きさ*/
+    int memSize;                        /*メムテーブルの項目のバイト数の合計*/
+    int numPut;                         /*メムテーブルのレコードの数*/
+    int numTombstone;                   /*メムテーブルの墓標の数*/
+    char logPage[PAGE_SIZE];            /*ログファイルの最後のページの内容*/
+    int logPageNum;                     /*ログファイルの最後のページの番号*/
+    int logUsed;                        /*logPageの使用済みのバイト数*/
+    LsmTable *next;                     /*次のテーブル*/
+};
+
+/*
+ * LsmCursor -- ランかメムテーブルの項目を順に読むカーソル
+ */
+typedef struct LsmCursor LsmCursor;
+struct LsmCursor {
+    LsmTable *table;                    /*テーブル*/
+    LsmRun *run;                        /*読むラン(NULLならメムテーブル)*/
+    File *file;                         /*ランのファイル*/
+    int pageNum;                        /*読み込んだデータページの、ランの中での番号*/
+    char page[PAGE_SIZE];               /*読み込んだデータページ*/
+    char *next;                         /*pageの中の次の項目*/
+    int remaining;                      /*pageの中でまだ読んでいない項目の数*/
+    int index;                          /*メムテーブルの次の項目の番号*/
+    int *numPageRead;                   /*読んだページの数を数える場所(NULLなら数えない)*/
+    char *data;                         /*今の項目(NULLなら終わり)*/
+};
+
+/*
+ * LsmWriter -- ランを書き出す途中の情報
+ */
+typedef struct LsmWriter LsmWriter;
+struct LsmWriter {
+    LsmTable *table;                    /*テーブル*/
+    File *file;                         /*ランのファイル*/
+    LsmRun *run;                        /*書き出しているラン*/
+    char page[PAGE_SIZE];               /*書き出し中のデータページ*/
+    int used;                           /*pageの使用済みのバイト数*/
+    int numPageEntry;                   /*pageの項目の数*/
+    char maxKey[MAX_VARSTRING];         /*最後に書いた項目のキーの文字列*/
+};
+
+/*
+ * LsmMatch -- 検索で見つけたレコード
+ */
+typedef struct LsmMatch LsmMatch;
+struct LsmMatch {
+    RecordData *recordData;             /*レコード*/
+    int seq;                            /*通し番号*/
+};
+
+/*
+ * lsmList -- メモリ上に読み込んだログ構造化テーブルのリスト
+ */
+static LsmTable *lsmList = NULL;
+
+/*
+ * getLsmField -- ログ構造化テーブルのキーのフィールドの番号の取得
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	キーのフィールドの番号。ログ構造化テーブルでなければ-1を返す。
+ */
+int getLsmField(TableInfo *tableInfo)
+{
+    int i;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (IS_LSM_FIELD(tableInfo, i)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * makeLsmFileName -- テーブルのマニフェスト、ログファイルのファイル名を作る
+ */
+static void makeLsmFileName(char *filename, char *tableName, char *ext)
+{
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, ext);
+}
+
+/*
+ * makeRunFileName -- ランのファイルのファイル名を作る
+ */
+static void makeRunFileName(char *filename, char *tableName, int runId)
+{
+    snprintf(filename, MAX_FILENAME, "%s%s%d", tableName, LSM_RUN_EXT, runId);
+}
+
+/*
+ * getEntrySeq, getEntrySize, getEntryKind -- 項目の見出しの読み出し
+ */
+static int getEntrySeq(char *data)
+{
+    int seq;
+
+    memcpy(&seq, data, sizeof(int));
+    return seq;
+}
+
+static int getEntrySize(char *data)
+{
+    unsigned short size;
+
+    memcpy(&size, data + sizeof(int), sizeof(size));
+    return size;
+}
+
+static int getEntryKind(char *data)
+{
+    return data[LSM_ENTRY_HEADER - 1];
+}
+
+/*
+ * decodeKey -- 値の並びの先頭からキーの値を取り出し、その次の番地を返す
+ *
+ * 文字列はコピーせず、pの中を指す。
+ */
+static char *decodeKey(char *p, DataType keyType, LsmKey *key)
+{
+    if (keyType == TYPE_STRING) {
+        key->intValue = 0;
+        key->length = (unsigned char) *p;
+        key->stringValue = p + 1;
+        return p + 1 + key->length;
+    }
+    memcpy(&key->intValue, p, sizeof(int));
+    key->stringValue = NULL;
+    key->length = 0;
+    return p + sizeof(int);
+}
+
+/*
+ * encodeKey -- キーの値をpに書き、その次の番地を返す
+ */
+static char *encodeKey(char *p, DataType keyType, LsmKey *key)
+{
+    if (keyType == TYPE_STRING) {
+        *p = (char) key->length;
+        memcpy(p + 1, key->stringValue, key->length);
+        return p + 1 + key->length;
+    }
+    memcpy(p, &key->intValue, sizeof(int));
+    return p + sizeof(int);
+}
+
+/*
+ * getKeySize -- キーの値を書くのに必要なバイト数
+ */
+static int getKeySize(DataType keyType, LsmKey *key)
+{
+    return keyType == TYPE_STRING ? 1 + key->length : (int) sizeof(int);
+}
+
+/*
+ * getEntryKey -- 項目のキーの値を取り出す
+ */
+static void getEntryKey(char *data, DataType keyType, LsmKey *key)
+{
+    decodeKey(data + LSM_ENTRY_HEADER, keyType, key);
+}
+
+/*
+ * compareLsmKey -- キーの値の比較
+ *
+ * 返り値:
+ *	aがbより小さければ負、等しければ0、大きければ正の数
+ *	(文字列はstrcmpと同じ順になる)
+ */
+static int compareLsmKey(DataType keyType, LsmKey *a, LsmKey *b)
+{
+    int c;
+
+    if (keyType == TYPE_STRING) {
+        c = memcmp(a->stringValue, b->stringValue, a->length < b->length ? a->length : b->length);
+        return c != 0 ? c : a->length - b->length;
+    }
+    return a->intValue < b->intValue ? -1 : a->intValue > b->intValue ? 1 : 0;
+}
+
+/*
+ * compareLsmEntry -- 項目の比較(キー、通し番号、種類の順)
+ */
+static int compareLsmEntry(DataType keyType, char *a, char *b)
+{
+    LsmKey x, y;
+    int c;
+
+    getEntryKey(a, keyType, &x);
+    getEntryKey(b, keyType, &y);
+    if ((c = compareLsmKey(keyType, &x, &y)) != 0) {
+        return c;
+    }
+    if (getEntrySeq(a) != getEntrySeq(b)) {
+        return getEntrySeq(a) < getEntrySeq(b) ? -1 : 1;
+    }
+    return getEntryKind(a) - getEntryKind(b);
+}
+
+/*
+ * copyLsmKey -- キーの値をコピーする(文字列はmallocした領域にコピーする)
+ */
+static Result copyLsmKey(DataType keyType, LsmKey *from, LsmKey *to)
+{
+    *to = *from;
+    if (keyType == TYPE_STRING) {
+        if ((to->stringValue = malloc(from->length + 1)) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            return NG;
+        }
+        memcpy(to->stringValue, from->stringValue, from->length);
+    }
+    return OK;
+}
+
+/*
+ * encodeValue -- フィールドの値をpに書き、その次の番地を返す(endを超えるならNULL)
+ */
+static char *encodeValue(char *p, char *end, DataType dataType, FieldData *fieldData)
+{
+    int len;
+
+    if (dataType == TYPE_STRING) {
+        len = strlen(fieldData->stringValue);
+        if (len > MAX_VARSTRING - 1 || p + 1 + len > end) {
+            return NULL;
+        }
+        *p = (char) len;
+        memcpy(p + 1, fieldData->stringValue, len);
+        return p + 1 + len;
+    }
+    if (p + sizeof(int) > end) {
+        return NULL;
+    }
+    memcpy(p, &fieldData->intValue, sizeof(int));
+    return p + sizeof(int);
+}
+
+/*
+ * encodeLsmEntry -- レコードか墓標を項目に符号化する
+ *
+ * 返り値:
+ *	項目のバイト数。LSM_MAX_ENTRYバイトに収まらなければ-1を返す。
+ */
+static int encodeLsmEntry(TableInfo *tableInfo, int keyField, int seq, int kind,
+                          RecordData *recordData, char *data)
+{
+    char *p;
+    char *end = data + LSM_MAX_ENTRY;
+    unsigned short size;
+    int i;
+
+    p = encodeValue(data + LSM_ENTRY_HEADER, end, tableInfo->fieldInfo[keyField].dataType,
+                    &recordData->fieldData[keyField]);
+    for (i = 0; kind == LSM_PUT && p != NULL && i < tableInfo->numField; i++) {
+        if (i != keyField) {
+            p = encodeValue(p, end, tableInfo->fieldInfo[i].dataType, &recordData->fieldData[i]);
+        }
+    }
+    if (p == NULL) {
+        return -1;
+    }
+
+    size = p - data;
+    memcpy(data, &seq, sizeof(int));
+    memcpy(data + sizeof(int), &size, sizeof(size));
+    data[LSM_ENTRY_HEADER - 1] = (char) kind;
+    return size;
+}
+
+/*
+ * decodeValue -- pからフィールドの値を取り出してrecordDataに設定し、その次の番地を返す
+ */
+static char *decodeValue(char *p, TableInfo *tableInfo, int field, RecordData *recordData)
+{
+    FieldData *fieldData = &recordData->fieldData[field];
+    int len;
+
+    strcpy(fieldData->name, tableInfo->fieldInfo[field].name);
+    fieldData->dataType = tableInfo->fieldInfo[field].dataType;
+    if (fieldData->dataType == TYPE_STRING) {
+        len = (unsigned char) *p;
+        memcpy(fieldData->stringValue, p + 1, len);
+        fieldData->stringValue[len] = '\0';
+        return p + 1 + len;
+    }
+    memcpy(&fieldData->intValue, p, sizeof(int));
+    return p + sizeof(int);
+}
+
+/*
+ * decodeLsmRecord -- レコードの項目をRecordDataに戻す
+ */
+static void decodeLsmRecord(char *data, TableInfo *tableInfo, int keyField, RecordData *recordData)
+{
+    char *p;
+    int i;
+
+    recordData->numField = tableInfo->numField;
+    recordData->next = NULL;
+    recordData->rid.pageNum = -1;
+    recordData->rid.slot = -1;
+    p = decodeValue(data + LSM_ENTRY_HEADER, tableInfo, keyField, recordData);
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (i != keyField) {
+            p = decodeValue(p, tableInfo, i, recordData);
+        }
+    }
+}
+
+/*
+ * hashLsmKey -- キーの値のハッシュ値(FNV-1a)
+ */
+static unsigned int hashLsmKey(DataType keyType, LsmKey *key, unsigned int seed)
+{
+    unsigned int hash = 2166136261u ^ seed;
+    unsigned char *p;
+    int len;
+    int i;
+
+    if (keyType == TYPE_STRING) {
+        p = (unsigned char *) key->stringValue;
+        len = key->length;
+    } else {
+        p = (unsigned char *) &key->intValue;
+        len = sizeof(int);
+    }
+    for (i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * addToRunBloom -- ランのブルームフィルタにキーを加える
+ */
+static void addToRunBloom(LsmRun *run, DataType keyType, LsmKey *key)
+{
+    unsigned int h1, h2, bit;
+    int k;
+
+    h1 = hashLsmKey(keyType, key, 0);
+    h2 = hashLsmKey(keyType, key, h1) | 1;
+    for (k = 0; k < run->numHash; k++) {
+        bit = (h1 + k * h2) % (run->bloomSize * 8);
+        run->bloom[bit / 8] |= 1 << (bit % 8);
+    }
+}
+
+/*
+ * checkRunBloom -- ランにキーがあり得るかどうか
+ *
+ * 返り値:
+ *	キーがあり得なければ0、あり得れば1を返す
+ */
+static int checkRunBloom(LsmRun *run, DataType keyType, LsmKey *key)
+{
+    unsigned int h1, h2, bit;
+    int k;
+
+    h1 = hashLsmKey(keyType, key, 0);
+    h2 = hashLsmKey(keyType, key, h1) | 1;
+    for (k = 0; k < run->numHash; k++) {
+        bit = (h1 + k * h2) % (run->bloomSize * 8);
+        if ((run->bloom[bit / 8] & (1 << (bit % 8))) == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * getNumHash -- 偽陽性率の目標から、ブルームフィルタで立てるビットの数を決める
+ *
+ * テーブルのbloomRate(省略時はBLOOM_DEFAULT_RATE)を目標にする。
+ */
+static int getNumHash(TableInfo *tableInfo)
+{
+    int rate = tableInfo->option.bloomRate;
+    int numHash;
+
+    if (rate <= 0 || rate > MAX_BLOOM_RATE) {
+        rate = BLOOM_DEFAULT_RATE;
+    }
+    for (numHash = 1; numHash < LSM_MAX_HASH; numHash++) {
+        if (1000 <= rate << numHash) {
+            break;
+        }
+    }
+    return numHash;
+}
+
+/*
+ * freeLsmRun -- メモリ上のランの情報を解放する
+ */
+static void freeLsmRun(LsmTable *table, LsmRun *run)
+{
+    int i;
+
+    if (table->keyType == TYPE_STRING) {
+        for (i = 0; run->fences != NULL && i < run->numDataPage; i++) {
+            free(run->fences[i].stringValue);
+        }
+        free(run->maxKey.stringValue);
+    }
+    free(run->fences);
+    free(run->bloom);
+    free(run);
+}
+
+/*
+ * readLsmRun -- ランのファイルのヘッダ、ブルームフィルタ、フェンスキーを読み込む
+ *
+ * 返り値:
+ *	読み込んだランの情報。読めなければNULLを返す。
+ */
+static LsmRun *readLsmRun(LsmTable *table, int runId, int level)
+{
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    LsmRunHeader header;
+    LsmRun *run;
+    LsmKey key;
+    File *file;
+    char *p;
+    int pageNum;
+    int count;
+    int n, i;
+
+    makeRunFileName(filename, table->tableName, runId);
+    if ((file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NULL;
+    }
+    if (readPage(file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        closeFile(file);
+        return NULL;
+    }
+    memcpy(&header, page, sizeof(header));
+    if (header.magic != LSM_RUN_MAGIC || header.numDataPage < 1 || header.bloomSize < 1) {
+        closeFile(file);
+        return NULL;
+    }
+    if ((run = (LsmRun *) calloc(1, sizeof(LsmRun))) == NULL
+        || (run->bloom = (unsigned char *) malloc(header.bloomSize)) == NULL
+        || (run->fences = (LsmKey *) calloc(header.numDataPage, sizeof(LsmKey))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        if (run != NULL) {
+            free(run->bloom);
+            free(run);
+        }
+        closeFile(file);
+        return NULL;
+    }
+    run->runId = runId;
+    run->level = level;
+    run->numEntry = header.numEntry;
+    run->numPut = header.numPut;
+    run->numTombstone = header.numTombstone;
+    run->numDataPage = header.numDataPage;
+    run->firstDataPage = header.firstDataPage;
+    run->numHash = header.numHash;
+    run->bloomSize = header.bloomSize;
+    decodeKey(page + sizeof(header), table->keyType, &key);
+    copyLsmKey(table->keyType, &key, &run->maxKey);
+
+    /* ブルームフィルタを読み込む */
+    for (n = 0; n < run->bloomSize; n += PAGE_SIZE) {
+        if (readPage(file, 1 + n / PAGE_SIZE, page) != OK) {
+            break;
+        }
+        memcpy(run->bloom + n, page, run->bloomSize - n < PAGE_SIZE ? run->bloomSize - n : PAGE_SIZE);
+    }
+
+    /* フェンスキーを読み込む */
+    for (i = 0, pageNum = header.firstFencePage; n >= run->bloomSize && i < run->numDataPage; pageNum++) {
+        if (readPage(file, pageNum, page) != OK) {
+            break;
+        }
+        memcpy(&count, page, sizeof(int));
+        for (p = page + sizeof(int); count > 0 && i < run->numDataPage; count--, i++) {
+            p = decodeKey(p, table->keyType, &key);
+            if (copyLsmKey(table->keyType, &key, &run->fences[i]) != OK) {
+                break;
+            }
+        }
+        if (count > 0) {
+            break;
+        }
+    }
+    closeFile(file);
+    if (i < run->numDataPage) {
+        printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+        run->numDataPage = i;
+        freeLsmRun(table, run);
+        return NULL;
+    }
+    return run;
+}
+
+/*
+ * writeLsmManifest -- マニフェストにランの一覧を書き出す
+ */
+static Result writeLsmManifest(LsmTable *table)
+{
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    LsmManifest manifest;
+    File *file;
+    char *p;
+    int i;
+
+    memset(page, 0, PAGE_SIZE);
+    manifest.magic = LSM_MAGIC;
+    manifest.nextSeq = table->nextSeq;
+    manifest.nextRunId = table->nextRunId;
+    manifest.numRun = table->numRun;
+    memcpy(page, &manifest, sizeof(manifest));
+    for (i = 0, p = page + sizeof(manifest); i < table->numRun; i++) {
+        memcpy(p, &table->runs[i]->runId, sizeof(int));
+        p += sizeof(int);
+        memcpy(p, &table->runs[i]->level, sizeof(int));
+        p += sizeof(int);
+    }
+
+    makeLsmFileName(filename, table->tableName, LSM_MANIFEST_EXT);
+    if (getNumPages(filename) == -1 && createFile(filename) != OK) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        return NG;
+    }
+    if ((file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+    if (writePage(file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        closeFile(file);
+        return NG;
+    }
+    return closeFile(file);
+}
+
+/*
+ * resetLsmLog -- ログファイルを空にする
+ */
+static Result resetLsmLog(LsmTable *table)
+{
+    char filename[MAX_FILENAME];
+
+    makeLsmFileName(filename, table->tableName, LSM_LOG_EXT);
+    if (createFile(filename) != OK) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        return NG;
+    }
+    memset(table->logPage, 0, PAGE_SIZE);
+    table->logPageNum = 0;
+    table->logUsed = sizeof(int);
+    return OK;
+}
+
+/*
+ * appendLsmLog -- ログファイルの最後のページに項目を追記する
+ *
+ * ページがいっぱいになったら書き出して次のページに移る。
+ * 最後のページは、呼び出し側がwriteLsmLogで書き出す。
+ */
+static Result appendLsmLog(LsmTable *table, File *file, char *data)
+{
+    int size = getEntrySize(data);
+    int count;
+
+    if (table->logUsed + size > PAGE_SIZE) {
+        if (writePage(file, table->logPageNum, table->logPage) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            return NG;
+        }
+        memset(table->logPage, 0, PAGE_SIZE);
+        table->logPageNum++;
+        table->logUsed = sizeof(int);
+    }
+    memcpy(table->logPage + table->logUsed, data, size);
+    table->logUsed += size;
+    memcpy(&count, table->logPage, sizeof(int));
+    count++;
+    memcpy(table->logPage, &count, sizeof(int));
+    return OK;
+}
+
+/*
+ * writeLsmLog -- ログファイルの最後のページを書き出す
+ */
+static Result writeLsmLog(LsmTable *table, File *file)
+{
+    if (writePage(file, table->logPageNum, table->logPage) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    return OK;
+}
+
+/*
+ * findMemtableEntry -- メムテーブルの中で、項目dataより前に並ぶ項目の数を二分探索で求める
+ */
+static int findMemtableEntry(LsmTable *table, char *data)
+{
+    int low = 0;
+    int high = table->numEntry;
+    int mid;
+
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (compareLsmEntry(table->keyType, table->entries[mid], data) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/*
+ * applyLsmEntry -- メムテーブルに項目を加える
+ *
+ * 墓標なら、同じ通し番号のレコードがメムテーブルにあればそれを取り除き、
+ * なければ墓標を加える。ログファイルを読み直すときも、この関数で加える。
+ */
+static Result applyLsmEntry(LsmTable *table, char *data)
+{
+    char **entries;
+    char *copy;
+    char *found;
+    int size = getEntrySize(data);
+    int i;
+
+    /* 墓標なら、同じ通し番号のレコード(墓標の直前に並ぶ)を探す */
+    i = findMemtableEntry(table, data);
+    if (getEntryKind(data) == LSM_TOMBSTONE && i > 0) {
+        found = table->entries[i - 1];
+        if (getEntryKind(found) == LSM_PUT && getEntrySeq(found) == getEntrySeq(data)) {
+            table->memSize -= getEntrySize(found);
+            table->numPut--;
+            free(found);
+            memmove(table->entries + i - 1, table->entries + i, (table->numEntry - i) * sizeof(char *));
+            table->numEntry--;
+            return OK;
+        }
+    }
+
+    if (table->numEntry == table->maxEntry) {
+        if ((entries = (char **) realloc(table->entries,
+                                         (table->maxEntry == 0 ? 1024 : table->maxEntry * 2) * sizeof(char *))) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            return NG;
+        }
+        table->entries = entries;
+        table->maxEntry = table->maxEntry == 0 ? 1024 : table->maxEntry * 2;
+    }
+    if ((copy = malloc(size)) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    memcpy(copy, data, size);
+    memmove(table->entries + i + 1, table->entries + i, (table->numEntry - i) * sizeof(char *));
+    table->entries[i] = copy;
+    table->numEntry++;
+    table->memSize += size;
+    if (getEntryKind(data) == LSM_PUT) {
+        table->numPut++;
+        if (getEntrySeq(data) >= table->nextSeq) {
+            table->nextSeq = getEntrySeq(data) + 1;
+        }
+    } else {
+        table->numTombstone++;
+    }
+    return OK;
+}
+
+/*
+ * clearMemtable -- メムテーブルを空にする
+ */
+static void clearMemtable(LsmTable *table)
+{
+    int i;
+
+    for (i = 0; i < table->numEntry; i++) {
+        free(table->entries[i]);
+    }
+    table->numEntry = 0;
+    table->memSize = 0;
+    table->numPut = 0;
+    table->numTombstone = 0;
+}
+
+/*
+ * freeLsmTable -- メモリ上のテーブルの情報をリストから外して解放する
+ */
+static void freeLsmTable(LsmTable *table)
+{
+    LsmTable **p;
+    int i;
+
+    for (p = &lsmList; *p != NULL; p = &(*p)->next) {
+        if (*p == table) {
+            *p = table->next;
+            break;
+        }
+    }
+    for (i = 0; i < table->numRun; i++) {
+        freeLsmRun(table, table->runs[i]);
+    }
+    clearMemtable(table);
+    free(table->entries);
+    free(table);
+}
+
+/*
+ * replayLsmLog -- ログファイルを読み直してメムテーブルを作る
+ */
+static Result replayLsmLog(LsmTable *table)
+{
+    char filename[MAX_FILENAME];
+    File *file;
+    char *p;
+    int numPage;
+    int count;
+    int i;
+
+    makeLsmFileName(filename, table->tableName, LSM_LOG_EXT);
+    if ((numPage = getNumPages(filename)) < 1) {
+        return resetLsmLog(table);
+    }
+    if ((file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+    for (i = 0; i < numPage; i++) {
+        if (readPage(file, i, table->logPage) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            closeFile(file);
+            return NG;
+        }
+        memcpy(&count, table->logPage, sizeof(int));
+        for (p = table->logPage + sizeof(int); count > 0; count--) {
+            if (applyLsmEntry(table, p) != OK) {
+                closeFile(file);
+                return NG;
+            }
+            p += getEntrySize(p);
+        }
+    }
+
+    /* 最後のページの続きから追記する */
+    table->logPageNum = numPage - 1;
+    table->logUsed = p - table->logPage;
+    return closeFile(file);
+}
+
+/*
+ * openLsmTable -- メモリ上のテーブルの情報を取得する(なければマニフェストとログファイルから作る)
+ */
+static LsmTable *openLsmTable(char *tableName, TableInfo *tableInfo)
+{
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    LsmManifest manifest;
+    LsmTable *table;
+    int runId, level;
+    int i;
+
+    for (table = lsmList; table != NULL; table = table->next) {
+        if (strcmp(table->tableName, tableName) == 0) {
+            return table;
+        }
+    }
+
+    if ((table = (LsmTable *) calloc(1, sizeof(LsmTable))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    strcpy(table->tableName, tableName);
+    table->keyField = getLsmField(tableInfo);
+    table->keyType = tableInfo->fieldInfo[table->keyField].dataType;
+    table->numHash = getNumHash(tableInfo);
+    table->next = lsmList;
+    lsmList = table;
+
+    /* マニフェストがあれば、ランの一覧を読み込む */
+    makeLsmFileName(filename, tableName, LSM_MANIFEST_EXT);
+    if (getNumPages(filename) > 0) {
+        File *file;
+
+        if ((file = openFile(filename)) == NULL || readPage(file, 0, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            if (file != NULL) {
+                closeFile(file);
+            }
+            freeLsmTable(table);
+            return NULL;
+        }
+        closeFile(file);
+        memcpy(&manifest, page, sizeof(manifest));
+        if (manifest.magic != LSM_MAGIC || manifest.numRun < 0 || manifest.numRun > LSM_MAX_RUN) {
+            freeLsmTable(table);
+            return NULL;
+        }
+        table->nextSeq = manifest.nextSeq;
+        table->nextRunId = manifest.nextRunId;
+        for (i = 0; i < manifest.numRun; i++) {
+            memcpy(&runId, page + sizeof(manifest) + i * 2 * sizeof(int), sizeof(int));
+            memcpy(&level, page + sizeof(manifest) + (i * 2 + 1) * sizeof(int), sizeof(int));
+            if ((table->runs[i] = readLsmRun(table, runId, level)) == NULL) {
+                freeLsmTable(table);
+                return NULL;
+            }
+            table->numRun++;
+        }
+    }
+
+    /* ログファイルからメムテーブルを作る */
+    if (replayLsmLog(table) != OK) {
+        freeLsmTable(table);
+        return NULL;
+    }
+    return table;
+}
+
+/*
+ * openLsmCursor -- カーソルを開き、最初の項目に進める
+ *
+ * 引数:
+ *	run: 読むラン(NULLならメムテーブル)
+ *	startPage: ランの中で読み始めるデータページの番号
+ *	numPageRead: 読んだページの数を数える場所(NULLなら数えない)
+ */
+static Result advanceLsmCursor(LsmCursor *cursor);
+static Result openLsmCursor(LsmTable *table, LsmCursor *cursor, LsmRun *run, int startPage, int *numPageRead)
+{
+    char filename[MAX_FILENAME];
+
+    cursor->table = table;
+    cursor->run = run;
+    cursor->file = NULL;
+    cursor->pageNum = startPage - 1;
+    cursor->remaining = 0;
+    cursor->index = 0;
+    cursor->numPageRead = numPageRead;
+    cursor->data = NULL;
+    if (run != NULL) {
+        makeRunFileName(filename, table->tableName, run->runId);
+        if ((cursor->file = openFile(filename)) == NULL) {
+            printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+            return NG;
+        }
+    }
+    return advanceLsmCursor(cursor);
+}
+
+/*
+ * advanceLsmCursor -- カーソルを次の項目に進める(なければdataをNULLにする)
+ */
+static Result advanceLsmCursor(LsmCursor *cursor)
+{
+    if (cursor->run == NULL) {
+        cursor->data = cursor->index < cursor->table->numEntry ? cursor->table->entries[cursor->index++] : NULL;
+        return OK;
+    }
+
+    while (cursor->remaining == 0) {
+        if (cursor->pageNum + 1 >= cursor->run->numDataPage) {
+            cursor->data = NULL;
+            return OK;
+        }
+        cursor->pageNum++;
+        if (readPage(cursor->file, cursor->run->firstDataPage + cursor->pageNum, cursor->page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            cursor->data = NULL;
+            return NG;
+        }
+        if (cursor->numPageRead != NULL) {
+            (*cursor->numPageRead)++;
+        }
+        memcpy(&cursor->remaining, cursor->page, sizeof(int));
+        cursor->next = cursor->page + sizeof(int);
+    }
+    cursor->data = cursor->next;
+    cursor->next += getEntrySize(cursor->next);
+    cursor->remaining--;
+    return OK;
+}
+
+/*
+ * closeLsmCursor -- カーソルを閉じる
+ */
+static void closeLsmCursor(LsmCursor *cursor)
+{
+    if (cursor->file != NULL) {
+        closeFile(cursor->file);
+        cursor->file = NULL;
+    }
+}
+
+/*
+ * startLsmWriter -- ランの書き出しを始める
+ *
+ * 引数:
+ *	maxEntry: 書き出す項目の数の上限(ブルームフィルタの大きさを決める)
+ *	level: ランの段
+ */
+static Result startLsmWriter(LsmTable *table, LsmWriter *writer, int maxEntry, int level)
+{
+    char filename[MAX_FILENAME];
+    LsmRun *run;
+    int bits;
+
+    if ((run = (LsmRun *) calloc(1, sizeof(LsmRun))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    run->runId = table->nextRunId++;
+    run->level = level;
+    run->numHash = table->numHash;
+    bits = (int) ((long long) maxEntry * run->numHash * LSM_BITS_PER_HASH / 1000);
+    run->bloomSize = bits / 8 + 1;
+    run->firstDataPage = 1 + (run->bloomSize + PAGE_SIZE - 1) / PAGE_SIZE;
+    if ((run->bloom = (unsigned char *) calloc(1, run->bloomSize)) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        free(run);
+        return NG;
+    }
+
+    makeRunFileName(filename, table->tableName, run->runId);
+    if (createFile(filename) != OK || (writer->file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        freeLsmRun(table, run);
+        return NG;
+    }
+    writer->table = table;
+    writer->run = run;
+    writer->used = sizeof(int);
+    writer->numPageEntry = 0;
+    return OK;
+}
+
+/*
+ * writeLsmDataPage -- 書き出し中のデータページをファイルに書く
+ */
+static Result writeLsmDataPage(LsmWriter *writer)
+{
+    LsmRun *run = writer->run;
+
+    memcpy(writer->page, &writer->numPageEntry, sizeof(int));
+    memset(writer->page + writer->used, 0, PAGE_SIZE - writer->used);
+    if (writePage(writer->file, run->firstDataPage + run->numDataPage, writer->page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    run->numDataPage++;
+    writer->used = sizeof(int);
+    writer->numPageEntry = 0;
+    return OK;
+}
+
+/*
+ * addLsmWriter -- 項目をランに加える(キー、通し番号、種類の順に加えること)
+ */
+static Result addLsmWriter(LsmWriter *writer, char *data)
+{
+    LsmRun *run = writer->run;
+    DataType keyType = writer->table->keyType;
+    LsmKey *fences;
+    LsmKey key;
+    int size = getEntrySize(data);
+
+    if (writer->used + size > PAGE_SIZE && writeLsmDataPage(writer) != OK) {
+        return NG;
+    }
+
+    /* データページの先頭の項目のキーを、フェンスキーとして覚えておく */
+    getEntryKey(data, keyType, &key);
+    if (writer->numPageEntry == 0) {
+        if ((run->numDataPage & (run->numDataPage - 1)) == 0) {
+            if ((fences = (LsmKey *) realloc(run->fences,
+                                             (run->numDataPage == 0 ? 1 : run->numDataPage * 2) * sizeof(LsmKey))) == NULL) {
+                printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+                return NG;
+            }
+            run->fences = fences;
+        }
+        if (copyLsmKey(keyType, &key, &run->fences[run->numDataPage]) != OK) {
+            return NG;
+        }
+    }
+
+    memcpy(writer->page + writer->used, data, size);
+    writer->used += size;
+    writer->numPageEntry++;
+    run->numEntry++;
+    if (getEntryKind(data) == LSM_PUT) {
+        run->numPut++;
+    } else {
+        run->numTombstone++;
+    }
+    addToRunBloom(run, keyType, &key);
+
+    /* 最大のキー(最後に加えた項目のキー)を覚えておく */
+    run->maxKey = key;
+    if (keyType == TYPE_STRING) {
+        memcpy(writer->maxKey, key.stringValue, key.length);
+        run->maxKey.stringValue = writer->maxKey;
+    }
+    return OK;
+}
+
+/*
+ * abortLsmWriter -- 書き出しをやめ、ランのファイルを削除する
+ */
+static void abortLsmWriter(LsmWriter *writer)
+{
+    char filename[MAX_FILENAME];
+    int numDataPage = writer->run->numDataPage;
+
+    closeFile(writer->file);
+    makeRunFileName(filename, writer->table->tableName, writer->run->runId);
+    deleteFile(filename);
+    if (writer->table->keyType == TYPE_STRING) {
+        writer->run->maxKey.stringValue = NULL;
+    }
+    /* 最後のページのフェンスキーは、ページを書く前に作っている */
+    writer->run->numDataPage = numDataPage + (writer->numPageEntry > 0 ? 1 : 0);
+    freeLsmRun(writer->table, writer->run);
+}
+
+/*
+ * finishLsmWriter -- ランの書き出しを終える
+ *
+ * 引数:
+ *	run: 書き出したランの情報を返す場所(項目が1つもなければNULLを返し、ファイルは作らない)
+ */
+static Result finishLsmWriter(LsmWriter *writer, LsmRun **run)
+{
+    LsmTable *table = writer->table;
+    LsmRun *r = writer->run;
+    LsmRunHeader header;
+    LsmKey maxKey;
+    char page[PAGE_SIZE];
+    char *p;
+    int pageNum;
+    int count;
+    int n, i;
+
+    *run = NULL;
+    if (r->numEntry == 0) {
+        abortLsmWriter(writer);
+        return OK;
+    }
+    if (writer->numPageEntry > 0 && writeLsmDataPage(writer) != OK) {
+        abortLsmWriter(writer);
+        return NG;
+    }
+
+    /* フェンスキーのページを書く */
+    pageNum = r->firstDataPage + r->numDataPage;
+    header.firstFencePage = pageNum;
+    for (i = 0; i < r->numDataPage; pageNum++) {
+        memset(page, 0, PAGE_SIZE);
+        p = page + sizeof(int);
+        for (count = 0; i < r->numDataPage
+                 && p + getKeySize(table->keyType, &r->fences[i]) <= page + PAGE_SIZE; count++, i++) {
+            p = encodeKey(p, table->keyType, &r->fences[i]);
+        }
+        memcpy(page, &count, sizeof(int));
+        if (writePage(writer->file, pageNum, page) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            abortLsmWriter(writer);
+            return NG;
+        }
+    }
+
+    /* ブルームフィルタのページを書く */
+    for (n = 0; n < r->bloomSize; n += PAGE_SIZE) {
+        memset(page, 0, PAGE_SIZE);
+        memcpy(page, r->bloom + n, r->bloomSize - n < PAGE_SIZE ? r->bloomSize - n : PAGE_SIZE);
+        if (writePage(writer->file, 1 + n / PAGE_SIZE, page) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            abortLsmWriter(writer);
+            return NG;
+        }
+    }
+
+    /* ヘッダを書く */
+    header.magic = LSM_RUN_MAGIC;
+    header.numEntry = r->numEntry;
+    header.numPut = r->numPut;
+    header.numTombstone = r->numTombstone;
+    header.numDataPage = r->numDataPage;
+    header.firstDataPage = r->firstDataPage;
+    header.numHash = r->numHash;
+    header.bloomSize = r->bloomSize;
+    memset(page, 0, PAGE_SIZE);
+    memcpy(page, &header, sizeof(header));
+    encodeKey(page + sizeof(header), table->keyType, &r->maxKey);
+    if (writePage(writer->file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        abortLsmWriter(writer);
+        return NG;
+    }
+    if (closeFile(writer->file) != OK) {
+        writer->file = NULL;
+        if (table->keyType == TYPE_STRING) {
+            r->maxKey.stringValue = NULL;
+        }
+        freeLsmRun(table, r);
+        return NG;
+    }
+
+    /* 最大のキーを、書き出し中の領域からコピーしておく */
+    maxKey = r->maxKey;
+    if (copyLsmKey(table->keyType, &maxKey, &r->maxKey) != OK) {
+        r->maxKey.stringValue = NULL;
+        freeLsmRun(table, r);
+        return NG;
+    }
+    *run = r;
+    return OK;
+}
+
+/*
+ * findMinCursor -- 今の項目が最も前に並ぶカーソルの番号(すべて終わっていれば-1)
+ */
+static int findMinCursor(LsmTable *table, LsmCursor *cursors, int numCursor)
+{
+    int min = -1;
+    int i;
+
+    for (i = 0; i < numCursor; i++) {
+        if (cursors[i].data != NULL
+            && (min == -1 || compareLsmEntry(table->keyType, cursors[i].data, cursors[min].data) < 0)) {
+            min = i;
+        }
+    }
+    return min;
+}
+
+/*
+ * mergeLsmEntries -- カーソルの項目を併合して、1つのランに書き出す
+ *
+ * 引数:
+ *	cursors: 読むカーソル(開いたもの)
+ *	numCursor: カーソルの数
+ *	maxEntry: 項目の数の合計
+ *	level: 書き出すランの段
+ *	dropTombstone: 1なら、レコードと出会わなかった墓標も捨てる
+ *	run: 書き出したランを返す場所(項目が残らなければNULL)
+ *
+ * 同じ通し番号のレコードと墓標は、両方とも捨てる。
+ */
+static Result mergeLsmEntries(LsmTable *table, LsmCursor *cursors, int numCursor, int maxEntry,
+                              int level, int dropTombstone, LsmRun **run)
+{
+    LsmWriter writer;
+    char data[PAGE_SIZE];
+    int min, next;
+
+    if (startLsmWriter(table, &writer, maxEntry, level) != OK) {
+        return NG;
+    }
+    while ((min = findMinCursor(table, cursors, numCursor)) != -1) {
+        memcpy(data, cursors[min].data, getEntrySize(cursors[min].data));
+        if (advanceLsmCursor(&cursors[min]) != OK) {
+            abortLsmWriter(&writer);
+            return NG;
+        }
+
+        /* 墓標はレコードの直後に並ぶので、次の項目が同じ通し番号の墓標なら両方とも捨てる */
+        if (getEntryKind(data) == LSM_PUT) {
+            next = findMinCursor(table, cursors, numCursor);
+            if (next != -1 && getEntryKind(cursors[next].data) == LSM_TOMBSTONE
+                && getEntrySeq(cursors[next].data) == getEntrySeq(data)) {
+                if (advanceLsmCursor(&cursors[next]) != OK) {
+                    abortLsmWriter(&writer);
+                    return NG;
+                }
+                continue;
+            }
+        } else if (dropTombstone) {
+            continue;
+        }
+
+        if (addLsmWriter(&writer, data) != OK) {
+            abortLsmWriter(&writer);
+            return NG;
+        }
+    }
+    return finishLsmWriter(&writer, run);
+}
+
+/*
+ * replaceLsmRuns -- 併合したランを一覧から外して新しいランを加え、マニフェストを書き直してから
+ * 併合したランのファイルを削除する
+ */
+static Result replaceLsmRuns(LsmTable *table, LsmRun **inputs, int numInput, LsmRun *output)
+{
+    char filename[MAX_FILENAME];
+    int i, j, k;
+
+    for (i = 0, k = 0; i < table->numRun; i++) {
+        for (j = 0; j < numInput && table->runs[i] != inputs[j]; j++) {
+        }
+        if (j == numInput) {
+            table->runs[k++] = table->runs[i];
+        }
+    }
+    table->numRun = k;
+    if (output != NULL) {
+        table->runs[table->numRun++] = output;
+    }
+    if (writeLsmManifest(table) != OK) {
+        return NG;
+    }
+    for (j = 0; j < numInput; j++) {
+        makeRunFileName(filename, table->tableName, inputs[j]->runId);
+        deleteFile(filename);
+        freeLsmRun(table, inputs[j]);
+    }
+    return OK;
+}
+
+/*
+ * mergeLsmRuns -- ランを併合して1つのランにする
+ *
+ * 引数:
+ *	inputs: 併合するラン
+ *	numInput: ランの数
+ *	level: 併合したランの段
+ *	dropTombstone: 1なら、レコードと出会わなかった墓標も捨てる
+ */
+static Result mergeLsmRuns(LsmTable *table, LsmRun **inputs, int numInput, int level, int dropTombstone)
+{
+    LsmCursor *cursors;
+    LsmRun *output;
+    int maxEntry = 0;
+    int i, n;
+    Result result;
+
+    if ((cursors = (LsmCursor *) malloc(numInput * sizeof(LsmCursor))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    for (n = 0; n < numInput; n++) {
+        maxEntry += inputs[n]->numEntry;
+        if (openLsmCursor(table, &cursors[n], inputs[n], 0, NULL) != OK) {
+            closeLsmCursor(&cursors[n]);
+            break;
+        }
+    }
+    result = n < numInput ? NG : mergeLsmEntries(table, cursors, numInput, maxEntry, level, dropTombstone, &output);
+    for (i = 0; i < n; i++) {
+        closeLsmCursor(&cursors[i]);
+    }
+    free(cursors);
+    if (result != OK) {
+        return NG;
+    }
+    return replaceLsmRuns(table, inputs, numInput, output);
+}
+
+/*
+ * compactLsmLevels -- LSM_FANOUT個たまった段のランを併合し、1つ下の段のランにする
+ *
+ * 併合してできたランで下の段がたまれば、続けて併合する。
+ * 併合する段より下にランがなければ、レコードのなくなった墓標も捨てる
+ * (墓標のレコードは、墓標と同じ段か、それより下の段にしかないため)。
+ */
+static Result compactLsmLevels(LsmTable *table)
+{
+    LsmRun *inputs[LSM_MAX_RUN];
+    int numInput;
+    int deeper;
+    int level;
+    int i;
+
+    for (level = 0; ; level++) {
+        numInput = 0;
+        deeper = 0;
+        for (i = 0; i < table->numRun; i++) {
+            if (table->runs[i]->level == level) {
+                inputs[numInput++] = table->runs[i];
+            } else if (table->runs[i]->level > level) {
+                deeper = 1;
+            }
+        }
+        if (numInput >= LSM_FANOUT || (table->numRun == LSM_MAX_RUN && numInput > 1)) {
+            if (mergeLsmRuns(table, inputs, numInput, level + 1, !deeper) != OK) {
+                return NG;
+            }
+        } else if (!deeper) {
+            return OK;
+        }
+    }
+}
+
+/*
+ * flushMemtable -- メムテーブルを0段目のランに書き出し、ログファイルを空にする
+ */
+static Result flushMemtable(LsmTable *table)
+{
+    LsmCursor cursor;
+    LsmRun *run;
+
+    if (table->numEntry == 0) {
+        return OK;
+    }
+    if (table->numRun == LSM_MAX_RUN) {
+        return NG;
+    }
+    openLsmCursor(table, &cursor, NULL, 0, NULL);
+    if (mergeLsmEntries(table, &cursor, 1, table->numEntry, 0, table->numRun == 0, &run) != OK) {
+        return NG;
+    }
+    if (run != NULL) {
+        table->runs[table->numRun++] = run;
+    }
+    if (writeLsmManifest(table) != OK) {
+        return NG;
+    }
+    clearMemtable(table);
+    if (resetLsmLog(table) != OK) {
+        return NG;
+    }
+    return compactLsmLevels(table);
+}
+
+/*
+ * addLsmEntries -- 項目をログファイルに追記してから、メムテーブルに加える
+ *
+ * メムテーブルが大きくなったら、ランに書き出す。
+ */
+static Result addLsmEntries(LsmTable *table, char **entries, int numEntry)
+{
+    char filename[MAX_FILENAME];
+    File *file;
+    int i;
+
+    makeLsmFileName(filename, table->tableName, LSM_LOG_EXT);
+    if ((file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+    for (i = 0; i < numEntry; i++) {
+        if (appendLsmLog(table, file, entries[i]) != OK) {
+            closeFile(file);
+            return NG;
+        }
+    }
+    if (writeLsmLog(table, file) != OK) {
+        closeFile(file);
+        return NG;
+    }
+    if (closeFile(file) != OK) {
+        return NG;
+    }
+
+    for (i = 0; i < numEntry; i++) {
+        if (applyLsmEntry(table, entries[i]) != OK) {
+            return NG;
+        }
+    }
+    if (table->memSize >= LSM_MEMTABLE_SIZE) {
+        return flushMemtable(table);
+    }
+    return OK;
+}
+
+/*
+ * makeConditionKey -- キーのフィールドの条件の値をキーの値にする
+ *
+ * 返り値:
+ *	キーのフィールドの=、<、>の条件なら1、そうでなければ0を返す
+ */
+static int makeConditionKey(LsmTable *table, TableInfo *tableInfo, Condition *condition, LsmKey *key)
+{
+    if (condition == NULL || strcmp(tableInfo->fieldInfo[table->keyField].name, condition->name) != 0
+        || condition->dataType != table->keyType
+        || (condition->operator != OPR_EQUAL && condition->operator != OPR_LESS_THAN
+            && condition->operator != OPR_GREATER_THAN)) {
+        return 0;
+    }
+    key->intValue = condition->intValue;
+    key->stringValue = condition->stringValue;
+    key->length = strlen(condition->stringValue);
+    if (table->keyType == TYPE_STRING && key->length > MAX_VARSTRING - 1) {
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * compareKeyRange -- 項目のキーが条件の範囲のどこにあるか
+ *
+ * 返り値:
+ *	範囲より前なら-1、範囲の中なら0、範囲より後なら1を返す
+ */
+static int compareKeyRange(LsmTable *table, char *data, OperatorType operator, LsmKey *key)
+{
+    LsmKey entryKey;
+    int c;
+
+    getEntryKey(data, table->keyType, &entryKey);
+    c = compareLsmKey(table->keyType, &entryKey, key);
+    switch (operator) {
+    case OPR_EQUAL:
+        return c < 0 ? -1 : c > 0 ? 1 : 0;
+    case OPR_LESS_THAN:
+        return c < 0 ? 0 : 1;
+    default:
+        return c > 0 ? 0 : -1;
+    }
+}
+
+/*
+ * findStartPage -- ランの中で、条件の範囲のキーがあり得る最初のデータページの番号
+ *
+ * 返り値:
+ *	データページの番号。ランに範囲のキーがあり得なければ-1を返す。
+ */
+static int findStartPage(LsmTable *table, LsmRun *run, OperatorType operator, LsmKey *key)
+{
+    int low = 0;
+    int high = run->numDataPage;
+    int mid;
+    int c;
+
+    /* キーの範囲とブルームフィルタで、ランを読み飛ばせるか調べる */
+    switch (operator) {
+    case OPR_EQUAL:
+        if (compareLsmKey(table->keyType, &run->fences[0], key) > 0
+            || compareLsmKey(table->keyType, &run->maxKey, key) < 0
+            || checkRunBloom(run, table->keyType, key) == 0) {
+            return -1;
+        }
+        break;
+    case OPR_LESS_THAN:
+        return compareLsmKey(table->keyType, &run->fences[0], key) < 0 ? 0 : -1;
+    default:
+        if (compareLsmKey(table->keyType, &run->maxKey, key) <= 0) {
+            return -1;
+        }
+    }
+
+    /*
+     * =ならフェンスキーが値より小さいページ、>なら値以下のページの数を求め、
+     * 最後のそのページから読む(そのページの後ろの方に範囲のキーがあり得る)
+     */
+    while (low < high) {
+        mid = (low + high) / 2;
+        c = compareLsmKey(table->keyType, &run->fences[mid], key);
+        if (c < 0 || (c == 0 && operator == OPR_GREATER_THAN)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low > 0 ? low - 1 : 0;
+}
+
+/*
+ * addSeq -- 通し番号の配列に加える
+ */
+static Result addSeq(int **seqs, int *numSeq, int *maxSeq, int seq)
+{
+    int *grown;
+
+    if (*numSeq == *maxSeq) {
+        if ((grown = (int *) realloc(*seqs, (*maxSeq == 0 ? 256 : *maxSeq * 2) * sizeof(int))) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            return NG;
+        }
+        *seqs = grown;
+        *maxSeq = *maxSeq == 0 ? 256 : *maxSeq * 2;
+    }
+    (*seqs)[(*numSeq)++] = seq;
+    return OK;
+}
+
+/*
+ * compareSeq -- qsortとbsearchに渡す、通し番号の比較関数
+ */
+static int compareSeq(const void *a, const void *b)
+{
+    int x = *(const int *) a;
+    int y = *(const int *) b;
+
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/*
+ * compareMatch -- qsortに渡す、見つけたレコードの比較関数(キー、通し番号の順)
+ */
+static int sortKeyField;
+static int compareMatch(const void *a, const void *b)
+{
+    const LsmMatch *x = a;
+    const LsmMatch *y = b;
+    FieldData *p = &x->recordData->fieldData[sortKeyField];
+    FieldData *q = &y->recordData->fieldData[sortKeyField];
+    int c;
+
+    if (p->dataType == TYPE_STRING) {
+        c = strcmp(p->stringValue, q->stringValue);
+    } else {
+        c = p->intValue < q->intValue ? -1 : p->intValue > q->intValue ? 1 : 0;
+    }
+    return c != 0 ? c : x->seq < y->seq ? -1 : x->seq > y->seq ? 1 : 0;
+}
+
+/*
+ * collectEntry -- 検索で読んだ項目を、墓標の通し番号か、条件に合ったレコードとして集める
+ */
+static Result collectEntry(LsmTable *table, TableInfo *tableInfo, Condition *condition, int condField,
+                           char *data, LsmMatch **matches, int *numMatch, int *maxMatch,
+                           int **tombstones, int *numTombstone, int *maxTombstone)
+{
+    RecordData record;
+    LsmMatch *grown;
+
+    if (getEntryKind(data) == LSM_TOMBSTONE) {
+        return addSeq(tombstones, numTombstone, maxTombstone, getEntrySeq(data));
+    }
+
+    decodeLsmRecord(data, tableInfo, table->keyField, &record);
+    if (condition != NULL && (condField == -1 || checkCondition(&record, condition) != OK)) {
+        return OK;
+    }
+    if (*numMatch == *maxMatch) {
+        if ((grown = (LsmMatch *) realloc(*matches, (*maxMatch == 0 ? 64 : *maxMatch * 2) * sizeof(LsmMatch))) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            return NG;
+        }
+        *matches = grown;
+        *maxMatch = *maxMatch == 0 ? 64 : *maxMatch * 2;
+    }
+    if (((*matches)[*numMatch].recordData = (RecordData *) malloc(RECORD_DATA_SIZE(record.numField))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    memcpy((*matches)[*numMatch].recordData, &record, RECORD_DATA_SIZE(record.numField));
+    (*matches)[*numMatch].seq = getEntrySeq(data);
+    (*numMatch)++;
+    return OK;
+}
+
+/*
+ * freeMatches -- 見つけたレコードの配列を解放する
+ */
+static void freeMatches(LsmMatch *matches, int numMatch)
+{
+    int i;
+
+    for (i = 0; i < numMatch; i++) {
+        free(matches[i].recordData);
+    }
+    free(matches);
+}
+
+/*
+ * collectLsmMatches -- メムテーブルとすべてのランから、墓標のない、条件に合うレコードを集める
+ *
+ * 引数:
+ *	condition: 条件(NULLならすべてのレコード)
+ *	stat: ランのデータページの数と、読んだページの数を記録する場所
+ *	matches: 見つけたレコードの配列を返す場所(キー、通し番号の順)
+ *	numMatch: 見つけたレコードの数を返す場所
+ */
+static Result collectLsmMatches(LsmTable *table, TableInfo *tableInfo, Condition *condition, QueryStat *stat,
+                                LsmMatch **matches, int *numMatch)
+{
+    LsmCursor cursor;
+    LsmKey key;
+    int *tombstones = NULL;
+    int numTombstone = 0;
+    int maxTombstone = 0;
+    int maxMatch = 0;
+    int useKey;
+    int condField = -1;
+    int start;
+    int range;
+    int i, k;
+    Result result = OK;
+
+    *matches = NULL;
+    *numMatch = 0;
+    for (i = 0; condition != NULL && i < tableInfo->numField; i++) {
+        if (strcmp(tableInfo->fieldInfo[i].name, condition->name) == 0) {
+            condField = i;
+        }
+    }
+    useKey = makeConditionKey(table, tableInfo, condition, &key);
+
+    memset(stat, 0, sizeof(QueryStat));
+    for (i = 0; i < table->numRun; i++) {
+        stat->numPage += table->runs[i]->numDataPage;
+    }
+
+    /* メムテーブルの項目 */
+    for (i = 0; result == OK && i < table->numEntry; i++) {
+        if (useKey && (range = compareKeyRange(table, table->entries[i], condition->operator, &key)) != 0) {
+            if (range > 0) {
+                break;
+            }
+            continue;
+        }
+        result = collectEntry(table, tableInfo, condition, condField, table->entries[i], matches, numMatch, &maxMatch,
+                              &tombstones, &numTombstone, &maxTombstone);
+    }
+
+    /* ランの項目(キーの条件なら、範囲のキーがあり得るページだけを読む) */
+    for (i = 0; result == OK && i < table->numRun; i++) {
+        start = useKey ? findStartPage(table, table->runs[i], condition->operator, &key) : 0;
+        if (start == -1) {
+            continue;
+        }
+        if ((result = openLsmCursor(table, &cursor, table->runs[i], start, &stat->numPageRead)) != OK) {
+            closeLsmCursor(&cursor);
+            break;
+        }
+        while (result == OK && cursor.data != NULL) {
+            range = useKey ? compareKeyRange(table, cursor.data, condition->operator, &key) : 0;
+            if (range > 0) {
+                break;
+            }
+            if (range == 0) {
+                result = collectEntry(table, tableInfo, condition, condField, cursor.data, matches, numMatch, &maxMatch,
+                                      &tombstones, &numTombstone, &maxTombstone);
+            }
+            if (result == OK) {
+                result = advanceLsmCursor(&cursor);
+            }
+        }
+        closeLsmCursor(&cursor);
+    }
+    stat->numPageSkipped = stat->numPage - stat->numPageRead;
+    if (result != OK) {
+        free(tombstones);
+        freeMatches(*matches, *numMatch);
+        *matches = NULL;
+        *numMatch = 0;
+        return NG;
+    }
+
+    /* 墓標のあるレコードを取り除き、キーの順に並べる */
+    if (numTombstone > 0) {
+        qsort(tombstones, numTombstone, sizeof(int), compareSeq);
+    }
+    for (i = 0, k = 0; i < *numMatch; i++) {
+        if (numTombstone > 0
+            && bsearch(&(*matches)[i].seq, tombstones, numTombstone, sizeof(int), compareSeq) != NULL) {
+            free((*matches)[i].recordData);
+        } else {
+            (*matches)[k++] = (*matches)[i];
+        }
+    }
+    *numMatch = k;
+    free(tombstones);
+    sortKeyField = table->keyField;
+    if (*numMatch > 0) {
+        qsort(*matches, *numMatch, sizeof(LsmMatch), compareMatch);
+    }
+    return OK;
+}
+
+/*
+ * insertLsmRecord -- ログ構造化テーブルへのレコードの挿入
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	tableInfo: テーブルのデータ定義情報
+ *	recordData: 挿入するレコード
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * レコードをログファイルに追記してメムテーブルに加えるだけで、ランは読まない。
+ */
+Result insertLsmRecord(char *tableName, TableInfo *tableInfo, RecordData *recordData)
+{
+    LsmTable *table;
+    char data[PAGE_SIZE];
+    char *entry = data;
+
+    if ((table = openLsmTable(tableName, tableInfo)) == NULL) {
+        return NG;
+    }
+    if (encodeLsmEntry(tableInfo, table->keyField, table->nextSeq, LSM_PUT, recordData, data) == -1) {
+        printErrorMessage(ERR_MSG_RECORD_SIZE, __func__, __LINE__);
+        return NG;
+    }
+    return addLsmEntries(table, &entry, 1);
+}
+
+/*
+ * searchLsmTable -- ログ構造化テーブルの検索
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	tableInfo: テーブルのデータ定義情報
+ *	condition: 条件(NULLならすべてのレコード)
+ *	stat: ランのデータページの数と、読んだページ、読み飛ばしたページの数を記録する場所
+ *	result: 見つけたレコードのリスト(キーの順、nextでつなぐ)を返す場所
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * ***注意***
+ *	resultのレコードは、1つずつfreeで解放すること。
+ */
+Result searchLsmTable(char *tableName, TableInfo *tableInfo, Condition *condition, QueryStat *stat,
+                      RecordData **result)
+{
+    LsmTable *table;
+    LsmMatch *matches;
+    int numMatch;
+    int i;
+
+    *result = NULL;
+    if ((table = openLsmTable(tableName, tableInfo)) == NULL
+        || collectLsmMatches(table, tableInfo, condition, stat, &matches, &numMatch) != OK) {
+        return NG;
+    }
+    for (i = numMatch - 1; i >= 0; i--) {
+        matches[i].recordData->next = *result;
+        *result = matches[i].recordData;
+    }
+    free(matches);
+    return OK;
+}
+
+/*
+ * deleteLsmRecord -- ログ構造化テーブルのレコードの削除
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	tableInfo: テーブルのデータ定義情報
+ *	condition: 削除するレコードの条件
+ *	stat: ランのデータページの数と、読んだページ、読み飛ばしたページの数を記録する場所
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * 検索と同じように条件に合うレコードを探し、その通し番号の墓標を書く。
+ */
+Result deleteLsmRecord(char *tableName, TableInfo *tableInfo, Condition *condition, QueryStat *stat)
+{
+    LsmTable *table;
+    LsmMatch *matches;
+    char **entries;
+    int numMatch;
+    int n;
+    int i;
+    Result result = OK;
+
+    if ((table = openLsmTable(tableName, tableInfo)) == NULL
+        || collectLsmMatches(table, tableInfo, condition, stat, &matches, &numMatch) != OK) {
+        return NG;
+    }
+    if (numMatch == 0) {
+        free(matches);
+        return OK;
+    }
+
+    /* 墓標を作る(符号化した墓標は、レコードより大きくならない) */
+    if ((entries = (char **) calloc(numMatch, sizeof(char *))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        freeMatches(matches, numMatch);
+        return NG;
+    }
+    for (n = 0; n < numMatch; n++) {
+        if ((entries[n] = malloc(LSM_MAX_ENTRY)) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            result = NG;
+            break;
+        }
+        encodeLsmEntry(tableInfo, table->keyField, matches[n].seq, LSM_TOMBSTONE, matches[n].recordData, entries[n]);
+    }
+    if (result == OK) {
+        result = addLsmEntries(table, entries, numMatch);
+    }
+    for (i = 0; i < n; i++) {
+        free(entries[i]);
+    }
+    free(entries);
+    freeMatches(matches, numMatch);
+    return result;
+}
+
+/*
+ * updateLsmRecord -- ログ構造化テーブルのレコードの更新
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	tableInfo: テーブルのデータ定義情報
+ *	assignments: 書き換えるフィールドと値(フィールド名とデータ型は確かめておくこと)
+ *	condition: 更新するレコードの条件
+ *	stat: ランのデータページの数と、読んだページ、読み飛ばしたページの数を記録する場所
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * ランは書き換えないので、条件に合うレコードごとに、その通し番号の墓標と、
+ * 書き換えたレコードを新しい通し番号で書く(キーを書き換えてもよい)。
+ */
+Result updateLsmRecord(char *tableName, TableInfo *tableInfo, RecordData *assignments,
+                       Condition *condition, QueryStat *stat)
+{
+    LsmTable *table;
+    LsmMatch *matches;
+    char **entries;
+    int numMatch;
+    int n;
+    int i;
+    Result result = OK;
+
+    if ((table = openLsmTable(tableName, tableInfo)) == NULL
+        || collectLsmMatches(table, tableInfo, condition, stat, &matches, &numMatch) != OK) {
+        return NG;
+    }
+    if (numMatch == 0) {
+        free(matches);
+        return OK;
+    }
+
+    /* 墓標と書き換えたレコードを交互に並べる */
+    if ((entries = (char **) calloc(numMatch * 2, sizeof(char *))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        freeMatches(matches, numMatch);
+        return NG;
+    }
+    for (n = 0; n < numMatch * 2; n += 2) {
+        if ((entries[n] = malloc(LSM_MAX_ENTRY)) == NULL || (entries[n + 1] = malloc(LSM_MAX_ENTRY)) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            result = NG;
+            break;
+        }
+        encodeLsmEntry(tableInfo, table->keyField, matches[n / 2].seq, LSM_TOMBSTONE,
+                       matches[n / 2].recordData, entries[n]);
+        applyAssignments(assignments, matches[n / 2].recordData);
+        if (encodeLsmEntry(tableInfo, table->keyField, table->nextSeq + n / 2, LSM_PUT,
+                           matches[n / 2].recordData, entries[n + 1]) == -1) {
+            printErrorMessage(ERR_MSG_RECORD_SIZE, __func__, __LINE__);
+            result = NG;
+            break;
+        }
+    }
+    if (result == OK) {
+        result = addLsmEntries(table, entries, numMatch * 2);
+    }
+    for (i = 0; i < numMatch * 2; i++) {
+        free(entries[i]);
+    }
+    free(entries);
+    freeMatches(matches, numMatch);
+    return result;
+}
+
+/*
+ * countLsmRecord -- ログ構造化テーブルのレコード数
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	レコード数。失敗した場合は-1を返す。
+ *
+ * 墓標はどれも、それより前に書いたちょうど1つのレコードを消すので、
+ * ランとメムテーブルのレコードの数から墓標の数を引けばよく、ランは読まない。
+ */
+int countLsmRecord(char *tableName, TableInfo *tableInfo)
+{
+    LsmTable *table;
+    int numRecord;
+    int i;
+
+    if ((table = openLsmTable(tableName, tableInfo)) == NULL) {
+        return -1;
+    }
+    numRecord = table->numPut - table->numTombstone;
+    for (i = 0; i < table->numRun; i++) {
+        numRecord += table->runs[i]->numPut - table->runs[i]->numTombstone;
+    }
+    return numRecord;
+}
+
+/*
+ * compactLsmTable -- ログ構造化テーブルのすべてのランを1つに併合する
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * メムテーブルを書き出してから、すべてのランを一番下の段の1つのランに併合する。
+ * 墓標はすべてなくなる。
+ */
+Result compactLsmTable(char *tableName)
+{
+    TableInfo *tableInfo;
+    LsmTable *table;
+    LsmRun *inputs[LSM_MAX_RUN];
+    int level = 0;
+    int i;
+
+    tableName = resolveTableName(tableName);
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        return NG;
+    }
+    if (getLsmField(tableInfo) == -1 || (table = openLsmTable(tableName, tableInfo)) == NULL) {
+        freeTableInfo(tableInfo);
+        return NG;
+    }
+    freeTableInfo(tableInfo);
+
+    if (flushMemtable(table) != OK) {
+        return NG;
+    }
+    for (i = 0; i < table->numRun; i++) {
+        inputs[i] = table->runs[i];
+        if (table->runs[i]->level > level) {
+            level = table->runs[i]->level;
+        }
+    }
+    if (table->numRun == 0 || (table->numRun == 1 && table->runs[0]->numTombstone == 0)) {
+        return OK;
+    }
+    return mergeLsmRuns(table, inputs, table->numRun, level, 1);
+}
+
+/*
+ * deleteLsmTable -- ログ構造化テーブルのファイルの削除
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す(ログ構造化テーブルでなければ何もしない)
+ *
+ * マニフェストにあるランのファイルと、マニフェスト、ログファイルを削除し、
+ * メモリ上のメムテーブルを捨てる。
+ */
+Result deleteLsmTable(char *tableName)
+{
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    LsmManifest manifest;
+    File *file;
+    int runId;
+    int i;
+
+    discardLsmTable(tableName);
+
+    makeLsmFileName(filename, tableName, LSM_MANIFEST_EXT);
+    if (getNumPages(filename) > 0 && (file = openFile(filename)) != NULL) {
+        if (readPage(file, 0, page) == OK) {
+            memcpy(&manifest, page, sizeof(manifest));
+            for (i = 0; manifest.magic == LSM_MAGIC && i < manifest.numRun && i < LSM_MAX_RUN; i++) {
+                memcpy(&runId, page + sizeof(manifest) + i * 2 * sizeof(int), sizeof(int));
+                makeRunFileName(filename, tableName, runId);
+                deleteFile(filename);
+            }
+        }
+        closeFile(file);
+    }
+    makeLsmFileName(filename, tableName, LSM_MANIFEST_EXT);
+    deleteFile(filename);
+    makeLsmFileName(filename, tableName, LSM_LOG_EXT);
+    deleteFile(filename);
+    return OK;
+}
+
+/*
+ * discardLsmTable -- メモリ上のログ構造化テーブルの情報を捨てる
+ *
+ * 引数:
+ *	tableName: テーブルの名前(NULLならすべてのテーブル)
+ *
+ * 返り値:
+ *	なし
+ *
+ * メムテーブルは書き出さない(内容はログファイルに残っている)。
+ */
+void discardLsmTable(char *tableName)
+{
+    LsmTable *table;
+    LsmTable *next;
+
+    for (table = lsmList; table != NULL; table = next) {
+        next = table->next;
+        if (tableName == NULL || strcmp(table->tableName, tableName) == 0) {
+            freeLsmTable(table);
+        }
+    }
+}
+
+/*
+ * closeLsmTables -- すべてのログ構造化テーブルのメムテーブルを書き出し、メモリ上の情報を捨てる
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result closeLsmTables()
+{
+    Result result = OK;
+
+    while (lsmList != NULL) {
+        if (flushMemtable(lsmList) != OK) {
+            result = NG;
+        }
+        freeLsmTable(lsmList);
+    }
+    return result;
+}
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include "microdb.h"
 #include <readline/readline.h>
 #include <readline/history.h>
@@ -14,6 +15,11 @@
  */
 #define MAX_INPUT 256
 
+/*
+ * VACUUM_STEP_PAGES -- バックグラウンドのvacuumが、入力待ちの間に1回に調べるページ数
+ */
+#define VACUUM_STEP_PAGES 16
+
 
 
 /*
@@ -29,6 +35,11 @@ static char inputString[3 * MAX_INPUT];
  */
 static char *nextPosition;
 
+/*
+ * backgroundVacuumTable -- バックグラウンドでvacuum中のテーブルの名前(""ならなし)
+ */
+static char backgroundVacuumTable[MAX_INPUT] = "";
+
 /*
  * setInputString -- 字句解析する文字列の設定
  *
@@ -151,6 +162,107 @@ static char *getNextToken()
     return start;
 }
 
+void callCreatePartition();
+void callCreateIndex();
+
+/*
+ * parseFieldList -- create tableの格納方法の指定のうち、フィールド名の並びの構文解析
+ *
+ * 引数:
+ *	tableInfo: 作るテーブルのデータ定義情報
+ *	dataType: 指定できるフィールドのデータ型(TYPE_UNKNOWNなら整数型と文字列型のどちらでもよい)
+ *	flags: 指定されたフィールドの番号の要素に1(maxBitsが0でなければビット数)を格納する配列
+ *	maxBits: 0でなければ、フィールド名の後ろに1からmaxBitsまでのビット数を読む
+ *
+ * 返り値:
+ *	最後の")"まで正しく読めればOK、間違いがあればメッセージを表示してNGを返す
+ *
+ * 書式:
+ *	( フィールド名 [ ビット数 ], ... )
+ */
+static Result parseFieldList(TableInfo *tableInfo, DataType dataType, char *flags, int maxBits)
+{
+    char *token;
+    int i;
+
+    if ((token = getNextToken()) == NULL || strcmp(token, "(") != 0) {
+	printf("入力行に間違いがあります。\n");
+	return NG;
+    }
+    for (;;) {
+	if ((token = getNextToken()) == NULL) {
+	    printf("入力行に間違いがあります。\n");
+	    return NG;
+	}
+	for (i = 0; i < tableInfo->numField; i++) {
+	    if (strcmp(tableInfo->fieldInfo[i].name, token) == 0) {
+		break;
+	    }
+	}
+	if (i == tableInfo->numField
+	    || (dataType != TYPE_UNKNOWN && tableInfo->fieldInfo[i].dataType != dataType)) {
+	    printf("%sのフィールド%sはありません。\n", dataType == TYPE_INTEGER ? "整数型"
+		   : dataType == TYPE_STRING ? "文字列型" : "整数型か文字列型", token);
+	    return NG;
+	}
+	flags[i] = 1;
+	if (maxBits != 0) {
+	    if ((token = getNextToken()) == NULL || atoi(token) < 1 || atoi(token) > maxBits) {
+		printf("ビット数は1から%dまでで指定してください。\n", maxBits);
+		return NG;
+	    }
+	    flags[i] = atoi(token);
+	}
+
+	/* ","なら次のフィールド名、")"なら終わり */
+	if ((token = getNextToken()) == NULL) {
+	    printf("入力行に間違いがあります。\n");
+	    return NG;
+	}
+	if (strcmp(token, ")") == 0) {
+	    return OK;
+	} else if (strcmp(token, ",") != 0) {
+	    printf("入力行に間違いがあります。\n");
+	    return NG;
+	}
+    }
+}
+
+/*
+ * parseSingleField -- create tableの格納方法の指定のうち、フィールドを1つだけ取るものの構文解析
+ *
+ * 引数:
+ *	tableInfo: 作るテーブルのデータ定義情報
+ *	dataType: 指定できるフィールドのデータ型(TYPE_UNKNOWNなら整数型と文字列型のどちらでもよい)
+ *	flags: 指定されたフィールドの番号の要素だけを1にする配列
+ *
+ * 返り値:
+ *	フィールドがちょうど1つ指定されていればOK、そうでなければメッセージを表示してNGを返す
+ *
+ * 書式:
+ *	( フィールド名 )
+ */
+static Result parseSingleField(TableInfo *tableInfo, DataType dataType, char *flags)
+{
+    int numFlag = 0;
+    int i;
+
+    memset(flags, 0, MAX_FIELD);
+    if (parseFieldList(tableInfo, dataType, flags, 0) != OK) {
+	return NG;
+    }
+    for (i = 0; i < tableInfo->numField; i++) {
+	if (flags[i] != 0) {
+	    numFlag++;
+	}
+    }
+    if (numFlag != 1) {
+	printf("フィールドは1つだけ指定してください。\n");
+	return NG;
+    }
+    return OK;
+}
+
 /*
  * callCreateTable -- create文の構文解析とcreateTableの呼び出し
  *
@@ -161,17 +273,67 @@ static char *getNextToken()
  *	なし
  *
  * create tableの書式:
- *	create table テーブル名 ( フィールド名 データ型, ... )
+ *	create [ memory | temp ] table テーブル名 ( フィールド名 データ型, ... )
+ *	    [ partition パーティション名 ] [ layout { fixed | slotted | pax } ]
+ *	    [ dictionary ( フィールド名, ... ) ] [ pack ( フィールド名 ビット数, ... ) ]
+ *	    [ bloom ( フィールド名, ... ) ] [ rate 偽陽性率(千分率) ]
+ *	    [ crack ( フィールド名, ... ) ] [ clustered by ( フィールド名 ) ]
+ *	    [ lsm ( フィールド名 ) ] [ append ( フィールド名 ) ]
+ *
+ * packは列ごとの形式(layout pax)のテーブルの整数型のフィールドにだけ指定できる。
+ * bloomは辞書圧縮しない文字列型のフィールドにだけ指定できる。rateはbloomで作る
+ * ブルームフィルタの偽陽性率の目標で、省略するとBLOOM_DEFAULT_RATEになる。
+ * crackは整数型のフィールドにだけ指定でき、そのフィールドの範囲の検索のたびに
+ * メモリ上のクラッカー列を少しずつ並べ直して、次からの検索で読むページを減らす。
+ * clustered byは整数型か文字列型のフィールドに1つだけ指定でき、レコードを
+ * そのフィールドの値の順にページに並べて、=と範囲の検索で読むページを減らす。
+ * lsmは整数型か文字列型のフィールドに1つだけ指定でき、そのフィールドをキーとする
+ * ログ構造化テーブル(挿入をメモリにためてまとめて書き出す)にする。lsmを指定した
+ * テーブルには、dictionary、pack、bloom、crack、clustered byは指定できない。
+ * appendは整数型のフィールドに1つだけ指定でき、そのフィールドを時刻とする
+ * 追記専用の時系列テーブルにする。レコードは時刻の順にしか挿入できず、削除の代わりに
+ * truncate tableで古いレコードをまとめて捨てる。clustered byやlsmとは同時に指定できない。
+ * memoryを指定すると、ファイルを作らずメモリ上にだけ置くインメモリテーブルにする。
+ * インメモリテーブルはプログラムの終了時に削除され、格納方法の指定はできない。
+ * tempを指定すると、このセッションの一時ディレクトリにファイルを置く一時テーブルにする。
+ * 一時テーブルはプログラムの終了時に削除され、バッファプールは一時テーブル専用の
+ * パーティションを使う(partitionは指定できない)。
  */
 void callCreateTable()
 {
     char *token;
     char *tableName;
     int numField;
+    int clustered = 0;
+    int lsm = 0;
+    int series = 0;
+    int memory = 0;
+    int temp = 0;
+    int i;
     TableInfo tableInfo;
+    TableOption option;
 
     /* createの次のトークンを読み込み、それが"table"かどうかをチェック */
     token = getNextToken();
+    if (token != NULL && strcmp(token, "partition") == 0) {
+	/* create partitionの場合 */
+	callCreatePartition();
+	return;
+    }
+    if (token != NULL && strcmp(token, "index") == 0) {
+	/* create indexの場合 */
+	callCreateIndex();
+	return;
+    }
+    if (token != NULL && strcmp(token, "memory") == 0) {
+	/* create memory tableの場合 */
+	memory = 1;
+	token = getNextToken();
+    } else if (token != NULL && strcmp(token, "temp") == 0) {
+	/* create temp tableの場合 */
+	temp = 1;
+	token = getNextToken();
+    }
     if (token == NULL || strcmp(token, "table") != 0) {
 	/* 文法エラー */
 	printf("入力行に間違いがあります。\n");
@@ -266,8 +428,154 @@ void callCreateTable()
 
     tableInfo.numField = numField;
 
-    /* createTableを呼び出し、テーブルを作成 */
-    if (createTable(tableName, &tableInfo) == OK) {
+    /* インメモリテーブルにはファイルもページもないので、格納方法は指定できない */
+    memset(&option, 0, sizeof(option));
+    if (memory) {
+	if (getNextToken() != NULL) {
+	    printf("create memory tableには格納方法を指定できません。\n");
+	    return;
+	}
+	option.memory = 1;
+    }
+    option.temp = temp;
+
+    /* ")"の後ろに続くテーブルの格納方法の指定を読み込む */
+    while (!memory && (token = getNextToken()) != NULL) {
+	if (strcmp(token, "partition") == 0) {
+	    /* バッファプールのパーティションの指定 */
+	    if (temp) {
+		printf("create temp tableにはパーティションを指定できません。\n");
+		return;
+	    }
+	    if ((token = getNextToken()) == NULL || strlen(token) >= MAX_PARTITION_NAME) {
+		printf("入力行に間違いがあります。\n");
+		return;
+	    }
+	    strcpy(option.partition, token);
+	} else if (strcmp(token, "layout") == 0) {
+	    /* ページ形式の指定 */
+	    if ((token = getNextToken()) == NULL) {
+		printf("入力行に間違いがあります。\n");
+		return;
+	    }
+	    if (strcmp(token, "fixed") == 0) {
+		option.layout = LAYOUT_FIXED;
+	    } else if (strcmp(token, "slotted") == 0) {
+		option.layout = LAYOUT_SLOTTED;
+	    } else if (strcmp(token, "pax") == 0) {
+		option.layout = LAYOUT_PAX;
+	    } else {
+		printf("ページ形式%sはありません。\n", token);
+		return;
+	    }
+	} else if (strcmp(token, "dictionary") == 0) {
+	    /* 辞書圧縮する文字列型のフィールドの指定 */
+	    if (parseFieldList(&tableInfo, TYPE_STRING, option.dictionary, 0) != OK) {
+		return;
+	    }
+	} else if (strcmp(token, "pack") == 0) {
+	    /* ビット詰めする整数型のフィールドと、値を詰めるビット数の指定 */
+	    if (parseFieldList(&tableInfo, TYPE_INTEGER, option.packBits, MAX_PACK_BITS) != OK) {
+		return;
+	    }
+	} else if (strcmp(token, "bloom") == 0) {
+	    /* ブルームフィルタを作る文字列型のフィールドの指定 */
+	    if (parseFieldList(&tableInfo, TYPE_STRING, option.bloom, 0) != OK) {
+		return;
+	    }
+	} else if (strcmp(token, "rate") == 0) {
+	    /* ブルームフィルタの偽陽性率の目標の指定 */
+	    if ((token = getNextToken()) == NULL
+		|| atoi(token) < 1 || atoi(token) > MAX_BLOOM_RATE) {
+		printf("偽陽性率は千分率で1から%dまでで指定してください。\n", MAX_BLOOM_RATE);
+		return;
+	    }
+	    option.bloomRate = atoi(token);
+	} else if (strcmp(token, "crack") == 0) {
+	    /* クラッキングする整数型のフィールドの指定 */
+	    if (parseFieldList(&tableInfo, TYPE_INTEGER, option.crack, 0) != OK) {
+		return;
+	    }
+	} else if (strcmp(token, "clustered") == 0) {
+	    /* レコードを値の順に並べるフィールドの指定 */
+	    if ((token = getNextToken()) == NULL || strcmp(token, "by") != 0) {
+		printf("入力行に間違いがあります。\n");
+		return;
+	    }
+	    if (parseSingleField(&tableInfo, TYPE_UNKNOWN, option.cluster) != OK) {
+		return;
+	    }
+	} else if (strcmp(token, "lsm") == 0) {
+	    /* ログ構造化テーブルのキーのフィールドの指定 */
+	    if (parseSingleField(&tableInfo, TYPE_UNKNOWN, option.lsm) != OK) {
+		return;
+	    }
+	    lsm = 1;
+	} else if (strcmp(token, "append") == 0) {
+	    /* 時系列テーブルの時刻のフィールドの指定 */
+	    if (parseSingleField(&tableInfo, TYPE_INTEGER, option.series) != OK) {
+		return;
+	    }
+	    series = 1;
+	} else {
+	    /* 文法エラー */
+	    printf("入力行に間違いがあります。\n");
+	    return;
+	}
+    }
+
+    /* 辞書圧縮するフィールドには、ブルームフィルタは作れない */
+    for (i = 0; i < numField; i++) {
+	if (option.bloom[i] != 0 && option.dictionary[i] != 0) {
+	    printf("bloomとdictionaryは同じフィールドに指定できません。\n");
+	    return;
+	}
+    }
+
+    /* クラスタ化のキーは辞書圧縮できず、クラスタ化テーブルではビット詰めは使えない */
+    for (i = 0; i < numField; i++) {
+	if (option.cluster[i] != 0) {
+	    clustered = 1;
+	    if (option.dictionary[i] != 0) {
+		printf("clustered byとdictionaryは同じフィールドに指定できません。\n");
+		return;
+	    }
+	}
+    }
+    for (i = 0; clustered && i < numField; i++) {
+	if (option.packBits[i] != 0) {
+	    printf("clustered byとpackは同じテーブルに指定できません。\n");
+	    return;
+	}
+    }
+
+    /* ログ構造化テーブルのレコードはデータファイルに置かないので、ページに関わる指定は使えない */
+    for (i = 0; lsm && i < numField; i++) {
+	if (option.dictionary[i] != 0 || option.packBits[i] != 0 || option.bloom[i] != 0
+	    || option.crack[i] != 0 || option.cluster[i] != 0) {
+	    printf("lsmとdictionary、pack、bloom、crack、clustered byは同じテーブルに指定できません。\n");
+	    return;
+	}
+    }
+
+    /* 時系列テーブルは挿入の順にページへ追記するので、クラスタ化やログ構造化はできない */
+    if (series && (clustered || lsm)) {
+	printf("appendとclustered by、lsmは同じテーブルに指定できません。\n");
+	return;
+    }
+
+    /* ビット詰めは列ごとの形式のテーブルにだけ使える */
+    if (option.layout != LAYOUT_PAX) {
+	for (i = 0; i < numField; i++) {
+	    if (option.packBits[i] != 0) {
+		printf("packはlayout paxのテーブルにだけ指定できます。\n");
+		return;
+	    }
+	}
+    }
+
+    /* createTableWithOptionを呼び出し、テーブルを作成 */
+    if (createTableWithOption(tableName, &tableInfo, &option) == OK) {
 	printf("テーブルを作成しました。\n");
     } else {
 	printf("テーブルの作成に失敗しました。\n");
@@ -285,6 +593,9 @@ void callCreateTable()
  *
  * drop tableの書式:
  *	drop table テーブル名
+ *
+ * drop indexの書式:
+ *	drop index 索引名
  */
 void callDropTable()
 {
@@ -293,6 +604,32 @@ void callDropTable()
 
     /* dropの次のトークンを読み込み、それが"table"かどうかをチェック */
     token = getNextToken();
+    if (token != NULL && strcmp(token, "partition") == 0) {
+	/* drop partitionの場合 */
+	if ((token = getNextToken()) == NULL) {
+	    printf("入力行に間違いがあります。\n");
+	    return;
+	}
+	if (dropBufferPartition(token) == OK) {
+	    printf("パーティション%sを削除しました。\n", token);
+	} else {
+	    printf("パーティション%sの削除に失敗しました。\n", token);
+	}
+	return;
+    }
+    if (token != NULL && strcmp(token, "index") == 0) {
+	/* drop indexの場合 */
+	if ((token = getNextToken()) == NULL) {
+	    printf("入力行に間違いがあります。\n");
+	    return;
+	}
+	if (dropIndex(token) == OK) {
+	    printf("索引%sを削除しました。\n", token);
+	} else {
+	    printf("索引%sの削除に失敗しました。\n", token);
+	}
+	return;
+    }
     if (token == NULL || strcmp(token, "table") != 0) {
 	/* 文法エラー */
 	printf("入力行に間違いがあります。\n");
@@ -318,7 +655,7 @@ void callDropTable()
 }
 
 /*
- * callInsertRecord -- insert文の構文解析とinsertRecordの呼び出し
+ * callCreatePartition -- create partition文の構文解析とcreateBufferPartitionの呼び出し
  *
  * 引数:
  *	なし
@@ -326,114 +663,46 @@ void callDropTable()
  * 返り値:
  *	なし
  *
- * insertの書式:
- *	insert into テーブル名 values ( フィールド値 , ... )
+ * create partitionの書式:
+ *	create partition パーティション名 min 保証するページ数 max 上限のページ数
  */
-void callInsertRecord()
+void callCreatePartition()
 {
-    char *tableName;
+    char *name;
     char *token;
-    int i;
-    TableInfo *tableInfo;
-    RecordData *recordData;
-
-    /* insertの次のトークンを読み込み、それが"into"かどうかをチェック */
-    token = getNextToken();
-    if (token == NULL || strcmp(token, "into") != 0) {
-        /* 文法エラー */
-        printf("入力行に間違いがあります。(insert)\n");
-        return;
-    }
+    int minFrames, maxFrames;
 
-    
-    /* 次のトークンを読み込み、テーブル名を取得 */
-    tableName = getNextToken();
-    if (tableName == NULL) {
-        /* 文法エラー */
-        printf("入力行に間違いがあります。(テーブル名)\n");
-        return;
+    /* パーティション名を読み込む */
+    if ((name = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
     }
 
-    
-    /* 次のトークンを読み込み、それが"values"かどうかをチェック */
+    /* "min"とページ数を読み込む */
     token = getNextToken();
-    if (token == NULL || strcmp(token, "values") != 0) {
-        /* 文法エラー */
-        printf("入力行に間違いがあります。(values)\n");
-        return;
+    if (token == NULL || strcmp(token, "min") != 0 || (token = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
     }
+    minFrames = atoi(token);
 
-    
-    /* 次のトークンを読み込み、それが"("かどうかをチェック */
+    /* "max"とページ数を読み込む */
     token = getNextToken();
-    if (token == NULL || strcmp(token, "(") != 0) {
-        /* 文法エラー */
-        printf("入力行に間違いがあります。\n");
-        return;
-    }
-
-    /*tableの情報を取得*/
-
-    if((tableInfo = getTableInfo(tableName)) == NULL){
-        printf("テーブル情報を取得できません");
-        return;
-    }
-
-    recordData = (RecordData *)malloc(sizeof(RecordData));
-    /*ここからフィールド値をゲットしてrecordDataに入れてく*/
-    for(i=0; i<tableInfo->numField; i++){
-        token = getNextToken();
-        if(token == NULL){
-            printf("入力行に間違いがあります\n");
-            freeTableInfo(tableInfo);
-            free(recordData);
-            return;
-        }
-        strcpy(recordData->fieldData[i].name, tableInfo->fieldInfo[i].name);
-        recordData->fieldData[i].dataType = tableInfo->fieldInfo[i].dataType;
-        if(tableInfo->fieldInfo[i].dataType == TYPE_INTEGER){
-            recordData->fieldData[i].intValue = atoi(token);
-        }
-        else if(tableInfo->fieldInfo[i].dataType == TYPE_STRING){
-            strcpy(recordData->fieldData[i].stringValue, token);
-        }
-        else{
-            printf("入力行に間違いがあります\n");
-            freeTableInfo(tableInfo);
-            free(recordData);
-            return;
-        }
-
-        token = getNextToken();
-        if(token == NULL|| (strcmp(token, ",") != 0 && i<tableInfo->numField-1)){
-            /*文法エラー*/
-            printf("入力行に間違いがあります\n");
-            freeTableInfo(tableInfo);
-            free(recordData);
-            return;
-        }
+    if (token == NULL || strcmp(token, "max") != 0 || (token = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
     }
+    maxFrames = atoi(token);
 
-    if(insertRecord(tableName, recordData) == NG){
-        printf("入力行に間違いがあります\n");
-        freeTableInfo(tableInfo);
-        free(recordData);
-        return;
+    if (createBufferPartition(name, minFrames, maxFrames) == OK) {
+	printf("パーティション%sを作成しました。\n", name);
+    } else {
+	printf("パーティション%sの作成に失敗しました。\n", name);
     }
-    
-
-    printf("データの挿入に成功しました");
-    freeTableInfo(tableInfo);
-    free(recordData);
-
-
-
-
-
 }
 
 /*
- * callSelectRecord -- select文の構文解析とselectRecordの呼び出し
+ * callCreateIndex -- create index文の構文解析とcreateIndexWithTypeの呼び出し
  *
  * 引数:
  *	なし
@@ -441,147 +710,648 @@ void callInsertRecord()
  * 返り値:
  *	なし
  *
- * selectの書式:
- *	select * from テーブル名 where 条件式
- *	select フィールド名 , ... from テーブル名 where 条件式 (発展課題)
+ * create indexの書式:
+ *	create index 索引名 on テーブル名 ( フィールド名 ) [ using { btree | hash | bitmap | trigram } ]
+ *
+ * 索引を作ったフィールドについての条件の検索と削除には、自動的に索引が使われる。
+ * B+木(btree、省略時)は=、<、>の条件に、ハッシュ(hash)は=の条件にだけ使われる。
+ * ビットマップ(bitmap)は値の種類が少ないフィールド向けで、!=を含むすべての条件に使われる。
+ * トライグラム(trigram)は文字列のフィールドにだけ作れ、likeの条件に使われる。
  */
-void callSelectRecord()
+void callCreateIndex()
 {
     char *token;
-    char *tableName;
-    char *fieldName;
-    char *str;
-    int numField;
-    int i;
-    TableInfo *tableInfo;
-    Condition condition;
-    FieldInfo fieldInfo;
-    OperatorType ope;
-    RecordSet *recordSet;
+    char indexName[MAX_INDEX_NAME];
+    char tableName[MAX_FILENAME];
+    char fieldName[MAX_FIELD_NAME];
+    IndexType type;
 
+    /* 索引名を読み込む */
+    if ((token = getNextToken()) == NULL || strlen(token) >= MAX_INDEX_NAME) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+    strcpy(indexName, token);
 
-    /* selectの次のトークンを読み込み、それが"*"かどうかをチェック */
+    /* "on"とテーブル名を読み込む */
     token = getNextToken();
-    if (token == NULL || (strcmp(token, "*") != 0 && strcmp(token, "distinct") != 0)) {
-        /* 文法エラー */
-        printf("入力行に間違いがあります。\n");
-        return;
+    if (token == NULL || strcmp(token, "on") != 0 || (token = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
     }
+    snprintf(tableName, MAX_FILENAME, "%s", token);
 
-    //重複確認
-    if(strcmp(token, "distinct") == 0){
-        condition.distinct = DISTINCT;
+    /* 開きカッコ、フィールド名、閉じカッコを読み込む */
+    token = getNextToken();
+    if (token == NULL || strcmp(token, "(") != 0 || (token = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
     }
-    else{
-        condition.distinct = NOT_DISTINCT;
+    snprintf(fieldName, MAX_FIELD_NAME, "%s", token);
+    token = getNextToken();
+    if (token == NULL || strcmp(token, ")") != 0) {
+	printf("入力行に間違いがあります。\n");
+	return;
     }
 
-
-    /* 次のトークンを読み込み、それが"from"かどうかをチェック */
+    /* 索引の種類を読み込む(省略したらB+木) */
+    type = INDEX_BTREE;
+    if ((token = getNextToken()) != NULL) {
+	if (strcmp(token, "using") != 0 || (token = getNextToken()) == NULL) {
+	    printf("入力行に間違いがあります。\n");
+	    return;
+	}
+	if (strcmp(token, "hash") == 0) {
+	    type = INDEX_HASH;
+	} else if (strcmp(token, "bitmap") == 0) {
+	    type = INDEX_BITMAP;
+	} else if (strcmp(token, "trigram") == 0) {
+	    type = INDEX_TRIGRAM;
+	} else if (strcmp(token, "btree") != 0) {
+	    printf("索引の種類%sは使えません。\n", token);
+	    return;
+	}
+    }
+
+    if (createIndexWithType(indexName, tableName, fieldName, type) == OK) {
+	printf("索引%sを作成しました。\n", indexName);
+    } else {
+	printf("索引%sの作成に失敗しました。\n", indexName);
+    }
+}
+
+/*
+ * callAlterTable -- alter table文の構文解析とsetTablePartitionの呼び出し
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ *
+ * alter tableの書式:
+ *	alter table テーブル名 partition パーティション名
+ */
+void callAlterTable()
+{
+    char *tableName;
+    char *token;
+
+    /* alterの次のトークンを読み込み、それが"table"かどうかをチェック */
     token = getNextToken();
-    if (token == NULL || strcmp(token, "from") != 0) {
+    if (token == NULL || strcmp(token, "table") != 0) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+
+    /* テーブル名を読み込む */
+    if ((tableName = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+
+    /* "partition"とパーティション名を読み込む */
+    token = getNextToken();
+    if (token == NULL || strcmp(token, "partition") != 0 || (token = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+
+    if (setTablePartition(tableName, token) == OK) {
+	printf("%sのパーティションを%sに変更しました。\n", tableName, token);
+    } else {
+	printf("%sのパーティションの変更に失敗しました。\n", tableName);
+    }
+}
+
+/*
+ * callClusterTable -- cluster table文の構文解析とclusterTableの呼び出し
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ *
+ * cluster tableの書式:
+ *	cluster table テーブル名 [ by ( フィールド名 ) ]
+ *
+ * テーブルのレコードをフィールドの値の順に並べ直し、そのフィールドの
+ * クラスタ化テーブルにする。byを省略すると、今のクラスタ化テーブルのキーで並べ直す。
+ */
+void callClusterTable()
+{
+    char *tableName;
+    char *fieldName = NULL;
+    char *token;
+
+    /* clusterの次のトークンを読み込み、それが"table"かどうかをチェック */
+    token = getNextToken();
+    if (token == NULL || strcmp(token, "table") != 0) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+
+    /* テーブル名を読み込む */
+    if ((tableName = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+
+    /* "by ( フィールド名 )"があれば読み込む */
+    if ((token = getNextToken()) != NULL) {
+	if (strcmp(token, "by") != 0
+	    || (token = getNextToken()) == NULL || strcmp(token, "(") != 0
+	    || (fieldName = getNextToken()) == NULL
+	    || (token = getNextToken()) == NULL || strcmp(token, ")") != 0) {
+	    printf("入力行に間違いがあります。\n");
+	    return;
+	}
+    }
+
+    if (clusterTable(tableName, fieldName) == OK) {
+	printf("%sのレコードを並べ直しました。\n", tableName);
+    } else {
+	printf("%sのレコードの並べ直しに失敗しました。\n", tableName);
+    }
+}
+
+/*
+ * callTruncateTable -- truncate table文の構文解析とtruncateSeriesTableの呼び出し
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ *
+ * truncate tableの書式:
+ *	truncate table テーブル名 before 時刻
+ *
+ * 時系列テーブルの、時刻より前のレコードだけが入った先頭のページをまとめて捨てる。
+ */
+void callTruncateTable()
+{
+    char *tableName;
+    char *token;
+
+    /* truncateの次のトークンを読み込み、それが"table"かどうかをチェック */
+    token = getNextToken();
+    if (token == NULL || strcmp(token, "table") != 0) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+
+    /* テーブル名を読み込む */
+    if ((tableName = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+
+    /* "before 時刻"を読み込む */
+    if ((token = getNextToken()) == NULL || strcmp(token, "before") != 0
+	|| (token = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+
+    if (truncateSeriesTable(tableName, atoi(token)) == OK) {
+	printf("%sの%sより前のレコードを捨てました。\n", tableName, token);
+    } else {
+	printf("%sのレコードを捨てられませんでした。\n", tableName);
+    }
+}
+
+/*
+ * stepBackgroundVacuum -- バックグラウンドのvacuumを少し進める
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	常に0
+ *
+ * readlineが入力を待っている間に繰り返し呼ばれる(rl_event_hook)。1回に
+ * VACUUM_STEP_PAGESページだけ調べて返るので、入力を待たせず、回収の速さも抑えられる。
+ * 回収し終わるか失敗したら、呼ばれないようにする。
+ */
+static int stepBackgroundVacuum(void)
+{
+    int result;
+
+    if (backgroundVacuumTable[0] == '\0') {
+	rl_event_hook = NULL;
+	return 0;
+    }
+    if ((result = vacuumTable(backgroundVacuumTable, VACUUM_STEP_PAGES)) != 1) {
+	if (result == -1) {
+	    printf("\n%sの領域の回収に失敗しました。\n", backgroundVacuumTable);
+	    rl_on_new_line();
+	    rl_redisplay();
+	}
+	backgroundVacuumTable[0] = '\0';
+	rl_event_hook = NULL;
+    }
+    return 0;
+}
+
+/*
+ * callVacuumTable -- vacuum table文の構文解析とvacuumTableの呼び出し
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ *
+ * vacuum tableの書式:
+ *	vacuum table テーブル名 [ background ]
+ *
+ * 削除で空いたデータファイルの末尾のページのレコードを前の方のページに詰め、
+ * 空になったページを切り詰める。backgroundを指定すると、すぐに次の入力に戻り、
+ * 入力を待っている間に少しずつ回収する(同時にバックグラウンドで回収できるのは1つのテーブルだけ)。
+ */
+void callVacuumTable()
+{
+    char *tableName;
+    char *token;
+
+    /* vacuumの次のトークンを読み込み、それが"table"かどうかをチェック */
+    token = getNextToken();
+    if (token == NULL || strcmp(token, "table") != 0) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+
+    /* テーブル名を読み込む */
+    if ((tableName = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+
+    /* "background"があれば、入力待ちの間に回収する */
+    if ((token = getNextToken()) != NULL) {
+	if (strcmp(token, "background") != 0) {
+	    printf("入力行に間違いがあります。\n");
+	    return;
+	}
+	strncpy(backgroundVacuumTable, tableName, MAX_INPUT - 1);
+	rl_event_hook = stepBackgroundVacuum;
+	printf("%sの領域をバックグラウンドで回収します。\n", tableName);
+	return;
+    }
+
+    /* バックグラウンドで回収中のテーブルなら、ここで最後まで回収する */
+    if (strcmp(backgroundVacuumTable, tableName) == 0) {
+	backgroundVacuumTable[0] = '\0';
+	rl_event_hook = NULL;
+    }
+    if (vacuumTable(tableName, 0) == 0) {
+	printf("%sの領域を回収しました。\n", tableName);
+    } else {
+	printf("%sの領域の回収に失敗しました。\n", tableName);
+    }
+}
+
+/*
+ * callShow -- show文の構文解析と各種情報の表示
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ *
+ * showの書式:
+ *	show partitions
+ *	show query      (直前のselect・deleteで読んだページ数と読み飛ばしたページ数)
+ */
+void callShow()
+{
+    char *token;
+
+    token = getNextToken();
+    if (token != NULL && strcmp(token, "partitions") == 0) {
+	printBufferPartitionStats();
+    } else if (token != NULL && strcmp(token, "query") == 0) {
+	printQueryStat();
+    } else {
+	printf("入力行に間違いがあります。\n");
+    }
+}
+
+/*
+ * setFieldValue -- 値の字句をフィールドのデータ型の値にする
+ *
+ * 引数:
+ *	token: 値の字句
+ *	dataType: フィールドのデータ型
+ *	intValue: 整数の値を格納する場所
+ *	stringValue: 文字列の値を格納するMAX_VARSTRINGバイトの領域
+ *
+ * 返り値:
+ *	成功ならOK、整数でない字句や長すぎる文字列の場合はNGを返す
+ *
+ * insertの値、updateのsetの値、条件式の値で共通に使う。文字列は字句をそのまま
+ * (「'」で囲んであれば「'」も含めて)値にするので、挿入した値と同じ字句で検索できる。
+ */
+static Result setFieldValue(char *token, DataType dataType, int *intValue, char *stringValue)
+{
+    char *end;
+    long value;
+
+    if (dataType == TYPE_INTEGER) {
+	errno = 0;
+	value = strtol(token, &end, 10);
+	if (end == token || *end != '\0' || errno == ERANGE || value != (int) value) {
+	    return NG;
+	}
+	*intValue = (int) value;
+	return OK;
+    }
+    if (dataType != TYPE_STRING || strlen(token) >= MAX_VARSTRING) {
+	return NG;
+    }
+    strcpy(stringValue, token);
+    return OK;
+}
+
+/*
+ * parseCondition -- 条件式の構文解析
+ *
+ * 引数:
+ *	tableInfo: 検索するテーブルのデータ定義情報
+ *	condition: 読み込んだ条件を格納する場所(distinctは変えない)
+ *
+ * 返り値:
+ *	正しく読めればOK、間違いがあればメッセージを表示してNGを返す
+ *
+ * 条件式の書式:
+ *	フィールド名 { = | != | > | < | like } 値
+ *
+ * select、delete、updateのwhereの後ろで共通に使う。likeは文字列型のフィールドにだけ使える。
+ */
+static Result parseCondition(TableInfo *tableInfo, Condition *condition)
+{
+    char *token;
+    FieldInfo fieldInfo;
+    OperatorType ope;
+
+    /* フィールド名を読み込み、そのデータ型を調べる */
+    if ((token = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return NG;
+    }
+    fieldInfo = checkFieldName(token, tableInfo);
+    if (strcmp(fieldInfo.name, "") == 0) {
+	printf("フィールド%sは存在しないです。\n", token);
+	return NG;
+    }
+    strcpy(condition->name, fieldInfo.name);
+    condition->dataType = fieldInfo.dataType;
+
+    /* 比較演算子を読み込む */
+    if ((token = getNextToken()) == NULL) {
+	printf("比較演算子が不正です\n");
+	return NG;
+    }
+    ope = checkOperator(token);
+    if ((ope != OPR_EQUAL && ope != OPR_NOT_EQUAL && ope != OPR_LESS_THAN && ope != OPR_GREATER_THAN
+	 && ope != OPR_LIKE) || (ope == OPR_LIKE && condition->dataType != TYPE_STRING)) {
+	printf("比較演算子が不正です\n");
+	return NG;
+    }
+    condition->operator = ope;
+
+    /* 比べる値を読み込む */
+    if ((token = getNextToken()) == NULL
+	|| setFieldValue(token, condition->dataType, &condition->intValue, condition->stringValue) != OK) {
+	printf("値が不正です\n");
+	return NG;
+    }
+    return OK;
+}
+
+/*
+ * callInsertRecord -- insert文の構文解析とinsertRecordの呼び出し
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ *
+ * insertの書式:
+ *	insert into テーブル名 values ( フィールド値 , ... )
+ */
+void callInsertRecord()
+{
+    char *tableName;
+    char *token;
+    int i;
+    TableInfo *tableInfo;
+    RecordData *recordData;
+
+    /* insertの次のトークンを読み込み、それが"into"かどうかをチェック */
+    token = getNextToken();
+    if (token == NULL || strcmp(token, "into") != 0) {
         /* 文法エラー */
-        printf("入力行に間違いがあります。\n");
+        printf("入力行に間違いがあります。(insert)\n");
         return;
     }
 
-    /* 次のトークンを読み込み、tablenameに保存*/
-    if ((tableName = getNextToken()) == NULL){
-        /*文法エラー*/
-        printf("入力行に間違いがあります\n");
+    
+    /* 次のトークンを読み込み、テーブル名を取得 */
+    tableName = getNextToken();
+    if (tableName == NULL) {
+        /* 文法エラー */
+        printf("入力行に間違いがあります。(テーブル名)\n");
         return;
     }
 
-    tableInfo = getTableInfo(tableName);
-
-    /* 次のトークンを読み込み、それが"where"かどうかをチェック */
+    
+    /* 次のトークンを読み込み、それが"values"かどうかをチェック */
     token = getNextToken();
-    if (token == NULL || strcmp(token, "where") != 0) {
+    if (token == NULL || strcmp(token, "values") != 0) {
         /* 文法エラー */
-        printf("入力行に間違いがあります。\n");
-        freeTableInfo(tableInfo);
+        printf("入力行に間違いがあります。(values)\n");
         return;
     }
 
-    /*
-     * 条件式を読み込む
-     * 次のトークンを読み込み、それがフィールド名かどうかをチェック
-     */
+    
+    /* 次のトークンを読み込み、それが"("かどうかをチェック */
     token = getNextToken();
-    fieldInfo = checkFieldName(token, tableInfo);
-    if (token == NULL || strcmp(fieldInfo.name, "") == 0){
+    if (token == NULL || strcmp(token, "(") != 0) {
         /* 文法エラー */
-        printf("フィールド%sは存在しないです。\n",token);
-        freeTableInfo(tableInfo);
+        printf("入力行に間違いがあります。\n");
         return;
     }
 
-    fieldName = token;
+    /*tableの情報を取得*/
 
-    /* 条件式に指定されたフィールドのデータ型を調べる */
-    condition.dataType = TYPE_UNKNOWN;
-    for (i = 0; i < tableInfo->numField; i++) {
-        if (strcmp(tableInfo->fieldInfo[i].name, fieldName) == 0) {
-            /* フィールドのデータ型を構造体に設定してループを抜ける */
-            condition.dataType = tableInfo->fieldInfo[i].dataType;
-            break;
+    if((tableInfo = getTableInfo(tableName)) == NULL){
+        printf("テーブル情報を取得できません");
+        return;
+    }
+
+    recordData = (RecordData *)malloc(sizeof(RecordData));
+    recordData->numField = tableInfo->numField;
+    /*ここからフィールド値をゲットしてrecordDataに入れてく*/
+    for(i=0; i<tableInfo->numField; i++){
+        token = getNextToken();
+        if(token == NULL){
+            printf("入力行に間違いがあります\n");
+            freeTableInfo(tableInfo);
+            free(recordData);
+            return;
         }
+        strcpy(recordData->fieldData[i].name, tableInfo->fieldInfo[i].name);
+        recordData->fieldData[i].dataType = tableInfo->fieldInfo[i].dataType;
+        if (setFieldValue(token, recordData->fieldData[i].dataType, &recordData->fieldData[i].intValue,
+                          recordData->fieldData[i].stringValue) != OK) {
+            printf("フィールド%sの値%sが不正です\n", recordData->fieldData[i].name, token);
+            freeTableInfo(tableInfo);
+            free(recordData);
+            return;
+        }
+
+        token = getNextToken();
+        if(token == NULL|| (strcmp(token, ",") != 0 && i<tableInfo->numField-1)){
+            /*文法エラー*/
+            printf("入力行に間違いがあります\n");
+            freeTableInfo(tableInfo);
+            free(recordData);
+            return;
+        }
+    }
+
+    if(insertRecord(tableName, recordData) == NG){
+        printf("入力行に間違いがあります\n");
+        freeTableInfo(tableInfo);
+        free(recordData);
+        return;
     }
+    
 
+    printf("データの挿入に成功しました");
     freeTableInfo(tableInfo);
+    free(recordData);
 
 
 
 
-    token = getNextToken();
-    ope = checkOperator(token);
 
+}
 
-    if(ope != OPR_EQUAL && ope != OPR_NOT_EQUAL && ope != OPR_LESS_THAN && ope != OPR_GREATER_THAN){
-        /* 文法エラー*/
-        printf("比較演算子が不正です\n");
-        freeTableInfo(tableInfo);
-        return;
-    }
+/*
+ * callSelectRecord -- select文の構文解析とselectRecordの呼び出し
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ *
+ * selectの書式:
+ *	select * from テーブル名 where 条件式
+ *	select フィールド名 , ... from テーブル名 where 条件式 (発展課題)
+ */
+void callSelectRecord()
+{
+    char *token;
+    char *tableName;
+    TableInfo *tableInfo;
+    Condition condition;
+    RecordSet *recordSet;
+    Result result;
+    int countOnly = 0;
+    int numRecord;
 
 
-    //「'」に囲まれているか確認
+    /* selectの次のトークンを読み込み、それが"*"かどうかをチェック */
     token = getNextToken();
-    if(strcmp(token, "") == 0){
-        printf("文字列が不正です\n");
+    if (token == NULL || (strcmp(token, "*") != 0 && strcmp(token, "distinct") != 0
+                          && strcmp(token, "count") != 0)) {
+        /* 文法エラー */
+        printf("入力行に間違いがあります。\n");
         return;
     }
-    if(condition.dataType == TYPE_INTEGER){
-        //int型の場合
-        condition.intValue = atoi(token);
-    }
-    else if(condition.dataType == TYPE_STRING){
-        //stringがたの場合
-        //「'」を取り除く
-        if(strcmp(&token[0], "'") != 0 && strcmp(&token[strlen(token)-1], "'") != 0){
-            printf("文字列は「'」で囲んでください");
+
+    /* "count ( * )"ならレコード数だけを表示する */
+    if (strcmp(token, "count") == 0) {
+        if ((token = getNextToken()) == NULL || strcmp(token, "(") != 0
+            || (token = getNextToken()) == NULL || strcmp(token, "*") != 0
+            || (token = getNextToken()) == NULL || strcmp(token, ")") != 0) {
+            /* 文法エラー */
+            printf("入力行に間違いがあります。\n");
             return;
         }
-        str = strtok(token, "'");
-        strcpy(condition.stringValue, str);
+        countOnly = 1;
+    }
+
+    //重複確認
+    if(strcmp(token, "distinct") == 0){
+        condition.distinct = DISTINCT;
     }
     else{
+        condition.distinct = NOT_DISTINCT;
+    }
+
+
+    /* 次のトークンを読み込み、それが"from"かどうかをチェック */
+    token = getNextToken();
+    if (token == NULL || strcmp(token, "from") != 0) {
+        /* 文法エラー */
+        printf("入力行に間違いがあります。\n");
+        return;
+    }
+
+    /* 次のトークンを読み込み、tablenameに保存*/
+    if ((tableName = getNextToken()) == NULL){
+        /*文法エラー*/
         printf("入力行に間違いがあります\n");
         return;
     }
 
-   //conditionにセットする
-   strcpy(condition.name, fieldName);
-   condition.operator = ope;
+    /* 条件のない"select count(*) from テーブル名"は、データファイルを読まずに答える */
+    token = getNextToken();
+    if (countOnly && token == NULL) {
+        if ((numRecord = countRecord(tableName)) == -1) {
+            printf("検索に失敗しました\n");
+            return;
+        }
+        printf("count(*) = %d\n", numRecord);
+        return;
+    }
 
+    /* 次のトークンが"where"かどうかをチェック */
+    if (token == NULL || strcmp(token, "where") != 0) {
+        /* 文法エラー */
+        printf("入力行に間違いがあります。\n");
+        return;
+    }
 
+    /* 条件式を読み込む */
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        printf("テーブル%sは存在しません。\n", tableName);
+        return;
+    }
+    result = parseCondition(tableInfo, &condition);
+    freeTableInfo(tableInfo);
+    if (result != OK) {
+        return;
+    }
 
    if((recordSet = selectRecord(tableName, &condition)) == NULL){
        printf("検索に失敗しました");
        return;
    }
 
-   printRecordSet(recordSet);
+   if (countOnly) {
+       printf("count(*) = %d\n", recordSet->numRecord);
+   } else {
+       printRecordSet(recordSet);
+   }
 
    freeRecordSet(recordSet);
 
@@ -609,6 +1379,9 @@ OperatorType checkOperator(char *token){
     else if(strcmp(token, "<") == 0){
         return OPR_LESS_THAN;
     }
+    else if(strcmp(token, "like") == 0){
+        return OPR_LIKE;
+    }
     else{
         return -1;
     }
@@ -650,15 +1423,12 @@ FieldInfo checkFieldName(char *fieldName, TableInfo *tableInfo){
  */
 void callDeleteRecord()
 {
-    int i;
     char *tableName;
     char *token;
-    char *fieldName;
-    char *str;
     TableInfo *tableInfo;
     Condition condition;
-    FieldInfo fieldInfo;
-    OperatorType ope;
+    Result result;
+
     /* deleteの次のトークンを読み込み、それが"from"かどうかをチェック */
     token = getNextToken();
     if (token == NULL || strcmp(token, "from") != 0) {
@@ -676,88 +1446,124 @@ void callDeleteRecord()
         return;
     }
 
-    tableInfo = getTableInfo(tableName);
-
     /* 次のトークンを読み込み、それが"where"かどうかをチェック */
     token = getNextToken();
     if (token == NULL || strcmp(token, "where") != 0) {
         /* 文法エラー */
         printf("入力行に間違いがあります。\n");
-        freeTableInfo(tableInfo);
         return;
     }
 
-    token = getNextToken();
-    fieldInfo = checkFieldName(token, tableInfo);
-    if (token == NULL || strcmp(fieldInfo.name, "") == 0){
-        /* 文法エラー */
-        printf("フィールド%sは存在しないです。\n",token);
-        freeTableInfo(tableInfo);
+    /* 条件式を読み込む */
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+        printf("テーブル%sは存在しません。\n", tableName);
         return;
     }
-    fieldName = token;
-
-    /* 条件式に指定されたフィールドのデータ型を調べる */
-    condition.dataType = TYPE_UNKNOWN;
-    for (i = 0; i < tableInfo->numField; i++) {
-        if (strcmp(tableInfo->fieldInfo[i].name, fieldName) == 0) {
-            /* フィールドのデータ型を構造体に設定してループを抜ける */
-            condition.dataType = tableInfo->fieldInfo[i].dataType;
-            break;
-        }
+    condition.distinct = NOT_DISTINCT;
+    result = parseCondition(tableInfo, &condition);
+    freeTableInfo(tableInfo);
+    if (result != OK) {
+        return;
     }
 
-    freeTableInfo(tableInfo);
+   if(deleteRecord(tableName, &condition) == NG){
+       printf("%sのデリート失敗しました", condition.stringValue);
+   }
 
-    token = getNextToken();
-    ope = checkOperator(token);
+   printf("%sをデリートしました", condition.stringValue);
 
+}
 
-    if(ope != OPR_EQUAL && ope != OPR_NOT_EQUAL && ope != OPR_LESS_THAN && ope != OPR_GREATER_THAN){
-        /* 文法エラー*/
-        printf("比較演算子が不正です\n");
-        freeTableInfo(tableInfo);
-        return;
-    }
+/*
+ * callUpdateRecord -- update文の構文解析とupdateRecordの呼び出し
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ *
+ * updateの書式:
+ *	update テーブル名 set フィールド名 = 値 [ , フィールド名 = 値 ... ] where 条件式
+ *
+ * 条件に合うレコードを、1回の走査でその場所のまま書き換える。
+ */
+void callUpdateRecord()
+{
+    char *tableName;
+    char *token;
+    TableInfo *tableInfo;
+    FieldInfo fieldInfo;
+    RecordData assignments;
+    FieldData *fieldData;
+    Condition condition;
+    Result result;
 
+    /* テーブル名を読み込む */
+    if ((tableName = getNextToken()) == NULL) {
+	printf("入力行に間違いがあります。\n");
+	return;
+    }
+    if ((tableInfo = getTableInfo(tableName)) == NULL) {
+	printf("テーブル%sは存在しません。\n", tableName);
+	return;
+    }
 
-    //検索文字列
-    //「'」外したりとか
+    /* "set フィールド名 = 値 , ..."を読み込む */
     token = getNextToken();
-    if(strcmp(token, "") == 0){
-        printf("文字列が不正です\n");
-        return;
+    if (token == NULL || strcmp(token, "set") != 0) {
+	printf("入力行に間違いがあります。\n");
+	freeTableInfo(tableInfo);
+	return;
     }
-    if(condition.dataType == TYPE_INTEGER){
-        //int型の場合
-        condition.intValue = atoi(token);
+    assignments.numField = 0;
+    for (;;) {
+	if ((token = getNextToken()) == NULL || assignments.numField == MAX_FIELD) {
+	    printf("入力行に間違いがあります。\n");
+	    freeTableInfo(tableInfo);
+	    return;
+	}
+	fieldInfo = checkFieldName(token, tableInfo);
+	if (strcmp(fieldInfo.name, "") == 0) {
+	    printf("フィールド%sは存在しません。\n", token);
+	    freeTableInfo(tableInfo);
+	    return;
+	}
+	fieldData = &assignments.fieldData[assignments.numField];
+	strcpy(fieldData->name, fieldInfo.name);
+	fieldData->dataType = fieldInfo.dataType;
+	if ((token = getNextToken()) == NULL || strcmp(token, "=") != 0
+	    || (token = getNextToken()) == NULL
+	    || setFieldValue(token, fieldData->dataType, &fieldData->intValue, fieldData->stringValue) != OK) {
+	    printf("入力行に間違いがあります。\n");
+	    freeTableInfo(tableInfo);
+	    return;
+	}
+	assignments.numField++;
+
+	if ((token = getNextToken()) == NULL || strcmp(token, ",") != 0) {
+	    break;
+	}
     }
-    else if(condition.dataType == TYPE_STRING){
-        //stringがたの場合
-        //「'」を取り除く
-        if(strcmp(&token[0], "'") != 0 && strcmp(&token[strlen(token)-1], "'") != 0){
-            printf("文字列は「'」で囲んでください");
-            return;
-        }
-        str = strtok(token, "'");
-        strcpy(condition.stringValue, str);
+
+    /* "where 条件式"を読み込む */
+    if (token == NULL || strcmp(token, "where") != 0) {
+	printf("入力行に間違いがあります。\n");
+	freeTableInfo(tableInfo);
+	return;
     }
-    else{
-        printf("入力行に間違いがあります\n");
-        freeTableInfo(tableInfo);
-        return;
+    condition.distinct = NOT_DISTINCT;
+    result = parseCondition(tableInfo, &condition);
+    freeTableInfo(tableInfo);
+    if (result != OK) {
+	return;
     }
 
-   //conditionにセットする
-   strcpy(condition.name, fieldName);
-   condition.operator = ope;
-
-   if(deleteRecord(tableName, &condition) == NG){
-       printf("%sのデリート失敗しました", condition.stringValue);
-   }
-
-   printf("%sをデリートしました", condition.stringValue);
-
+    if (updateRecord(tableName, &assignments, &condition) == OK) {
+	printf("%sのレコードを更新しました。\n", tableName);
+    } else {
+	printf("%sのレコードの更新に失敗しました。\n", tableName);
+    }
 }
 
 /*
@@ -768,9 +1574,24 @@ int main()
     char input[MAX_INPUT];
     char *token;
     char *line;
+    char *shmName;
+    char *numBufferString;
+    int numBuffer;
+
+    /*
+     * 環境変数MICRODB_SHMが設定されていれば、その名前の共有メモリ上の
+     * バッファプールを他のmicrodbプロセスと共有する
+     * (共有メモリは、最後に終了したmicrodbプロセスが削除する)
+     * バッファ数は環境変数MICRODB_NUM_BUFFERで変更できる
+     */
+    shmName = getenv("MICRODB_SHM");
+    numBuffer = NUM_BUFFER;
+    if ((numBufferString = getenv("MICRODB_NUM_BUFFER")) != NULL && atoi(numBufferString) > 0) {
+	numBuffer = atoi(numBufferString);
+    }
 
     /* ファイルモジュールの初期化 */
-    if (initializeFileModule() != OK) {
+    if (initializeFileModuleWithOption(numBuffer, shmName) != OK) {
 	fprintf(stderr, "Cannot initialize file module.\n");
 	exit(1);
     }
@@ -837,6 +1658,18 @@ int main()
 	    callSelectRecord();
 	} else if (strcmp(token, "delete") == 0) {
 	    callDeleteRecord();
+	} else if (strcmp(token, "update") == 0) {
+	    callUpdateRecord();
+	} else if (strcmp(token, "alter") == 0) {
+	    callAlterTable();
+	} else if (strcmp(token, "cluster") == 0) {
+	    callClusterTable();
+	} else if (strcmp(token, "truncate") == 0) {
+	    callTruncateTable();
+	} else if (strcmp(token, "vacuum") == 0) {
+	    callVacuumTable();
+	} else if (strcmp(token, "show") == 0) {
+	    callShow();
 	} else {
 	    /* 入力に間違いがあった */
 	    printf("入力に間違いがあります。\n");
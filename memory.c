@@ -0,0 +1,536 @@
+/*
+ * memory.c -- インメモリテーブルのモジュール
+ *
+ * create memory tableで作ったテーブル(インメモリテーブル)は、データ定義ファイルも
+ * データファイルも作らず、定義とレコードをこのプロセスのメモリ上にだけ置く。
+ * ファイルもバッファプールも通らないので、挿入、検索、削除でページの読み書きは起きない。
+ * インメモリテーブルはfinalizeDataManipModuleで(プログラムの終了時に)削除される。
+ *
+ * レコードはフィールドごとの配列(列)に、挿入の順に詰めて格納する。
+ * 整数型のフィールドはintの配列、文字列型のフィールドはmallocした文字列へのポインタの
+ * 配列で、条件の判定ではそのフィールドの配列だけを先頭から順に読む。
+ * レコードを削除すると、最後のレコードをその位置に移して穴を空けないので、
+ * 検索結果の順序は挿入の順とは限らず、検索結果のレコードは位置(rid)を持たない。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * MemoryColumn -- インメモリテーブルの1つのフィールドの値の配列
+ */
+typedef struct MemoryColumn MemoryColumn;
+struct MemoryColumn {
+    int *intValues;                     /*整数型のフィールドの値*/
+    char **stringValues;                /*文字列型のフィールドの値(mallocした領域)*/
+};
+
+/*
+ * MemoryTable -- インメモリテーブル
+ */
+typedef struct MemoryTable MemoryTable;
+struct MemoryTable {
+    char tableName[MAX_FILENAME];       /*テーブル名*/
+    TableInfo tableInfo;                /*データ定義情報*/
+    MemoryColumn columns[MAX_FIELD];    /*フィールドごとの値の配列*/
+    int numRecord;                      /*レコード数*/
+    int maxRecord;                      /*配列の大きさ*/
+    MemoryTable *next;                  /*次のテーブル*/
+};
+
+/*
+ * memoryTableList -- インメモリテーブルのリスト
+ */
+static MemoryTable *memoryTableList = NULL;
+
+/*
+ * findMemoryTable -- インメモリテーブルを探す
+ */
+static MemoryTable *findMemoryTable(char *tableName)
+{
+    MemoryTable *table;
+
+    for (table = memoryTableList; table != NULL; table = table->next) {
+        if (strcmp(table->tableName, tableName) == 0) {
+            return table;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * freeMemoryTable -- インメモリテーブルのメモリを解放する
+ */
+static void freeMemoryTable(MemoryTable *table)
+{
+    int i, j;
+
+    for (i = 0; i < table->tableInfo.numField; i++) {
+        if (table->columns[i].stringValues != NULL) {
+            for (j = 0; j < table->numRecord; j++) {
+                free(table->columns[i].stringValues[j]);
+            }
+        }
+        free(table->columns[i].intValues);
+        free(table->columns[i].stringValues);
+    }
+    free(table);
+}
+
+/*
+ * growMemoryTable -- フィールドごとの配列を、レコードを1つ加えられる大きさにする
+ */
+static Result growMemoryTable(MemoryTable *table)
+{
+    MemoryColumn *column;
+    void *grown;
+    int maxRecord;
+    int i;
+
+    if (table->numRecord < table->maxRecord) {
+        return OK;
+    }
+    maxRecord = table->maxRecord == 0 ? 256 : table->maxRecord * 2;
+    for (i = 0; i < table->tableInfo.numField; i++) {
+        column = &table->columns[i];
+        if (table->tableInfo.fieldInfo[i].dataType == TYPE_INTEGER) {
+            grown = realloc(column->intValues, maxRecord * sizeof(int));
+        } else {
+            grown = realloc(column->stringValues, maxRecord * sizeof(char *));
+        }
+        if (grown == NULL) {
+            /* 大きくできた配列はそのまま使う(maxRecordは小さい方のまま) */
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            return NG;
+        }
+        if (table->tableInfo.fieldInfo[i].dataType == TYPE_INTEGER) {
+            column->intValues = (int *) grown;
+        } else {
+            column->stringValues = (char **) grown;
+        }
+    }
+    table->maxRecord = maxRecord;
+    return OK;
+}
+
+/*
+ * findMemoryField -- 条件のフィールドの番号を求める
+ */
+static int findMemoryField(MemoryTable *table, Condition *condition)
+{
+    int i;
+
+    for (i = 0; i < table->tableInfo.numField; i++) {
+        if (strcmp(table->tableInfo.fieldInfo[i].name, condition->name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * matchMemoryRecord -- row番目のレコードが条件に合うかどうかの判定
+ *
+ * checkConditionと同じ比較を、RecordDataを作らずにフィールドの配列の値で行う。
+ */
+static int matchMemoryRecord(MemoryTable *table, int field, int row, Condition *condition)
+{
+    int cmp;
+
+    if (table->tableInfo.fieldInfo[field].dataType == TYPE_INTEGER) {
+        if (condition->operator == OPR_LIKE) {
+            return 0;
+        }
+        cmp = table->columns[field].intValues[row] < condition->intValue ? -1
+            : table->columns[field].intValues[row] > condition->intValue;
+    } else {
+        if (condition->operator == OPR_LIKE) {
+            return matchLike(table->columns[field].stringValues[row], condition->stringValue);
+        }
+        cmp = strcmp(table->columns[field].stringValues[row], condition->stringValue);
+    }
+
+    switch (condition->operator) {
+    case OPR_EQUAL:
+        return cmp == 0;
+    case OPR_NOT_EQUAL:
+        return cmp != 0;
+    case OPR_GREATER_THAN:
+        return cmp > 0;
+    case OPR_LESS_THAN:
+        return cmp < 0;
+    default:
+        return 0;
+    }
+}
+
+/*
+ * removeMemoryRecord -- row番目のレコードを取り除き、最後のレコードをその位置に移す
+ */
+static void removeMemoryRecord(MemoryTable *table, int row)
+{
+    MemoryColumn *column;
+    int last = table->numRecord - 1;
+    int i;
+
+    for (i = 0; i < table->tableInfo.numField; i++) {
+        column = &table->columns[i];
+        if (table->tableInfo.fieldInfo[i].dataType == TYPE_INTEGER) {
+            column->intValues[row] = column->intValues[last];
+        } else {
+            free(column->stringValues[row]);
+            column->stringValues[row] = column->stringValues[last];
+        }
+    }
+    table->numRecord--;
+}
+
+/*
+ * createMemoryTable -- インメモリテーブルの作成
+ *
+ * 引数:
+ *	tableName: 作成するテーブルの名前
+ *	tableInfo: データ定義情報
+ *
+ * 返り値:
+ *	成功ならOK、失敗(同じ名前のインメモリテーブルがある場合を含む)ならNGを返す
+ *
+ * tableInfo->optionは使わない(インメモリテーブルにはほかの格納方法の設定はない)。
+ */
+Result createMemoryTable(char *tableName, TableInfo *tableInfo)
+{
+    MemoryTable *table;
+    int i;
+
+    if (findMemoryTable(tableName) != NULL || strlen(tableName) >= MAX_FILENAME
+        || tableInfo->numField < 0 || tableInfo->numField > MAX_FIELD) {
+        return NG;
+    }
+    if ((table = (MemoryTable *) calloc(1, sizeof(MemoryTable))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    strcpy(table->tableName, tableName);
+    table->tableInfo.numField = tableInfo->numField;
+    for (i = 0; i < tableInfo->numField; i++) {
+        table->tableInfo.fieldInfo[i] = tableInfo->fieldInfo[i];
+    }
+    table->tableInfo.option.memory = 1;
+
+    table->next = memoryTableList;
+    memoryTableList = table;
+    return OK;
+}
+
+/*
+ * dropMemoryTable -- インメモリテーブルの削除
+ *
+ * 引数:
+ *	tableName: 削除するテーブルの名前
+ *
+ * 返り値:
+ *	成功ならOK、失敗(インメモリテーブルがない場合を含む)ならNGを返す
+ */
+Result dropMemoryTable(char *tableName)
+{
+    MemoryTable **p;
+    MemoryTable *table;
+
+    for (p = &memoryTableList; *p != NULL; p = &(*p)->next) {
+        if (strcmp((*p)->tableName, tableName) == 0) {
+            table = *p;
+            *p = table->next;
+            freeMemoryTable(table);
+            return OK;
+        }
+    }
+    return NG;
+}
+
+/*
+ * dropMemoryTables -- すべてのインメモリテーブルの削除
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ */
+void dropMemoryTables()
+{
+    MemoryTable *table;
+
+    while ((table = memoryTableList) != NULL) {
+        memoryTableList = table->next;
+        freeMemoryTable(table);
+    }
+}
+
+/*
+ * isMemoryTable -- インメモリテーブルかどうか
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *
+ * 返り値:
+ *	インメモリテーブルなら1、そうでなければ0を返す
+ */
+int isMemoryTable(char *tableName)
+{
+    return findMemoryTable(tableName) != NULL;
+}
+
+/*
+ * getMemoryTableInfo -- インメモリテーブルのデータ定義情報の取得
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *
+ * 返り値:
+ *	データ定義情報(option.memoryは1)。使い終わったらfreeTableInfoで解放すること。
+ *	インメモリテーブルでない場合やエラーの場合はNULLを返す。
+ */
+TableInfo *getMemoryTableInfo(char *tableName)
+{
+    MemoryTable *table;
+    TableInfo *tableInfo;
+
+    if ((table = findMemoryTable(tableName)) == NULL) {
+        return NULL;
+    }
+    if ((tableInfo = (TableInfo *) malloc(sizeof(TableInfo))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    *tableInfo = table->tableInfo;
+    return tableInfo;
+}
+
+/*
+ * insertMemoryRecord -- インメモリテーブルへのレコードの挿入
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	recordData: 挿入するレコード(データ定義のフィールドの数だけ、データ定義の順に並べる)
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result insertMemoryRecord(char *tableName, RecordData *recordData)
+{
+    MemoryTable *table;
+    char *copies[MAX_FIELD];
+    int i;
+
+    if ((table = findMemoryTable(tableName)) == NULL) {
+        return NG;
+    }
+    if (growMemoryTable(table) != OK) {
+        return NG;
+    }
+
+    /* 文字列を先にすべて複製してから、配列の末尾に加える */
+    for (i = 0; i < table->tableInfo.numField; i++) {
+        copies[i] = NULL;
+        if (table->tableInfo.fieldInfo[i].dataType == TYPE_STRING
+            && (copies[i] = strdup(recordData->fieldData[i].stringValue)) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            break;
+        }
+    }
+    if (i < table->tableInfo.numField) {
+        while (--i >= 0) {
+            free(copies[i]);
+        }
+        return NG;
+    }
+    for (i = 0; i < table->tableInfo.numField; i++) {
+        if (table->tableInfo.fieldInfo[i].dataType == TYPE_INTEGER) {
+            table->columns[i].intValues[table->numRecord] = recordData->fieldData[i].intValue;
+        } else {
+            table->columns[i].stringValues[table->numRecord] = copies[i];
+        }
+    }
+    table->numRecord++;
+    return OK;
+}
+
+/*
+ * searchMemoryTable -- インメモリテーブルの検索
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	condition: 検索の条件(NULLならすべてのレコード)
+ *	stat: 検索の統計情報を格納する場所(ページは読まないので、すべて0になる)
+ *	result: 条件に合うレコードのリストを格納する場所
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * リストのレコードはフィールドの数の分だけmallocした領域で、使い終わったら1つずつfreeで解放すること。
+ */
+Result searchMemoryTable(char *tableName, Condition *condition, QueryStat *stat, RecordData **result)
+{
+    MemoryTable *table;
+    RecordData *recordData;
+    RecordData **tail = result;
+    FieldData *fieldData;
+    int field = -1;
+    int row;
+    int i;
+
+    memset(stat, 0, sizeof(QueryStat));
+    *result = NULL;
+    if ((table = findMemoryTable(tableName)) == NULL) {
+        return NG;
+    }
+    if (condition != NULL && (field = findMemoryField(table, condition)) == -1) {
+        return NG;
+    }
+
+    for (row = 0; row < table->numRecord; row++) {
+        if (condition != NULL && !matchMemoryRecord(table, field, row, condition)) {
+            continue;
+        }
+
+        /* 条件に合ったレコードだけを、フィールドの数の分のRecordDataにする */
+        if ((recordData = (RecordData *) malloc(RECORD_DATA_SIZE(table->tableInfo.numField))) == NULL) {
+            printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+            for (recordData = *result; recordData != NULL; recordData = *result) {
+                *result = recordData->next;
+                free(recordData);
+            }
+            return NG;
+        }
+        recordData->numField = table->tableInfo.numField;
+        recordData->next = NULL;
+        recordData->rid.pageNum = -1;
+        recordData->rid.slot = -1;
+        for (i = 0; i < table->tableInfo.numField; i++) {
+            fieldData = &recordData->fieldData[i];
+            strcpy(fieldData->name, table->tableInfo.fieldInfo[i].name);
+            fieldData->dataType = table->tableInfo.fieldInfo[i].dataType;
+            if (fieldData->dataType == TYPE_INTEGER) {
+                fieldData->intValue = table->columns[i].intValues[row];
+                fieldData->stringValue[0] = '\0';
+            } else {
+                fieldData->intValue = 0;
+                snprintf(fieldData->stringValue, MAX_VARSTRING, "%s", table->columns[i].stringValues[row]);
+            }
+        }
+        *tail = recordData;
+        tail = &recordData->next;
+    }
+    return OK;
+}
+
+/*
+ * deleteMemoryRecord -- インメモリテーブルのレコードの削除
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	condition: 削除するレコードの条件
+ *	stat: 削除の統計情報を格納する場所(ページは読まないので、すべて0になる)
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result deleteMemoryRecord(char *tableName, Condition *condition, QueryStat *stat)
+{
+    MemoryTable *table;
+    int field;
+    int row;
+
+    memset(stat, 0, sizeof(QueryStat));
+    if ((table = findMemoryTable(tableName)) == NULL || (field = findMemoryField(table, condition)) == -1) {
+        return NG;
+    }
+
+    /* 削除した位置には最後のレコードが移ってくるので、同じ位置をもう一度調べる */
+    row = 0;
+    while (row < table->numRecord) {
+        if (matchMemoryRecord(table, field, row, condition)) {
+            removeMemoryRecord(table, row);
+        } else {
+            row++;
+        }
+    }
+    return OK;
+}
+
+/*
+ * updateMemoryRecord -- インメモリテーブルのレコードの更新
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *	assignments: 書き換えるフィールドと値(フィールド名とデータ型は確かめておくこと)
+ *	condition: 更新するレコードの条件
+ *	stat: 更新の統計情報を格納する場所(ページは読まないので、すべて0になる)
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * 条件に合うレコードの、そのフィールドの配列の値だけを書き換える(レコードは移らない)。
+ */
+Result updateMemoryRecord(char *tableName, RecordData *assignments, Condition *condition, QueryStat *stat)
+{
+    MemoryTable *table;
+    Condition assigned;
+    char *copy;
+    int fields[MAX_FIELD];
+    int field;
+    int row;
+    int i;
+
+    memset(stat, 0, sizeof(QueryStat));
+    if ((table = findMemoryTable(tableName)) == NULL || (field = findMemoryField(table, condition)) == -1) {
+        return NG;
+    }
+    for (i = 0; i < assignments->numField; i++) {
+        strcpy(assigned.name, assignments->fieldData[i].name);
+        if ((fields[i] = findMemoryField(table, &assigned)) == -1) {
+            return NG;
+        }
+    }
+
+    for (row = 0; row < table->numRecord; row++) {
+        if (!matchMemoryRecord(table, field, row, condition)) {
+            continue;
+        }
+        for (i = 0; i < assignments->numField; i++) {
+            if (table->tableInfo.fieldInfo[fields[i]].dataType == TYPE_INTEGER) {
+                table->columns[fields[i]].intValues[row] = assignments->fieldData[i].intValue;
+                continue;
+            }
+            if ((copy = strdup(assignments->fieldData[i].stringValue)) == NULL) {
+                printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+                return NG;
+            }
+            free(table->columns[fields[i]].stringValues[row]);
+            table->columns[fields[i]].stringValues[row] = copy;
+        }
+    }
+    return OK;
+}
+
+/*
+ * countMemoryRecord -- インメモリテーブルのレコード数の取得
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *
+ * 返り値:
+ *	レコード数。インメモリテーブルでなければ-1を返す。
+ */
+int countMemoryRecord(char *tableName)
+{
+    MemoryTable *table;
+
+    if ((table = findMemoryTable(tableName)) == NULL) {
+        return -1;
+    }
+    return table->numRecord;
+}
@@ -4,6 +4,10 @@
 #ifndef __micro_INCLUDED__
 #define __micro_INCLUDED__
 
+#include <sys/types.h>
+#include <stddef.h>
+#include <time.h>
+
 /*
  * Result -- 成功/失敗を返す返り値
  */
@@ -25,6 +29,11 @@ typedef enum { NOT_DISTINCT = 0, DISTINCT = 1 } distinctFlag;
  */
 #define MAX_FILENAME 256
 
+/*
+ * MAX_PATHNAME -- バッファの書き戻しに使うファイルの絶対パスの長さの上限
+ */
+#define MAX_PATHNAME 1024
+
 /*
  * MAX_FIELD -- １レコードに含まれるフィールド数の上限
  */
@@ -36,10 +45,45 @@ typedef enum { NOT_DISTINCT = 0, DISTINCT = 1 } distinctFlag;
 #define MAX_FIELD_NAME 20
 
 /*
- * MAX_STRING -- 文字列型データの長さの上限
+ * MAX_STRING -- 文字列型データの長さの上限(固定長形式のテーブル)
  */
 #define MAX_STRING 20
 
+/*
+ * MAX_VARSTRING -- 文字列型データを保持する領域の大きさ(終端文字を含む)
+ *
+ * スロット形式のテーブルと、辞書圧縮するフィールドには、MAX_VARSTRING - 1文字までの
+ * 文字列を格納できる。
+ */
+#define MAX_VARSTRING 256
+
+/*
+ * MAX_PACK_BITS -- ビット詰めするフィールドの1つの値に使えるビット数の上限
+ */
+#define MAX_PACK_BITS 31
+
+/*
+ * BLOOM_DEFAULT_RATE -- ブルームフィルタの偽陽性率の目標のデフォルト(千分率)
+ */
+#define BLOOM_DEFAULT_RATE 10
+
+/*
+ * MAX_BLOOM_RATE -- 指定できるブルームフィルタの偽陽性率の目標の上限(千分率)
+ */
+#define MAX_BLOOM_RATE 500
+
+/*
+ * MAX_INDEX_NAME -- 索引名の長さの上限
+ */
+#define MAX_INDEX_NAME 20
+
+/*
+ * MAX_SLOT_PER_PAGE -- 1ページのスロット数の上限
+ *
+ * どの形式でも、1スロットは少なくとも使用中ビットの1ビットを使う。
+ */
+#define MAX_SLOT_PER_PAGE (PAGE_SIZE * 8)
+
 
 /*
  * NUM_BUFFER -- ファイルアクセスモジュールが管理するバッファの大きさ(ページ数)
@@ -47,6 +91,21 @@ typedef enum { NOT_DISTINCT = 0, DISTINCT = 1 } distinctFlag;
 #define NUM_BUFFER 4
 
 
+/*
+ * MAX_PARTITION -- バッファプールのパーティション数の上限
+ */
+#define MAX_PARTITION 16
+
+/*
+ * MAX_PARTITION_NAME -- パーティション名の長さの上限
+ */
+#define MAX_PARTITION_NAME 20
+
+/*
+ * DEFAULT_PARTITION_NAME -- パーティションを指定しないときに使うパーティション名
+ */
+#define DEFAULT_PARTITION_NAME "default"
+
 /*
  * File - オープンしたファイルの情報を保持する構造体
  */
@@ -54,8 +113,96 @@ typedef struct File File;
 struct File {
     int desc;                           /* ファイルディスクリプタ */
     char name[MAX_FILENAME];            /* ファイル名 */
+    dev_t dev;                          /* デバイス番号(バッファの識別用) */
+    ino_t ino;                          /* iノード番号(バッファの識別用) */
+    char path[MAX_PATHNAME];            /* 絶対パス(バッファの書き戻し用) */
+    int partition;                      /* ページを置くバッファプールのパーティション番号 */
+    struct timespec mtime;              /* オープンした時点の更新時刻 */
+    int temporary;                      /* 一時ファイルなら1(クローズで書き戻さない) */
+    File *next;                         /* オープン中のファイルのリスト */
+};
+
+
+/*
+ * BufferPartitionStat -- バッファプールのパーティションの統計情報
+ */
+typedef struct BufferPartitionStat BufferPartitionStat;
+struct BufferPartitionStat {
+    char name[MAX_PARTITION_NAME];      /* パーティション名 */
+    int minFrames;                      /* 保証するフレーム数 */
+    int maxFrames;                      /* 使えるフレーム数の上限 */
+    int numFrames;                      /* 現在使っているフレーム数 */
+    long hits;                          /* バッファにページがあった回数 */
+    long misses;                        /* バッファにページがなかった回数 */
 };
 
+/*
+ * FreeSpaceMap -- オープンした空き領域マップの情報を保持する構造体
+ */
+typedef struct FreeSpaceMap FreeSpaceMap;
+struct FreeSpaceMap {
+    File *file;                         /* 空き領域マップファイル */
+    int numPage;                        /* 記録しているデータページ数 */
+    int numFSMPage;                     /* 空き領域マップファイルのページ数 */
+    int firstFreePage;                  /* これより前のデータページには空きがない */
+    int headerModified;                 /* ヘッダを書き戻す必要があれば1 */
+};
+
+/*
+ * ZoneMap -- オープンしたゾーンマップの情報を保持する構造体
+ */
+typedef struct ZoneMap ZoneMap;
+struct ZoneMap {
+    File *file;                         /* ゾーンマップを記録したデータ定義ファイル */
+    int numPage;                        /* 項目が有効なデータページ数 */
+    int numField;                       /* 最小値と最大値を記録するフィールドの数 */
+    int numTableField;                  /* テーブルのフィールドの数(columnの有効な要素数) */
+    int column[MAX_FIELD];              /* フィールドの番号ごとの項目の中での位置(-1なら記録しない) */
+    int cachedPageNum;                  /* pageに読み込んであるページの番号(-1ならなし) */
+    char page[PAGE_SIZE];               /* 最後に使ったゾーンマップのページの内容 */
+};
+
+/*
+ * BloomFilter -- オープンしたブルームフィルタの情報を保持する構造体
+ */
+typedef struct BloomFilter BloomFilter;
+struct BloomFilter {
+    File *file;                         /* ブルームフィルタファイル */
+    int numPage;                        /* 記録しているデータページ数 */
+    int numFilterPage;                  /* ブルームフィルタファイルのページ数 */
+    int numField;                       /* フィルタを作るフィールドの数 */
+    int numTableField;                  /* テーブルのフィールドの数(columnの有効な要素数) */
+    int column[MAX_FIELD];              /* フィールドの番号ごとの項目の中での位置(-1なら作らない) */
+    int filterSize;                     /* データページ1つ、フィールド1つあたりのフィルタの大きさ(バイト数) */
+    int numHash;                        /* 1つの値について立てるビットの数 */
+    int cachedPageNum;                  /* pageに読み込んであるページの番号(-1ならなし) */
+    char page[PAGE_SIZE];               /* 最後に使ったブルームフィルタファイルのページの内容 */
+    int headerModified;                 /* ヘッダを書き戻す必要があれば1 */
+};
+
+/*
+ * Dictionary -- オープンした辞書の情報を保持する構造体
+ *
+ * 項目の番号が、その値のコードになる。
+ */
+typedef struct Dictionary Dictionary;
+struct Dictionary {
+    File *file;                         /* 辞書ファイル */
+    int numEntry;                       /* 項目数 */
+    int numSaved;                       /* 辞書ファイルに書き出し済みの項目数 */
+    int capacity;                       /* 項目ごとの配列の大きさ */
+    int *field;                         /* 項目ごとのフィールドの番号 */
+    int *offset;                        /* 項目ごとの値のpoolの中での位置 */
+    int *next;                          /* ハッシュ表で同じ位置にある次の項目の番号 */
+    int *bucket;                        /* 値のハッシュ値ごとの最初の項目の番号 */
+    char *pool;                         /* 値(終端文字つき)を詰めて収める領域 */
+    int poolSize;                       /* poolの大きさ */
+    int poolUsed;                       /* poolの使用済みのバイト数 */
+    int numPage;                        /* 項目を記録した辞書ファイルのページ数 */
+    char lastPage[PAGE_SIZE];           /* 項目を記録した最後のページの内容 */
+    int lastPageUsed;                   /* lastPageの使用済みのバイト数 */
+    int headerModified;                 /* ヘッダを書き戻す必要があれば1 */
+};
 
 /*
  * dataType -- データベースに保存するデータの型
@@ -77,6 +224,139 @@ struct FieldInfo {
     DataType dataType;          /*フィールドのデータ型*/
 };
 
+/*
+ * TableLayout -- データファイルのページ形式
+ */
+typedef enum TableLayout TableLayout;
+enum TableLayout {
+    LAYOUT_FIXED_FLAG = 0,  /*固定長形式(レコードごとの使用中フラグ、以前の形式)*/
+    LAYOUT_SLOTTED = 1,     /*スロット形式(可変長の文字列)*/
+    LAYOUT_FIXED = 2,       /*固定長形式(ページ先頭の使用中ビットマップ)*/
+    LAYOUT_PAX = 3          /*列ごとの形式(ページの中をフィールドごとに分ける)*/
+};
+
+/*
+ * TableOption -- テーブルの格納方法の設定
+ *
+ * データ定義ファイルに記録される。すべて0ならデフォルトの設定を表す。
+ */
+typedef struct TableOption TableOption;
+struct TableOption {
+    char partition[MAX_PARTITION_NAME]; /*ページを置くバッファプールのパーティション名*/
+    TableLayout layout;                 /*データファイルのページ形式*/
+    char dictionary[MAX_FIELD];         /*1なら、その番号の文字列型のフィールドを辞書圧縮する*/
+    char packBits[MAX_FIELD];           /*0でなければ、その番号の整数型のフィールドをこのビット数に詰める*/
+    char bloom[MAX_FIELD];              /*1なら、その番号の文字列型のフィールドのブルームフィルタを作る*/
+    int bloomRate;                      /*ブルームフィルタの偽陽性率の目標(千分率、0ならBLOOM_DEFAULT_RATE)*/
+    char index[MAX_FIELD][MAX_INDEX_NAME]; /*空でなければ、その番号のフィールドに作った索引の名前*/
+    char crack[MAX_FIELD];              /*1なら、その番号の整数型のフィールドを検索のたびにクラッキングする*/
+    char cluster[MAX_FIELD];            /*1なら、その番号のフィールドをキーとしてレコードをページに振り分ける*/
+    char lsm[MAX_FIELD];                /*1なら、その番号のフィールドをキーとするログ構造化テーブルにする*/
+    char series[MAX_FIELD];             /*1なら、その番号の整数型のフィールドを時刻とする追記専用のテーブルにする*/
+    char memory;                        /*1なら、ファイルを作らずメモリ上にだけ置くテーブル(インメモリテーブル)*/
+    char temp;                          /*1なら、セッションの間だけ使う一時テーブルとして作る(記録はしない)*/
+};
+
+/*
+ * IS_DICTIONARY_FIELD -- 辞書圧縮するフィールドかどうか
+ *
+ * 辞書圧縮するフィールドには、値の代わりに辞書のコード(整数)を格納する。
+ */
+#define IS_DICTIONARY_FIELD(tableInfo, i) ((tableInfo)->option.dictionary[i] != 0)
+
+/*
+ * IS_PACKED_FIELD -- ビット詰めするフィールドかどうか
+ *
+ * 列ごとの形式のテーブルの整数型のフィールドだけをビット詰めできる。
+ * ページごとに基準値を決め、値と基準値の差をpackBitsビットに詰めて格納する。
+ */
+#define IS_PACKED_FIELD(tableInfo, i) \
+    ((tableInfo)->option.layout == LAYOUT_PAX && (tableInfo)->option.packBits[i] != 0)
+
+/*
+ * IS_BLOOM_FIELD -- ブルームフィルタを作るフィールドかどうか
+ *
+ * 辞書圧縮しない文字列型のフィールドにだけ作る。
+ */
+#define IS_BLOOM_FIELD(tableInfo, i) ((tableInfo)->option.bloom[i] != 0)
+
+/*
+ * HAS_INDEX -- 索引を作ったフィールドかどうか
+ *
+ * 1つのフィールドに作れる索引は1つまで。辞書圧縮するフィールドには作れない。
+ */
+#define HAS_INDEX(tableInfo, i) ((tableInfo)->option.index[i][0] != '\0')
+
+/*
+ * IS_CRACK_FIELD -- クラッキング(適応型索引)を使うフィールドかどうか
+ *
+ * 整数型のフィールドにだけ使う。索引があるフィールドでは索引の方を使う。
+ */
+#define IS_CRACK_FIELD(tableInfo, i) ((tableInfo)->option.crack[i] != 0)
+
+/*
+ * IS_CLUSTER_FIELD -- クラスタ化テーブルのキーのフィールドかどうか
+ *
+ * キーにできるのは、1つのテーブルに1つの、整数型か辞書圧縮しない文字列型のフィールド。
+ * クラスタ化テーブルではビット詰めはしない。
+ */
+#define IS_CLUSTER_FIELD(tableInfo, i) ((tableInfo)->option.cluster[i] != 0)
+
+/*
+ * IS_LSM_FIELD -- ログ構造化テーブルのキーのフィールドかどうか
+ *
+ * キーにできるのは、1つのテーブルに1つの、整数型か文字列型のフィールド。
+ * ログ構造化テーブルのレコードはデータファイルには置かないので、辞書圧縮、ビット詰め、
+ * ブルームフィルタ、索引、クラッキング、クラスタ化は使わない。
+ */
+#define IS_LSM_FIELD(tableInfo, i) ((tableInfo)->option.lsm[i] != 0)
+
+/*
+ * IS_SERIES_FIELD -- 時系列テーブルの時刻のフィールドかどうか
+ *
+ * 時刻にできるのは、1つのテーブルに1つの整数型のフィールド。時系列テーブルには
+ * 時刻が減らない順にしか挿入できず、レコードを削除できない(古いページをまとめて捨てる)。
+ * 時系列テーブルはクラスタ化しない。
+ */
+#define IS_SERIES_FIELD(tableInfo, i) ((tableInfo)->option.series[i] != 0)
+
+/*
+ * SERIES_EXTENT_PAGES -- 時系列テーブルで古いレコードをまとめて捨てる単位のページ数
+ */
+#define SERIES_EXTENT_PAGES 16
+
+/*
+ * IS_MEMORY_TABLE -- インメモリテーブルかどうか
+ *
+ * インメモリテーブルのデータ定義とレコードはプロセスのメモリ上にだけあり、
+ * プログラムの終了時に削除される。ほかの格納方法の設定と索引は使わない。
+ */
+#define IS_MEMORY_TABLE(tableInfo) ((tableInfo)->option.memory != 0)
+
+/*
+ * QueryStat -- 直前の検索・削除の統計情報
+ */
+typedef struct QueryStat QueryStat;
+struct QueryStat {
+    int numPage;                        /*データファイルのページ数*/
+    int numPageRead;                    /*読んだページ数*/
+    int numPageSkipped;                 /*ゾーンマップやブルームフィルタ、索引で読み飛ばしたページ数*/
+};
+
+/*
+ * TableStat -- テーブルの統計情報
+ *
+ * データ定義ファイルのヘッダページに記録され、挿入や削除のたびに更新される。
+ */
+typedef struct TableStat TableStat;
+struct TableStat {
+    int numRecord;                      /*レコード数*/
+    int numPage;                        /*データファイルのページ数*/
+    int numDeadSlot;                    /*データページ中の空きスロット数(削除されたレコードを含む)*/
+    int lastInsertPage;                 /*最後にレコードを挿入したページ(-1なら挿入していない)*/
+    int numZoneMapPage;                 /*ゾーンマップの項目が有効なデータページ数(numPageと違えば作り直す)*/
+};
+
 /*
  * TableInfo -- テーブルの情報を表現する構造体
  */
@@ -84,6 +364,7 @@ typedef struct TableInfo TableInfo;
 struct TableInfo{
     int numField;                       /*フィールド数*/
     FieldInfo fieldInfo[MAX_FIELD];     /*フィールド情報の配列*/
+    TableOption option;                 /*格納方法の設定(getTableInfoが設定する)*/
 };
 
 
@@ -95,7 +376,22 @@ struct FieldData {
     char name[MAX_FIELD_NAME];
     DataType dataType;
     int intValue;
-    char stringValue[MAX_STRING];
+    char stringValue[MAX_VARSTRING];
+};
+
+/*
+ * RecordId -- データファイルの中でのレコードの位置
+ *
+ * レコードは削除されるまで同じ位置にあるので、fetchRecordやdeleteRecordByRidで
+ * 1ページだけを読んでレコードを取り出したり削除したりできる。ただし、vacuumTableや
+ * clusterTableでレコードを移すと位置は変わる。updateRecordも、元の場所に収まらない
+ * レコード(スロット形式で長くなったもの、ビット詰めの幅を超える値になったもの)や
+ * クラスタキーを変えたレコードを削除して挿入し直すので、その位置は変わる。
+ */
+typedef struct RecordId RecordId;
+struct RecordId {
+    int pageNum;                    /* データページの番号(位置を持たないレコードでは-1) */
+    int slot;                       /* ページの中のスロット番号 */
 };
 
 /*
@@ -104,10 +400,16 @@ struct FieldData {
 typedef struct RecordData RecordData;
 struct RecordData {
     int numField;
-    FieldData fieldData[MAX_FIELD];
     RecordData *next;
+    RecordId rid;                       /*selectRecordの結果では、データファイルの中での位置*/
+    FieldData fieldData[MAX_FIELD];     /*selectRecordの結果ではnumField個分だけ確保される*/
 };
 
+/*
+ * RECORD_DATA_SIZE -- numField個のフィールドを持つRecordDataに必要なバイト数
+ */
+#define RECORD_DATA_SIZE(numField) (offsetof(RecordData, fieldData) + (numField) * sizeof(FieldData))
+
 /*
  * RecordSet -- レコードの集合を表現する構造体
  */
@@ -125,7 +427,8 @@ enum OperatorType {
     OPR_EQUAL,              /* = */
     OPR_NOT_EQUAL,          /* != */
     OPR_GREATER_THAN,       /* > */
-    OPR_LESS_THAN           /* < */
+    OPR_LESS_THAN,          /* < */
+    OPR_LIKE                /* like(文字列のパターン、%は任意の文字列、_は任意の1文字) */
 };
 
 /*
@@ -137,10 +440,47 @@ struct Condition {
     DataType dataType;              /* フィールドのデータ型 */
     OperatorType operator;          /* 比較演算子 */
     int intValue;                   /* integer型の場合の値 */
-    char stringValue[MAX_STRING];   /* string型の場合の値 */
+    char stringValue[MAX_VARSTRING]; /* string型の場合の値 */
     distinctFlag distinct;          /* 重複除去フラグ */
 };
 
+/*
+ * IndexType -- 索引の種類
+ */
+typedef enum IndexType IndexType;
+enum IndexType {
+    INDEX_BTREE = 0,        /*B+木(=、<、>の条件に使える)*/
+    INDEX_HASH = 1,         /*線形ハッシュ(=の条件にだけ使える)*/
+    INDEX_BITMAP = 2,       /*値ごとのビットマップ(値の種類が少ないフィールド向け、!=にも使える)*/
+    INDEX_TRIGRAM = 3       /*文字列の3文字ずつの並び(likeの条件にだけ使える)*/
+};
+
+/*
+ * MAX_HASH_SPLITPOINT -- ハッシュ索引のバケット数を倍にできる回数の上限
+ */
+#define MAX_HASH_SPLITPOINT 32
+
+/*
+ * Index -- オープンした索引の情報を保持する構造体
+ */
+typedef struct Index Index;
+struct Index {
+    File *file;                         /* 索引ファイル */
+    IndexType type;                     /* 索引の種類 */
+    int rootPage;                       /* 根のノードのページ番号(B+木) */
+    int numPage;                        /* 索引ファイルのページ数 */
+    int field;                          /* 索引を作ったフィールドの番号 */
+    DataType keyType;                   /* 値のデータ型 */
+    int keySize;                        /* 値の大きさ(バイト数) */
+    char tableName[MAX_FILENAME];       /* 索引を作ったテーブルの名前 */
+    int numBucket;                      /* バケット数(ハッシュ) */
+    int numEntry;                       /* キーの数(ハッシュ) */
+    int freePage;                       /* 空いたオーバーフローページのリストの先頭(ハッシュ、-1ならなし) */
+    int spares[MAX_HASH_SPLITPOINT];    /* 分割点ごとの、それより前に割り当てたオーバーフローページ数(ハッシュ) */
+    int bitsPerPage;                    /* データファイルの1ページあたりのビット数(ビットマップ) */
+    int headerModified;                 /* ヘッダを書き戻す必要があれば1 */
+};
+
 
 
 
@@ -148,14 +488,178 @@ struct Condition {
  * file.cに定義されている関数群
  */
 extern Result initializeFileModule();
+extern Result initializeFileModuleWithOption(int numBuffer, char *shmName);
 extern Result finalizeFileModule();
+extern Result removeSharedBufferPool(char *shmName);
 extern Result createFile(char *);
 extern Result deleteFile(char *);
 extern File *openFile(char *);
 extern Result closeFile(File *);
 extern Result readPage(File *, int, char *);
 extern Result writePage(File *, int, char *);
+extern Result discardPages(File *file, int pageNum, int numPage);
+extern Result truncatePages(File *file, int numPage);
 extern int getNumPages(char *);
+extern Result setTemporaryDirectory(char *dirname);
+extern Result createBufferPartition(char *name, int minFrames, int maxFrames);
+extern Result dropBufferPartition(char *name);
+extern Result setFilePartition(File *file, char *name);
+extern Result getBufferPartitionStat(char *name, BufferPartitionStat *stat);
+extern void printBufferPartitionStats();
+
+/*
+ * freespace.cに定義されている関数群
+ */
+extern Result createFreeSpaceMap(char *tableName);
+extern Result deleteFreeSpaceMap(char *tableName);
+extern FreeSpaceMap *openFreeSpaceMap(char *tableName);
+extern Result closeFreeSpaceMap(FreeSpaceMap *fsm);
+extern int getPageFreeSpace(FreeSpaceMap *fsm, int pageNum);
+extern Result setPageFreeSpace(FreeSpaceMap *fsm, int pageNum, int freeSpace);
+extern int findFreePage(FreeSpaceMap *fsm, int minFreeSpace);
+extern void truncateFreeSpaceMap(FreeSpaceMap *fsm, int numPage);
+
+/*
+ * zonemap.cに定義されている関数群
+ */
+extern int countZoneMapFields(TableInfo *tableInfo);
+extern ZoneMap *openZoneMap(File *file, int numPage, TableInfo *tableInfo);
+extern void closeZoneMap(ZoneMap *zoneMap);
+extern Result addToZoneMap(ZoneMap *zoneMap, int pageNum, RecordData *recordData);
+extern Result clearZoneMap(ZoneMap *zoneMap, int pageNum);
+extern void truncateZoneMap(ZoneMap *zoneMap, int numPage);
+extern int checkZoneMap(ZoneMap *zoneMap, int pageNum, int field, Condition *condition);
+
+/*
+ * bloom.cに定義されている関数群
+ */
+extern int hasBloomField(TableInfo *tableInfo);
+extern Result createBloomFilter(char *tableName, TableInfo *tableInfo);
+extern Result deleteBloomFilter(char *tableName);
+extern BloomFilter *openBloomFilter(char *tableName, TableInfo *tableInfo);
+extern Result closeBloomFilter(BloomFilter *bloom);
+extern Result addToBloomFilter(BloomFilter *bloom, int pageNum, RecordData *recordData);
+extern Result clearBloomFilter(BloomFilter *bloom, int pageNum);
+extern void truncateBloomFilter(BloomFilter *bloom, int numPage);
+extern int checkBloomFilter(BloomFilter *bloom, int pageNum, int field, Condition *condition);
+
+/*
+ * index.cに定義されている関数群
+ */
+extern Result createIndexFile(char *indexName, char *tableName, TableInfo *tableInfo, int field, IndexType type);
+extern Result deleteIndexFile(char *indexName);
+extern Index *openIndex(char *indexName);
+extern Result closeIndex(Index *index);
+extern Result insertIndexEntry(Index *index, FieldData *fieldData, RecordId *rid);
+extern Result deleteIndexEntry(Index *index, FieldData *fieldData, RecordId *rid);
+extern RecordId *searchIndex(Index *index, Condition *condition, int *numRid);
+extern int *searchIndexPages(Index *index, Condition *condition, int numPage, int *numListed);
+
+/*
+ * crack.cに定義されている関数群
+ */
+extern int *searchCracker(char *tableName, File *file, int numPage, TableInfo *tableInfo, int field,
+                          Condition *condition, int *numListed);
+extern void insertCrackerEntry(char *tableName, int numPage, RecordData *recordData, RecordId *rid);
+extern void deleteCrackerEntry(char *tableName, RecordData *recordData, RecordId *rid);
+extern void discardCracker(char *tableName);
+
+/*
+ * cluster.cに定義されている関数群
+ */
+extern int getClusterField(TableInfo *tableInfo);
+extern int findClusterPage(char *tableName, File *file, int numPage, TableInfo *tableInfo, FieldData *key);
+extern void addClusterFence(char *tableName, int numPage, int prevPage, FieldData *key, int pageNum);
+extern int *searchClusterPages(char *tableName, File *file, int numPage, TableInfo *tableInfo,
+                               Condition *condition, int *numListed);
+extern void discardClusterFence(char *tableName);
+
+/*
+ * lsm.cに定義されている関数群
+ */
+extern int getLsmField(TableInfo *tableInfo);
+extern Result insertLsmRecord(char *tableName, TableInfo *tableInfo, RecordData *recordData);
+extern Result searchLsmTable(char *tableName, TableInfo *tableInfo, Condition *condition, QueryStat *stat,
+                             RecordData **result);
+extern Result deleteLsmRecord(char *tableName, TableInfo *tableInfo, Condition *condition, QueryStat *stat);
+extern Result updateLsmRecord(char *tableName, TableInfo *tableInfo, RecordData *assignments,
+                              Condition *condition, QueryStat *stat);
+extern int countLsmRecord(char *tableName, TableInfo *tableInfo);
+extern Result compactLsmTable(char *tableName);
+extern Result deleteLsmTable(char *tableName);
+extern void discardLsmTable(char *tableName);
+extern Result closeLsmTables();
+
+/*
+ * series.cに定義されている関数群
+ */
+extern int getSeriesField(TableInfo *tableInfo);
+extern int getSeriesTail(char *tableName, File *file, int numPage, TableInfo *tableInfo, int numRecord,
+                         char *page, int *lastTime);
+extern void addSeriesRecord(char *tableName, int pageNum, char *page, int time, int numRecord);
+extern int *searchSeriesPages(char *tableName, File *file, int numPage, TableInfo *tableInfo, int condField,
+                              Condition *condition, int *numListed);
+extern int findSeriesExtents(char *tableName, File *file, int numPage, TableInfo *tableInfo, int before,
+                             int *firstPage);
+extern Result setSeriesFirstPage(char *tableName, int firstPage);
+extern Result deleteSeriesIndex(char *tableName);
+extern void discardSeries(char *tableName);
+
+/*
+ * memory.cに定義されている関数群
+ */
+extern Result createMemoryTable(char *tableName, TableInfo *tableInfo);
+extern Result dropMemoryTable(char *tableName);
+extern void dropMemoryTables();
+extern int isMemoryTable(char *tableName);
+extern TableInfo *getMemoryTableInfo(char *tableName);
+extern Result insertMemoryRecord(char *tableName, RecordData *recordData);
+extern Result searchMemoryTable(char *tableName, Condition *condition, QueryStat *stat, RecordData **result);
+extern Result deleteMemoryRecord(char *tableName, Condition *condition, QueryStat *stat);
+extern Result updateMemoryRecord(char *tableName, RecordData *assignments, Condition *condition, QueryStat *stat);
+extern int countMemoryRecord(char *tableName);
+
+/*
+ * temp.cに定義されている関数群
+ */
+extern char *createTempTable(char *tableName, TableOption *option);
+extern void removeTempTable(char *path);
+extern void dropTempTables();
+extern int isTempTable(char *tableName);
+extern char *resolveTableName(char *tableName);
+
+/*
+ * dictionary.cに定義されている関数群
+ */
+extern Result deleteDictionary(char *tableName);
+extern Dictionary *openDictionary(char *tableName);
+extern Result closeDictionary(Dictionary *dict);
+extern int lookupDictionaryCode(Dictionary *dict, int field, char *value);
+extern int getDictionaryCode(Dictionary *dict, int field, char *value);
+extern char *getDictionaryValue(Dictionary *dict, int field, int code);
+extern int hasDictionaryField(TableInfo *tableInfo);
+extern Result encodeDictionaryFields(Dictionary *dict, TableInfo *tableInfo, RecordData *recordData);
+extern void decodeDictionaryFields(Dictionary *dict, TableInfo *tableInfo, RecordData *recordData);
+
+/*
+ * page.cに定義されている関数群
+ */
+extern int getRecordSize(TableInfo *tableInfo);
+extern void initializePage(char *page, TableInfo *tableInfo);
+extern int getNumSlots(char *page, TableInfo *tableInfo);
+extern int getNextSlot(char *page, int slot, TableInfo *tableInfo);
+extern char *getFieldColumn(char *page, TableInfo *tableInfo, int field, int *stride);
+extern Result matchPackedField(char *page, TableInfo *tableInfo, int field, Condition *condition, char *match);
+extern Result readSlotField(char *page, int slot, TableInfo *tableInfo, int field, FieldData *fieldData);
+extern Result readSlot(char *page, int slot, TableInfo *tableInfo, RecordData *recordData);
+extern int insertIntoPage(char *page, TableInfo *tableInfo, RecordData *recordData);
+extern void deleteFromPage(char *page, int slot, TableInfo *tableInfo);
+extern Result updateSlot(char *page, int slot, TableInfo *tableInfo, RecordData *recordData);
+extern int countFreeSlots(char *page, TableInfo *tableInfo);
+extern int countUsedSlots(char *page, TableInfo *tableInfo);
+extern int getPageFreeSpaceValue(char *page, TableInfo *tableInfo);
+extern int getRequiredFreeSpaceValue(TableInfo *tableInfo, RecordData *recordData);
+extern int getMaxRecordsPerPage(TableInfo *tableInfo);
 
 /*
  * detadef.cに定義されている関数群
@@ -163,6 +667,14 @@ extern int getNumPages(char *);
 extern Result initializeDataDefModule();
 extern Result finalizeDataDefModule();
 extern Result createTable(char *, TableInfo *);
+extern Result createTableWithOption(char *, TableInfo *, TableOption *);
+extern Result setTablePartition(char *tableName, char *partition);
+extern Result setTableIndex(char *tableName, int field, char *indexName);
+extern Result setTableCluster(char *tableName, int field);
+extern File *openTableStat(char *tableName, TableStat *stat);
+extern Result closeTableStat(File *file, TableStat *stat);
+extern Result getTableStat(char *tableName, TableStat *stat);
+extern Result setTableStat(char *tableName, TableStat *stat);
 extern Result dropTable(char *);
 extern TableInfo *getTableInfo(char *);
 extern void freeTableInfo(TableInfo *);
@@ -173,14 +685,28 @@ extern void printTableInfo(char *);
  *
  */
 extern Result checkCondition(RecordData *recordData, Condition *condition);
+extern void applyAssignments(RecordData *assignments, RecordData *recordData);
+extern int matchLike(char *value, char *pattern);
 extern Result initializeDataManipModule();
 extern Result finalizeDataManipModule();
 extern Result insertRecord(char *tableName, RecordData *recordData);
 extern Result deleteRecord(char *tableName, Condition *condition);
 extern RecordSet *selectRecord(char *tableName, Condition *condition);
+extern Result fetchRecord(char *tableName, RecordId *rid, RecordData *recordData);
+extern Result deleteRecordByRid(char *tableName, RecordId *rid);
+extern Result updateRecord(char *tableName, RecordData *assignments, Condition *condition);
+extern int countRecord(char *tableName);
+extern void getQueryStat(QueryStat *stat);
+extern void printQueryStat();
 extern void freeRecordSet(RecordSet *recordSet);
 extern Result createDataFile(char *tableName);
 extern Result deleteDataFile(char *tableName);
+extern Result createIndex(char *indexName, char *tableName, char *fieldName);
+extern Result createIndexWithType(char *indexName, char *tableName, char *fieldName, IndexType type);
+extern Result dropIndex(char *indexName);
+extern Result clusterTable(char *tableName, char *fieldName);
+extern Result truncateSeriesTable(char *tableName, int before);
+extern int vacuumTable(char *tableName, int maxPage);
 extern void printRecordSet(RecordSet *recordSet);
 extern void printTableData(char *tableName);
 
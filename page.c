@@ -0,0 +1,1272 @@
+/*
+ * page.c -- ページ形式モジュール
+ *
+ * データファイルの1ページの中にレコードをどう並べるかを扱う。
+ * テーブルごとに、次のどれかの形式を選べる(TableOptionのlayout)。
+ *
+ * LAYOUT_FIXED(固定長形式):
+ *   +---------------------------+--------+--------+----
+ *   |使用中ビットマップ         |レコード|レコード|
+ *   |(64ビットの語をスロット数分)|0       |1       |
+ *   +---------------------------+--------+--------+----
+ *   1レコードを固定長で詰めて並べ、どのスロットが使用中かをページ先頭の
+ *   ビットマップで表す(スロットjの使用中ビットは、j / 64語目の j % 64ビット目)。
+ *   整数型は sizeof(int) バイト、文字列型は MAX_STRING バイトを占める。
+ *   使用中のスロットはpopcount/ctzで数えたり列挙したりでき、ページが空か満杯かは
+ *   語単位の比較で分かる。
+ *
+ * LAYOUT_PAX(列ごとの形式):
+ *   +---------------------------+--------------------+--------------------+----
+ *   |使用中ビットマップ         |フィールド0の値     |フィールド1の値     |
+ *   |                           |(スロット0, 1, ...) |(スロット0, 1, ...) |
+ *   +---------------------------+--------------------+--------------------+----
+ *   スロット数と使用中ビットマップは固定長形式と同じだが、ページの中を
+ *   フィールドごとの領域(ミニページ)に分け、同じフィールドの値を続けて並べる。
+ *   1つのフィールドだけを見る条件の判定では、そのフィールドの領域だけを読めばよい。
+ *
+ *   ビット詰めする整数型のフィールド(TableOptionのpackBits)の領域は、
+ *   +-----------+-----------------------------------------------+
+ *   |基準値     |値と基準値の差(スロット0, 1, ...)              |
+ *   |(8バイト)  |(packBitsビットずつ、64ビットの語をまたがずに詰める)|
+ *   +-----------+-----------------------------------------------+
+ *   となる。基準値は、空のページに最初に格納する値を2^packBitsの倍数に
+ *   切り捨てたもので、差がpackBitsビットに収まらない値はそのページには格納しない。
+ *   ビット詰めするフィールドがあると、1ページに入るスロット数が増える。
+ *
+ * LAYOUT_FIXED_FLAG(固定長形式の以前の形式):
+ *   1レコードを getRecordSize() バイトの固定長で詰めて並べる。
+ *   各レコードの先頭1バイトは「使用中」のフラグ(1なら使用中、0なら空き)。
+ *   ビットマップを導入する前に作られたテーブルを読み書きするためだけに残してある。
+ *
+ * LAYOUT_SLOTTED(スロット形式):
+ *   +----------+----------+-------------------+-------+---------------+
+ *   |スロット数|データの  |スロット0, 1, ...  | 空き  |レコードのデータ|
+ *   |(2バイト) |先頭位置  |(位置2バイト,      |       |(ページの末尾から|
+ *   |          |(2バイト) | 長さ2バイト)      |       | 前に向かって詰める)|
+ *   +----------+----------+-------------------+-------+---------------+
+ *   レコードは、整数型を sizeof(int) バイト、文字列型を1バイトの長さと
+ *   文字列の本体(終端文字なし)で表す可変長形式で格納する。
+ *   長さ0のスロットは空きを表す。削除したときにページ内のデータを詰めるので、
+ *   空き領域は常にスロットの配列とレコードのデータの間に1か所にまとまっている。
+ *
+ * どの形式でも、レコードはページ内の「スロット番号」で指す。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+
+/*
+ * SLOTTED_HEADER_SIZE -- スロット形式のページのヘッダの大きさ(バイト数)
+ */
+#define SLOTTED_HEADER_SIZE 4
+
+/*
+ * SLOT_ENTRY_SIZE -- スロット形式のスロット1つの大きさ(バイト数)
+ */
+#define SLOT_ENTRY_SIZE 4
+
+/*
+ * SLOTTED_FREE_SPACE_UNIT -- スロット形式の空き量の単位(バイト数)
+ *
+ * 空き領域マップには1ページあたり1バイトしか記録できないので、
+ * 空きバイト数をこの単位で数える。
+ */
+#define SLOTTED_FREE_SPACE_UNIT 16
+
+/*
+ * MAX_VAR_RECORD_SIZE -- 可変長形式に変換したレコードの大きさの上限(バイト数)
+ */
+#define MAX_VAR_RECORD_SIZE (MAX_FIELD * (MAX_VARSTRING + sizeof(int)))
+
+/*
+ * スロット形式のページのヘッダとスロットを読み書きするマクロ
+ */
+#define SLOTTED_NUM_SLOT(page) (((unsigned short *)(page))[0])
+#define SLOTTED_FREE_END(page) (((unsigned short *)(page))[1])
+#define SLOT_OFFSET(page, slot) (((unsigned short *)((page) + SLOTTED_HEADER_SIZE))[(slot) * 2])
+#define SLOT_LENGTH(page, slot) (((unsigned short *)((page) + SLOTTED_HEADER_SIZE))[(slot) * 2 + 1])
+
+/*
+ * BitmapWord -- 使用中ビットマップの1語
+ */
+typedef unsigned long long BitmapWord;
+
+/*
+ * BITMAP_WORD_BITS -- 使用中ビットマップの1語のビット数
+ */
+#define BITMAP_WORD_BITS 64
+
+/*
+ * BITMAP_NUM_WORDS -- numSlot個のスロットの使用中ビットマップの語数
+ */
+#define BITMAP_NUM_WORDS(numSlot) (((numSlot) + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS)
+
+/*
+ * getBitmapWord -- 語の並びwordsのn語目
+ *
+ * ページの内容は8バイト境界に揃っているとは限らないので(スタック上のchar配列など)、
+ * 語へのポインタにキャストせず、memcpyで読み書きする。
+ */
+static BitmapWord getBitmapWord(char *words, int n)
+{
+    BitmapWord word;
+
+    memcpy(&word, words + n * sizeof(BitmapWord), sizeof(BitmapWord));
+    return word;
+}
+
+/*
+ * setBitmapWord -- 語の並びwordsのn語目に値を書く
+ */
+static void setBitmapWord(char *words, int n, BitmapWord word)
+{
+    memcpy(words + n * sizeof(BitmapWord), &word, sizeof(BitmapWord));
+}
+
+/*
+ * BITMAP_TAIL_MASK -- 最後の語のうち、スロットに対応するビットだけを1にしたマスク
+ */
+#define BITMAP_TAIL_MASK(numSlot) \
+    ((numSlot) % BITMAP_WORD_BITS == 0 ? ~(BitmapWord) 0 \
+     : ((BitmapWord) 1 << ((numSlot) % BITMAP_WORD_BITS)) - 1)
+
+/*
+ * PACKED_VALUES_PER_WORD -- bitsビットに詰めた値が1語に入る個数
+ *
+ * ビット詰めした値も、使用中ビットマップと同じ64ビットの語に並べる。
+ */
+#define PACKED_VALUES_PER_WORD(bits) (BITMAP_WORD_BITS / (bits))
+
+/*
+ * PACKED_NUM_WORDS -- numSlot個の値をbitsビットに詰めたときの語数
+ */
+#define PACKED_NUM_WORDS(numSlot, bits) \
+    (((numSlot) + PACKED_VALUES_PER_WORD(bits) - 1) / PACKED_VALUES_PER_WORD(bits))
+
+/*
+ * PACKED_HEADER_SIZE -- ビット詰めしたフィールドの領域の先頭の、基準値を置く部分の大きさ
+ */
+#define PACKED_HEADER_SIZE sizeof(BitmapWord)
+
+/*
+ * PACKED_MASK -- bitsビットの値のマスク
+ */
+#define PACKED_MASK(bits) (((BitmapWord) 1 << (bits)) - 1)
+
+/*
+ * PACKED_VALUE -- 語の並びwordsのslot番目の、bitsビットに詰めた値(基準値との差)
+ */
+#define PACKED_VALUE(words, slot, bits) \
+    ((unsigned int) ((getBitmapWord((words), (slot) / PACKED_VALUES_PER_WORD(bits)) \
+                      >> ((slot) % PACKED_VALUES_PER_WORD(bits) * (bits))) & PACKED_MASK(bits)))
+
+/*
+ * getStoredType -- ページに格納するフィールドの値のデータ型
+ *
+ * 辞書圧縮するフィールドは、文字列型でも辞書のコードを整数として格納する。
+ */
+static DataType getStoredType(TableInfo *tableInfo, int field)
+{
+    if (IS_DICTIONARY_FIELD(tableInfo, field)) {
+        return TYPE_INTEGER;
+    }
+    return tableInfo->fieldInfo[field].dataType;
+}
+
+/*
+ * getRecordSize -- 固定長形式の1レコードの大きさの計算
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	tableInfoのテーブルに収められた1つのレコードを保存するのに
+ *	必要なバイト数(LAYOUT_FIXED_FLAGの形式での「使用中」フラグの1バイトを含む)
+ */
+int getRecordSize(TableInfo *tableInfo)
+{
+    int total = 0;
+    int i;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        /* i番目のフィールドがINT型かSTRING型か調べる */
+        switch (getStoredType(tableInfo, i)) {
+            case TYPE_INTEGER:
+                /* INT型ならtotalにsizeof(int)を加算 */
+                total += sizeof(int);
+                break;
+            case TYPE_STRING:
+                /* STRING型ならtotalにMAX_STRINGを加算 */
+                total += MAX_STRING;
+                break;
+            case TYPE_UNKNOWN:
+                break;
+        }
+
+    }
+
+    /* フラグの分の1を足す */
+    total++;
+
+    return total;
+}
+
+/*
+ * getBitmapNumSlots -- 固定長形式(ビットマップ)の1ページあたりのスロット数
+ *
+ * ビットマップとレコードの両方がページに収まる最大のスロット数を返す。
+ */
+static int getBitmapNumSlots(int slotSize)
+{
+    /* 1スロットあたりslotSizeバイトと1ビットを使うとして見積もり、語単位の切り上げの分を調整する */
+    int numSlot = PAGE_SIZE * 8 / (slotSize * 8 + 1);
+
+    while (BITMAP_NUM_WORDS(numSlot) * sizeof(BitmapWord) + numSlot * slotSize > PAGE_SIZE) {
+        numSlot--;
+    }
+    return numSlot;
+}
+
+/*
+ * getBitmapSlot -- 固定長形式(ビットマップ)のスロットの先頭番地
+ */
+static char *getBitmapSlot(char *page, int slot, int numSlot, int slotSize)
+{
+    return page + BITMAP_NUM_WORDS(numSlot) * sizeof(BitmapWord) + slot * slotSize;
+}
+
+/*
+ * IS_BITMAP_LAYOUT -- 使用中ビットマップを使う形式かどうか
+ */
+#define IS_BITMAP_LAYOUT(tableInfo) \
+    ((tableInfo)->option.layout == LAYOUT_FIXED || (tableInfo)->option.layout == LAYOUT_PAX)
+
+/*
+ * getFieldSize -- 固定長形式でのフィールドの大きさ(バイト数)
+ */
+static int getFieldSize(TableInfo *tableInfo, int field)
+{
+    switch (getStoredType(tableInfo, field)) {
+        case TYPE_INTEGER:
+            return sizeof(int);
+        case TYPE_STRING:
+            return MAX_STRING;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * getPackBits -- フィールドの値を詰めるビット数(ビット詰めしないフィールドなら0)
+ */
+static int getPackBits(TableInfo *tableInfo, int field)
+{
+    return IS_PACKED_FIELD(tableInfo, field) ? tableInfo->option.packBits[field] : 0;
+}
+
+/*
+ * getBitmapLayoutNumSlots -- 使用中ビットマップを使う形式の1ページあたりのスロット数
+ *
+ * ビット詰めするフィールドがなければgetBitmapNumSlotsと同じ。あれば、1スロットあたりの
+ * ビット数と、語単位の切り上げや基準値の分をもとに、ページに必ず収まるスロット数を見積もる
+ * (収まる最大の数より、語の切り上げの分だけ少ないことがある)。
+ */
+static int getBitmapLayoutNumSlots(TableInfo *tableInfo)
+{
+    int cost = BITMAP_WORD_BITS;        /* 1スロットあたりのビット数のBITMAP_WORD_BITS倍 */
+    int overhead = BITMAP_WORD_BITS;    /* スロット数によらずに使うビット数 */
+    int numPacked = 0;
+    int bits;
+    int i;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        if ((bits = getPackBits(tableInfo, i)) != 0) {
+            cost += (BITMAP_WORD_BITS * BITMAP_WORD_BITS + PACKED_VALUES_PER_WORD(bits) - 1)
+                / PACKED_VALUES_PER_WORD(bits);
+            overhead += PACKED_HEADER_SIZE * 8 + BITMAP_WORD_BITS;
+            numPacked++;
+        } else {
+            cost += getFieldSize(tableInfo, i) * 8 * BITMAP_WORD_BITS;
+        }
+    }
+
+    if (numPacked == 0) {
+        return getBitmapNumSlots(getRecordSize(tableInfo) - 1);
+    }
+    return (PAGE_SIZE * 8 - overhead) * BITMAP_WORD_BITS / cost;
+}
+
+/*
+ * getPaxAreaSize -- 列ごとの形式のページでのフィールドの領域の大きさ(バイト数)
+ */
+static int getPaxAreaSize(TableInfo *tableInfo, int field, int numSlot)
+{
+    int bits = getPackBits(tableInfo, field);
+
+    if (bits != 0) {
+        return PACKED_HEADER_SIZE + PACKED_NUM_WORDS(numSlot, bits) * sizeof(BitmapWord);
+    }
+    return numSlot * getFieldSize(tableInfo, field);
+}
+
+/*
+ * getFieldAddress -- 固定長形式・列ごとの形式のページでのフィールドの値の番地
+ *
+ * ビット詰めするフィールドでは、スロットによらずフィールドの領域の先頭(基準値)の番地を返す。
+ */
+static char *getFieldAddress(char *page, int slot, int field, TableInfo *tableInfo)
+{
+    int recordSize = getRecordSize(tableInfo) - 1;
+    int numSlot;
+    int offset = 0;
+    char *p;
+    int i;
+
+    if (tableInfo->option.layout == LAYOUT_PAX) {
+        /* フィールドの領域は、それより前のフィールドの領域の後に続く */
+        numSlot = getBitmapLayoutNumSlots(tableInfo);
+        p = page + BITMAP_NUM_WORDS(numSlot) * sizeof(BitmapWord);
+        for (i = 0; i < field; i++) {
+            p += getPaxAreaSize(tableInfo, i, numSlot);
+        }
+        if (getPackBits(tableInfo, field) != 0) {
+            return p;
+        }
+        return p + slot * getFieldSize(tableInfo, field);
+    }
+
+    /* レコードの中でのフィールドの位置 */
+    for (i = 0; i < field; i++) {
+        offset += getFieldSize(tableInfo, i);
+    }
+
+    if (tableInfo->option.layout == LAYOUT_FIXED) {
+        return getBitmapSlot(page, slot, getBitmapNumSlots(recordSize), recordSize) + offset;
+    }
+
+    /* フラグの分だけずらす */
+    return page + slot * (recordSize + 1) + 1 + offset;
+}
+
+/*
+ * getPackedBase -- ビット詰めしたフィールドの領域に記録した基準値
+ */
+static int getPackedBase(char *area)
+{
+    int base;
+
+    memcpy(&base, area, sizeof(int));
+    return base;
+}
+
+/*
+ * canPackValue -- 値が、基準値からの差としてbitsビットに収まるかどうか
+ */
+static int canPackValue(char *area, int bits, int value)
+{
+    long long diff = (long long) value - getPackedBase(area);
+
+    return diff >= 0 && diff <= (long long) PACKED_MASK(bits);
+}
+
+/*
+ * encodePackedField -- ビット詰めしたフィールドの領域のslot番目に値を格納する
+ *
+ * 値はcanPackValueで収まることを確かめておくこと。
+ */
+static void encodePackedField(char *area, int slot, int bits, int value)
+{
+    char *words = area + PACKED_HEADER_SIZE;
+    int n = slot / PACKED_VALUES_PER_WORD(bits);
+    int shift = slot % PACKED_VALUES_PER_WORD(bits) * bits;
+    unsigned int diff = (unsigned int) value - (unsigned int) getPackedBase(area);
+
+    setBitmapWord(words, n, (getBitmapWord(words, n) & ~(PACKED_MASK(bits) << shift)) | ((BitmapWord) diff << shift));
+}
+
+/*
+ * decodePackedField -- ビット詰めしたフィールドの領域のslot番目の値
+ */
+static int decodePackedField(char *area, int slot, int bits)
+{
+    return (int) ((unsigned int) getPackedBase(area)
+                  + PACKED_VALUE(area + PACKED_HEADER_SIZE, slot, bits));
+}
+
+/*
+ * encodeFixedField -- フィールドの値を固定長形式に変換する
+ */
+static void encodeFixedField(TableInfo *tableInfo, int field, FieldData *fieldData, char *p)
+{
+    switch (getStoredType(tableInfo, field)) {
+        case TYPE_INTEGER:
+            memcpy(p, &fieldData->intValue, sizeof(int));
+            break;
+        case TYPE_STRING:
+            strncpy(p, fieldData->stringValue, MAX_STRING);
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * decodeFixedField -- 固定長形式のフィールドの値をFieldDataに変換する
+ */
+static void decodeFixedField(TableInfo *tableInfo, int field, char *p, FieldData *fieldData)
+{
+    switch (getStoredType(tableInfo, field)) {
+        case TYPE_INTEGER:
+            memcpy(&fieldData->intValue, p, sizeof(int));
+            break;
+        case TYPE_STRING:
+            memcpy(fieldData->stringValue, p, MAX_STRING);
+            fieldData->stringValue[MAX_STRING] = '\0';
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * readField -- 固定長形式・列ごとの形式のページから、1つのフィールドの値を読み出す
+ */
+static void readField(char *page, int slot, int field, TableInfo *tableInfo, FieldData *fieldData)
+{
+    int bits = getPackBits(tableInfo, field);
+
+    if (bits != 0) {
+        fieldData->intValue = decodePackedField(getFieldAddress(page, slot, field, tableInfo), slot, bits);
+    } else {
+        decodeFixedField(tableInfo, field, getFieldAddress(page, slot, field, tableInfo), fieldData);
+    }
+}
+
+/*
+ * isSlotUsed -- スロットが使用中かどうか
+ */
+static int isSlotUsed(char *page, int slot, TableInfo *tableInfo)
+{
+    int numSlot;
+
+    if (IS_BITMAP_LAYOUT(tableInfo)) {
+        numSlot = getBitmapLayoutNumSlots(tableInfo);
+        return slot < numSlot
+            && (getBitmapWord(page, slot / BITMAP_WORD_BITS) & ((BitmapWord) 1 << (slot % BITMAP_WORD_BITS))) != 0;
+    }
+    if (tableInfo->option.layout == LAYOUT_SLOTTED) {
+        return slot < SLOTTED_NUM_SLOT(page) && SLOT_LENGTH(page, slot) != 0;
+    }
+    return slot < PAGE_SIZE / getRecordSize(tableInfo) && page[slot * getRecordSize(tableInfo)] != 0;
+}
+
+/*
+ * encodeVarRecord -- レコードを可変長形式に変換する
+ *
+ * 返り値:
+ *	変換後のバイト数。格納できない値があれば-1を返す。
+ */
+static int encodeVarRecord(TableInfo *tableInfo, RecordData *recordData, char *buf)
+{
+    char *p = buf;
+    int i;
+    size_t len;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        switch (getStoredType(tableInfo, i)) {
+            case TYPE_INTEGER:
+                memcpy(p, &recordData->fieldData[i].intValue, sizeof(int));
+                p += sizeof(int);
+                break;
+            case TYPE_STRING:
+                len = strlen(recordData->fieldData[i].stringValue);
+                if (len >= MAX_VARSTRING) {
+                    return -1;
+                }
+                *p++ = (unsigned char) len;
+                memcpy(p, recordData->fieldData[i].stringValue, len);
+                p += len;
+                break;
+            default:
+                return -1;
+        }
+    }
+
+    return p - buf;
+}
+
+/*
+ * decodeVarRecord -- 可変長形式のレコードをRecordDataに変換する
+ */
+static void decodeVarRecord(TableInfo *tableInfo, char *p, RecordData *recordData)
+{
+    int i;
+    int len;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        switch (getStoredType(tableInfo, i)) {
+            case TYPE_INTEGER:
+                memcpy(&recordData->fieldData[i].intValue, p, sizeof(int));
+                p += sizeof(int);
+                break;
+            case TYPE_STRING:
+                len = (unsigned char) *p++;
+                memcpy(recordData->fieldData[i].stringValue, p, len);
+                recordData->fieldData[i].stringValue[len] = '\0';
+                p += len;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/*
+ * decodeVarField -- 可変長形式のレコードから1つのフィールドの値だけを取り出す
+ */
+static void decodeVarField(TableInfo *tableInfo, int field, char *p, FieldData *fieldData)
+{
+    int i;
+
+    /* 前のフィールドを読み飛ばす */
+    for (i = 0; i < field; i++) {
+        switch (getStoredType(tableInfo, i)) {
+            case TYPE_INTEGER:
+                p += sizeof(int);
+                break;
+            case TYPE_STRING:
+                p += 1 + (unsigned char) *p;
+                break;
+            default:
+                break;
+        }
+    }
+
+    switch (getStoredType(tableInfo, field)) {
+        case TYPE_INTEGER:
+            memcpy(&fieldData->intValue, p, sizeof(int));
+            break;
+        case TYPE_STRING:
+            memcpy(fieldData->stringValue, p + 1, (unsigned char) *p);
+            fieldData->stringValue[(unsigned char) *p] = '\0';
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * getSlottedFreeBytes -- スロット形式のページの空きバイト数
+ */
+static int getSlottedFreeBytes(char *page)
+{
+    return SLOTTED_FREE_END(page) - SLOTTED_HEADER_SIZE - SLOTTED_NUM_SLOT(page) * SLOT_ENTRY_SIZE;
+}
+
+/*
+ * initializePage -- 空のページの作成
+ *
+ * 引数:
+ *	page: 初期化するページ
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	なし
+ */
+void initializePage(char *page, TableInfo *tableInfo)
+{
+    memset(page, 0, PAGE_SIZE);
+    if (tableInfo->option.layout == LAYOUT_SLOTTED) {
+        SLOTTED_NUM_SLOT(page) = 0;
+        SLOTTED_FREE_END(page) = PAGE_SIZE;
+    }
+}
+
+/*
+ * getNumSlots -- ページのスロット数の取得
+ *
+ * 引数:
+ *	page: ページ
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	ページのスロット数(空きのスロットを含む)
+ */
+int getNumSlots(char *page, TableInfo *tableInfo)
+{
+    switch (tableInfo->option.layout) {
+        case LAYOUT_SLOTTED:
+            return SLOTTED_NUM_SLOT(page);
+        case LAYOUT_FIXED:
+        case LAYOUT_PAX:
+            return getBitmapLayoutNumSlots(tableInfo);
+        default:
+            return PAGE_SIZE / getRecordSize(tableInfo);
+    }
+}
+
+/*
+ * getNextSlot -- 使用中のスロットの列挙
+ *
+ * 引数:
+ *	page: ページ
+ *	slot: 探し始めるスロット番号
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	slot番以降で最初の使用中のスロットの番号。なければ-1を返す。
+ *
+ * ページのレコードは、次のようにして順に取り出せる。
+ *	for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo))
+ * 固定長形式と列ごとの形式では、ビットマップの語ごとにctzで使用中のビットを探すので、
+ * 空きのスロットには触らない。
+ */
+int getNextSlot(char *page, int slot, TableInfo *tableInfo)
+{
+    BitmapWord word;
+    int numSlot;
+    int recordSize;
+    int n;
+
+    switch (tableInfo->option.layout) {
+        case LAYOUT_FIXED:
+        case LAYOUT_PAX:
+            numSlot = getBitmapLayoutNumSlots(tableInfo);
+            if (slot >= numSlot) {
+                return -1;
+            }
+
+            /* slot番より前のビットを落とし、0でない語を探す */
+            n = slot / BITMAP_WORD_BITS;
+            word = getBitmapWord(page, n) & (~(BitmapWord) 0 << (slot % BITMAP_WORD_BITS));
+            while (word == 0) {
+                if (++n >= BITMAP_NUM_WORDS(numSlot)) {
+                    return -1;
+                }
+                word = getBitmapWord(page, n);
+            }
+            slot = n * BITMAP_WORD_BITS + __builtin_ctzll(word);
+            return slot < numSlot ? slot : -1;
+
+        case LAYOUT_SLOTTED:
+            for (; slot < SLOTTED_NUM_SLOT(page); slot++) {
+                if (SLOT_LENGTH(page, slot) != 0) {
+                    return slot;
+                }
+            }
+            return -1;
+
+        default:
+            recordSize = getRecordSize(tableInfo);
+            for (; slot < PAGE_SIZE / recordSize; slot++) {
+                if (page[slot * recordSize] != 0) {
+                    return slot;
+                }
+            }
+            return -1;
+    }
+}
+
+/*
+ * readSlot -- スロットに格納されたレコードの読み出し
+ *
+ * 引数:
+ *	page: ページ
+ *	slot: スロット番号
+ *	tableInfo: テーブルのデータ定義情報
+ *	recordData: 読み出したレコードを格納する場所
+ *
+ * 返り値:
+ *	スロットが使用中ならOK、空きならNGを返す
+ *
+ * recordDataのnumField、フィールド名とデータ型も設定する。nextは変更しない。
+ */
+Result readSlot(char *page, int slot, TableInfo *tableInfo, RecordData *recordData)
+{
+    int i;
+
+    if (!isSlotUsed(page, slot, tableInfo)) {
+        return NG;
+    }
+
+    recordData->numField = tableInfo->numField;
+    for (i = 0; i < tableInfo->numField; i++) {
+        strcpy(recordData->fieldData[i].name, tableInfo->fieldInfo[i].name);
+        recordData->fieldData[i].dataType = tableInfo->fieldInfo[i].dataType;
+    }
+
+    if (tableInfo->option.layout == LAYOUT_SLOTTED) {
+        decodeVarRecord(tableInfo, page + SLOT_OFFSET(page, slot), recordData);
+    } else {
+        for (i = 0; i < tableInfo->numField; i++) {
+            readField(page, slot, i, tableInfo, &recordData->fieldData[i]);
+        }
+    }
+    return OK;
+}
+
+/*
+ * readSlotField -- スロットに格納されたレコードの1つのフィールドの値の読み出し
+ *
+ * 引数:
+ *	page: ページ
+ *	slot: スロット番号
+ *	tableInfo: テーブルのデータ定義情報
+ *	field: フィールドの番号
+ *	fieldData: 読み出した値を格納する場所
+ *
+ * 返り値:
+ *	スロットが使用中ならOK、空きならNGを返す
+ *
+ * fieldDataのintValueかstringValueだけを設定する。列ごとの形式では、
+ * そのフィールドの領域だけを読む。
+ */
+Result readSlotField(char *page, int slot, TableInfo *tableInfo, int field, FieldData *fieldData)
+{
+    if (!isSlotUsed(page, slot, tableInfo)) {
+        return NG;
+    }
+
+    if (tableInfo->option.layout == LAYOUT_SLOTTED) {
+        decodeVarField(tableInfo, field, page + SLOT_OFFSET(page, slot), fieldData);
+    } else {
+        readField(page, slot, field, tableInfo, fieldData);
+    }
+    return OK;
+}
+
+/*
+ * getFieldColumn -- ページの中のフィールドの値の並びの取得
+ *
+ * 引数:
+ *	page: ページ
+ *	tableInfo: テーブルのデータ定義情報
+ *	field: フィールドの番号
+ *	stride: 隣り合うスロットの値の間隔(バイト数)を返す場所
+ *
+ * 返り値:
+ *	スロット0のフィールドの値の番地(スロットjの値は、この番地からj * strideバイト後ろにある)。
+ *	値が等間隔に並ばない形式(スロット形式、LAYOUT_FIXED_FLAG)と、
+ *	ビット詰めするフィールドではNULLを返す。
+ *
+ * 列ごとの形式では、strideはフィールドの大きさになり、値が隙間なく並ぶ。
+ * 値が使用中のスロットのものかどうかは、getNextSlotで確かめること。
+ * ビット詰めするフィールドの条件は、matchPackedFieldで判定する。
+ */
+char *getFieldColumn(char *page, TableInfo *tableInfo, int field, int *stride)
+{
+    if (!IS_BITMAP_LAYOUT(tableInfo) || getPackBits(tableInfo, field) != 0) {
+        return NULL;
+    }
+
+    if (tableInfo->option.layout == LAYOUT_PAX) {
+        *stride = getFieldSize(tableInfo, field);
+    } else {
+        *stride = getRecordSize(tableInfo) - 1;
+    }
+    return getFieldAddress(page, 0, field, tableInfo);
+}
+
+/*
+ * matchPackedField -- ビット詰めしたフィールドの条件の判定
+ *
+ * 引数:
+ *	page: ページ
+ *	tableInfo: テーブルのデータ定義情報
+ *	field: 条件のフィールドの番号
+ *	condition: 条件(整数の値との比較)
+ *	match: スロットごとの判定の結果(条件を満たせば1、満たさなければ0)を格納する場所
+ *	       (MAX_SLOT_PER_PAGEバイト)
+ *
+ * 返り値:
+ *	判定できればOK、ビット詰めしないフィールドや整数でない条件、likeの条件ならNGを返す
+ *
+ * 条件の値をページの基準値からの差に直し、詰めたままの差と比べるので、
+ * 値を1つずつ整数に戻さない。差の範囲の外の値との比較なら、ページのすべての
+ * スロットの結果が値を見ずに決まる。空きスロットの結果も設定するので、
+ * 使用中かどうかはgetNextSlotで確かめること。
+ */
+Result matchPackedField(char *page, TableInfo *tableInfo, int field, Condition *condition, char *match)
+{
+    char *words;
+    char *area;
+    long long value;
+    long long maxDiff;
+    unsigned int limit;
+    int numSlot;
+    int bits;
+    int j;
+
+    if ((bits = getPackBits(tableInfo, field)) == 0 || condition->dataType != TYPE_INTEGER) {
+        return NG;
+    }
+
+    numSlot = getBitmapLayoutNumSlots(tableInfo);
+    area = getFieldAddress(page, 0, field, tableInfo);
+    words = area + PACKED_HEADER_SIZE;
+    maxDiff = (long long) PACKED_MASK(bits);
+    value = (long long) condition->intValue - getPackedBase(area);
+
+    /* 条件の値の差が範囲の外なら、すべてのスロットの結果が同じになる */
+    switch (condition->operator) {
+        case OPR_EQUAL:
+            if (value < 0 || value > maxDiff) {
+                memset(match, 0, numSlot);
+                return OK;
+            }
+            break;
+        case OPR_NOT_EQUAL:
+            if (value < 0 || value > maxDiff) {
+                memset(match, 1, numSlot);
+                return OK;
+            }
+            break;
+        case OPR_GREATER_THAN:
+            if (value < 0 || value >= maxDiff) {
+                memset(match, value < 0, numSlot);
+                return OK;
+            }
+            break;
+        case OPR_LESS_THAN:
+            if (value <= 0 || value > maxDiff) {
+                memset(match, value > 0, numSlot);
+                return OK;
+            }
+            break;
+        case OPR_LIKE:
+            /* パターンとの比較は整数の差では判定できない */
+        default:
+            return NG;
+    }
+
+    /* 詰めたままの差どうしを比べる */
+    limit = (unsigned int) value;
+    switch (condition->operator) {
+        case OPR_EQUAL:
+            for (j = 0; j < numSlot; j++) {
+                match[j] = PACKED_VALUE(words, j, bits) == limit;
+            }
+            break;
+        case OPR_NOT_EQUAL:
+            for (j = 0; j < numSlot; j++) {
+                match[j] = PACKED_VALUE(words, j, bits) != limit;
+            }
+            break;
+        case OPR_GREATER_THAN:
+            for (j = 0; j < numSlot; j++) {
+                match[j] = PACKED_VALUE(words, j, bits) > limit;
+            }
+            break;
+        case OPR_LESS_THAN:
+            for (j = 0; j < numSlot; j++) {
+                match[j] = PACKED_VALUE(words, j, bits) < limit;
+            }
+            break;
+        case OPR_LIKE:
+            return NG;
+    }
+    return OK;
+}
+
+/*
+ * insertIntoPage -- ページへのレコードの格納
+ *
+ * 引数:
+ *	page: ページ
+ *	tableInfo: テーブルのデータ定義情報
+ *	recordData: 格納するレコード
+ *
+ * 返り値:
+ *	格納したスロット番号。ページに入りきらない場合と、ビット詰めするフィールドの
+ *	値がページの基準値からの差の範囲に収まらない場合は-1を返す。
+ */
+int insertIntoPage(char *page, TableInfo *tableInfo, RecordData *recordData)
+{
+    char buf[MAX_VAR_RECORD_SIZE];
+    char *p;
+    BitmapWord word;
+    int recordSize;
+    int numSlot;
+    int empty;
+    int bits;
+    int len;
+    int slot;
+    int n;
+    int i;
+
+    switch (tableInfo->option.layout) {
+        case LAYOUT_FIXED:
+        case LAYOUT_PAX:
+            numSlot = getBitmapLayoutNumSlots(tableInfo);
+
+            /* ビットがすべて1ではない語を探し、最初の0のビットの位置を空きスロットにする */
+            for (n = 0; n < BITMAP_NUM_WORDS(numSlot); n++) {
+                word = ~getBitmapWord(page, n);
+                if (n == BITMAP_NUM_WORDS(numSlot) - 1) {
+                    word &= BITMAP_TAIL_MASK(numSlot);
+                }
+                if (word != 0) {
+                    break;
+                }
+            }
+            if (n == BITMAP_NUM_WORDS(numSlot)) {
+                return -1;
+            }
+            slot = n * BITMAP_WORD_BITS + __builtin_ctzll(word);
+
+            /*
+             * ビット詰めするフィールドの値が基準値からの差に収まるか確かめる
+             * (空のページなら、値を2^bitsの倍数に切り捨てて基準値にする)
+             */
+            empty = countUsedSlots(page, tableInfo) == 0;
+            for (i = 0; i < tableInfo->numField; i++) {
+                if ((bits = getPackBits(tableInfo, i)) == 0) {
+                    continue;
+                }
+                p = getFieldAddress(page, slot, i, tableInfo);
+                if (empty) {
+                    n = recordData->fieldData[i].intValue & ~(int) PACKED_MASK(bits);
+                    memcpy(p, &n, sizeof(int));
+                } else if (!canPackValue(p, bits, recordData->fieldData[i].intValue)) {
+                    return -1;
+                }
+            }
+
+            n = slot / BITMAP_WORD_BITS;
+            setBitmapWord(page, n, getBitmapWord(page, n) | (BitmapWord) 1 << (slot % BITMAP_WORD_BITS));
+            for (i = 0; i < tableInfo->numField; i++) {
+                p = getFieldAddress(page, slot, i, tableInfo);
+                if ((bits = getPackBits(tableInfo, i)) != 0) {
+                    encodePackedField(p, slot, bits, recordData->fieldData[i].intValue);
+                } else {
+                    encodeFixedField(tableInfo, i, &recordData->fieldData[i], p);
+                }
+            }
+            return slot;
+
+        case LAYOUT_SLOTTED:
+            if ((len = encodeVarRecord(tableInfo, recordData, buf)) < 0) {
+                return -1;
+            }
+
+            /* 空いているスロットがあれば使い、なければスロットを1つ増やす */
+            numSlot = SLOTTED_NUM_SLOT(page);
+            for (slot = 0; slot < numSlot; slot++) {
+                if (SLOT_LENGTH(page, slot) == 0) {
+                    break;
+                }
+            }
+            if (getSlottedFreeBytes(page) < len + (slot == numSlot ? SLOT_ENTRY_SIZE : 0)) {
+                return -1;
+            }
+            if (slot == numSlot) {
+                SLOTTED_NUM_SLOT(page) = numSlot + 1;
+            }
+
+            SLOTTED_FREE_END(page) -= len;
+            memcpy(page + SLOTTED_FREE_END(page), buf, len);
+            SLOT_OFFSET(page, slot) = SLOTTED_FREE_END(page);
+            SLOT_LENGTH(page, slot) = len;
+            return slot;
+
+        default:
+            /* pageの先頭からrecordSizeバイトずつ飛びながら、先頭のフラグが「0」(未使用)の場所を探す */
+            recordSize = getRecordSize(tableInfo);
+            for (slot = 0; slot < (PAGE_SIZE / recordSize); slot++) {
+                if (page[slot * recordSize] == 0) {
+                    break;
+                }
+            }
+            if (slot == (PAGE_SIZE / recordSize)) {
+                return -1;
+            }
+
+            /* 先頭に、「使用中」を意味するフラグを立て、フィールドのデータを順に埋め込む */
+            p = page + slot * recordSize;
+            memset(p, 0, recordSize);
+            *p = 1;
+            for (i = 0; i < tableInfo->numField; i++) {
+                encodeFixedField(tableInfo, i, &recordData->fieldData[i],
+                                 getFieldAddress(page, slot, i, tableInfo));
+            }
+            return slot;
+    }
+}
+
+/*
+ * deleteFromPage -- ページからのレコードの削除
+ *
+ * 引数:
+ *	page: ページ
+ *	slot: 削除するレコードのスロット番号
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	なし
+ *
+ * スロット形式では、削除したレコードより前に詰めてあるデータをずらして
+ * 空き領域を1か所にまとめる。ほかのレコードのスロット番号は変わらない。
+ */
+void deleteFromPage(char *page, int slot, TableInfo *tableInfo)
+{
+    int offset, len;
+    int freeEnd;
+    int n;
+    int i;
+
+    switch (tableInfo->option.layout) {
+        case LAYOUT_FIXED:
+        case LAYOUT_PAX:
+            n = slot / BITMAP_WORD_BITS;
+            setBitmapWord(page, n, getBitmapWord(page, n) & ~((BitmapWord) 1 << (slot % BITMAP_WORD_BITS)));
+            return;
+        case LAYOUT_SLOTTED:
+            break;
+        default:
+            page[getRecordSize(tableInfo) * slot] = 0;
+            return;
+    }
+
+    if (slot >= SLOTTED_NUM_SLOT(page) || (len = SLOT_LENGTH(page, slot)) == 0) {
+        return;
+    }
+    offset = SLOT_OFFSET(page, slot);
+    freeEnd = SLOTTED_FREE_END(page);
+
+    /* 削除したレコードより前にあるデータを、その長さの分だけ後ろにずらす */
+    memmove(page + freeEnd + len, page + freeEnd, offset - freeEnd);
+    for (i = 0; i < SLOTTED_NUM_SLOT(page); i++) {
+        if (SLOT_LENGTH(page, i) != 0 && SLOT_OFFSET(page, i) < offset) {
+            SLOT_OFFSET(page, i) += len;
+        }
+    }
+    SLOTTED_FREE_END(page) = freeEnd + len;
+    SLOT_OFFSET(page, slot) = 0;
+    SLOT_LENGTH(page, slot) = 0;
+
+    /* 末尾の空きスロットはスロット配列から外す */
+    while (SLOTTED_NUM_SLOT(page) > 0 && SLOT_LENGTH(page, SLOTTED_NUM_SLOT(page) - 1) == 0) {
+        SLOTTED_NUM_SLOT(page)--;
+    }
+}
+
+/*
+ * updateSlot -- ページの中のレコードの書き換え
+ *
+ * 引数:
+ *	page: ページ
+ *	slot: 書き換えるレコードのスロット番号
+ *	tableInfo: テーブルのデータ定義情報
+ *	recordData: 書き換えた後のレコード
+ *
+ * 返り値:
+ *	書き換えられたらOK、そのページに収まらなければNGを返す(ページは変わらない)
+ *
+ * スロット番号は変わらない。スロット形式では、レコードが長くなると
+ * ページの空きに収まらないことがある。ビット詰めするフィールドの値が
+ * ページの基準値からの差に収まらない場合も書き換えられない。
+ */
+Result updateSlot(char *page, int slot, TableInfo *tableInfo, RecordData *recordData)
+{
+    char buf[MAX_VAR_RECORD_SIZE];
+    char *p;
+    int recordSize;
+    int bits;
+    int len;
+    int i;
+
+    if (!isSlotUsed(page, slot, tableInfo)) {
+        return NG;
+    }
+
+    switch (tableInfo->option.layout) {
+        case LAYOUT_FIXED:
+        case LAYOUT_PAX:
+            /* ビット詰めするフィールドの値がすべて収まるか、先に確かめる */
+            for (i = 0; i < tableInfo->numField; i++) {
+                if ((bits = getPackBits(tableInfo, i)) != 0
+                    && !canPackValue(getFieldAddress(page, slot, i, tableInfo), bits,
+                                     recordData->fieldData[i].intValue)) {
+                    return NG;
+                }
+            }
+            for (i = 0; i < tableInfo->numField; i++) {
+                p = getFieldAddress(page, slot, i, tableInfo);
+                if ((bits = getPackBits(tableInfo, i)) != 0) {
+                    encodePackedField(p, slot, bits, recordData->fieldData[i].intValue);
+                } else {
+                    encodeFixedField(tableInfo, i, &recordData->fieldData[i], p);
+                }
+            }
+            return OK;
+
+        case LAYOUT_SLOTTED:
+            if ((len = encodeVarRecord(tableInfo, recordData, buf)) < 0
+                || getSlottedFreeBytes(page) + SLOT_LENGTH(page, slot) < len) {
+                return NG;
+            }
+
+            /* 元のデータを取り除いて空きをまとめてから、同じスロットに格納し直す */
+            deleteFromPage(page, slot, tableInfo);
+            if (slot >= SLOTTED_NUM_SLOT(page)) {
+                SLOTTED_NUM_SLOT(page) = slot + 1;
+            }
+            SLOTTED_FREE_END(page) -= len;
+            memcpy(page + SLOTTED_FREE_END(page), buf, len);
+            SLOT_OFFSET(page, slot) = SLOTTED_FREE_END(page);
+            SLOT_LENGTH(page, slot) = len;
+            return OK;
+
+        default:
+            recordSize = getRecordSize(tableInfo);
+            p = page + slot * recordSize;
+            memset(p, 0, recordSize);
+            *p = 1;
+            for (i = 0; i < tableInfo->numField; i++) {
+                encodeFixedField(tableInfo, i, &recordData->fieldData[i],
+                                 getFieldAddress(page, slot, i, tableInfo));
+            }
+            return OK;
+    }
+}
+
+/*
+ * countFreeSlots -- ページの中の空きスロットの数
+ *
+ * 引数:
+ *	page: ページ
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	空きスロットの数
+ *	(固定長形式では未使用のレコード領域の数、スロット形式では長さ0のスロットの数)
+ */
+int countFreeSlots(char *page, TableInfo *tableInfo)
+{
+    int numSlot = getNumSlots(page, tableInfo);
+
+    return numSlot - countUsedSlots(page, tableInfo);
+}
+
+/*
+ * countUsedSlots -- ページの中のレコード数
+ *
+ * 引数:
+ *	page: ページ
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	使用中のスロットの数
+ *
+ * 固定長形式と列ごとの形式では、ビットマップの語ごとにpopcountで数える。
+ */
+int countUsedSlots(char *page, TableInfo *tableInfo)
+{
+    int numSlot;
+    int count = 0;
+    int j;
+
+    if (IS_BITMAP_LAYOUT(tableInfo)) {
+        numSlot = getBitmapLayoutNumSlots(tableInfo);
+        for (j = 0; j < BITMAP_NUM_WORDS(numSlot); j++) {
+            count += __builtin_popcountll(getBitmapWord(page, j));
+        }
+        return count;
+    }
+
+    for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+        count++;
+    }
+    return count;
+}
+
+/*
+ * getPageFreeSpaceValue -- 空き領域マップに記録するページの空き量
+ *
+ * 引数:
+ *	page: ページ
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	固定長形式では空きスロット数、
+ *	スロット形式では空きバイト数をSLOTTED_FREE_SPACE_UNIT単位で切り捨てた値
+ */
+int getPageFreeSpaceValue(char *page, TableInfo *tableInfo)
+{
+    if (tableInfo->option.layout == LAYOUT_SLOTTED) {
+        return getSlottedFreeBytes(page) / SLOTTED_FREE_SPACE_UNIT;
+    }
+    return countFreeSlots(page, tableInfo);
+}
+
+/*
+ * getRequiredFreeSpaceValue -- レコードの格納に必要な空き量
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *	recordData: 格納するレコード
+ *
+ * 返り値:
+ *	getPageFreeSpaceValueと同じ単位で表した、レコードの格納に必要な空き量
+ *	格納できないレコード(1ページに入りきらない、固定長形式で文字列が長すぎる)
+ *	の場合は-1を返す(辞書圧縮するフィールドの文字列の長さは調べない)
+ *
+ * 空き量がこの値以上のページには、必ずレコードを格納できる。ただし、ビット詰めする
+ * フィールドがあるテーブルでは、値がページの基準値からの差に収まらなければ格納できない
+ * (空のページには必ず格納できる)。
+ */
+int getRequiredFreeSpaceValue(TableInfo *tableInfo, RecordData *recordData)
+{
+    char buf[MAX_VAR_RECORD_SIZE];
+    int len;
+    int i;
+
+    if (tableInfo->option.layout != LAYOUT_SLOTTED) {
+        /* 固定長形式では、MAX_STRINGバイトを超える文字列は格納できない */
+        for (i = 0; i < tableInfo->numField; i++) {
+            if (getStoredType(tableInfo, i) == TYPE_STRING
+                && strlen(recordData->fieldData[i].stringValue) > MAX_STRING) {
+                return -1;
+            }
+        }
+        return 1;
+    }
+
+    if ((len = encodeVarRecord(tableInfo, recordData, buf)) < 0
+        || len + SLOT_ENTRY_SIZE > PAGE_SIZE - SLOTTED_HEADER_SIZE) {
+        return -1;
+    }
+    len += SLOT_ENTRY_SIZE;
+    return (len + SLOTTED_FREE_SPACE_UNIT - 1) / SLOTTED_FREE_SPACE_UNIT;
+}
+
+/*
+ * getMaxRecordsPerPage -- 1ページに格納できるレコード数の上限
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	固定長形式ではスロット数、スロット形式では文字列がすべて空のレコードを
+ *	詰めたときのレコード数
+ */
+int getMaxRecordsPerPage(TableInfo *tableInfo)
+{
+    int minSize = 0;
+    int i;
+
+    if (IS_BITMAP_LAYOUT(tableInfo)) {
+        return getBitmapLayoutNumSlots(tableInfo);
+    }
+    if (tableInfo->option.layout != LAYOUT_SLOTTED) {
+        return PAGE_SIZE / getRecordSize(tableInfo);
+    }
+
+    /* 可変長形式では、整数はsizeof(int)バイト、文字列は少なくとも長さの1バイトを使う */
+    for (i = 0; i < tableInfo->numField; i++) {
+        minSize += getStoredType(tableInfo, i) == TYPE_INTEGER ? sizeof(int) : 1;
+    }
+    return (PAGE_SIZE - SLOTTED_HEADER_SIZE) / (minSize + SLOT_ENTRY_SIZE);
+}
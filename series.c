@@ -0,0 +1,609 @@
+/*
+ * series.c -- 追記専用の時系列テーブルのモジュール
+ *
+ * append (フィールド名)を指定したテーブル(時系列テーブル)では、指定した整数型の
+ * フィールドを時刻とし、時刻が減らない順にしかレコードを挿入できない。
+ * レコードは常にデータファイルの最後のページ(末尾ページ)に追記し、入らなければ
+ * 新しいページを加える。空き領域マップで空きを探すことも、削除で穴を空けることもない。
+ * 末尾ページの内容はメモリ上にも持っておき、挿入のたびに読み直さない。
+ *
+ * ページごとの最初のレコードの時刻を、ページ番号の順に並べた疎な索引
+ * (tableName.tsi)を持つ。時刻は減らないので、索引も時刻の順に並んでおり、
+ * 時刻のフィールドの=、<、>の条件に合うレコードがあるページの範囲を二分探索で求める。
+ *
+ * 古いレコードは、先頭のエクステント(SERIES_EXTENT_PAGESページ)ごとに捨てる。
+ * 捨てたページはデータファイルから解放し(0のページとして読める)、ページ番号は
+ * そのままにして、索引に最初の有効なページの番号を記録する。
+ *
+ * 索引ファイルの0ページ目にはSeriesHeaderを、1ページ目からはページごとの
+ * 最初の時刻(sizeof(int)バイトずつ)を記録する。索引ファイルがないか、
+ * データファイルとページ数が食い違っていれば、データファイルを1回読んで作り直す。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * SERIES_INDEX_EXT -- 時系列テーブルの索引ファイルの拡張子
+ */
+#define SERIES_INDEX_EXT ".tsi"
+
+/*
+ * SERIES_MAGIC -- 時系列テーブルの索引ファイルであることを示す値
+ */
+#define SERIES_MAGIC 0x74736931
+
+/*
+ * SERIES_TIMES_PER_PAGE -- 索引ファイルの1ページに記録する時刻の数
+ */
+#define SERIES_TIMES_PER_PAGE (PAGE_SIZE / (int) sizeof(int))
+
+/*
+ * SeriesHeader -- 索引ファイルのヘッダ
+ */
+typedef struct SeriesHeader SeriesHeader;
+struct SeriesHeader {
+    int magic;                          /*SERIES_MAGIC*/
+    int numPage;                        /*索引に記録したデータファイルのページ数*/
+    int firstPage;                      /*最初の有効なページの番号(それより前は捨てたページ)*/
+};
+
+/*
+ * SeriesIndex -- メモリ上の時系列テーブルの情報
+ *
+ * tailはページの使用中ビットマップを語単位で読むので、mallocした領域の先頭に置いて
+ * 境界を揃える。
+ */
+typedef struct SeriesIndex SeriesIndex;
+struct SeriesIndex {
+    char tail[PAGE_SIZE];               /*末尾ページの内容*/
+    char tableName[MAX_FILENAME];       /*テーブル名*/
+    int numPage;                        /*データファイルのページ数*/
+    int firstPage;                      /*最初の有効なページの番号*/
+    int *firstTimes;                    /*ページごとの最初のレコードの時刻*/
+    int maxPage;                        /*firstTimesの大きさ*/
+    int numRecord;                      /*tailを読んだときのテーブルのレコード数(-1なら読んでいない)*/
+    int lastTime;                       /*最後に挿入したレコードの時刻*/
+    SeriesIndex *next;                  /*次のテーブル*/
+};
+
+/*
+ * seriesList -- メモリ上に読み込んだ時系列テーブルの情報のリスト
+ */
+static SeriesIndex *seriesList = NULL;
+
+/*
+ * getSeriesField -- 時系列テーブルの時刻のフィールドの番号の取得
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	時刻のフィールドの番号。時系列テーブルでなければ-1を返す。
+ */
+int getSeriesField(TableInfo *tableInfo)
+{
+    int i;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (IS_SERIES_FIELD(tableInfo, i)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * freeSeriesIndex -- メモリ上の時系列テーブルの情報をリストから外して解放する
+ */
+static void freeSeriesIndex(SeriesIndex *index)
+{
+    SeriesIndex **p;
+
+    for (p = &seriesList; *p != NULL; p = &(*p)->next) {
+        if (*p == index) {
+            *p = index->next;
+            break;
+        }
+    }
+    free(index->firstTimes);
+    free(index);
+}
+
+/*
+ * findSeriesIndex -- メモリ上の時系列テーブルの情報を探す
+ */
+static SeriesIndex *findSeriesIndex(char *tableName)
+{
+    SeriesIndex *index;
+
+    for (index = seriesList; index != NULL; index = index->next) {
+        if (strcmp(index->tableName, tableName) == 0) {
+            return index;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * growSeriesIndex -- ページごとの時刻の配列を、numPageページ分の大きさにする
+ */
+static Result growSeriesIndex(SeriesIndex *index, int numPage)
+{
+    int *firstTimes;
+    int maxPage;
+
+    if (numPage <= index->maxPage) {
+        return OK;
+    }
+    for (maxPage = index->maxPage == 0 ? 64 : index->maxPage; maxPage < numPage; maxPage *= 2) {
+        ;
+    }
+    if ((firstTimes = (int *) realloc(index->firstTimes, maxPage * sizeof(int))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NG;
+    }
+    index->firstTimes = firstTimes;
+    index->maxPage = maxPage;
+    return OK;
+}
+
+/*
+ * writeSeriesIndex -- 索引ファイルに、ヘッダとfromページ目以降の時刻を書く
+ */
+static Result writeSeriesIndex(SeriesIndex *index, int from)
+{
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    SeriesHeader header;
+    File *file;
+    int n, count;
+
+    if (snprintf(filename, MAX_FILENAME, "%s%s", index->tableName, SERIES_INDEX_EXT) >= MAX_FILENAME) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        return NG;
+    }
+    if (getNumPages(filename) == -1 && createFile(filename) != OK) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        return NG;
+    }
+    if ((file = openFile(filename)) == NULL) {
+        printErrorMessage(ERR_MSG_OPEN, __func__, __LINE__);
+        return NG;
+    }
+
+    /* fromページ目の時刻を含む索引ファイルのページから書く */
+    for (n = from - from % SERIES_TIMES_PER_PAGE; n < index->numPage; n += SERIES_TIMES_PER_PAGE) {
+        memset(page, 0, PAGE_SIZE);
+        count = index->numPage - n < SERIES_TIMES_PER_PAGE ? index->numPage - n : SERIES_TIMES_PER_PAGE;
+        memcpy(page, &index->firstTimes[n], count * sizeof(int));
+        if (writePage(file, 1 + n / SERIES_TIMES_PER_PAGE, page) != OK) {
+            printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+            closeFile(file);
+            return NG;
+        }
+    }
+
+    memset(page, 0, PAGE_SIZE);
+    header.magic = SERIES_MAGIC;
+    header.numPage = index->numPage;
+    header.firstPage = index->firstPage;
+    memcpy(page, &header, sizeof(header));
+    if (writePage(file, 0, page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        closeFile(file);
+        return NG;
+    }
+    return closeFile(file);
+}
+
+/*
+ * readSeriesIndex -- 索引ファイルを読み込む
+ *
+ * 返り値:
+ *	索引ファイルがデータファイルのページ数と一致していればOK、そうでなければNGを返す
+ */
+static Result readSeriesIndex(SeriesIndex *index, int numPage)
+{
+    char filename[MAX_FILENAME];
+    char page[PAGE_SIZE];
+    SeriesHeader header;
+    File *file;
+    int n, count;
+
+    if (snprintf(filename, MAX_FILENAME, "%s%s", index->tableName, SERIES_INDEX_EXT) >= MAX_FILENAME
+        || getNumPages(filename) < 1 || (file = openFile(filename)) == NULL) {
+        return NG;
+    }
+    if (readPage(file, 0, page) != OK) {
+        closeFile(file);
+        return NG;
+    }
+    memcpy(&header, page, sizeof(header));
+    if (header.magic != SERIES_MAGIC || header.numPage != numPage
+        || growSeriesIndex(index, numPage) != OK) {
+        closeFile(file);
+        return NG;
+    }
+    for (n = 0; n < numPage; n += SERIES_TIMES_PER_PAGE) {
+        if (readPage(file, 1 + n / SERIES_TIMES_PER_PAGE, page) != OK) {
+            closeFile(file);
+            return NG;
+        }
+        count = numPage - n < SERIES_TIMES_PER_PAGE ? numPage - n : SERIES_TIMES_PER_PAGE;
+        memcpy(&index->firstTimes[n], page, count * sizeof(int));
+    }
+    index->numPage = numPage;
+    index->firstPage = header.firstPage;
+    return closeFile(file);
+}
+
+/*
+ * buildSeriesIndex -- データファイルを読んで、ページごとの最初の時刻を求める
+ *
+ * 先頭のレコードのないページ(捨てたページ)は、有効なページに含めない。
+ */
+static Result buildSeriesIndex(SeriesIndex *index, File *file, int numPage, TableInfo *tableInfo)
+{
+    FieldData fieldData;
+    char page[PAGE_SIZE];
+    int field = getSeriesField(tableInfo);
+    int found;
+    int i, j;
+
+    if (growSeriesIndex(index, numPage) != OK) {
+        return NG;
+    }
+    index->firstPage = 0;
+    for (i = 0; i < numPage; i++) {
+        if (readPage(file, i, page) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return NG;
+        }
+        found = 0;
+        index->firstTimes[i] = i > 0 ? index->firstTimes[i - 1] : INT_MIN;
+        for (j = getNextSlot(page, 0, tableInfo); j != -1; j = getNextSlot(page, j + 1, tableInfo)) {
+            if (readSlotField(page, j, tableInfo, field, &fieldData) == OK
+                && (!found || fieldData.intValue < index->firstTimes[i])) {
+                index->firstTimes[i] = fieldData.intValue;
+                found = 1;
+            }
+        }
+        if (!found && index->firstPage == i) {
+            index->firstPage = i + 1;
+        }
+    }
+    if (index->firstPage >= numPage) {
+        index->firstPage = numPage > 0 ? numPage - 1 : 0;
+    }
+    index->numPage = numPage;
+    return writeSeriesIndex(index, 0);
+}
+
+/*
+ * openSeriesIndex -- メモリ上の時系列テーブルの情報を取得する(なければ索引ファイルから作る)
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	時系列テーブルの情報。時系列テーブルでない場合やエラーの場合はNULLを返す。
+ */
+static SeriesIndex *openSeriesIndex(char *tableName, File *file, int numPage, TableInfo *tableInfo)
+{
+    SeriesIndex *index;
+
+    if (getSeriesField(tableInfo) == -1) {
+        return NULL;
+    }
+    if ((index = findSeriesIndex(tableName)) != NULL) {
+        if (index->numPage == numPage) {
+            return index;
+        }
+        freeSeriesIndex(index);
+    }
+
+    if ((index = (SeriesIndex *) calloc(1, sizeof(SeriesIndex))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    snprintf(index->tableName, MAX_FILENAME, "%s", tableName);
+    index->numRecord = -1;
+    if (readSeriesIndex(index, numPage) != OK && buildSeriesIndex(index, file, numPage, tableInfo) != OK) {
+        free(index->firstTimes);
+        free(index);
+        return NULL;
+    }
+    index->next = seriesList;
+    seriesList = index;
+    return index;
+}
+
+/*
+ * getSeriesTail -- 時系列テーブルの末尾ページと最後の時刻の取得
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *	numRecord: テーブルのレコード数(統計情報の値)
+ *	page: 末尾ページの内容を格納するPAGE_SIZEバイトの領域
+ *	lastTime: 最後に挿入したレコードの時刻を格納する場所(レコードがなければINT_MIN)
+ *
+ * 返り値:
+ *	末尾ページの番号。ページがなければ-1、エラーの場合は-2を返す。
+ *
+ * メモリ上の末尾ページは、レコード数が読んだときと変わっていなければそのまま使い
+ * (他のプロセスが挿入していれば変わる)、変わっていれば読み直す。
+ */
+int getSeriesTail(char *tableName, File *file, int numPage, TableInfo *tableInfo, int numRecord,
+                  char *page, int *lastTime)
+{
+    SeriesIndex *index;
+    FieldData fieldData;
+    int field = getSeriesField(tableInfo);
+    int j;
+
+    if ((index = openSeriesIndex(tableName, file, numPage, tableInfo)) == NULL) {
+        return -2;
+    }
+    if (numPage == 0) {
+        *lastTime = INT_MIN;
+        return -1;
+    }
+    if (index->numRecord != numRecord) {
+        if (readPage(file, numPage - 1, index->tail) != OK) {
+            printErrorMessage(ERR_MSG_READ, __func__, __LINE__);
+            return -2;
+        }
+        index->lastTime = INT_MIN;
+        for (j = getNextSlot(index->tail, 0, tableInfo); j != -1; j = getNextSlot(index->tail, j + 1, tableInfo)) {
+            if (readSlotField(index->tail, j, tableInfo, field, &fieldData) == OK
+                && fieldData.intValue > index->lastTime) {
+                index->lastTime = fieldData.intValue;
+            }
+        }
+        index->numRecord = numRecord;
+    }
+    memcpy(page, index->tail, PAGE_SIZE);
+    *lastTime = index->lastTime;
+    return numPage - 1;
+}
+
+/*
+ * addSeriesRecord -- 時系列テーブルに挿入したレコードを、メモリ上の末尾ページと索引に反映する
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	pageNum: レコードを挿入したページの番号
+ *	page: 挿入した後のページの内容
+ *	time: 挿入したレコードの時刻
+ *	numRecord: 挿入した後のテーブルのレコード数
+ *
+ * 返り値:
+ *	なし
+ *
+ * 新しいページなら、索引ファイルにそのページの時刻を加える。
+ * 加えられなかった場合はメモリ上の情報と索引ファイルを捨て、次に使うときに作り直す。
+ */
+void addSeriesRecord(char *tableName, int pageNum, char *page, int time, int numRecord)
+{
+    char filename[MAX_FILENAME];
+    SeriesIndex *index;
+
+    if ((index = findSeriesIndex(tableName)) == NULL) {
+        return;
+    }
+    if (pageNum == index->numPage) {
+        if (growSeriesIndex(index, pageNum + 1) != OK) {
+            freeSeriesIndex(index);
+            return;
+        }
+        index->firstTimes[pageNum] = time;
+        index->numPage++;
+        if (writeSeriesIndex(index, pageNum) != OK) {
+            freeSeriesIndex(index);
+            snprintf(filename, MAX_FILENAME, "%s%s", tableName, SERIES_INDEX_EXT);
+            deleteFile(filename);
+            return;
+        }
+    } else if (pageNum != index->numPage - 1) {
+        freeSeriesIndex(index);
+        return;
+    }
+    memcpy(index->tail, page, PAGE_SIZE);
+    index->lastTime = time;
+    index->numRecord = numRecord;
+}
+
+/*
+ * countTimesBelow -- 有効なページのうち、最初の時刻が値より小さい(orEqualが1なら値以下の)
+ * ページの最後の番号の次を求める
+ */
+static int countTimesBelow(SeriesIndex *index, int value, int orEqual)
+{
+    int lo = index->firstPage;
+    int hi = index->numPage;
+    int mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (index->firstTimes[mid] < value || (orEqual && index->firstTimes[mid] == value)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+ * searchSeriesPages -- 時系列テーブルの、条件に合うレコードがあるページの検索
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *	condField: 条件のフィールドの番号(-1なら条件のフィールドがない)
+ *	condition: 条件
+ *	numListed: 見つかったページの数を格納する場所
+ *
+ * 返り値:
+ *	条件に合うレコードがあるページの番号を昇順に並べた配列。使い終わったらfreeで解放すること。
+ *	時刻のフィールドの=、<、>の条件なら、索引を二分探索して読むページの範囲を絞る。
+ *	それ以外の条件では捨てたページを除き、捨てたページもなければNULLを返す。
+ */
+int *searchSeriesPages(char *tableName, File *file, int numPage, TableInfo *tableInfo, int condField,
+                       Condition *condition, int *numListed)
+{
+    SeriesIndex *index;
+    int *pageList;
+    int start, end;
+    int i;
+
+    if ((index = openSeriesIndex(tableName, file, numPage, tableInfo)) == NULL) {
+        return NULL;
+    }
+
+    /* 条件に合う時刻があるかもしれないページの範囲[start, end)を求める */
+    start = index->firstPage;
+    end = numPage;
+    if (condField != -1 && IS_SERIES_FIELD(tableInfo, condField) && condition->dataType == TYPE_INTEGER) {
+        switch (condition->operator) {
+        case OPR_EQUAL:
+            start = countTimesBelow(index, condition->intValue, 0) - 1;
+            end = countTimesBelow(index, condition->intValue, 1);
+            break;
+        case OPR_LESS_THAN:
+            end = countTimesBelow(index, condition->intValue, 0);
+            break;
+        case OPR_GREATER_THAN:
+            start = countTimesBelow(index, condition->intValue, 1) - 1;
+            break;
+        default:
+            break;
+        }
+        if (start < index->firstPage) {
+            start = index->firstPage;
+        }
+    } else if (start == 0) {
+        return NULL;
+    }
+
+    if ((pageList = (int *) malloc((end - start + 1) * sizeof(int))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    *numListed = 0;
+    for (i = start; i < end; i++) {
+        pageList[(*numListed)++] = i;
+    }
+    return pageList;
+}
+
+/*
+ * findSeriesExtents -- 捨てられる先頭のエクステントの範囲の検索
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	file: オープン済みのデータファイル
+ *	numPage: データファイルのページ数
+ *	tableInfo: テーブルのデータ定義情報
+ *	before: この時刻より前のレコードだけのエクステントを捨てる
+ *	firstPage: 今の最初の有効なページの番号を格納する場所
+ *
+ * 返り値:
+ *	捨てた後の最初の有効なページの番号(firstPageと同じなら捨てるページはない)。
+ *	エラーの場合は-1を返す。
+ *
+ * エクステントの次のページの最初の時刻がbeforeより前なら、エクステントのレコードはすべて
+ * beforeより前にある。末尾ページを含むエクステントは捨てない。
+ */
+int findSeriesExtents(char *tableName, File *file, int numPage, TableInfo *tableInfo, int before, int *firstPage)
+{
+    SeriesIndex *index;
+    int end;
+
+    if ((index = openSeriesIndex(tableName, file, numPage, tableInfo)) == NULL) {
+        return -1;
+    }
+    *firstPage = index->firstPage;
+    end = countTimesBelow(index, before, 0) - 1;
+    end -= end % SERIES_EXTENT_PAGES;
+    return end > index->firstPage ? end : index->firstPage;
+}
+
+/*
+ * setSeriesFirstPage -- 最初の有効なページの番号の記録
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *	firstPage: 最初の有効なページの番号
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result setSeriesFirstPage(char *tableName, int firstPage)
+{
+    SeriesIndex *index;
+
+    if ((index = findSeriesIndex(tableName)) == NULL) {
+        return NG;
+    }
+    index->firstPage = firstPage;
+    if (writeSeriesIndex(index, index->numPage) != OK) {
+        freeSeriesIndex(index);
+        return NG;
+    }
+    return OK;
+}
+
+/*
+ * deleteSeriesIndex -- 時系列テーブルの索引ファイルの削除
+ *
+ * 引数:
+ *	tableName: テーブル名
+ *
+ * 返り値:
+ *	成功ならOK、失敗(索引ファイルがない場合を含む)ならNGを返す
+ *
+ * メモリ上の末尾ページと索引も捨てる。
+ */
+Result deleteSeriesIndex(char *tableName)
+{
+    char filename[MAX_FILENAME];
+
+    discardSeries(tableName);
+    snprintf(filename, MAX_FILENAME, "%s%s", tableName, SERIES_INDEX_EXT);
+    return deleteFile(filename);
+}
+
+/*
+ * discardSeries -- メモリ上の時系列テーブルの情報を捨てる
+ *
+ * 引数:
+ *	tableName: テーブル名(NULLならすべてのテーブル)
+ *
+ * 返り値:
+ *	なし
+ */
+void discardSeries(char *tableName)
+{
+    SeriesIndex *index, *next;
+
+    for (index = seriesList; index != NULL; index = next) {
+        next = index->next;
+        if (tableName == NULL || strcmp(index->tableName, tableName) == 0) {
+            freeSeriesIndex(index);
+        }
+    }
+}
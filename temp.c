@@ -0,0 +1,246 @@
+/*
+ * temp.c -- 一時テーブルのモジュール
+ *
+ * create temp tableで作ったテーブル(一時テーブル)は、このセッション(プロセス)の
+ * 一時ディレクトリ(TEMP_DIR_FORMAT)にデータ定義ファイルやデータファイルを置く。
+ * 一時テーブルの名前は、データ操作やデータ定義の入口でresolveTableNameによって
+ * ディレクトリ付きの名前に置き換えるので、以降はふつうのテーブルと同じように扱える。
+ *
+ * 一時ディレクトリのファイルはファイルモジュールで一時ファイルとして扱われ、
+ * クローズしても変更されたページを書き戻さない(バッファから追い出されるときにだけ書く)。
+ * また、一時テーブルのページは、このセッション専用のパーティションに置くので、
+ * 中間結果を読み書きしても、ほかのテーブルのページをバッファから追い出さない。
+ * 一時テーブルはfinalizeDataManipModuleで(セッションの終了時に)、一時ディレクトリごと削除される。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * TEMP_DIR_FORMAT -- 一時ディレクトリの名前(%dはプロセスID)
+ */
+#define TEMP_DIR_FORMAT "temp.%d"
+
+/*
+ * TEMP_PARTITION_FORMAT -- 一時テーブルが使うパーティションの名前(%dはプロセスID)
+ */
+#define TEMP_PARTITION_FORMAT "temp.%d"
+
+/*
+ * TEMP_PARTITION_RATIO -- 一時テーブルのパーティションが使えるフレーム数(バッファ数の何分の1か)
+ */
+#define TEMP_PARTITION_RATIO 4
+
+/*
+ * TempTable -- 一時テーブル
+ */
+typedef struct TempTable TempTable;
+struct TempTable {
+    char tableName[MAX_FILENAME];       /*テーブル名*/
+    char path[MAX_FILENAME];            /*一時ディレクトリ付きの名前(ファイル名の元になる)*/
+    TempTable *next;                    /*次のテーブル*/
+};
+
+/*
+ * tempTableList -- 一時テーブルのリスト
+ */
+static TempTable *tempTableList = NULL;
+
+/*
+ * tempDirName -- 一時ディレクトリの名前(""なら、まだ作っていない)
+ */
+static char tempDirName[MAX_FILENAME] = "";
+
+/*
+ * tempPartitionName -- 一時テーブルが使うパーティションの名前
+ */
+static char tempPartitionName[MAX_PARTITION_NAME] = "";
+
+/*
+ * prepareTempSpace -- 一時ディレクトリとパーティションを用意する
+ *
+ * 最初の一時テーブルを作るときに呼ぶ。
+ */
+static Result prepareTempSpace()
+{
+    BufferPartitionStat stat;
+    char dirName[MAX_FILENAME];
+    int maxFrames;
+
+    if (tempDirName[0] != '\0') {
+        return OK;
+    }
+
+    snprintf(dirName, MAX_FILENAME, TEMP_DIR_FORMAT, (int) getpid());
+    if (mkdir(dirName, 0700) == -1 && errno != EEXIST) {
+        printErrorMessage(ERR_MSG_CREATE, __func__, __LINE__);
+        return NG;
+    }
+    if (setTemporaryDirectory(dirName) != OK) {
+        rmdir(dirName);
+        return NG;
+    }
+
+    /* パーティションが作れなければ、一時テーブルも"default"パーティションを使う */
+    snprintf(tempPartitionName, MAX_PARTITION_NAME, TEMP_PARTITION_FORMAT, (int) getpid());
+    if (getBufferPartitionStat(DEFAULT_PARTITION_NAME, &stat) != OK
+        || (maxFrames = stat.maxFrames / TEMP_PARTITION_RATIO) < 1
+        || createBufferPartition(tempPartitionName, 0, maxFrames) != OK) {
+        tempPartitionName[0] = '\0';
+    }
+
+    strcpy(tempDirName, dirName);
+    return OK;
+}
+
+/*
+ * findTempTable -- 一時テーブルを探す
+ */
+static TempTable *findTempTable(char *tableName)
+{
+    TempTable *table;
+
+    for (table = tempTableList; table != NULL; table = table->next) {
+        if (strcmp(table->tableName, tableName) == 0) {
+            return table;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * createTempTable -- 一時テーブルの登録
+ *
+ * 引数:
+ *	tableName: 作成するテーブルの名前
+ *	option: テーブルの格納方法の設定(パーティションを一時テーブル専用のものに書き換える)
+ *
+ * 返り値:
+ *	一時ディレクトリ付きの名前(この名前でデータ定義ファイルなどを作る)
+ *	失敗(同じ名前の一時テーブルがある場合を含む)ならNULLを返す
+ *
+ * テーブルのファイルは作らないので、呼び出し側で返した名前のテーブルを作ること。
+ */
+char *createTempTable(char *tableName, TableOption *option)
+{
+    TempTable *table;
+
+    if (findTempTable(tableName) != NULL || strchr(tableName, '/') != NULL
+        || prepareTempSpace() != OK) {
+        return NULL;
+    }
+    if ((table = (TempTable *) calloc(1, sizeof(TempTable))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+    if (snprintf(table->tableName, MAX_FILENAME, "%s", tableName) >= MAX_FILENAME
+        || snprintf(table->path, MAX_FILENAME, "%s/%s", tempDirName, tableName) >= MAX_FILENAME) {
+        free(table);
+        return NULL;
+    }
+
+    memset(option->partition, 0, MAX_PARTITION_NAME);
+    strcpy(option->partition, tempPartitionName);
+
+    table->next = tempTableList;
+    tempTableList = table;
+    return table->path;
+}
+
+/*
+ * removeTempTable -- 一時テーブルの登録の取り消し
+ *
+ * 引数:
+ *	path: 一時ディレクトリ付きの名前(一時テーブルでなければ何もしない)
+ *
+ * 返り値:
+ *	なし
+ *
+ * テーブルのファイルは削除しないので、先にdropTableで削除しておくこと。
+ */
+void removeTempTable(char *path)
+{
+    TempTable **p;
+    TempTable *table;
+
+    for (p = &tempTableList; *p != NULL; p = &(*p)->next) {
+        if (strcmp((*p)->path, path) == 0) {
+            table = *p;
+            *p = table->next;
+            free(table);
+            return;
+        }
+    }
+}
+
+/*
+ * dropTempTables -- すべての一時テーブルの削除
+ *
+ * 引数:
+ *	なし
+ *
+ * 返り値:
+ *	なし
+ *
+ * 一時ディレクトリとパーティションも削除する。
+ */
+void dropTempTables()
+{
+    char path[MAX_FILENAME];
+
+    while (tempTableList != NULL) {
+        strcpy(path, tempTableList->path);
+        dropTable(path);
+        removeTempTable(path);
+    }
+
+    if (tempDirName[0] != '\0') {
+        rmdir(tempDirName);
+        setTemporaryDirectory(NULL);
+        tempDirName[0] = '\0';
+    }
+    if (tempPartitionName[0] != '\0') {
+        dropBufferPartition(tempPartitionName);
+        tempPartitionName[0] = '\0';
+    }
+}
+
+/*
+ * isTempTable -- 一時テーブルかどうか
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *
+ * 返り値:
+ *	一時テーブルなら1、そうでなければ0を返す
+ */
+int isTempTable(char *tableName)
+{
+    return findTempTable(tableName) != NULL;
+}
+
+/*
+ * resolveTableName -- ファイル名の元になるテーブルの名前を求める
+ *
+ * 引数:
+ *	tableName: テーブルの名前
+ *
+ * 返り値:
+ *	一時テーブルなら一時ディレクトリ付きの名前、そうでなければtableNameをそのまま返す
+ *	(返した名前を、もう一度この関数に渡しても変わらない)
+ */
+char *resolveTableName(char *tableName)
+{
+    TempTable *table;
+
+    if (tempTableList == NULL || (table = findTempTable(tableName)) == NULL) {
+        return tableName;
+    }
+    return table->path;
+}
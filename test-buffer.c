@@ -274,6 +274,134 @@ void test2()
     printf("---------- test2 end ----------\n\n");
 }
 
+/*
+ * test3 -- パーティションのテスト
+ *
+ * file1を保証フレーム数2、上限2のパーティションに割り当て、
+ * file2の大きなスキャンの後でもfile1のページがバッファに残っていることと、
+ * file1が上限を超えてバッファを使わないことを確認する。
+ */
+Result test3()
+{
+    File *file[2];
+    char page[PAGE_SIZE];
+    BufferPartitionStat stat;
+    long hits;
+    int i;
+
+    printf("---------- test3 start ----------\n");
+
+    if (createBufferPartition("hot", 2, 2) != OK) {
+	fprintf(stderr, "Cannot create partition.\n");
+	return NG;
+    }
+
+    if ((file[0] = openFile(TEST_FILE1)) == NULL || (file[1] = openFile(TEST_FILE2)) == NULL) {
+	fprintf(stderr, "Cannot open file.\n");
+	return NG;
+    }
+    setFilePartition(file[0], "hot");
+
+    /* file1の2ページをバッファに載せる */
+    readPage(file[0], 0, page);
+    readPage(file[0], 1, page);
+
+    /* file2を全ページスキャンする */
+    for (i = 0; i < FILE_SIZE; i++) {
+	readPage(file[1], i, page);
+    }
+    printBufferList();
+
+    /* file1の2ページはバッファに残っているはず */
+    getBufferPartitionStat("hot", &stat);
+    hits = stat.hits;
+    readPage(file[0], 0, page);
+    readPage(file[0], 1, page);
+    getBufferPartitionStat("hot", &stat);
+    printf("hot: frames = %d, hits = %ld, misses = %ld\n", stat.numFrames, stat.hits, stat.misses);
+    if (stat.hits - hits != 2) {
+	fprintf(stderr, "Pages of the partition were evicted.\n");
+	return NG;
+    }
+
+    /* file1を全ページスキャンしても、上限の2フレームしか使わないはず */
+    for (i = 0; i < FILE_SIZE; i++) {
+	readPage(file[0], i, page);
+    }
+    printBufferList();
+    getBufferPartitionStat("hot", &stat);
+    if (stat.numFrames != 2) {
+	fprintf(stderr, "The partition exceeded its quota (%d frames).\n", stat.numFrames);
+	return NG;
+    }
+    printBufferPartitionStats();
+
+    closeFile(file[0]);
+    closeFile(file[1]);
+    dropBufferPartition("hot");
+
+    printf("---------- test3 end ----------\n\n");
+    return OK;
+}
+
+/*
+ * test4 -- 保証フレーム数のテスト
+ *
+ * すべてのフレームをfile1のパーティションに保証すると、file2のページは
+ * file1のページを追い出して読み込むことはできず、エラーになることを確認する。
+ */
+Result test4()
+{
+    File *file[2];
+    char page[PAGE_SIZE];
+    BufferPartitionStat stat;
+    Result result = OK;
+    int i;
+
+    printf("---------- test4 start ----------\n");
+
+    if (createBufferPartition("all", NUM_BUFFER, NUM_BUFFER) != OK) {
+	fprintf(stderr, "Cannot create partition.\n");
+	return NG;
+    }
+
+    if ((file[0] = openFile(TEST_FILE1)) == NULL || (file[1] = openFile(TEST_FILE2)) == NULL) {
+	fprintf(stderr, "Cannot open file.\n");
+	return NG;
+    }
+    setFilePartition(file[0], "all");
+
+    /* file1のページですべてのフレームを埋める */
+    for (i = 0; i < NUM_BUFFER; i++) {
+	readPage(file[0], i, page);
+    }
+
+    /* file2のページを読むフレームはないはず */
+    if (readPage(file[1], 0, page) != NG) {
+	fprintf(stderr, "A reserved frame was evicted.\n");
+	result = NG;
+    }
+    printBufferList();
+    getBufferPartitionStat("all", &stat);
+    if (stat.numFrames != NUM_BUFFER) {
+	fprintf(stderr, "The partition lost its reserved frames (%d frames).\n", stat.numFrames);
+	result = NG;
+    }
+
+    /* パーティションを削除すれば、また読める */
+    dropBufferPartition("all");
+    if (readPage(file[1], 0, page) != OK) {
+	fprintf(stderr, "Cannot read page after dropping the partition.\n");
+	result = NG;
+    }
+
+    closeFile(file[0]);
+    closeFile(file[1]);
+
+    printf("---------- test4 end ----------\n\n");
+    return result;
+}
+
 /*
  * main -- バッファ管理モジュールのテスト
  */
@@ -364,6 +492,12 @@ int main(int argc, char **argv)
      */
     test1();
     test2();
+    if (test3() != OK) {
+	fprintf(stderr, "%s: test3 NG\n", TEST_NAME);
+    }
+    if (test4() != OK) {
+	fprintf(stderr, "%s: test4 NG\n", TEST_NAME);
+    }
 
     /*
      * ファイルアクセスモジュールの終了処理
@@ -5,9 +5,31 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "microdb.h"
 
 #define TABLE_NAME "student"
+#define SLOTTED_TABLE_NAME "memo"
+#define SPARSE_TABLE_NAME "sparse"
+#define PAX_TABLE_NAME "paxtable"
+#define DICTIONARY_TABLE_NAME "dictable"
+#define PACKED_TABLE_NAME "packtable"
+#define ZONE_TABLE_NAME "zonetable"
+#define BLOOM_TABLE_NAME "bloomtable"
+#define INDEX_TABLE_NAME "idxtable"
+#define HASH_TABLE_NAME "hashtable"
+#define BITMAP_TABLE_NAME "bitmaptable"
+#define LIKE_TABLE_NAME "liketable"
+#define CRACK_TABLE_NAME "cracktable"
+#define CLUSTER_TABLE_NAME "clustertable"
+#define LSM_TABLE_NAME "lsmtable"
+#define SERIES_TABLE_NAME "seriestable"
+#define MEMORY_TABLE_NAME "memtable"
+#define TEMP_TABLE_NAME "temptable"
+#define VACUUM_TABLE_NAME "vacuumtable"
+#define RID_TABLE_NAME "ridtable"
+#define UPDATE_TABLE_NAME "updatetable"
 
 /*
  * test1 -- レコードの挿入
@@ -230,6 +252,2763 @@ Result test3()
     return OK;
 }
 
+/*
+ * test4 -- レコード数の取得
+ */
+Result test4()
+{
+    Condition condition;
+    RecordSet *recordSet;
+    TableStat stat;
+    int numRecord;
+
+    /*
+     * 全件を検索した結果の件数と、統計情報のレコード数が一致するか確認する
+     * select * from TABLE_NAME where age != -1
+     */
+    strcpy(condition.name, "age");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_NOT_EQUAL;
+    condition.intValue = -1;
+    condition.distinct = NOT_DISTINCT;
+
+    if ((recordSet = selectRecord(TABLE_NAME, &condition)) == NULL) {
+	fprintf(stderr, "Cannot select records.\n");
+	return NG;
+    }
+    numRecord = recordSet->numRecord;
+    freeRecordSet(recordSet);
+
+    printf("select count(*) from %s = %d\n", TABLE_NAME, countRecord(TABLE_NAME));
+    if (countRecord(TABLE_NAME) != numRecord) {
+	fprintf(stderr, "countRecord: expected %d, got %d\n", numRecord, countRecord(TABLE_NAME));
+	return NG;
+    }
+
+    if (getTableStat(TABLE_NAME, &stat) != OK) {
+	fprintf(stderr, "Cannot get table stat.\n");
+	return NG;
+    }
+    if (stat.numPage != getNumPages(TABLE_NAME ".dat") || stat.lastInsertPage != 0) {
+	fprintf(stderr, "Table stat is wrong.\n");
+	return NG;
+    }
+
+    return OK;
+}
+
+/*
+ * test5 -- スロット形式のテーブル(可変長の文字列)
+ */
+Result test5()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    RecordData record;
+    RecordSet *recordSet;
+    Condition condition;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table memo (id integer, body string) layout slotted
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "body");
+    tableInfo.fieldInfo[1].dataType = TYPE_STRING;
+    tableInfo.numField = 2;
+    memset(&option, 0, sizeof(option));
+    option.layout = LAYOUT_SLOTTED;
+    dropTable(SLOTTED_TABLE_NAME);
+    if (createTableWithOption(SLOTTED_TABLE_NAME, &tableInfo, &option) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* MAX_STRINGより長い文字列を持つレコードを200件挿入 */
+    record.numField = 2;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "body");
+    record.fieldData[1].dataType = TYPE_STRING;
+    for (i = 0; i < 200; i++) {
+	record.fieldData[0].intValue = i;
+	snprintf(record.fieldData[1].stringValue, MAX_VARSTRING,
+		 "memo %d: a string longer than MAX_STRING", i);
+	if (insertRecord(SLOTTED_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* delete from memo where id < 100 (ページ内のデータが詰められる) */
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_LESS_THAN;
+    condition.intValue = 100;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(SLOTTED_TABLE_NAME, &condition) != OK) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+    if (countRecord(SLOTTED_TABLE_NAME) != 100) {
+	fprintf(stderr, "countRecord: expected 100, got %d\n", countRecord(SLOTTED_TABLE_NAME));
+	return NG;
+    }
+
+    /* select * from memo where id = 150 で、長い文字列がそのまま読めるか確認する */
+    condition.operator = OPR_EQUAL;
+    condition.intValue = 150;
+    if ((recordSet = selectRecord(SLOTTED_TABLE_NAME, &condition)) == NULL) {
+	fprintf(stderr, "Cannot select records.\n");
+	return NG;
+    }
+    printRecordSet(recordSet);
+    if (recordSet->numRecord != 1
+	|| strcmp(recordSet->recordData->fieldData[1].stringValue,
+		  "memo 150: a string longer than MAX_STRING") != 0) {
+	fprintf(stderr, "Wrong record.\n");
+	freeRecordSet(recordSet);
+	return NG;
+    }
+    freeRecordSet(recordSet);
+
+    dropTable(SLOTTED_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * test6 -- まばらなテーブル(使用中ビットマップ)
+ */
+Result test6()
+{
+    TableInfo tableInfo;
+    RecordData record;
+    RecordSet *recordSet;
+    RecordData *r;
+    Condition condition;
+    TableStat stat;
+    int numPage;
+    int i;
+
+    /*
+     * 以下のテーブルを作成(1ページに1000個以上のスロットができる)
+     * create table sparse (id integer)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    tableInfo.numField = 1;
+    dropTable(SPARSE_TABLE_NAME);
+    if (createTable(SPARSE_TABLE_NAME, &tableInfo) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 3000件挿入し、idが100の倍数のレコード以外を削除する */
+    record.numField = 1;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    for (i = 0; i < 3000; i++) {
+	record.fieldData[0].intValue = i;
+	if (insertRecord(SPARSE_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    if (getTableStat(SPARSE_TABLE_NAME, &stat) != OK) {
+	fprintf(stderr, "Cannot get table stat.\n");
+	return NG;
+    }
+    numPage = stat.numPage;
+
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.intValue = 0;
+    condition.distinct = NOT_DISTINCT;
+    for (i = 0; i < 3000; i++) {
+	if (i % 100 == 0) {
+	    continue;
+	}
+	condition.operator = OPR_EQUAL;
+	condition.intValue = i;
+	if (deleteRecord(SPARSE_TABLE_NAME, &condition) != OK) {
+	    fprintf(stderr, "Cannot delete records.\n");
+	    return NG;
+	}
+    }
+
+    /* select * from sparse where id > -1 で、残った30件が順に読めるか確認する */
+    condition.operator = OPR_GREATER_THAN;
+    condition.intValue = -1;
+    if ((recordSet = selectRecord(SPARSE_TABLE_NAME, &condition)) == NULL) {
+	fprintf(stderr, "Cannot select records.\n");
+	return NG;
+    }
+    if (recordSet->numRecord != 30) {
+	fprintf(stderr, "selectRecord: expected 30, got %d\n", recordSet->numRecord);
+	freeRecordSet(recordSet);
+	return NG;
+    }
+    for (i = 0, r = recordSet->recordData; r != NULL; i++, r = r->next) {
+	if (r->fieldData[0].intValue != i * 100) {
+	    fprintf(stderr, "Wrong record: expected %d, got %d\n", i * 100, r->fieldData[0].intValue);
+	    freeRecordSet(recordSet);
+	    return NG;
+	}
+    }
+    freeRecordSet(recordSet);
+
+    /* 空いたスロットが再利用され、ページが増えないことを確認する */
+    for (i = 3000; i < 5900; i++) {
+	record.fieldData[0].intValue = i;
+	if (insertRecord(SPARSE_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    if (getTableStat(SPARSE_TABLE_NAME, &stat) != OK
+	|| stat.numPage != numPage || countRecord(SPARSE_TABLE_NAME) != 2930) {
+	fprintf(stderr, "Free slots are not reused: %d pages (expected %d), %d records\n",
+		stat.numPage, numPage, countRecord(SPARSE_TABLE_NAME));
+	return NG;
+    }
+
+    dropTable(SPARSE_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * test7 -- 列ごとの形式(PAX)のテーブル
+ */
+Result test7()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    RecordData record;
+    RecordSet *recordSet;
+    Condition condition;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table paxtable (name string, age integer, address string) layout pax
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "name");
+    tableInfo.fieldInfo[0].dataType = TYPE_STRING;
+    strcpy(tableInfo.fieldInfo[1].name, "age");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "address");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    memset(&option, 0, sizeof(option));
+    option.layout = LAYOUT_PAX;
+    dropTable(PAX_TABLE_NAME);
+    if (createTableWithOption(PAX_TABLE_NAME, &tableInfo, &option) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 2ページ以上になるように300件挿入する */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "name");
+    record.fieldData[0].dataType = TYPE_STRING;
+    strcpy(record.fieldData[1].name, "age");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "address");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < 300; i++) {
+	snprintf(record.fieldData[0].stringValue, MAX_STRING, "name%d", i);
+	record.fieldData[1].intValue = i % 30;
+	snprintf(record.fieldData[2].stringValue, MAX_STRING, "address%d", i);
+	if (insertRecord(PAX_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* delete from paxtable where age < 10 */
+    strcpy(condition.name, "age");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_LESS_THAN;
+    condition.intValue = 10;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(PAX_TABLE_NAME, &condition) != OK) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+
+    /* select * from paxtable where address = 'address225' で、すべてのフィールドが読めるか確認する */
+    strcpy(condition.name, "address");
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_EQUAL;
+    strcpy(condition.stringValue, "address225");
+    if ((recordSet = selectRecord(PAX_TABLE_NAME, &condition)) == NULL) {
+	fprintf(stderr, "Cannot select records.\n");
+	return NG;
+    }
+    printRecordSet(recordSet);
+    if (recordSet->numRecord != 1
+	|| strcmp(recordSet->recordData->fieldData[0].stringValue, "name225") != 0
+	|| recordSet->recordData->fieldData[1].intValue != 225 % 30) {
+	fprintf(stderr, "Wrong record.\n");
+	freeRecordSet(recordSet);
+	return NG;
+    }
+    freeRecordSet(recordSet);
+
+    if (countRecord(PAX_TABLE_NAME) != 200) {
+	fprintf(stderr, "countRecord: expected 200, got %d\n", countRecord(PAX_TABLE_NAME));
+	return NG;
+    }
+
+    dropTable(PAX_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * test8 -- 辞書圧縮するフィールド
+ */
+Result test8()
+{
+    static char *addresses[] = {
+	"Tokyo", "Osaka", "Nagoya", "Sapporo",
+	"Urayasu-shi, Chiba-ken (longer than MAX_STRING)"
+    };
+    TableInfo tableInfo;
+    TableOption option;
+    RecordData record;
+    RecordSet *recordSet;
+    Condition condition;
+    Dictionary *dict;
+    int numEntry;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table dictable (id integer, address string) dictionary (address)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "address");
+    tableInfo.fieldInfo[1].dataType = TYPE_STRING;
+    tableInfo.numField = 2;
+    memset(&option, 0, sizeof(option));
+    option.dictionary[1] = 1;
+    dropTable(DICTIONARY_TABLE_NAME);
+    if (createTableWithOption(DICTIONARY_TABLE_NAME, &tableInfo, &option) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 5種類の住所を持つレコードを500件挿入する */
+    record.numField = 2;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "address");
+    record.fieldData[1].dataType = TYPE_STRING;
+    for (i = 0; i < 500; i++) {
+	record.fieldData[0].intValue = i;
+	strcpy(record.fieldData[1].stringValue, addresses[i % 5]);
+	if (insertRecord(DICTIONARY_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* 辞書には5つの値だけが記録されているはず */
+    if ((dict = openDictionary(DICTIONARY_TABLE_NAME)) == NULL) {
+	fprintf(stderr, "Cannot open dictionary.\n");
+	return NG;
+    }
+    numEntry = dict->numEntry;
+    closeDictionary(dict);
+    if (numEntry != 5) {
+	fprintf(stderr, "Dictionary: expected 5 entries, got %d\n", numEntry);
+	return NG;
+    }
+
+    /* select * from dictable where address = '(長い住所)' */
+    strcpy(condition.name, "address");
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_EQUAL;
+    strcpy(condition.stringValue, addresses[4]);
+    condition.distinct = NOT_DISTINCT;
+    if ((recordSet = selectRecord(DICTIONARY_TABLE_NAME, &condition)) == NULL) {
+	fprintf(stderr, "Cannot select records.\n");
+	return NG;
+    }
+    if (recordSet->numRecord != 100 || recordSet->recordData->fieldData[0].intValue != 4
+	|| strcmp(recordSet->recordData->fieldData[1].stringValue, addresses[4]) != 0) {
+	fprintf(stderr, "Wrong records for '=': %d\n", recordSet->numRecord);
+	freeRecordSet(recordSet);
+	return NG;
+    }
+    freeRecordSet(recordSet);
+
+    /* 辞書にない値との「=」「!=」、コードではなく値で比べる「<」 */
+    strcpy(condition.stringValue, "Kyoto");
+    if ((recordSet = selectRecord(DICTIONARY_TABLE_NAME, &condition)) == NULL) {
+	return NG;
+    }
+    i = recordSet->numRecord;
+    freeRecordSet(recordSet);
+    condition.operator = OPR_NOT_EQUAL;
+    if ((recordSet = selectRecord(DICTIONARY_TABLE_NAME, &condition)) == NULL) {
+	return NG;
+    }
+    if (i != 0 || recordSet->numRecord != 500) {
+	fprintf(stderr, "Wrong records for a missing value: %d, %d\n", i, recordSet->numRecord);
+	freeRecordSet(recordSet);
+	return NG;
+    }
+    freeRecordSet(recordSet);
+    condition.operator = OPR_LESS_THAN;
+    strcpy(condition.stringValue, "P");
+    if ((recordSet = selectRecord(DICTIONARY_TABLE_NAME, &condition)) == NULL) {
+	return NG;
+    }
+    if (recordSet->numRecord != 200) {
+	fprintf(stderr, "Wrong records for '<': %d\n", recordSet->numRecord);
+	freeRecordSet(recordSet);
+	return NG;
+    }
+    freeRecordSet(recordSet);
+
+    /* delete from dictable where address = 'Tokyo' */
+    condition.operator = OPR_EQUAL;
+    strcpy(condition.stringValue, "Tokyo");
+    if (deleteRecord(DICTIONARY_TABLE_NAME, &condition) != OK
+	|| countRecord(DICTIONARY_TABLE_NAME) != 400) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+
+    /*
+     * numFieldを設定していないレコードも、テーブルの定義どおりに挿入できる
+     * (対話的に入力したinsert文と同じ)
+     */
+    memset(&record, 0x7f, sizeof(record));
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    record.fieldData[0].intValue = 500;
+    strcpy(record.fieldData[1].name, "address");
+    record.fieldData[1].dataType = TYPE_STRING;
+    strcpy(record.fieldData[1].stringValue, "Kyoto");
+    if (insertRecord(DICTIONARY_TABLE_NAME, &record) != OK) {
+	fprintf(stderr, "Cannot insert a record without numField.\n");
+	return NG;
+    }
+    strcpy(condition.stringValue, "Kyoto");
+    if ((recordSet = selectRecord(DICTIONARY_TABLE_NAME, &condition)) == NULL) {
+	return NG;
+    }
+    if (recordSet->numRecord != 1 || recordSet->recordData->fieldData[0].intValue != 500) {
+	fprintf(stderr, "Wrong records for a record without numField: %d\n", recordSet->numRecord);
+	freeRecordSet(recordSet);
+	return NG;
+    }
+    freeRecordSet(recordSet);
+
+    dropTable(DICTIONARY_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * countSelected -- 整数の条件で検索したレコード数(検索できなければ-1)
+ */
+int countSelected(char *tableName, char *fieldName, OperatorType operator, int value)
+{
+    RecordSet *recordSet;
+    Condition condition;
+    int numRecord;
+
+    strcpy(condition.name, fieldName);
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = operator;
+    condition.intValue = value;
+    condition.distinct = NOT_DISTINCT;
+    if ((recordSet = selectRecord(tableName, &condition)) == NULL) {
+	return -1;
+    }
+    numRecord = recordSet->numRecord;
+    freeRecordSet(recordSet);
+    return numRecord;
+}
+
+/*
+ * test9 -- ビット詰めする整数型のフィールド
+ */
+Result test9()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    RecordData record;
+    RecordSet *recordSet;
+    Condition condition;
+    int numPage;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table packtable (id integer, age integer, name string) layout pax pack (id 12, age 7)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "age");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "name");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    memset(&option, 0, sizeof(option));
+    option.layout = LAYOUT_PAX;
+    option.packBits[0] = 12;
+    option.packBits[1] = 7;
+    dropTable(PACKED_TABLE_NAME);
+    if (createTableWithOption(PACKED_TABLE_NAME, &tableInfo, &option) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 3000件のレコードを挿入する(ageは0〜99) */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "age");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < 3000; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = i % 100;
+	sprintf(record.fieldData[2].stringValue, "name%d", i);
+	if (insertRecord(PACKED_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    numPage = getNumPages(PACKED_TABLE_NAME ".dat");
+
+    /* 基準値からの差に収まらない値(7ビットを超えるage、負のage)も格納できる */
+    record.fieldData[0].intValue = 3000;
+    record.fieldData[1].intValue = 1000;
+    if (insertRecord(PACKED_TABLE_NAME, &record) != OK) {
+	fprintf(stderr, "Cannot insert record.\n");
+	return NG;
+    }
+    record.fieldData[0].intValue = -5;
+    record.fieldData[1].intValue = -3;
+    if (insertRecord(PACKED_TABLE_NAME, &record) != OK) {
+	fprintf(stderr, "Cannot insert record.\n");
+	return NG;
+    }
+
+    /* 詰めたままの差で判定した結果が正しいか */
+    if (countSelected(PACKED_TABLE_NAME, "age", OPR_EQUAL, 42) != 30
+	|| countSelected(PACKED_TABLE_NAME, "age", OPR_GREATER_THAN, 95) != 121
+	|| countSelected(PACKED_TABLE_NAME, "age", OPR_LESS_THAN, 0) != 1
+	|| countSelected(PACKED_TABLE_NAME, "age", OPR_EQUAL, 1000) != 1
+	|| countSelected(PACKED_TABLE_NAME, "age", OPR_NOT_EQUAL, 42) != 2972
+	|| countSelected(PACKED_TABLE_NAME, "id", OPR_GREATER_THAN, 2990) != 10
+	|| countSelected(PACKED_TABLE_NAME, "id", OPR_LESS_THAN, 1) != 2) {
+	fprintf(stderr, "Wrong records for packed fields.\n");
+	return NG;
+    }
+
+    /* 範囲外の値の2件は、それぞれ新しいページに入ったはず */
+    if (getNumPages(PACKED_TABLE_NAME ".dat") != numPage + 2) {
+	fprintf(stderr, "Wrong number of pages: %d, %d\n", numPage, getNumPages(PACKED_TABLE_NAME ".dat"));
+	return NG;
+    }
+
+    /* delete from packtable where age < 50 */
+    strcpy(condition.name, "age");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_LESS_THAN;
+    condition.intValue = 50;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(PACKED_TABLE_NAME, &condition) != OK
+	|| countRecord(PACKED_TABLE_NAME) != 1501) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+
+    /* select * from packtable where id = 2999 (値を基準値に足して戻せるか) */
+    strcpy(condition.name, "id");
+    condition.operator = OPR_EQUAL;
+    condition.intValue = 2999;
+    if ((recordSet = selectRecord(PACKED_TABLE_NAME, &condition)) == NULL) {
+	fprintf(stderr, "Cannot select records.\n");
+	return NG;
+    }
+    if (recordSet->numRecord != 1 || recordSet->recordData->fieldData[1].intValue != 99
+	|| strcmp(recordSet->recordData->fieldData[2].stringValue, "name2999") != 0) {
+	fprintf(stderr, "Wrong record for id = 2999.\n");
+	freeRecordSet(recordSet);
+	return NG;
+    }
+    freeRecordSet(recordSet);
+
+    dropTable(PACKED_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * test10 -- ゾーンマップによるページの読み飛ばし
+ */
+Result test10()
+{
+    TableInfo tableInfo;
+    RecordData record;
+    Condition condition;
+    QueryStat stat;
+    int numPage;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table zonetable (id integer, name string)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "name");
+    tableInfo.fieldInfo[1].dataType = TYPE_STRING;
+    tableInfo.numField = 2;
+    dropTable(ZONE_TABLE_NAME);
+    if (createTable(ZONE_TABLE_NAME, &tableInfo) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* idの順に3000件挿入する(ページごとのidの範囲が重ならない) */
+    record.numField = 2;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "name");
+    record.fieldData[1].dataType = TYPE_STRING;
+    for (i = 0; i < 3000; i++) {
+	record.fieldData[0].intValue = i;
+	sprintf(record.fieldData[1].stringValue, "name%d", i);
+	if (insertRecord(ZONE_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    numPage = getNumPages(ZONE_TABLE_NAME ".dat");
+
+    /* select * from zonetable where id > 2900 は、最後のページだけを読むはず */
+    if (countSelected(ZONE_TABLE_NAME, "id", OPR_GREATER_THAN, 2900) != 99) {
+	fprintf(stderr, "Wrong records for id > 2900.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPage != numPage || stat.numPageRead != 1 || stat.numPageSkipped != numPage - 1) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read, %d skipped\n",
+		stat.numPage, stat.numPageRead, stat.numPageSkipped);
+	return NG;
+    }
+
+    /* 範囲の外の値との比較では、どのページも読まない */
+    if (countSelected(ZONE_TABLE_NAME, "id", OPR_LESS_THAN, 0) != 0
+	|| countSelected(ZONE_TABLE_NAME, "id", OPR_EQUAL, 5000) != 0) {
+	fprintf(stderr, "Wrong records for out-of-range values.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead != 0) {
+	fprintf(stderr, "Pages read for an out-of-range value: %d\n", stat.numPageRead);
+	return NG;
+    }
+
+    /* delete from zonetable where id < 1500 で空になったページは、次から読まない */
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_LESS_THAN;
+    condition.intValue = 1500;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(ZONE_TABLE_NAME, &condition) != OK) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+    if (countSelected(ZONE_TABLE_NAME, "id", OPR_NOT_EQUAL, -1) != 1500) {
+	fprintf(stderr, "Wrong records after delete.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageSkipped == 0) {
+	fprintf(stderr, "Empty pages are not skipped.\n");
+	return NG;
+    }
+
+    /* 空になったページに挿入した値も見つかる(範囲が広がる) */
+    record.fieldData[0].intValue = 10;
+    if (insertRecord(ZONE_TABLE_NAME, &record) != OK
+	|| countSelected(ZONE_TABLE_NAME, "id", OPR_EQUAL, 10) != 1) {
+	fprintf(stderr, "Cannot find a record inserted after delete.\n");
+	return NG;
+    }
+
+    /*
+     * numFieldを設定していないレコード(対話的に入力したinsert文と同じ)の値でも
+     * 範囲が広がり、範囲の検索で見つかる
+     */
+    record.numField = 0;
+    record.fieldData[0].intValue = 20000;
+    if (insertRecord(ZONE_TABLE_NAME, &record) != OK
+	|| countSelected(ZONE_TABLE_NAME, "id", OPR_GREATER_THAN, 10000) != 1
+	|| countSelected(ZONE_TABLE_NAME, "id", OPR_GREATER_THAN, 0) != 1502) {
+	fprintf(stderr, "Cannot find a record inserted without numField.\n");
+	return NG;
+    }
+
+    dropTable(ZONE_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * countSelectedString -- 文字列の等号の条件で検索したレコード数(検索できなければ-1)
+ */
+int countSelectedString(char *tableName, char *fieldName, char *value)
+{
+    RecordSet *recordSet;
+    Condition condition;
+    int numRecord;
+
+    strcpy(condition.name, fieldName);
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_EQUAL;
+    strcpy(condition.stringValue, value);
+    condition.distinct = NOT_DISTINCT;
+    if ((recordSet = selectRecord(tableName, &condition)) == NULL) {
+	return -1;
+    }
+    numRecord = recordSet->numRecord;
+    freeRecordSet(recordSet);
+    return numRecord;
+}
+
+/*
+ * test11 -- 文字列型のフィールドのブルームフィルタ
+ */
+Result test11()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    RecordData record;
+    Condition condition;
+    QueryStat stat;
+    int numPage;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table bloomtable (id string, age integer) layout slotted bloom (id)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_STRING;
+    strcpy(tableInfo.fieldInfo[1].name, "age");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    tableInfo.numField = 2;
+    memset(&option, 0, sizeof(option));
+    option.layout = LAYOUT_SLOTTED;
+    option.bloom[0] = 1;
+    dropTable(BLOOM_TABLE_NAME);
+    if (createTableWithOption(BLOOM_TABLE_NAME, &tableInfo, &option) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 3000件挿入する */
+    record.numField = 2;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_STRING;
+    strcpy(record.fieldData[1].name, "age");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    for (i = 0; i < 3000; i++) {
+	sprintf(record.fieldData[0].stringValue, "i%05d", i);
+	record.fieldData[1].intValue = i % 100;
+	if (insertRecord(BLOOM_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    numPage = getNumPages(BLOOM_TABLE_NAME ".dat");
+
+    /* select * from bloomtable where id = 'i01234' は、ほぼ値のあるページだけを読むはず */
+    if (countSelectedString(BLOOM_TABLE_NAME, "id", "i01234") != 1) {
+	fprintf(stderr, "Wrong records for id = 'i01234'.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPage != numPage || stat.numPageRead > 2) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read, %d skipped\n",
+		stat.numPage, stat.numPageRead, stat.numPageSkipped);
+	return NG;
+    }
+
+    /* ない値は見つからない */
+    if (countSelectedString(BLOOM_TABLE_NAME, "id", "x") != 0) {
+	fprintf(stderr, "Wrong records for a missing value.\n");
+	return NG;
+    }
+
+    /* ブルームフィルタファイルがなくても正しく検索でき、次の挿入で作り直される */
+    deleteBloomFilter(BLOOM_TABLE_NAME);
+    if (countSelectedString(BLOOM_TABLE_NAME, "id", "i02999") != 1) {
+	fprintf(stderr, "Wrong records without a bloom filter.\n");
+	return NG;
+    }
+    strcpy(record.fieldData[0].stringValue, "i03000");
+    if (insertRecord(BLOOM_TABLE_NAME, &record) != OK
+	|| countSelectedString(BLOOM_TABLE_NAME, "id", "i00042") != 1) {
+	fprintf(stderr, "Cannot rebuild the bloom filter.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead > 2) {
+	fprintf(stderr, "Rebuilt bloom filter is not used: %d read\n", stat.numPageRead);
+	return NG;
+    }
+
+    /* delete from bloomtable where id = 'i00005' の後は見つからず、挿入し直せば見つかる */
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_EQUAL;
+    strcpy(condition.stringValue, "i00005");
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(BLOOM_TABLE_NAME, &condition) != OK
+	|| countSelectedString(BLOOM_TABLE_NAME, "id", "i00005") != 0) {
+	fprintf(stderr, "Cannot delete a record.\n");
+	return NG;
+    }
+    strcpy(record.fieldData[0].stringValue, "i00005");
+    if (insertRecord(BLOOM_TABLE_NAME, &record) != OK
+	|| countSelectedString(BLOOM_TABLE_NAME, "id", "i00005") != 1) {
+	fprintf(stderr, "Cannot find a record inserted after delete.\n");
+	return NG;
+    }
+
+    /* numFieldを設定していないレコードの値も、フィルタに加わり見つかる */
+    record.numField = 0;
+    strcpy(record.fieldData[0].stringValue, "i09999");
+    if (insertRecord(BLOOM_TABLE_NAME, &record) != OK
+	|| countSelectedString(BLOOM_TABLE_NAME, "id", "i09999") != 1) {
+	fprintf(stderr, "Cannot find a record inserted without numField.\n");
+	return NG;
+    }
+
+    dropTable(BLOOM_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * test12 -- 索引を使った検索と削除
+ */
+Result test12()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    RecordData record;
+    Condition condition;
+    QueryStat stat;
+    Index *index;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table idxtable (id integer, name string) layout slotted
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "name");
+    tableInfo.fieldInfo[1].dataType = TYPE_STRING;
+    tableInfo.numField = 2;
+    memset(&option, 0, sizeof(option));
+    option.layout = LAYOUT_SLOTTED;
+    dropTable(INDEX_TABLE_NAME);
+    if (createTableWithOption(INDEX_TABLE_NAME, &tableInfo, &option) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 2000件挿入してから索引を作り、さらに1000件挿入する(nameは3件ずつ同じ値) */
+    record.numField = 2;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "name");
+    record.fieldData[1].dataType = TYPE_STRING;
+    for (i = 0; i < 3000; i++) {
+	if (i == 2000
+	    && (createIndex("idx_id", INDEX_TABLE_NAME, "id") != OK
+		|| createIndex("idx_name", INDEX_TABLE_NAME, "name") != OK)) {
+	    fprintf(stderr, "Cannot create index.\n");
+	    return NG;
+	}
+	record.fieldData[0].intValue = i;
+	sprintf(record.fieldData[1].stringValue, "n%04d", i % 1000);
+	if (insertRecord(INDEX_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* 同じ名前の索引や、索引のあるフィールドへの索引は作れない */
+    if (createIndex("idx_id", INDEX_TABLE_NAME, "name") == OK
+	|| createIndex("idx_id2", INDEX_TABLE_NAME, "id") == OK) {
+	fprintf(stderr, "Duplicate index is created.\n");
+	return NG;
+    }
+
+    /* select * from idxtable where id = 2345 は1ページだけを読むはず */
+    if (countSelected(INDEX_TABLE_NAME, "id", OPR_EQUAL, 2345) != 1) {
+	fprintf(stderr, "Wrong records for id = 2345.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead != 1 || stat.numPageSkipped != stat.numPage - 1) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read, %d skipped\n",
+		stat.numPage, stat.numPageRead, stat.numPageSkipped);
+	return NG;
+    }
+
+    /* 範囲の条件、同じ値が複数ある文字列の条件 */
+    if (countSelected(INDEX_TABLE_NAME, "id", OPR_LESS_THAN, 10) != 10
+	|| countSelected(INDEX_TABLE_NAME, "id", OPR_GREATER_THAN, 1500) != 1499
+	|| countSelected(INDEX_TABLE_NAME, "id", OPR_NOT_EQUAL, 0) != 2999
+	|| countSelectedString(INDEX_TABLE_NAME, "name", "n0042") != 3
+	|| countSelectedString(INDEX_TABLE_NAME, "name", "x") != 0) {
+	fprintf(stderr, "Wrong records with index.\n");
+	return NG;
+    }
+
+    /* delete from idxtable where id < 100 の後は、削除したレコードが索引からも消える */
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_LESS_THAN;
+    condition.intValue = 100;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(INDEX_TABLE_NAME, &condition) != OK
+	|| countSelected(INDEX_TABLE_NAME, "id", OPR_LESS_THAN, 100) != 0
+	|| countSelectedString(INDEX_TABLE_NAME, "name", "n0042") != 2
+	|| countRecord(INDEX_TABLE_NAME) != 2900) {
+	fprintf(stderr, "Cannot delete records with index.\n");
+	return NG;
+    }
+
+    /* 削除で空いたスロットに挿入し直したレコードも見つかる */
+    record.fieldData[0].intValue = 42;
+    strcpy(record.fieldData[1].stringValue, "n0042");
+    if (insertRecord(INDEX_TABLE_NAME, &record) != OK
+	|| countSelected(INDEX_TABLE_NAME, "id", OPR_EQUAL, 42) != 1
+	|| countSelectedString(INDEX_TABLE_NAME, "name", "n0042") != 3) {
+	fprintf(stderr, "Cannot find a record inserted after delete.\n");
+	return NG;
+    }
+
+    /* 索引を削除しても、同じ結果になる */
+    if (dropIndex("idx_name") != OK || (index = openIndex("idx_name")) != NULL
+	|| countSelectedString(INDEX_TABLE_NAME, "name", "n0042") != 3) {
+	fprintf(stderr, "Cannot drop index.\n");
+	return NG;
+    }
+
+    /* テーブルを削除すると索引ファイルも削除される */
+    dropTable(INDEX_TABLE_NAME);
+    if ((index = openIndex("idx_id")) != NULL) {
+	fprintf(stderr, "Index file is left after drop table.\n");
+	closeIndex(index);
+	return NG;
+    }
+    return OK;
+}
+
+/*
+ * test13 -- ハッシュ索引を使った検索と削除
+ */
+Result test13()
+{
+    TableInfo tableInfo;
+    RecordData record;
+    Condition condition;
+    QueryStat stat;
+    Index *index;
+    char value[MAX_STRING];
+    int i;
+
+    /*
+     * 以下のテーブルを作成し、索引を作る
+     * create table hashtable (id integer, name string)
+     * create index idx_hash on hashtable (name) using hash
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "name");
+    tableInfo.fieldInfo[1].dataType = TYPE_STRING;
+    tableInfo.numField = 2;
+    dropTable(HASH_TABLE_NAME);
+    if (createTable(HASH_TABLE_NAME, &tableInfo) != OK
+	|| createIndexWithType("idx_hash", HASH_TABLE_NAME, "name", INDEX_HASH) != OK) {
+	fprintf(stderr, "Cannot create table and index.\n");
+	return NG;
+    }
+
+    /* 5000件挿入する(バケットの分割が何度も起きる、nameは2件ずつ同じ値) */
+    record.numField = 2;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "name");
+    record.fieldData[1].dataType = TYPE_STRING;
+    for (i = 0; i < 5000; i++) {
+	record.fieldData[0].intValue = i;
+	sprintf(record.fieldData[1].stringValue, "n%04d", i % 2500);
+	if (insertRecord(HASH_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    if ((index = openIndex("idx_hash")) == NULL || index->type != INDEX_HASH
+	|| index->numEntry != 5000 || index->numBucket < 2) {
+	fprintf(stderr, "Wrong hash index.\n");
+	return NG;
+    }
+    closeIndex(index);
+
+    /* どの値も、値のあるページだけを読んで見つかる */
+    for (i = 0; i < 2500; i += 97) {
+	sprintf(value, "n%04d", i);
+	if (countSelectedString(HASH_TABLE_NAME, "name", value) != 2) {
+	    fprintf(stderr, "Wrong records for name = '%s'.\n", value);
+	    return NG;
+	}
+	getQueryStat(&stat);
+	if (stat.numPageRead > 2 || stat.numPageSkipped != stat.numPage - stat.numPageRead) {
+	    fprintf(stderr, "Wrong query stat: %d pages, %d read, %d skipped\n",
+		    stat.numPage, stat.numPageRead, stat.numPageSkipped);
+	    return NG;
+	}
+    }
+    if (countSelectedString(HASH_TABLE_NAME, "name", "x") != 0) {
+	fprintf(stderr, "Wrong records for a missing value.\n");
+	return NG;
+    }
+
+    /* =以外の条件には使えないが、テーブルを走査して正しく検索できる */
+    strcpy(condition.name, "name");
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_LESS_THAN;
+    strcpy(condition.stringValue, "n0010");
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(HASH_TABLE_NAME, &condition) != OK
+	|| countSelectedString(HASH_TABLE_NAME, "name", "n0005") != 0
+	|| countSelectedString(HASH_TABLE_NAME, "name", "n0010") != 2
+	|| countRecord(HASH_TABLE_NAME) != 4980) {
+	fprintf(stderr, "Cannot delete records with hash index.\n");
+	return NG;
+    }
+
+    /* delete from hashtable where name = 'n0042' も索引を使い、索引からも消える */
+    condition.operator = OPR_EQUAL;
+    strcpy(condition.stringValue, "n0042");
+    if (deleteRecord(HASH_TABLE_NAME, &condition) != OK
+	|| countSelectedString(HASH_TABLE_NAME, "name", "n0042") != 0
+	|| (index = openIndex("idx_hash")) == NULL || index->numEntry != 4978) {
+	fprintf(stderr, "Cannot delete records by hash index.\n");
+	return NG;
+    }
+    closeIndex(index);
+
+    dropTable(HASH_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * test14 -- ビットマップ索引を使った検索と削除
+ */
+Result test14()
+{
+    TableInfo tableInfo;
+    RecordData record;
+    RecordSet *recordSet;
+    Condition condition;
+    QueryStat stat;
+    Index *index;
+    int i;
+
+    /*
+     * 以下のテーブルを作成し、索引を作る
+     * create table bitmaptable (id integer, status integer, region string)
+     * create index idx_status on bitmaptable (status) using bitmap
+     * create index idx_region on bitmaptable (region) using bitmap
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "status");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "region");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    dropTable(BITMAP_TABLE_NAME);
+    if (createTable(BITMAP_TABLE_NAME, &tableInfo) != OK
+	|| createIndexWithType("idx_status", BITMAP_TABLE_NAME, "status", INDEX_BITMAP) != OK
+	|| createIndexWithType("idx_region", BITMAP_TABLE_NAME, "region", INDEX_BITMAP) != OK) {
+	fprintf(stderr, "Cannot create table and index.\n");
+	return NG;
+    }
+
+    /*
+     * 5000件挿入する(statusは0と1が交互で、配列のコンテナがビットマップに変わる。
+     * regionは1000件に1件だけ'rare'で、残りは4種類)
+     */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "status");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "region");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < 5000; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = i % 2;
+	if (i % 1000 == 7) {
+	    strcpy(record.fieldData[2].stringValue, "rare");
+	} else {
+	    sprintf(record.fieldData[2].stringValue, "r%d", i % 4);
+	}
+	if (insertRecord(BITMAP_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    if ((index = openIndex("idx_status")) == NULL || index->type != INDEX_BITMAP) {
+	fprintf(stderr, "Wrong bitmap index.\n");
+	return NG;
+    }
+    closeIndex(index);
+
+    /* =、!=、<、>のどの条件にも使える */
+    if (countSelected(BITMAP_TABLE_NAME, "status", OPR_EQUAL, 0) != 2500
+	|| countSelected(BITMAP_TABLE_NAME, "status", OPR_NOT_EQUAL, 0) != 2500
+	|| countSelected(BITMAP_TABLE_NAME, "status", OPR_GREATER_THAN, 0) != 2500
+	|| countSelected(BITMAP_TABLE_NAME, "status", OPR_LESS_THAN, 1) != 2500
+	|| countSelected(BITMAP_TABLE_NAME, "status", OPR_EQUAL, 5) != 0) {
+	fprintf(stderr, "Wrong records with bitmap index.\n");
+	return NG;
+    }
+
+    /* select * from bitmaptable where region = 'rare' は値のある5ページだけを読む */
+    if (countSelectedString(BITMAP_TABLE_NAME, "region", "rare") != 5) {
+	fprintf(stderr, "Wrong records for region = 'rare'.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead != 5 || stat.numPageSkipped != stat.numPage - 5) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read, %d skipped\n",
+		stat.numPage, stat.numPageRead, stat.numPageSkipped);
+	return NG;
+    }
+
+    /* select * from bitmaptable where region != 'r0' */
+    strcpy(condition.name, "region");
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_NOT_EQUAL;
+    strcpy(condition.stringValue, "r0");
+    condition.distinct = NOT_DISTINCT;
+    if ((recordSet = selectRecord(BITMAP_TABLE_NAME, &condition)) == NULL) {
+	fprintf(stderr, "Cannot select records.\n");
+	return NG;
+    }
+    if (recordSet->numRecord != 3750) {
+	fprintf(stderr, "Wrong records for region != 'r0': %d\n", recordSet->numRecord);
+	freeRecordSet(recordSet);
+	return NG;
+    }
+    freeRecordSet(recordSet);
+
+    /* delete from bitmaptable where id < 4000 の後は、ビットマップが配列に戻っても正しく検索できる */
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_LESS_THAN;
+    condition.intValue = 4000;
+    if (deleteRecord(BITMAP_TABLE_NAME, &condition) != OK
+	|| countSelected(BITMAP_TABLE_NAME, "status", OPR_EQUAL, 0) != 500
+	|| countSelected(BITMAP_TABLE_NAME, "status", OPR_NOT_EQUAL, 0) != 500
+	|| countSelectedString(BITMAP_TABLE_NAME, "region", "rare") != 1) {
+	fprintf(stderr, "Cannot delete records with bitmap index.\n");
+	return NG;
+    }
+
+    /* 削除で空いたスロットに挿入した新しい値のレコードも見つかる */
+    for (i = 0; i < 100; i++) {
+	record.fieldData[0].intValue = 10000 + i;
+	record.fieldData[1].intValue = 2;
+	strcpy(record.fieldData[2].stringValue, "new");
+	if (insertRecord(BITMAP_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    if (countSelected(BITMAP_TABLE_NAME, "status", OPR_EQUAL, 2) != 100
+	|| countSelected(BITMAP_TABLE_NAME, "status", OPR_GREATER_THAN, 0) != 600
+	|| countSelectedString(BITMAP_TABLE_NAME, "region", "new") != 100) {
+	fprintf(stderr, "Cannot find records inserted after delete.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead != 1) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read\n", stat.numPage, stat.numPageRead);
+	return NG;
+    }
+
+    dropTable(BITMAP_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * countSelectedLike -- likeの条件で検索したレコード数(検索できなければ-1)
+ */
+int countSelectedLike(char *tableName, char *fieldName, char *pattern)
+{
+    RecordSet *recordSet;
+    Condition condition;
+    int numRecord;
+
+    strcpy(condition.name, fieldName);
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_LIKE;
+    strcpy(condition.stringValue, pattern);
+    condition.distinct = NOT_DISTINCT;
+    if ((recordSet = selectRecord(tableName, &condition)) == NULL) {
+	return -1;
+    }
+    numRecord = recordSet->numRecord;
+    freeRecordSet(recordSet);
+    return numRecord;
+}
+
+/*
+ * test15 -- likeの条件とトライグラム索引
+ */
+Result test15()
+{
+    TableInfo tableInfo;
+    RecordData record;
+    Condition condition;
+    QueryStat stat;
+    int i;
+
+    /* パターンの照合 */
+    if (!matchLike("abc", "a%c") || !matchLike("abc", "_b_") || matchLike("abc", "%d%")
+	|| !matchLike("", "%") || matchLike("ab", "abc") || !matchLike("aXbXc", "a%b%c")
+	|| !matchLike("abcabd", "%abd") || matchLike("abc", "ab") || !matchLike("abc", "abc%%")) {
+	fprintf(stderr, "Wrong result of matchLike.\n");
+	return NG;
+    }
+
+    /*
+     * 以下のテーブルを作成
+     * create table liketable (id integer, name string)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "name");
+    tableInfo.fieldInfo[1].dataType = TYPE_STRING;
+    tableInfo.numField = 2;
+    dropTable(LIKE_TABLE_NAME);
+    if (createTable(LIKE_TABLE_NAME, &tableInfo) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 3000件挿入する(nameは'user0001'の形で、100件に1件だけ'admin0100'の形) */
+    record.numField = 2;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "name");
+    record.fieldData[1].dataType = TYPE_STRING;
+    for (i = 0; i < 3000; i++) {
+	record.fieldData[0].intValue = i;
+	sprintf(record.fieldData[1].stringValue, i % 100 == 0 ? "admin%04d" : "user%04d", i);
+	if (insertRecord(LIKE_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* 索引がなくても、索引があっても同じ結果になる */
+    for (i = 0; i < 2; i++) {
+	if (i == 1 && createIndexWithType("idx_like", LIKE_TABLE_NAME, "name", INDEX_TRIGRAM) != OK) {
+	    fprintf(stderr, "Cannot create trigram index.\n");
+	    return NG;
+	}
+	if (countSelectedLike(LIKE_TABLE_NAME, "name", "%004%") != 13
+	    || countSelectedLike(LIKE_TABLE_NAME, "name", "%admin%") != 30
+	    || countSelectedLike(LIKE_TABLE_NAME, "name", "user1%") != 990
+	    || countSelectedLike(LIKE_TABLE_NAME, "name", "%_9_9") != 30
+	    || countSelectedLike(LIKE_TABLE_NAME, "name", "u%r2%5") != 100
+	    || countSelectedLike(LIKE_TABLE_NAME, "name", "%00%") != 147
+	    || countSelectedLike(LIKE_TABLE_NAME, "name", "%xyz%") != 0) {
+	    fprintf(stderr, "Wrong records for like (index %d).\n", i);
+	    return NG;
+	}
+    }
+
+    /* 索引があれば、like '%admin02%' は候補の1ページだけを読む */
+    if (countSelectedLike(LIKE_TABLE_NAME, "name", "%admin02%") != 1) {
+	fprintf(stderr, "Wrong records for like '%%admin02%%'.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead != 1 || stat.numPageSkipped != stat.numPage - 1) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read, %d skipped\n",
+		stat.numPage, stat.numPageRead, stat.numPageSkipped);
+	return NG;
+    }
+
+    /* 整数のフィールドへのトライグラム索引は作れない */
+    if (createIndexWithType("idx_like_id", LIKE_TABLE_NAME, "id", INDEX_TRIGRAM) == OK) {
+	fprintf(stderr, "Trigram index on integer field is created.\n");
+	return NG;
+    }
+
+    /* delete from liketable where name like 'admin%' の後は、索引からも消える */
+    strcpy(condition.name, "name");
+    condition.dataType = TYPE_STRING;
+    condition.operator = OPR_LIKE;
+    strcpy(condition.stringValue, "admin%");
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(LIKE_TABLE_NAME, &condition) != OK
+	|| countSelectedLike(LIKE_TABLE_NAME, "name", "%admin%") != 0
+	|| countRecord(LIKE_TABLE_NAME) != 2970) {
+	fprintf(stderr, "Cannot delete records with like.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead != 0) {
+	fprintf(stderr, "Deleted records are left in trigram index.\n");
+	return NG;
+    }
+
+    dropTable(LIKE_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * CRACK_VALUE -- test16でi番目に挿入するレコードのvalの値
+ *
+ * 挿入の順と値の順が一致するとゾーンマップで読み飛ばせてしまうので、値をばらばらにする
+ * (0から4999までの値が1回ずつ現れる)。
+ */
+#define CRACK_VALUE(i) ((i) * 37 % 5000)
+
+/*
+ * test16 -- クラッキング(適応型索引)
+ */
+Result test16()
+{
+    TableInfo tableInfo;
+    TableInfo *info;
+    TableOption option;
+    RecordData record;
+    Condition condition;
+    QueryStat stat;
+    int expected;
+    int i, k;
+
+    /*
+     * 以下のテーブルを作成
+     * create table cracktable (id integer, val integer, name string) crack (val)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "val");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "name");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    memset(&option, 0, sizeof(option));
+    option.crack[1] = 1;
+    option.crack[2] = 1;
+    dropTable(CRACK_TABLE_NAME);
+    if (createTableWithOption(CRACK_TABLE_NAME, &tableInfo, &option) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* crackは整数型のフィールドにだけ付く */
+    if ((info = getTableInfo(CRACK_TABLE_NAME)) == NULL) {
+	fprintf(stderr, "Cannot get table info.\n");
+	return NG;
+    }
+    if (!IS_CRACK_FIELD(info, 1) || IS_CRACK_FIELD(info, 2)) {
+	fprintf(stderr, "Wrong crack option.\n");
+	freeTableInfo(info);
+	return NG;
+    }
+    freeTableInfo(info);
+
+    /* 5000件挿入する */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < 5000; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = CRACK_VALUE(i);
+	sprintf(record.fieldData[2].stringValue, "n%d", i);
+	if (insertRecord(CRACK_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* select * from cracktable where val < 10 は、値のある10ページまでしか読まない */
+    if (countSelected(CRACK_TABLE_NAME, "val", OPR_LESS_THAN, 10) != 10) {
+	fprintf(stderr, "Wrong records for val < 10.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead > 10 || stat.numPageRead + stat.numPageSkipped != stat.numPage) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read, %d skipped\n",
+		stat.numPage, stat.numPageRead, stat.numPageSkipped);
+	return NG;
+    }
+
+    /* 範囲を変えながら検索しても、結果はテーブル全体を読むのと同じ */
+    for (k = 0; k <= 5000; k += 250) {
+	if (countSelected(CRACK_TABLE_NAME, "val", OPR_LESS_THAN, k) != k
+	    || countSelected(CRACK_TABLE_NAME, "val", OPR_GREATER_THAN, k) != (k < 5000 ? 4999 - k : 0)
+	    || countSelected(CRACK_TABLE_NAME, "val", OPR_EQUAL, k) != (k < 5000 ? 1 : 0)) {
+	    fprintf(stderr, "Wrong records for val around %d.\n", k);
+	    return NG;
+	}
+    }
+    if (countSelected(CRACK_TABLE_NAME, "val", OPR_EQUAL, 1234) != 1) {
+	fprintf(stderr, "Wrong records for val = 1234.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead != 1) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read\n", stat.numPage, stat.numPageRead);
+	return NG;
+    }
+    if (countSelected(CRACK_TABLE_NAME, "val", OPR_NOT_EQUAL, 1234) != 4999
+	|| countSelected(CRACK_TABLE_NAME, "val", OPR_GREATER_THAN, 2147483647) != 0) {
+	fprintf(stderr, "Wrong records for val != 1234.\n");
+	return NG;
+    }
+
+    /* 挿入したレコードはクラッカー列にも加わる */
+    for (i = 5000; i < 5100; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = i;
+	sprintf(record.fieldData[2].stringValue, "n%d", i);
+	if (insertRecord(CRACK_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    if (countSelected(CRACK_TABLE_NAME, "val", OPR_GREATER_THAN, 4989) != 110
+	|| countSelected(CRACK_TABLE_NAME, "val", OPR_LESS_THAN, 10) != 10
+	|| countSelected(CRACK_TABLE_NAME, "val", OPR_EQUAL, 5050) != 1) {
+	fprintf(stderr, "Cannot find inserted records.\n");
+	return NG;
+    }
+
+    /* delete from cracktable where id < 1000 の後も、クラッカー列は正しい */
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_LESS_THAN;
+    condition.intValue = 1000;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(CRACK_TABLE_NAME, &condition) != OK) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+    for (k = 0; k <= 5100; k += 300) {
+	expected = 0;
+	for (i = 1000; i < 5100; i++) {
+	    if ((i < 5000 ? CRACK_VALUE(i) : i) < k) {
+		expected++;
+	    }
+	}
+	if (countSelected(CRACK_TABLE_NAME, "val", OPR_LESS_THAN, k) != expected) {
+	    fprintf(stderr, "Wrong records for val < %d after delete.\n", k);
+	    return NG;
+	}
+    }
+
+    /* delete from cracktable where val < 2000 (条件のフィールドでクラッカー列を使って削除する) */
+    strcpy(condition.name, "val");
+    condition.intValue = 2000;
+    if (deleteRecord(CRACK_TABLE_NAME, &condition) != OK
+	|| countSelected(CRACK_TABLE_NAME, "val", OPR_LESS_THAN, 2000) != 0
+	|| countSelected(CRACK_TABLE_NAME, "val", OPR_GREATER_THAN, 1999) != countRecord(CRACK_TABLE_NAME)
+	|| countSelected(CRACK_TABLE_NAME, "val", OPR_EQUAL, 4321) != 1) {
+	fprintf(stderr, "Cannot delete records with cracking.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead != 1) {
+	fprintf(stderr, "Cracker column is not used after delete.\n");
+	return NG;
+    }
+
+    dropTable(CRACK_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * test17 -- クラスタ化テーブル
+ */
+Result test17()
+{
+    TableInfo tableInfo;
+    TableInfo *info;
+    TableOption option;
+    RecordData record;
+    Condition condition;
+    QueryStat stat;
+    char key[MAX_STRING];
+    int numPage;
+    int expected;
+    int i, k;
+
+    /*
+     * 以下のテーブルを作成
+     * create table clustertable (id integer, val integer, name string) clustered by (val)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "val");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "name");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    memset(&option, 0, sizeof(option));
+    option.cluster[1] = 1;
+    dropTable(CLUSTER_TABLE_NAME);
+    if (createTableWithOption(CLUSTER_TABLE_NAME, &tableInfo, &option) != OK
+	|| createIndex("idx_cluster", CLUSTER_TABLE_NAME, "id") != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 値の順とは無関係な順に5000件挿入する(ページの分割が起きる) */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < 5000; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = CRACK_VALUE(i);
+	sprintf(record.fieldData[2].stringValue, "k%05d", CRACK_VALUE(i));
+	if (insertRecord(CLUSTER_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* 結果はテーブル全体を読むのと同じ */
+    for (k = 0; k <= 5000; k += 250) {
+	if (countSelected(CLUSTER_TABLE_NAME, "val", OPR_LESS_THAN, k) != k
+	    || countSelected(CLUSTER_TABLE_NAME, "val", OPR_GREATER_THAN, k) != (k < 5000 ? 4999 - k : 0)
+	    || countSelected(CLUSTER_TABLE_NAME, "val", OPR_EQUAL, k) != (k < 5000 ? 1 : 0)) {
+	    fprintf(stderr, "Wrong records for val around %d.\n", k);
+	    return NG;
+	}
+    }
+
+    /* select * from clustertable where val = 1234 は、フェンスキーで探した1ページしか読まない */
+    if (countSelected(CLUSTER_TABLE_NAME, "val", OPR_EQUAL, 1234) != 1) {
+	fprintf(stderr, "Wrong records for val = 1234.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    numPage = stat.numPage;
+    if (numPage < 10 || stat.numPageRead > 2 || stat.numPageRead + stat.numPageSkipped != numPage) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read, %d skipped\n",
+		stat.numPage, stat.numPageRead, stat.numPageSkipped);
+	return NG;
+    }
+
+    /* val < 500 は、全体の1割ほどのページしか読まない */
+    if (countSelected(CLUSTER_TABLE_NAME, "val", OPR_LESS_THAN, 500) != 500) {
+	fprintf(stderr, "Wrong records for val < 500.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead > numPage / 4) {
+	fprintf(stderr, "Too many pages read: %d of %d\n", stat.numPageRead, numPage);
+	return NG;
+    }
+
+    /* ページの分割で移ったレコードも、索引で見つかる */
+    for (i = 0; i < 5000; i += 97) {
+	if (countSelected(CLUSTER_TABLE_NAME, "id", OPR_EQUAL, i) != 1) {
+	    fprintf(stderr, "Cannot find id = %d with index.\n", i);
+	    return NG;
+	}
+    }
+
+    /* delete from clustertable where id < 1000 の後も、結果は正しい */
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_LESS_THAN;
+    condition.intValue = 1000;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(CLUSTER_TABLE_NAME, &condition) != OK) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+    for (k = 0; k <= 5000; k += 300) {
+	expected = 0;
+	for (i = 1000; i < 5000; i++) {
+	    if (CRACK_VALUE(i) < k) {
+		expected++;
+	    }
+	}
+	if (countSelected(CLUSTER_TABLE_NAME, "val", OPR_LESS_THAN, k) != expected) {
+	    fprintf(stderr, "Wrong records for val < %d after delete.\n", k);
+	    return NG;
+	}
+    }
+
+    /* cluster table clustertable by (name) で、文字列型のフィールドの順に並べ直す */
+    if (clusterTable(CLUSTER_TABLE_NAME, "name") != OK) {
+	fprintf(stderr, "Cannot cluster table.\n");
+	return NG;
+    }
+    if ((info = getTableInfo(CLUSTER_TABLE_NAME)) == NULL) {
+	fprintf(stderr, "Cannot get table info.\n");
+	return NG;
+    }
+    if (IS_CLUSTER_FIELD(info, 1) || !IS_CLUSTER_FIELD(info, 2)) {
+	fprintf(stderr, "Wrong cluster option.\n");
+	freeTableInfo(info);
+	return NG;
+    }
+    freeTableInfo(info);
+    if (countRecord(CLUSTER_TABLE_NAME) != 4000) {
+	fprintf(stderr, "Wrong number of records after cluster table.\n");
+	return NG;
+    }
+    sprintf(key, "k%05d", CRACK_VALUE(4321));
+    if (countSelectedString(CLUSTER_TABLE_NAME, "name", key) != 1) {
+	fprintf(stderr, "Wrong records for name = '%s'.\n", key);
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead > 2 || stat.numPage >= numPage) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read\n", stat.numPage, stat.numPageRead);
+	return NG;
+    }
+
+    /* 並べ直した後も、作り直した索引で見つかる */
+    if (countSelected(CLUSTER_TABLE_NAME, "id", OPR_EQUAL, 4321) != 1
+	|| countSelected(CLUSTER_TABLE_NAME, "id", OPR_EQUAL, 999) != 0) {
+	fprintf(stderr, "Cannot find records with index after cluster table.\n");
+	return NG;
+    }
+
+    /* 並べ直した後に挿入したレコードも、文字列の順の位置に入る */
+    for (i = 0; i < 100; i++) {
+	record.fieldData[0].intValue = 5000 + i;
+	record.fieldData[1].intValue = 5000 + i;
+	sprintf(record.fieldData[2].stringValue, "k%05d", i * 50);
+	if (insertRecord(CLUSTER_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    sprintf(key, "k%05d", 2500);
+    expected = 1;
+    for (i = 1000; i < 5000; i++) {
+	if (CRACK_VALUE(i) == 2500) {
+	    expected++;
+	}
+    }
+    if (countSelectedString(CLUSTER_TABLE_NAME, "name", key) != expected
+	|| countSelected(CLUSTER_TABLE_NAME, "id", OPR_GREATER_THAN, 4999) != 100) {
+	fprintf(stderr, "Cannot find inserted records.\n");
+	return NG;
+    }
+
+    dropTable(CLUSTER_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * LSM_KEY -- test18でi番目に挿入するレコードのキー(0から19999までを1回ずつ、順不同)
+ */
+#define LSM_KEY(i) ((i) * 7919 % 20000)
+
+/*
+ * countLsmExpected -- test18で、キーがfromより小さいレコードとvalがdeletedValのレコードを
+ * 削除した後の、キーの条件に合うレコード数を数える
+ */
+int countLsmExpected(int from, OperatorType operator, int value, int deletedVal)
+{
+    int expected = 0;
+    int i, key;
+
+    for (i = 0; i < 20000; i++) {
+	key = LSM_KEY(i);
+	if (key < from || i % 100 == deletedVal) {
+	    continue;
+	}
+	if ((operator == OPR_EQUAL && key == value) || (operator == OPR_LESS_THAN && key < value)
+	    || (operator == OPR_GREATER_THAN && key > value)) {
+	    expected++;
+	}
+    }
+    return expected;
+}
+
+/*
+ * checkLsmCounts -- test18で、キーの条件の検索結果がテーブル全体を調べたものと一致するか
+ */
+Result checkLsmCounts(int from, int deletedVal, char *label)
+{
+    int k;
+
+    for (k = 0; k <= 20000; k += 1250) {
+	if (countSelected(LSM_TABLE_NAME, "id", OPR_LESS_THAN, k) != countLsmExpected(from, OPR_LESS_THAN, k, deletedVal)
+	    || countSelected(LSM_TABLE_NAME, "id", OPR_GREATER_THAN, k)
+	    != countLsmExpected(from, OPR_GREATER_THAN, k, deletedVal)
+	    || countSelected(LSM_TABLE_NAME, "id", OPR_EQUAL, k) != countLsmExpected(from, OPR_EQUAL, k, deletedVal)) {
+	    fprintf(stderr, "Wrong records for id around %d %s.\n", k, label);
+	    return NG;
+	}
+    }
+    return OK;
+}
+
+/*
+ * test18 -- ログ構造化テーブル
+ */
+Result test18()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    RecordData record;
+    Condition condition;
+    QueryStat stat;
+    int numRecord;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table lsmtable (id integer, val integer, name string) lsm (id)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "val");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "name");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    memset(&option, 0, sizeof(option));
+    option.lsm[0] = 1;
+    dropTable(LSM_TABLE_NAME);
+    if (createTableWithOption(LSM_TABLE_NAME, &tableInfo, &option) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 索引は作れない */
+    if (createIndex("idx_lsm", LSM_TABLE_NAME, "val") == OK) {
+	fprintf(stderr, "Index created on lsm table.\n");
+	return NG;
+    }
+
+    /* キーの順とは無関係な順に20000件挿入する(ランの書き出しと併合が起きる) */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < 20000; i++) {
+	record.fieldData[0].intValue = LSM_KEY(i);
+	record.fieldData[1].intValue = i % 100;
+	sprintf(record.fieldData[2].stringValue, "n%05d", i);
+	if (insertRecord(LSM_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    if (countRecord(LSM_TABLE_NAME) != 20000 || checkLsmCounts(0, -1, "after insert") != OK) {
+	fprintf(stderr, "Wrong records after insert.\n");
+	return NG;
+    }
+
+    /* キー以外のフィールドの条件でも見つかる */
+    if (countSelected(LSM_TABLE_NAME, "val", OPR_EQUAL, 5) != 200
+	|| countSelectedString(LSM_TABLE_NAME, "name", "n12345") != 1) {
+	fprintf(stderr, "Wrong records for val = 5 or name = 'n12345'.\n");
+	return NG;
+    }
+
+    /* select * from lsmtable where id = 12345 は、フェンスキーで探したページしか読まない */
+    if (countSelected(LSM_TABLE_NAME, "id", OPR_EQUAL, 12345) != 1) {
+	fprintf(stderr, "Wrong records for id = 12345.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPage < 20 || stat.numPageRead > 4 || stat.numPageRead + stat.numPageSkipped != stat.numPage) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read, %d skipped\n",
+		stat.numPage, stat.numPageRead, stat.numPageSkipped);
+	return NG;
+    }
+
+    /* delete from lsmtable where id < 1000 と、delete from lsmtable where val = 7 の後も、結果は正しい */
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_LESS_THAN;
+    condition.intValue = 1000;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(LSM_TABLE_NAME, &condition) != OK) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+    strcpy(condition.name, "val");
+    condition.operator = OPR_EQUAL;
+    condition.intValue = 7;
+    if (deleteRecord(LSM_TABLE_NAME, &condition) != OK) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+    numRecord = countLsmExpected(1000, OPR_LESS_THAN, 20000, 7);
+    if (countRecord(LSM_TABLE_NAME) != numRecord || checkLsmCounts(1000, 7, "after delete") != OK
+	|| countSelected(LSM_TABLE_NAME, "val", OPR_EQUAL, 7) != 0) {
+	fprintf(stderr, "Wrong records after delete.\n");
+	return NG;
+    }
+
+    /* 削除したキーで挿入し直すと、新しいレコードだけが見つかる */
+    for (i = 0; i < 100; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = 1000;
+	sprintf(record.fieldData[2].stringValue, "r%05d", i);
+	if (insertRecord(LSM_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    if (countRecord(LSM_TABLE_NAME) != numRecord + 100
+	|| countSelected(LSM_TABLE_NAME, "id", OPR_LESS_THAN, 100) != 100
+	|| countSelected(LSM_TABLE_NAME, "val", OPR_EQUAL, 1000) != 100) {
+	fprintf(stderr, "Wrong records after reinsert.\n");
+	return NG;
+    }
+
+    /* モジュールを終了して初期化し直しても、メムテーブルの内容は残っている */
+    finalizeDataManipModule();
+    initializeDataManipModule();
+    if (countRecord(LSM_TABLE_NAME) != numRecord + 100
+	|| countSelected(LSM_TABLE_NAME, "val", OPR_EQUAL, 1000) != 100
+	|| countSelected(LSM_TABLE_NAME, "id", OPR_GREATER_THAN, 999) != numRecord
+	|| countSelected(LSM_TABLE_NAME, "id", OPR_EQUAL, 12345) != countLsmExpected(1000, OPR_EQUAL, 12345, 7)) {
+	fprintf(stderr, "Wrong records after reopen.\n");
+	return NG;
+    }
+
+    /* すべてのランを併合すると墓標がなくなり、ページが減る */
+    countSelected(LSM_TABLE_NAME, "val", OPR_EQUAL, 1000);
+    getQueryStat(&stat);
+    if (compactLsmTable(LSM_TABLE_NAME) != OK) {
+	fprintf(stderr, "Cannot compact table.\n");
+	return NG;
+    }
+    if (countSelected(LSM_TABLE_NAME, "val", OPR_EQUAL, 1000) != 100) {
+	fprintf(stderr, "Wrong records after compaction.\n");
+	return NG;
+    }
+    i = stat.numPage;
+    getQueryStat(&stat);
+    if (stat.numPage >= i || countRecord(LSM_TABLE_NAME) != numRecord + 100) {
+	fprintf(stderr, "Wrong query stat after compaction: %d pages (%d before)\n", stat.numPage, i);
+	return NG;
+    }
+
+    dropTable(LSM_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * test19 -- 時系列テーブル
+ */
+Result test19()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    RecordData record;
+    Condition condition;
+    QueryStat stat;
+    int numPage;
+    int numRecord;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table seriestable (ts integer, val integer, name string) append (ts)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "ts");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "val");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "name");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    memset(&option, 0, sizeof(option));
+    option.series[0] = 1;
+    dropTable(SERIES_TABLE_NAME);
+    if (createTableWithOption(SERIES_TABLE_NAME, &tableInfo, &option) != OK
+	|| createIndex("idx_series", SERIES_TABLE_NAME, "val") != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 時刻が減らない順に10000件挿入する(同じ時刻のレコードが2件ずつ) */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "ts");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < 10000; i++) {
+	record.fieldData[0].intValue = i / 2;
+	record.fieldData[1].intValue = i;
+	sprintf(record.fieldData[2].stringValue, "s%05d", i);
+	if (insertRecord(SERIES_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* 最後の時刻より前のレコードは挿入できない */
+    record.fieldData[0].intValue = 100;
+    if (insertRecord(SERIES_TABLE_NAME, &record) == OK) {
+	fprintf(stderr, "Inserted record out of order.\n");
+	return NG;
+    }
+
+    /* 結果はテーブル全体を読むのと同じ */
+    for (i = 0; i <= 5000; i += 250) {
+	if (countSelected(SERIES_TABLE_NAME, "ts", OPR_LESS_THAN, i) != i * 2
+	    || countSelected(SERIES_TABLE_NAME, "ts", OPR_GREATER_THAN, i) != (i < 5000 ? 9998 - i * 2 : 0)
+	    || countSelected(SERIES_TABLE_NAME, "ts", OPR_EQUAL, i) != (i < 5000 ? 2 : 0)) {
+	    fprintf(stderr, "Wrong records for ts around %d.\n", i);
+	    return NG;
+	}
+    }
+
+    /* select * from seriestable where ts = 1234 は、最初の時刻の索引で探した1、2ページしか読まない */
+    if (countSelected(SERIES_TABLE_NAME, "ts", OPR_EQUAL, 1234) != 2) {
+	fprintf(stderr, "Wrong records for ts = 1234.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    numPage = stat.numPage;
+    if (numPage < SERIES_EXTENT_PAGES * 3 || stat.numPageRead > 2
+	|| stat.numPageRead + stat.numPageSkipped != numPage) {
+	fprintf(stderr, "Wrong query stat: %d pages, %d read, %d skipped\n",
+		stat.numPage, stat.numPageRead, stat.numPageSkipped);
+	return NG;
+    }
+
+    /* ts > 4500 は、全体の1割ほどのページしか読まない */
+    if (countSelected(SERIES_TABLE_NAME, "ts", OPR_GREATER_THAN, 4500) != 998) {
+	fprintf(stderr, "Wrong records for ts > 4500.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead > numPage / 6) {
+	fprintf(stderr, "Too many pages read: %d of %d\n", stat.numPageRead, numPage);
+	return NG;
+    }
+
+    /* レコードは削除できない */
+    strcpy(condition.name, "val");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_EQUAL;
+    condition.intValue = 10;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(SERIES_TABLE_NAME, &condition) == OK) {
+	fprintf(stderr, "Deleted records from series table.\n");
+	return NG;
+    }
+
+    /*
+     * truncate table seriestable before 4000 で、時刻が4000より前のレコードだけの
+     * 先頭のエクステントを捨てる(捨てたのは先頭から続くレコードで、4000以降のレコードは残る)
+     */
+    if (truncateSeriesTable(SERIES_TABLE_NAME, 4000) != OK) {
+	fprintf(stderr, "Cannot truncate table.\n");
+	return NG;
+    }
+    numRecord = countRecord(SERIES_TABLE_NAME);
+    if (numRecord > 10000 - 2000 - 100 || numRecord < 2000
+	|| countSelected(SERIES_TABLE_NAME, "ts", OPR_GREATER_THAN, 3999) != 2000
+	|| countSelected(SERIES_TABLE_NAME, "ts", OPR_LESS_THAN, 4000) != numRecord - 2000
+	|| countSelected(SERIES_TABLE_NAME, "ts", OPR_LESS_THAN, (10000 - numRecord) / 2) != 0) {
+	fprintf(stderr, "Wrong records after truncate: %d records\n", numRecord);
+	return NG;
+    }
+
+    /* 捨てたページは読まず、捨てたレコードは索引からも取り除かれている */
+    if (countSelectedString(SERIES_TABLE_NAME, "name", "s09000") != 1
+	|| countSelectedString(SERIES_TABLE_NAME, "name", "s00010") != 0) {
+	fprintf(stderr, "Wrong records for name after truncate.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageSkipped < SERIES_EXTENT_PAGES || stat.numPageRead + stat.numPageSkipped != numPage) {
+	fprintf(stderr, "Truncated pages read: %d of %d\n", stat.numPageRead, numPage);
+	return NG;
+    }
+    if (countSelected(SERIES_TABLE_NAME, "val", OPR_EQUAL, 10) != 0
+	|| countSelected(SERIES_TABLE_NAME, "val", OPR_EQUAL, 9000) != 1) {
+	fprintf(stderr, "Wrong records with index after truncate.\n");
+	return NG;
+    }
+
+    /* モジュールを終了して初期化し直しても、続きから挿入できる */
+    finalizeDataManipModule();
+    initializeDataManipModule();
+    record.fieldData[0].intValue = 4800;
+    if (insertRecord(SERIES_TABLE_NAME, &record) == OK) {
+	fprintf(stderr, "Inserted record out of order after reopen.\n");
+	return NG;
+    }
+    for (i = 0; i < 100; i++) {
+	record.fieldData[0].intValue = 6000 + i;
+	record.fieldData[1].intValue = 10000 + i;
+	if (insertRecord(SERIES_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record after reopen.\n");
+	    return NG;
+	}
+    }
+    if (countRecord(SERIES_TABLE_NAME) != numRecord + 100
+	|| countSelected(SERIES_TABLE_NAME, "ts", OPR_GREATER_THAN, 5999) != 100
+	|| countSelected(SERIES_TABLE_NAME, "ts", OPR_LESS_THAN, 4000) != numRecord - 2000
+	|| countSelected(SERIES_TABLE_NAME, "val", OPR_EQUAL, 10050) != 1) {
+	fprintf(stderr, "Wrong records after reopen.\n");
+	return NG;
+    }
+
+    dropTable(SERIES_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * test20 -- インメモリテーブル
+ */
+Result test20()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    TableInfo *memoryInfo;
+    RecordData record;
+    Condition condition;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create memory table memtable (id integer, val integer, name string)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "val");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "name");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    memset(&option, 0, sizeof(option));
+    option.memory = 1;
+    dropTable(MEMORY_TABLE_NAME);
+    if (createTableWithOption(MEMORY_TABLE_NAME, &tableInfo, &option) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 同じ名前のテーブルは作成できない */
+    if (createTable(MEMORY_TABLE_NAME, &tableInfo) == OK
+	|| createTableWithOption(MEMORY_TABLE_NAME, &tableInfo, &option) == OK) {
+	fprintf(stderr, "Created table with the same name.\n");
+	return NG;
+    }
+
+    /* 1000件挿入する */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < 1000; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = i % 10;
+	sprintf(record.fieldData[2].stringValue, "m%04d", i);
+	if (insertRecord(MEMORY_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* ファイルは作られない */
+    if (getNumPages(MEMORY_TABLE_NAME ".def") >= 0 || getNumPages(MEMORY_TABLE_NAME ".dat") >= 0) {
+	fprintf(stderr, "Memory table has files.\n");
+	return NG;
+    }
+    if ((memoryInfo = getTableInfo(MEMORY_TABLE_NAME)) == NULL || !IS_MEMORY_TABLE(memoryInfo)
+	|| memoryInfo->numField != 3) {
+	fprintf(stderr, "Wrong table info.\n");
+	return NG;
+    }
+    freeTableInfo(memoryInfo);
+
+    /* 検索の結果はファイルに置くテーブルと同じ */
+    if (countRecord(MEMORY_TABLE_NAME) != 1000
+	|| countSelected(MEMORY_TABLE_NAME, "id", OPR_LESS_THAN, 100) != 100
+	|| countSelected(MEMORY_TABLE_NAME, "id", OPR_GREATER_THAN, 899) != 100
+	|| countSelected(MEMORY_TABLE_NAME, "val", OPR_EQUAL, 3) != 100
+	|| countSelected(MEMORY_TABLE_NAME, "val", OPR_NOT_EQUAL, 3) != 900
+	|| countSelectedString(MEMORY_TABLE_NAME, "name", "m0123") != 1) {
+	fprintf(stderr, "Wrong records.\n");
+	return NG;
+    }
+
+    /* delete from memtable where val = 3 (削除した後も、残りのレコードは正しく検索できる) */
+    strcpy(condition.name, "val");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_EQUAL;
+    condition.intValue = 3;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(MEMORY_TABLE_NAME, &condition) != OK) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+    if (countRecord(MEMORY_TABLE_NAME) != 900
+	|| countSelected(MEMORY_TABLE_NAME, "val", OPR_EQUAL, 3) != 0
+	|| countSelected(MEMORY_TABLE_NAME, "id", OPR_LESS_THAN, 100) != 90
+	|| countSelectedString(MEMORY_TABLE_NAME, "name", "m0999") != 1
+	|| countSelectedString(MEMORY_TABLE_NAME, "name", "m0123") != 0) {
+	fprintf(stderr, "Wrong records after delete.\n");
+	return NG;
+    }
+
+    /* 索引は作成できない */
+    if (createIndex("idx_memory", MEMORY_TABLE_NAME, "id") == OK) {
+	fprintf(stderr, "Created index on memory table.\n");
+	return NG;
+    }
+
+    /* モジュールを終了すると、インメモリテーブルはなくなる */
+    finalizeDataManipModule();
+    initializeDataManipModule();
+    if ((memoryInfo = getTableInfo(MEMORY_TABLE_NAME)) != NULL) {
+	fprintf(stderr, "Memory table survived finalize.\n");
+	freeTableInfo(memoryInfo);
+	return NG;
+    }
+    return OK;
+}
+
+/*
+ * test21 -- 一時テーブル
+ */
+Result test21()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    TableInfo *tempInfo;
+    RecordData record;
+    Condition condition;
+    BufferPartitionStat partStat;
+    struct stat fileStat;
+    char dirName[MAX_FILENAME];
+    char fileName[MAX_FILENAME];
+    char partition[MAX_PARTITION_NAME];
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create temp table temptable (id integer, val integer, name string)
+     */
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "val");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "name");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    memset(&option, 0, sizeof(option));
+    option.temp = 1;
+    if (createTableWithOption(TEMP_TABLE_NAME, &tableInfo, &option) != OK
+	|| createIndex("idx_temp", TEMP_TABLE_NAME, "val") != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 同じ名前のテーブルは作成できない */
+    memset(&option, 0, sizeof(option));
+    if (createTableWithOption(TEMP_TABLE_NAME, &tableInfo, &option) == OK) {
+	fprintf(stderr, "Created table with the same name.\n");
+	return NG;
+    }
+
+    /* 2000件挿入する */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < 2000; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = i % 20;
+	sprintf(record.fieldData[2].stringValue, "t%04d", i);
+	if (insertRecord(TEMP_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* ファイルは一時ディレクトリにだけ作られる */
+    snprintf(dirName, MAX_FILENAME, "temp.%d", (int) getpid());
+    snprintf(fileName, MAX_FILENAME, "temp.%d/%s.dat", (int) getpid(), TEMP_TABLE_NAME);
+    if (getNumPages(TEMP_TABLE_NAME ".def") >= 0 || getNumPages(TEMP_TABLE_NAME ".dat") >= 0
+	|| getNumPages(fileName) < 1) {
+	fprintf(stderr, "Wrong temp files.\n");
+	return NG;
+    }
+
+    /* 検索の結果はふつうのテーブルと同じ */
+    if (countRecord(TEMP_TABLE_NAME) != 2000
+	|| countSelected(TEMP_TABLE_NAME, "id", OPR_LESS_THAN, 100) != 100
+	|| countSelected(TEMP_TABLE_NAME, "val", OPR_EQUAL, 7) != 100
+	|| countSelectedString(TEMP_TABLE_NAME, "name", "t1234") != 1) {
+	fprintf(stderr, "Wrong records.\n");
+	return NG;
+    }
+    strcpy(condition.name, "val");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_EQUAL;
+    condition.intValue = 7;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(TEMP_TABLE_NAME, &condition) != OK
+	|| countRecord(TEMP_TABLE_NAME) != 1900
+	|| countSelected(TEMP_TABLE_NAME, "val", OPR_EQUAL, 7) != 0) {
+	fprintf(stderr, "Wrong records after delete.\n");
+	return NG;
+    }
+
+    /* データファイルのページは、一時テーブル専用のパーティションに置かれる */
+    if ((tempInfo = getTableInfo(TEMP_TABLE_NAME)) == NULL) {
+	fprintf(stderr, "Cannot get table info.\n");
+	return NG;
+    }
+    strcpy(partition, tempInfo->option.partition);
+    freeTableInfo(tempInfo);
+    if (getBufferPartitionStat(partition, &partStat) != OK
+	|| partStat.numFrames > partStat.maxFrames || partStat.maxFrames >= NUM_BUFFER
+	|| partStat.misses == 0) {
+	fprintf(stderr, "Wrong temp partition: %s\n", partition);
+	return NG;
+    }
+
+    /* モジュールを終了すると、一時テーブルは一時ディレクトリやパーティションごとなくなる */
+    finalizeDataManipModule();
+    initializeDataManipModule();
+    if ((tempInfo = getTableInfo(TEMP_TABLE_NAME)) != NULL) {
+	fprintf(stderr, "Temp table survived finalize.\n");
+	freeTableInfo(tempInfo);
+	return NG;
+    }
+    if (stat(dirName, &fileStat) == 0 || getBufferPartitionStat(partition, &partStat) == OK) {
+	fprintf(stderr, "Temp directory or partition survived finalize.\n");
+	return NG;
+    }
+    return OK;
+}
+
+/*
+ * test22 -- 削除で空いた領域の回収(vacuum)
+ */
+Result test22()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    RecordData record;
+    Condition condition;
+    int numPage;
+    int result;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table vacuumtable (id integer, val integer, name string) bloom (name) crack (id)
+     * create index idx_vacuum on vacuumtable (id)
+     */
+    dropTable(VACUUM_TABLE_NAME);
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "val");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "name");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    memset(&option, 0, sizeof(option));
+    option.bloom[2] = 1;
+    option.crack[0] = 1;
+    if (createTableWithOption(VACUUM_TABLE_NAME, &tableInfo, &option) != OK
+	|| createIndex("idx_vacuum", VACUUM_TABLE_NAME, "id") != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 2000件挿入し、valが0から2のもの(4件のうち3件)を削除する */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < 2000; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = i % 4;
+	sprintf(record.fieldData[2].stringValue, "v%04d", i);
+	if (insertRecord(VACUUM_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    /* 検索してクラッカー列を作っておく */
+    if (countSelected(VACUUM_TABLE_NAME, "id", OPR_LESS_THAN, 1000) != 1000) {
+	fprintf(stderr, "Wrong records before delete.\n");
+	return NG;
+    }
+    strcpy(condition.name, "val");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_LESS_THAN;
+    condition.intValue = 3;
+    condition.distinct = NOT_DISTINCT;
+    if (deleteRecord(VACUUM_TABLE_NAME, &condition) != OK
+	|| countRecord(VACUUM_TABLE_NAME) != 500) {
+	fprintf(stderr, "Cannot delete records.\n");
+	return NG;
+    }
+    numPage = getNumPages(VACUUM_TABLE_NAME ".dat");
+
+    /* 少しずつ回収する場合は、調べるページ数の上限で返る */
+    if (vacuumTable(VACUUM_TABLE_NAME, 1) != 1
+	|| getNumPages(VACUUM_TABLE_NAME ".dat") != numPage - 1
+	|| countRecord(VACUUM_TABLE_NAME) != 500
+	|| countSelected(VACUUM_TABLE_NAME, "id", OPR_EQUAL, 1999) != 1) {
+	fprintf(stderr, "Wrong step vacuum.\n");
+	return NG;
+    }
+
+    /* 最後まで回収すると、残ったレコードが入るだけのページ数になる */
+    while ((result = vacuumTable(VACUUM_TABLE_NAME, 1)) == 1) {
+	;
+    }
+    if (result != 0 || getNumPages(VACUUM_TABLE_NAME ".dat") > numPage / 4 + 1
+	|| vacuumTable(VACUUM_TABLE_NAME, 0) != 0) {
+	fprintf(stderr, "Wrong vacuum: %d pages -> %d pages\n",
+		numPage, getNumPages(VACUUM_TABLE_NAME ".dat"));
+	return NG;
+    }
+
+    /* 索引、クラッキング、ブルームフィルタを使う検索の結果も変わらない */
+    if (countRecord(VACUUM_TABLE_NAME) != 500
+	|| countSelected(VACUUM_TABLE_NAME, "id", OPR_EQUAL, 1999) != 1
+	|| countSelected(VACUUM_TABLE_NAME, "id", OPR_EQUAL, 1998) != 0
+	|| countSelected(VACUUM_TABLE_NAME, "id", OPR_LESS_THAN, 1000) != 250
+	|| countSelected(VACUUM_TABLE_NAME, "val", OPR_EQUAL, 3) != 500
+	|| countSelectedString(VACUUM_TABLE_NAME, "name", "v1999") != 1
+	|| countSelectedString(VACUUM_TABLE_NAME, "name", "v0003") != 1) {
+	fprintf(stderr, "Wrong records after vacuum.\n");
+	return NG;
+    }
+
+    /* 回収した後も挿入と削除ができる */
+    for (i = 2000; i < 2400; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = i % 4;
+	sprintf(record.fieldData[2].stringValue, "v%04d", i);
+	if (insertRecord(VACUUM_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record after vacuum.\n");
+	    return NG;
+	}
+    }
+    strcpy(condition.name, "id");
+    condition.operator = OPR_EQUAL;
+    condition.intValue = 2399;
+    if (countRecord(VACUUM_TABLE_NAME) != 900
+	|| countSelected(VACUUM_TABLE_NAME, "id", OPR_EQUAL, 2399) != 1
+	|| countSelectedString(VACUUM_TABLE_NAME, "name", "v2399") != 1
+	|| deleteRecord(VACUUM_TABLE_NAME, &condition) != OK
+	|| countSelected(VACUUM_TABLE_NAME, "id", OPR_GREATER_THAN, 1990) != 402) {
+	fprintf(stderr, "Wrong records after insert.\n");
+	return NG;
+    }
+
+    dropTable(VACUUM_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * test23 -- レコードの位置による取り出しと削除
+ */
+Result test23()
+{
+    TableInfo tableInfo;
+    TableOption option;
+    RecordData record;
+    RecordData fetched;
+    RecordSet *recordSet;
+    Condition condition;
+    QueryStat stat;
+    RecordId rid;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table ridtable (id integer, name string) dictionary (name)
+     * create index idx_rid on ridtable (id)
+     */
+    dropTable(RID_TABLE_NAME);
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "name");
+    tableInfo.fieldInfo[1].dataType = TYPE_STRING;
+    tableInfo.numField = 2;
+    memset(&option, 0, sizeof(option));
+    option.dictionary[1] = 1;
+    if (createTableWithOption(RID_TABLE_NAME, &tableInfo, &option) != OK
+	|| createIndex("idx_rid", RID_TABLE_NAME, "id") != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    /* 1000件挿入する */
+    record.numField = 2;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "name");
+    record.fieldData[1].dataType = TYPE_STRING;
+    for (i = 0; i < 1000; i++) {
+	record.fieldData[0].intValue = i;
+	sprintf(record.fieldData[1].stringValue, "r%d", i % 10);
+	if (insertRecord(RID_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+
+    /* 検索の結果のレコードは位置を持つ */
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_EQUAL;
+    condition.intValue = 765;
+    condition.distinct = NOT_DISTINCT;
+    if ((recordSet = selectRecord(RID_TABLE_NAME, &condition)) == NULL || recordSet->numRecord != 1) {
+	fprintf(stderr, "Cannot select record.\n");
+	return NG;
+    }
+    rid = recordSet->recordData->rid;
+    freeRecordSet(recordSet);
+
+    /* 位置を指定すると、そのページだけを読んで取り出せる */
+    if (fetchRecord(RID_TABLE_NAME, &rid, &fetched) != OK) {
+	fprintf(stderr, "Cannot fetch record.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (fetched.numField != 2 || fetched.fieldData[0].intValue != 765
+	|| strcmp(fetched.fieldData[1].stringValue, "r5") != 0
+	|| fetched.rid.pageNum != rid.pageNum || fetched.rid.slot != rid.slot
+	|| stat.numPageRead != 1) {
+	fprintf(stderr, "Wrong fetched record.\n");
+	return NG;
+    }
+
+    /* 位置を指定して削除すると、索引からも取り除かれる */
+    if (deleteRecordByRid(RID_TABLE_NAME, &rid) != OK) {
+	fprintf(stderr, "Cannot delete record by rid.\n");
+	return NG;
+    }
+    getQueryStat(&stat);
+    if (stat.numPageRead != 1 || countRecord(RID_TABLE_NAME) != 999
+	|| countSelected(RID_TABLE_NAME, "id", OPR_EQUAL, 765) != 0
+	|| countSelected(RID_TABLE_NAME, "id", OPR_EQUAL, 764) != 1) {
+	fprintf(stderr, "Wrong records after delete by rid.\n");
+	return NG;
+    }
+
+    /* 削除した位置や範囲外の位置は取り出せず、削除もできない */
+    if (fetchRecord(RID_TABLE_NAME, &rid, &fetched) == OK
+	|| deleteRecordByRid(RID_TABLE_NAME, &rid) == OK) {
+	fprintf(stderr, "Fetched deleted record.\n");
+	return NG;
+    }
+    rid.pageNum = getNumPages(RID_TABLE_NAME ".dat");
+    rid.slot = 0;
+    if (fetchRecord(RID_TABLE_NAME, &rid, &fetched) == OK
+	|| deleteRecordByRid(RID_TABLE_NAME, &rid) == OK) {
+	fprintf(stderr, "Fetched record out of range.\n");
+	return NG;
+    }
+
+    dropTable(RID_TABLE_NAME);
+    return OK;
+}
+
+/*
+ * createUpdateTable -- test24で使うテーブル(id integer, val integer, name string)の作成と、
+ * numRow件のレコード(id, id % 10, 'u' + id)の挿入
+ */
+Result createUpdateTable(TableOption *option, int numRow)
+{
+    TableInfo tableInfo;
+    RecordData record;
+    int i;
+
+    dropTable(UPDATE_TABLE_NAME);
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "val");
+    tableInfo.fieldInfo[1].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[2].name, "name");
+    tableInfo.fieldInfo[2].dataType = TYPE_STRING;
+    tableInfo.numField = 3;
+    if (createTableWithOption(UPDATE_TABLE_NAME, &tableInfo, option) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    for (i = 0; i < numRow; i++) {
+	record.fieldData[0].intValue = i;
+	record.fieldData[1].intValue = i % 10;
+	sprintf(record.fieldData[2].stringValue, "u%d", i);
+	if (insertRecord(UPDATE_TABLE_NAME, &record) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    return OK;
+}
+
+/*
+ * updateWhere -- fieldName op valueの条件に合うレコードの1つのフィールドの書き換え
+ */
+Result updateWhere(char *fieldName, OperatorType op, int value, char *setName, int setInt, char *setString)
+{
+    RecordData assignments;
+    Condition condition;
+
+    strcpy(condition.name, fieldName);
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = op;
+    condition.intValue = value;
+    condition.distinct = NOT_DISTINCT;
+    assignments.numField = 1;
+    strcpy(assignments.fieldData[0].name, setName);
+    if (setString == NULL) {
+	assignments.fieldData[0].dataType = TYPE_INTEGER;
+	assignments.fieldData[0].intValue = setInt;
+    } else {
+	assignments.fieldData[0].dataType = TYPE_STRING;
+	strcpy(assignments.fieldData[0].stringValue, setString);
+    }
+    return updateRecord(UPDATE_TABLE_NAME, &assignments, &condition);
+}
+
+/*
+ * test24 -- レコードの更新
+ */
+Result test24()
+{
+    TableOption option;
+    RecordSet *recordSet;
+    RecordData record;
+    Condition condition;
+    RecordId rid;
+    char longName[MAX_VARSTRING];
+
+    /* 索引とクラッキングのあるテーブルでは、レコードはその場所のまま書き換わる */
+    memset(&option, 0, sizeof(option));
+    option.crack[0] = 1;
+    if (createUpdateTable(&option, 1000) != OK
+	|| createIndex("idx_update", UPDATE_TABLE_NAME, "val") != OK) {
+	return NG;
+    }
+    strcpy(condition.name, "id");
+    condition.dataType = TYPE_INTEGER;
+    condition.operator = OPR_EQUAL;
+    condition.intValue = 123;
+    condition.distinct = NOT_DISTINCT;
+    if (countSelected(UPDATE_TABLE_NAME, "id", OPR_LESS_THAN, 500) != 500
+	|| (recordSet = selectRecord(UPDATE_TABLE_NAME, &condition)) == NULL || recordSet->numRecord != 1) {
+	fprintf(stderr, "Cannot select record.\n");
+	return NG;
+    }
+    rid = recordSet->recordData->rid;
+    freeRecordSet(recordSet);
+    if (updateWhere("val", OPR_EQUAL, 3, "val", 42, NULL) != OK
+	|| updateWhere("id", OPR_LESS_THAN, 200, "id", 5000, NULL) != OK) {
+	fprintf(stderr, "Cannot update records.\n");
+	return NG;
+    }
+    condition.intValue = 5000;
+    condition.operator = OPR_EQUAL;
+    if (countRecord(UPDATE_TABLE_NAME) != 1000
+	|| countSelected(UPDATE_TABLE_NAME, "val", OPR_EQUAL, 3) != 0
+	|| countSelected(UPDATE_TABLE_NAME, "val", OPR_EQUAL, 42) != 100
+	|| countSelected(UPDATE_TABLE_NAME, "id", OPR_LESS_THAN, 500) != 300
+	|| countSelected(UPDATE_TABLE_NAME, "id", OPR_EQUAL, 5000) != 200
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", "u123") != 1
+	|| (recordSet = selectRecord(UPDATE_TABLE_NAME, &condition)) == NULL) {
+	fprintf(stderr, "Wrong records after update.\n");
+	return NG;
+    }
+    freeRecordSet(recordSet);
+
+    /* id 123はval 3なので、両方とも書き換わっている(位置は変わらない) */
+    if (fetchRecord(UPDATE_TABLE_NAME, &rid, &record) != OK
+	|| record.fieldData[0].intValue != 5000 || record.fieldData[1].intValue != 42) {
+	fprintf(stderr, "Record moved by update.\n");
+	return NG;
+    }
+
+    /* 固定長形式では、MAX_STRINGバイトを超える文字列には書き換えられない */
+    memset(longName, 'x', MAX_VARSTRING - 1);
+    longName[MAX_VARSTRING - 1] = '\0';
+    if (updateWhere("val", OPR_EQUAL, 5, "name", 0, longName) == OK
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", "u5") != 1) {
+	fprintf(stderr, "Updated with too long string.\n");
+	return NG;
+    }
+
+    /*
+     * スロット形式では、MAX_STRINGバイトを超える文字列にも書き換えられ、
+     * 長くなって収まらないレコードは挿入し直される
+     */
+    memset(&option, 0, sizeof(option));
+    option.layout = LAYOUT_SLOTTED;
+    if (createUpdateTable(&option, 1000) != OK) {
+	return NG;
+    }
+    longName[MAX_STRING * 3] = '\0';
+    if (updateWhere("val", OPR_LESS_THAN, 5, "name", 0, longName) != OK
+	|| countRecord(UPDATE_TABLE_NAME) != 1000
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", longName) != 500
+	|| countSelected(UPDATE_TABLE_NAME, "id", OPR_LESS_THAN, 1000) != 1000) {
+	fprintf(stderr, "Wrong records after growing update.\n");
+	return NG;
+    }
+
+    /* 辞書圧縮するフィールドは、新しい値を辞書に加えて書き換える */
+    memset(&option, 0, sizeof(option));
+    option.dictionary[2] = 1;
+    if (createUpdateTable(&option, 300) != OK
+	|| updateWhere("val", OPR_EQUAL, 7, "name", 0, "seven") != OK
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", "seven") != 30
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", "u7") != 0
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", "u8") != 1
+	|| updateWhere("val", OPR_EQUAL, 8, "name", 0, longName) != OK
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", longName) != 30) {
+	fprintf(stderr, "Wrong dictionary records after update.\n");
+	return NG;
+    }
+
+    /* 時系列テーブルでは、時刻は書き換えられないが、ほかのフィールドは書き換えられる */
+    memset(&option, 0, sizeof(option));
+    option.series[0] = 1;
+    if (createUpdateTable(&option, 500) != OK
+	|| updateWhere("val", OPR_EQUAL, 1, "id", 9999, NULL) == OK
+	|| updateWhere("id", OPR_GREATER_THAN, 490, "val", 77, NULL) != OK
+	|| countSelected(UPDATE_TABLE_NAME, "val", OPR_EQUAL, 77) != 9) {
+	fprintf(stderr, "Wrong series records after update.\n");
+	return NG;
+    }
+
+    /* 末尾ページに挿入しても、書き換えた値は残る */
+    record.numField = 3;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    record.fieldData[0].intValue = 500;
+    strcpy(record.fieldData[1].name, "val");
+    record.fieldData[1].dataType = TYPE_INTEGER;
+    record.fieldData[1].intValue = 77;
+    strcpy(record.fieldData[2].name, "name");
+    record.fieldData[2].dataType = TYPE_STRING;
+    strcpy(record.fieldData[2].stringValue, "u500");
+    if (insertRecord(UPDATE_TABLE_NAME, &record) != OK
+	|| countSelected(UPDATE_TABLE_NAME, "val", OPR_EQUAL, 77) != 10) {
+	fprintf(stderr, "Lost series update after insert.\n");
+	return NG;
+    }
+
+    /* ログ構造化テーブルでは、キーも書き換えられる */
+    memset(&option, 0, sizeof(option));
+    option.lsm[0] = 1;
+    if (createUpdateTable(&option, 500) != OK
+	|| updateWhere("id", OPR_LESS_THAN, 100, "id", -1, NULL) != OK
+	|| updateWhere("val", OPR_EQUAL, 2, "name", 0, "two") != OK
+	|| countRecord(UPDATE_TABLE_NAME) != 500
+	|| countSelected(UPDATE_TABLE_NAME, "id", OPR_EQUAL, -1) != 100
+	|| countSelected(UPDATE_TABLE_NAME, "id", OPR_LESS_THAN, 100) != 100
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", "two") != 50) {
+	fprintf(stderr, "Wrong lsm records after update.\n");
+	return NG;
+    }
+
+    /* インメモリテーブルでは、配列の値を書き換える */
+    memset(&option, 0, sizeof(option));
+    option.memory = 1;
+    if (createUpdateTable(&option, 500) != OK
+	|| updateWhere("val", OPR_EQUAL, 4, "name", 0, "four") != OK
+	|| countRecord(UPDATE_TABLE_NAME) != 500
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", "four") != 50
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", "u4") != 0
+	|| updateWhere("val", OPR_EQUAL, 6, "name", 0, longName) != OK
+	|| countSelectedString(UPDATE_TABLE_NAME, "name", longName) != 50) {
+	fprintf(stderr, "Wrong memory records after update.\n");
+	return NG;
+    }
+
+    /* ないフィールドやデータ型の違う値には書き換えられない */
+    if (updateWhere("val", OPR_EQUAL, 4, "nosuch", 1, NULL) == OK
+	|| updateWhere("val", OPR_EQUAL, 4, "name", 1, NULL) == OK) {
+	fprintf(stderr, "Updated with wrong assignment.\n");
+	return NG;
+    }
+
+    dropTable(UPDATE_TABLE_NAME);
+    return OK;
+}
+
 /*
  * main -- データ操作モジュールのテスト
  */
@@ -324,6 +3103,172 @@ int main(int argc, char **argv)
 	fprintf(stderr, "test3: NG\n\n");
     }
 
+    /* レコード数のテスト */
+    fprintf(stderr, "test4: Start\n\n");
+    if (test4() == OK) {
+	fprintf(stderr, "test4: OK\n\n");
+    } else {
+	fprintf(stderr, "test4: NG\n\n");
+    }
+
+    /* スロット形式のテスト */
+    fprintf(stderr, "test5: Start\n\n");
+    if (test5() == OK) {
+	fprintf(stderr, "test5: OK\n\n");
+    } else {
+	fprintf(stderr, "test5: NG\n\n");
+    }
+
+    /* まばらなテーブルのテスト */
+    fprintf(stderr, "test6: Start\n\n");
+    if (test6() == OK) {
+	fprintf(stderr, "test6: OK\n\n");
+    } else {
+	fprintf(stderr, "test6: NG\n\n");
+    }
+
+    /* 列ごとの形式のテスト */
+    fprintf(stderr, "test7: Start\n\n");
+    if (test7() == OK) {
+	fprintf(stderr, "test7: OK\n\n");
+    } else {
+	fprintf(stderr, "test7: NG\n\n");
+    }
+
+    /* 辞書圧縮のテスト */
+    fprintf(stderr, "test8: Start\n\n");
+    if (test8() == OK) {
+	fprintf(stderr, "test8: OK\n\n");
+    } else {
+	fprintf(stderr, "test8: NG\n\n");
+    }
+
+    fprintf(stderr, "test9: Start\n\n");
+    if (test9() == OK) {
+	fprintf(stderr, "test9: OK\n\n");
+    } else {
+	fprintf(stderr, "test9: NG\n\n");
+    }
+
+    fprintf(stderr, "test10: Start\n\n");
+    if (test10() == OK) {
+	fprintf(stderr, "test10: OK\n\n");
+    } else {
+	fprintf(stderr, "test10: NG\n\n");
+    }
+
+    /* ブルームフィルタのテスト */
+    fprintf(stderr, "test11: Start\n\n");
+    if (test11() == OK) {
+	fprintf(stderr, "test11: OK\n\n");
+    } else {
+	fprintf(stderr, "test11: NG\n\n");
+    }
+
+    /* 索引のテスト */
+    fprintf(stderr, "test12: Start\n\n");
+    if (test12() == OK) {
+	fprintf(stderr, "test12: OK\n\n");
+    } else {
+	fprintf(stderr, "test12: NG\n\n");
+    }
+
+    /* ハッシュ索引のテスト */
+    fprintf(stderr, "test13: Start\n\n");
+    if (test13() == OK) {
+	fprintf(stderr, "test13: OK\n\n");
+    } else {
+	fprintf(stderr, "test13: NG\n\n");
+    }
+
+    /* ビットマップ索引のテスト */
+    fprintf(stderr, "test14: Start\n\n");
+    if (test14() == OK) {
+	fprintf(stderr, "test14: OK\n\n");
+    } else {
+	fprintf(stderr, "test14: NG\n\n");
+    }
+
+    /* likeの条件とトライグラム索引のテスト */
+    fprintf(stderr, "test15: Start\n\n");
+    if (test15() == OK) {
+	fprintf(stderr, "test15: OK\n\n");
+    } else {
+	fprintf(stderr, "test15: NG\n\n");
+    }
+
+    /* クラッキングのテスト */
+    fprintf(stderr, "test16: Start\n\n");
+    if (test16() == OK) {
+	fprintf(stderr, "test16: OK\n\n");
+    } else {
+	fprintf(stderr, "test16: NG\n\n");
+    }
+
+    /* クラスタ化テーブルのテスト */
+    fprintf(stderr, "test17: Start\n\n");
+    if (test17() == OK) {
+	fprintf(stderr, "test17: OK\n\n");
+    } else {
+	fprintf(stderr, "test17: NG\n\n");
+    }
+
+    /* ログ構造化テーブルのテスト */
+    fprintf(stderr, "test18: Start\n\n");
+    if (test18() == OK) {
+	fprintf(stderr, "test18: OK\n\n");
+    } else {
+	fprintf(stderr, "test18: NG\n\n");
+    }
+
+    /* 時系列テーブルのテスト */
+    fprintf(stderr, "test19: Start\n\n");
+    if (test19() == OK) {
+	fprintf(stderr, "test19: OK\n\n");
+    } else {
+	fprintf(stderr, "test19: NG\n\n");
+    }
+
+    /* インメモリテーブルのテスト */
+    fprintf(stderr, "test20: Start\n\n");
+    if (test20() == OK) {
+	fprintf(stderr, "test20: OK\n\n");
+    } else {
+	fprintf(stderr, "test20: NG\n\n");
+    }
+
+    /* 一時テーブルのテスト */
+    fprintf(stderr, "test21: Start\n\n");
+    if (test21() == OK) {
+	fprintf(stderr, "test21: OK\n\n");
+    } else {
+	fprintf(stderr, "test21: NG\n\n");
+    }
+
+    /* 領域の回収のテスト */
+    fprintf(stderr, "test22: Start\n\n");
+    if (test22() == OK) {
+	fprintf(stderr, "test22: OK\n\n");
+    } else {
+	fprintf(stderr, "test22: NG\n\n");
+    }
+
+    /* レコードの位置のテスト */
+    fprintf(stderr, "test23: Start\n\n");
+    if (test23() == OK) {
+	fprintf(stderr, "test23: OK\n\n");
+    } else {
+	fprintf(stderr, "test23: NG\n\n");
+    }
+
+    /* 更新のテスト */
+    fprintf(stderr, "test24: Start\n\n");
+    if (test24() == OK) {
+	fprintf(stderr, "test24: OK\n\n");
+    } else {
+	fprintf(stderr, "test24: NG\n\n");
+    }
+
     /* 後始末 */
     dropTable(TABLE_NAME);
     finalizeDataManipModule();
@@ -6,6 +6,8 @@
 #include <string.h>
 #include <time.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "microdb.h"
 
 /*
@@ -19,6 +21,12 @@
 #define TEST_FILE1 "testfile1"
 #define TEST_FILE2 "testfile2"
 
+/*
+ * 一時ファイルのテストに使うディレクトリとファイル
+ */
+#define TEST_TEMP_DIR "testtemp"
+#define TEST_TEMP_FILE TEST_TEMP_DIR "/testfile3"
+
 /*
  * ファイルサイズ(ファイルに書き込むページ数)
  */
@@ -211,6 +219,50 @@ Result test4()
     return OK;
 }
 
+/*
+ * test5 -- 一時ファイル
+ *
+ * 一時ディレクトリのファイルは、クローズしても変更されたページを書き戻さない。
+ */
+Result test5()
+{
+    File *file;
+    struct stat statBuffer;
+    char page[PAGE_SIZE];
+
+    mkdir(TEST_TEMP_DIR, 0700);
+    if (setTemporaryDirectory(TEST_TEMP_DIR) != OK || createFile(TEST_TEMP_FILE) != OK
+	|| (file = openFile(TEST_TEMP_FILE)) == NULL) {
+	fprintf(stderr, "Cannot create temporary file.\n");
+	return NG;
+    }
+    if (writePage(file, 0, pagePattern[0]) != OK || closeFile(file) != OK) {
+	fprintf(stderr, "Cannot write temporary file.\n");
+	return NG;
+    }
+
+    /* ファイルには書かれていないが、バッファからは読める */
+    if (stat(TEST_TEMP_FILE, &statBuffer) != 0 || statBuffer.st_size != 0
+	|| getNumPages(TEST_TEMP_FILE) != 1) {
+	fprintf(stderr, "Temporary page was written back.\n");
+	return NG;
+    }
+    if ((file = openFile(TEST_TEMP_FILE)) == NULL || readPage(file, 0, page) != OK
+	|| memcmp(page, pagePattern[0], PAGE_SIZE) != 0 || closeFile(file) != OK) {
+	fprintf(stderr, "Cannot read temporary page.\n");
+	return NG;
+    }
+
+    /* 削除すれば、ページは書かれずに捨てられる */
+    if (deleteFile(TEST_TEMP_FILE) != OK || rmdir(TEST_TEMP_DIR) != 0
+	|| setTemporaryDirectory(NULL) != OK) {
+	fprintf(stderr, "Cannot delete temporary file.\n");
+	return NG;
+    }
+
+    return OK;
+}
+
 /*
  * main -- エントリポイント
  */
@@ -276,6 +328,13 @@ int main(int argc, char **argv)
 	fprintf(stderr, "%s: test 4: NG\n\n", TEST_NAME);
     }
 
+    fprintf(stderr, "%s: test 5: Start\n", TEST_NAME);
+    if (test5() == OK) {
+	fprintf(stderr, "%s: test 5: OK\n\n", TEST_NAME);
+    } else {
+	fprintf(stderr, "%s: test 5: NG\n\n", TEST_NAME);
+    }
+
     /*
      * ファイルアクセスモジュールの終了処理
      */
@@ -0,0 +1,232 @@
+/*
+ * 空き領域マップテストプログラム
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microdb.h"
+
+/*
+ * テスト名
+ */
+#define TEST_NAME "test-freespace"
+
+/*
+ * テスト用テーブルのテーブル名
+ */
+#define TABLE_NAME "fsmtable"
+
+/*
+ * テスト用テーブルに挿入するレコードの件数
+ */
+#define NUM_RECORD 2000
+
+/*
+ * changeRecord -- idのレコード(id, 'f' + id)の挿入(insertが0なら削除)
+ */
+Result changeRecord(int id, int insert)
+{
+    RecordData record;
+    Condition condition;
+
+    if (!insert) {
+	strcpy(condition.name, "id");
+	condition.dataType = TYPE_INTEGER;
+	condition.operator = OPR_EQUAL;
+	condition.intValue = id;
+	condition.distinct = NOT_DISTINCT;
+	return deleteRecord(TABLE_NAME, &condition);
+    }
+    record.numField = 2;
+    strcpy(record.fieldData[0].name, "id");
+    record.fieldData[0].dataType = TYPE_INTEGER;
+    record.fieldData[0].intValue = id;
+    strcpy(record.fieldData[1].name, "name");
+    record.fieldData[1].dataType = TYPE_STRING;
+    sprintf(record.fieldData[1].stringValue, "f%d", id);
+    return insertRecord(TABLE_NAME, &record);
+}
+
+/*
+ * getFirstFreePage -- 空き領域マップから見た、最初の空きのあるページの番号
+ */
+int getFirstFreePage()
+{
+    FreeSpaceMap *fsm;
+    int pageNum;
+
+    if ((fsm = openFreeSpaceMap(TABLE_NAME)) == NULL) {
+	return -1;
+    }
+    pageNum = findFreePage(fsm, 1);
+    closeFreeSpaceMap(fsm);
+    return pageNum;
+}
+
+/*
+ * checkFsmPages -- 空き領域マップが、numPageページを記録しているか
+ */
+Result checkFsmPages(int numPage)
+{
+    FreeSpaceMap *fsm;
+    int fsmPages;
+
+    if ((fsm = openFreeSpaceMap(TABLE_NAME)) == NULL) {
+	return NG;
+    }
+    fsmPages = fsm->numPage;
+    closeFreeSpaceMap(fsm);
+    return fsmPages == numPage ? OK : NG;
+}
+
+/*
+ * refillPage -- 1件削除して空いたページへの挿入
+ *
+ * idのレコードを削除してできた空きに、newIdのレコードが入るかを確かめる。
+ * 挿入の前にrebuildが呼ばれ、空き領域マップを壊す。
+ * 空き領域マップが正しく作り直されれば、データファイルのページ数は変わらず、
+ * 空いたページは挿入で埋まる。
+ */
+Result refillPage(int id, int newId, int numPage, void (*rebuild)())
+{
+    int pageNum;
+
+    if (changeRecord(id, 0) != OK || (pageNum = getFirstFreePage()) < 0) {
+	fprintf(stderr, "Cannot delete record.\n");
+	return NG;
+    }
+
+    rebuild();
+    if (changeRecord(newId, 1) != OK) {
+	fprintf(stderr, "Cannot insert record.\n");
+	return NG;
+    }
+
+    if (getNumPages(TABLE_NAME ".dat") != numPage || checkFsmPages(numPage) != OK
+	|| getFirstFreePage() == pageNum) {
+	fprintf(stderr, "page %d was not refilled.\n", pageNum);
+	return NG;
+    }
+    return OK;
+}
+
+/*
+ * keepFreeSpaceMap -- 空き領域マップをそのまま使う
+ */
+void keepFreeSpaceMap()
+{
+}
+
+/*
+ * removeFreeSpaceMap -- 空き領域マップの削除
+ */
+void removeFreeSpaceMap()
+{
+    deleteFreeSpaceMap(TABLE_NAME);
+}
+
+/*
+ * shrinkFreeSpaceMap -- 空き領域マップが記録しているページ数を1ページにする
+ * (データファイルより古い空き領域マップが残った状態を作る)
+ */
+void shrinkFreeSpaceMap()
+{
+    FreeSpaceMap *fsm;
+
+    if ((fsm = openFreeSpaceMap(TABLE_NAME)) == NULL) {
+	return;
+    }
+    fsm->numPage = 1;
+    fsm->firstFreePage = 0;
+    fsm->headerModified = 1;
+    closeFreeSpaceMap(fsm);
+}
+
+/*
+ * test1 -- 挿入で空き領域マップが伸び、削除で空いたページが再利用される
+ */
+Result test1(int *numPage)
+{
+    TableInfo tableInfo;
+    int i;
+
+    /*
+     * 以下のテーブルを作成
+     * create table fsmtable (id integer, name string)
+     */
+    dropTable(TABLE_NAME);
+    strcpy(tableInfo.fieldInfo[0].name, "id");
+    tableInfo.fieldInfo[0].dataType = TYPE_INTEGER;
+    strcpy(tableInfo.fieldInfo[1].name, "name");
+    tableInfo.fieldInfo[1].dataType = TYPE_STRING;
+    tableInfo.numField = 2;
+    if (createTable(TABLE_NAME, &tableInfo) != OK) {
+	fprintf(stderr, "Cannot create table.\n");
+	return NG;
+    }
+
+    for (i = 0; i < NUM_RECORD; i++) {
+	if (changeRecord(i, 1) != OK) {
+	    fprintf(stderr, "Cannot insert record.\n");
+	    return NG;
+	}
+    }
+    *numPage = getNumPages(TABLE_NAME ".dat");
+    if (*numPage < 4 || checkFsmPages(*numPage) != OK) {
+	fprintf(stderr, "Wrong free space map after insert.\n");
+	return NG;
+    }
+
+    /* 0ページ目のレコードを削除すると、次の挿入はそこに入る */
+    return refillPage(10, NUM_RECORD, *numPage, keepFreeSpaceMap);
+}
+
+/*
+ * main -- 空き領域マップのテスト
+ */
+int main(int argc, char **argv)
+{
+    int numPage = 0;
+    Result result = OK;
+
+    if (initializeFileModule() != OK || initializeDataDefModule() != OK
+	|| initializeDataManipModule() != OK) {
+	fprintf(stderr, "%s: initialization failed.\n", TEST_NAME);
+	exit(1);
+    }
+
+    fprintf(stderr, "test1: Start\n\n");
+    if (test1(&numPage) == OK) {
+	fprintf(stderr, "test1: OK\n\n");
+    } else {
+	fprintf(stderr, "test1: NG\n\n");
+	result = NG;
+    }
+
+    /* 空き領域マップがなくなっても、データファイルを読んで作り直す */
+    fprintf(stderr, "test2: Start\n\n");
+    if (result == OK && refillPage(NUM_RECORD / 2, NUM_RECORD + 1, numPage,
+				   removeFreeSpaceMap) == OK) {
+	fprintf(stderr, "test2: OK\n\n");
+    } else {
+	fprintf(stderr, "test2: NG\n\n");
+	result = NG;
+    }
+
+    /* 記録したページ数がデータファイルと合わない空き領域マップも作り直す */
+    fprintf(stderr, "test3: Start\n\n");
+    if (result == OK && refillPage(NUM_RECORD * 3 / 4, NUM_RECORD + 2, numPage,
+				   shrinkFreeSpaceMap) == OK) {
+	fprintf(stderr, "test3: OK\n\n");
+    } else {
+	fprintf(stderr, "test3: NG\n\n");
+	result = NG;
+    }
+
+    dropTable(TABLE_NAME);
+    finalizeDataManipModule();
+    finalizeDataDefModule();
+    finalizeFileModule();
+    return result == OK ? 0 : 1;
+}
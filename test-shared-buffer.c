@@ -0,0 +1,241 @@
+/*
+ * 共有バッファプールテストプログラム
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "microdb.h"
+
+/*
+ * テスト名
+ */
+#define TEST_NAME "test-shared-buffer"
+
+/*
+ * テスト用ファイルのファイル名
+ */
+#define TEST_FILE "testfile-shared"
+
+/*
+ * バッファ数
+ */
+#define TEST_NUM_BUFFER 8
+
+/*
+ * writer -- 共有バッファプールにページを書き込むプロセス
+ *
+ * ファイルはクローズせずに(ディスクに書き戻さずに)readerの終了を待つ。
+ */
+Result writer(char *shmName, int toReader, int fromReader)
+{
+    File *file;
+    char page[PAGE_SIZE];
+    char c;
+
+    if (initializeFileModuleWithOption(TEST_NUM_BUFFER, shmName) != OK) {
+	fprintf(stderr, "%s: cannot attach shared buffer pool.\n", TEST_NAME);
+	return NG;
+    }
+
+    if ((file = openFile(TEST_FILE)) == NULL) {
+	fprintf(stderr, "Cannot open file.\n");
+	return NG;
+    }
+
+    /* 0ページ目と1ページ目を書き込む */
+    memset(page, 0, PAGE_SIZE);
+    strcpy(page, "shared page 0");
+    writePage(file, 0, page);
+    strcpy(page, "shared page 1");
+    writePage(file, 1, page);
+
+    /* readerに書き込みが終わったことを知らせ、読み終わるのを待つ */
+    c = 'w';
+    write(toReader, &c, 1);
+    read(fromReader, &c, 1);
+
+    closeFile(file);
+    finalizeFileModule();
+    return OK;
+}
+
+/*
+ * reader -- 別プロセスから書かれたページを読み出すプロセス
+ */
+Result reader(char *shmName, int toWriter, int fromWriter)
+{
+    File *file;
+    char page[PAGE_SIZE];
+    char c;
+    Result result = OK;
+
+    /* writerの書き込みを待つ */
+    read(fromWriter, &c, 1);
+
+    if (initializeFileModuleWithOption(TEST_NUM_BUFFER, shmName) != OK) {
+	fprintf(stderr, "%s: cannot attach shared buffer pool.\n", TEST_NAME);
+	return NG;
+    }
+
+    /* ディスク上のファイルはまだ空だが、バッファ上のページ数が見えるはず */
+    if (getNumPages(TEST_FILE) != 2) {
+	fprintf(stderr, "getNumPages: expected 2, got %d\n", getNumPages(TEST_FILE));
+	result = NG;
+    }
+
+    if ((file = openFile(TEST_FILE)) == NULL) {
+	fprintf(stderr, "Cannot open file.\n");
+	return NG;
+    }
+
+    if (readPage(file, 1, page) != OK || strcmp(page, "shared page 1") != 0) {
+	fprintf(stderr, "page 1 is not visible.\n");
+	result = NG;
+    }
+
+    if (readPage(file, 0, page) != OK || strcmp(page, "shared page 0") != 0) {
+	fprintf(stderr, "page 0 is not visible.\n");
+	result = NG;
+    }
+
+    closeFile(file);
+    finalizeFileModule();
+
+    c = 'r';
+    write(toWriter, &c, 1);
+    return result;
+}
+
+/*
+ * existsSharedBufferPool -- 共有メモリが残っているかどうか
+ */
+int existsSharedBufferPool(char *shmName)
+{
+    int desc;
+
+    if ((desc = shm_open(shmName, O_RDWR, 0)) == -1) {
+	return 0;
+    }
+    close(desc);
+    return 1;
+}
+
+/*
+ * flusher -- ファイルをクローズせずに終了処理をするプロセス
+ *
+ * 終了処理で、書き戻されていないページがディスクに書き戻されるはず。
+ */
+Result flusher(char *shmName)
+{
+    File *file;
+    char page[PAGE_SIZE];
+
+    if (initializeFileModuleWithOption(TEST_NUM_BUFFER, shmName) != OK) {
+	fprintf(stderr, "%s: cannot attach shared buffer pool.\n", TEST_NAME);
+	return NG;
+    }
+
+    if ((file = openFile(TEST_FILE)) == NULL) {
+	fprintf(stderr, "Cannot open file.\n");
+	return NG;
+    }
+
+    memset(page, 0, PAGE_SIZE);
+    strcpy(page, "flushed page 2");
+    if (writePage(file, 2, page) != OK) {
+	fprintf(stderr, "Cannot write page.\n");
+	return NG;
+    }
+
+    return finalizeFileModule();
+}
+
+/*
+ * readPageFromDisk -- バッファプールを経由せずにページを読む
+ */
+Result readPageFromDisk(int pageNum, char *page)
+{
+    int desc;
+    Result result = OK;
+
+    if ((desc = open(TEST_FILE, O_RDONLY)) == -1) {
+	return NG;
+    }
+    if (lseek(desc, (off_t)PAGE_SIZE * pageNum, SEEK_SET) == -1
+	|| read(desc, page, PAGE_SIZE) < PAGE_SIZE) {
+	result = NG;
+    }
+    close(desc);
+    return result;
+}
+
+/*
+ * main -- 共有バッファプールのテスト
+ */
+int main(int argc, char **argv)
+{
+    char shmName[64];
+    char page[PAGE_SIZE];
+    int toReader[2], toWriter[2];
+    int status;
+    pid_t pid;
+    Result result;
+
+    snprintf(shmName, sizeof(shmName), "/microdb-test-%d", (int)getpid());
+
+    deleteFile(TEST_FILE);
+    if (createFile(TEST_FILE) != OK) {
+	fprintf(stderr, "Cannot create file.\n");
+	exit(1);
+    }
+
+    pipe(toReader);
+    pipe(toWriter);
+
+    fprintf(stderr, "test1: Start\n\n");
+    if ((pid = fork()) == 0) {
+	exit(reader(shmName, toWriter[1], toReader[0]) == OK ? 0 : 1);
+    }
+
+    result = writer(shmName, toReader[1], toWriter[0]);
+    waitpid(pid, &status, 0);
+
+    /* 最後のプロセスの終了処理で、共有メモリは削除されているはず */
+    if (existsSharedBufferPool(shmName)) {
+	fprintf(stderr, "shared buffer pool is left behind.\n");
+	removeSharedBufferPool(shmName);
+	result = NG;
+    }
+
+    if (result == OK && WIFEXITED(status) && WEXITSTATUS(status) == 0
+	&& getNumPages(TEST_FILE) == 2) {
+	fprintf(stderr, "test1: OK\n\n");
+    } else {
+	fprintf(stderr, "test1: NG\n\n");
+	result = NG;
+    }
+
+    fprintf(stderr, "test2: Start\n\n");
+    if ((pid = fork()) == 0) {
+	exit(flusher(shmName) == OK ? 0 : 1);
+    }
+    waitpid(pid, &status, 0);
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0
+	&& readPageFromDisk(2, page) == OK && strcmp(page, "flushed page 2") == 0
+	&& !existsSharedBufferPool(shmName)) {
+	fprintf(stderr, "test2: OK\n\n");
+    } else {
+	fprintf(stderr, "test2: NG\n\n");
+	removeSharedBufferPool(shmName);
+	result = NG;
+    }
+
+    deleteFile(TEST_FILE);
+    return result == OK ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+/*
+ * zonemap.c -- ゾーンマップモジュール
+ *
+ * データファイルの各ページについて、整数型のフィールドごとに値の最小値と最大値を
+ * データ定義ファイルに記録する。整数の値との比較の条件で検索・削除するときに、条件に合うレコードがあり得ない
+ * ページを読まずに済ませられる。
+ *
+ * 最小値と最大値は挿入のたびに広げるが、削除では狭めない(ページが空になったときだけ
+ * 空として記録し直す)。記録した範囲は、ページに実際にある値の範囲を必ず含む。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "microdb.h"
+#include "error.h"
+
+/*
+ * ZONEMAP_FIRST_PAGE -- データ定義ファイルの中で、ゾーンマップを記録する最初のページ
+ *
+ * 0ページ目はデータ定義、1ページ目は統計情報(datadef.cを参照)。
+ */
+#define ZONEMAP_FIRST_PAGE 2
+
+/*
+ * ゾーンマップの構造
+ *
+ * 挿入のたびに別のファイルをオープンせずに済むよう、統計情報と同じ
+ * データ定義ファイルのZONEMAP_FIRST_PAGEページ目以降に記録する。
+ * データページ1つにつき、整数型のフィールドごとの(最小値, 最大値)の組を
+ * フィールドの順に並べた項目を記録する。1ページに入る項目の数を n とすると、
+ * データファイルのiページ目の項目は、(ZONEMAP_FIRST_PAGE + i / n)ページ目の
+ * (i % n)番目にある。最小値が最大値より大きい組は、そのページにレコードがないことを表す。
+ *
+ * 何ページ目までの項目が有効かは、統計情報(TableStatのnumZoneMapPage)に記録する。
+ * それより後ろの項目は、以前の内容が残っていても使わない。
+ */
+
+/*
+ * countZoneMapFields -- 最小値と最大値を記録するフィールドの数
+ *
+ * 引数:
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	整数型のフィールドの数(0ならゾーンマップは作らない)
+ */
+int countZoneMapFields(TableInfo *tableInfo)
+{
+    int numField = 0;
+    int i;
+
+    for (i = 0; i < tableInfo->numField; i++) {
+        if (tableInfo->fieldInfo[i].dataType == TYPE_INTEGER) {
+            numField++;
+        }
+    }
+    return numField;
+}
+
+/*
+ * getEntriesPerPage -- 1ページに入る項目の数
+ */
+static int getEntriesPerPage(ZoneMap *zoneMap)
+{
+    return PAGE_SIZE / (zoneMap->numField * 2 * sizeof(int));
+}
+
+/*
+ * getZoneMapEntry -- データページの項目を読み込み、その番地を返す
+ *
+ * 項目を含むページはzoneMap->pageに読み込んでおき、続けて同じページの
+ * 項目を使うときは読み直さない。有効な範囲より後ろの項目は空にしておく。
+ */
+static int *getZoneMapEntry(ZoneMap *zoneMap, int pageNum)
+{
+    int entriesPerPage = getEntriesPerPage(zoneMap);
+    int zonePageNum = pageNum / entriesPerPage;
+    int *p;
+    int i;
+
+    if (zonePageNum != zoneMap->cachedPageNum) {
+        if (zonePageNum * entriesPerPage >= zoneMap->numPage
+            || readPage(zoneMap->file, ZONEMAP_FIRST_PAGE + zonePageNum, zoneMap->page) != OK) {
+            memset(zoneMap->page, 0, PAGE_SIZE);
+        }
+        /* 有効な範囲より後ろの項目の(最小値, 最大値)の組をすべて空にする */
+        p = (int *) zoneMap->page;
+        i = zoneMap->numPage - zonePageNum * entriesPerPage;
+        for (i = (i > 0 ? i : 0) * zoneMap->numField; i < entriesPerPage * zoneMap->numField; i++) {
+            p[i * 2] = INT_MAX;
+            p[i * 2 + 1] = INT_MIN;
+        }
+        zoneMap->cachedPageNum = zonePageNum;
+    }
+
+    return (int *) zoneMap->page + (pageNum % entriesPerPage) * zoneMap->numField * 2;
+}
+
+/*
+ * writeZoneMapEntry -- getZoneMapEntryで読み込んだページをファイルに書き戻す
+ */
+static Result writeZoneMapEntry(ZoneMap *zoneMap, int pageNum)
+{
+    if (writePage(zoneMap->file, ZONEMAP_FIRST_PAGE + zoneMap->cachedPageNum, zoneMap->page) != OK) {
+        printErrorMessage(ERR_MSG_WRITE, __func__, __LINE__);
+        return NG;
+    }
+    if (pageNum >= zoneMap->numPage) {
+        zoneMap->numPage = pageNum + 1;
+    }
+    return OK;
+}
+
+/*
+ * openZoneMap -- ゾーンマップのオープン
+ *
+ * 引数:
+ *	file: openTableStatでオープンしたデータ定義ファイル
+ *	numPage: 項目が有効なデータページ数(統計情報のnumZoneMapPage、作り直すときは0)
+ *	tableInfo: テーブルのデータ定義情報
+ *
+ * 返り値:
+ *	オープンしたゾーンマップ
+ *	整数型のフィールドがない場合や、メモリが確保できない場合はNULLを返す
+ *
+ * ***注意***
+ *	使い終わったら必ずcloseZoneMapでクローズすること。fileはクローズしない。
+ *	項目が有効なデータページ数はzoneMap->numPageで分かるので、統計情報に記録しておくこと。
+ */
+ZoneMap *openZoneMap(File *file, int numPage, TableInfo *tableInfo)
+{
+    ZoneMap *zoneMap;
+    int numField = 0;
+    int i;
+
+    if (countZoneMapFields(tableInfo) == 0) {
+        return NULL;
+    }
+    if ((zoneMap = (ZoneMap *) malloc(sizeof(ZoneMap))) == NULL) {
+        printErrorMessage(ERR_MSG_MALLOC, __func__, __LINE__);
+        return NULL;
+    }
+
+    /* フィールドの番号から、項目の中での位置への対応を作る */
+    for (i = 0; i < MAX_FIELD; i++) {
+        zoneMap->column[i] = -1;
+        if (i < tableInfo->numField && tableInfo->fieldInfo[i].dataType == TYPE_INTEGER) {
+            zoneMap->column[i] = numField++;
+        }
+    }
+
+    zoneMap->file = file;
+    zoneMap->numPage = numPage > 0 ? numPage : 0;
+    zoneMap->numField = numField;
+    zoneMap->numTableField = tableInfo->numField;
+    zoneMap->cachedPageNum = -1;
+    return zoneMap;
+}
+
+/*
+ * closeZoneMap -- ゾーンマップのクローズ
+ *
+ * 引数:
+ *	zoneMap: クローズするゾーンマップ
+ *
+ * 返り値:
+ *	なし
+ */
+void closeZoneMap(ZoneMap *zoneMap)
+{
+    free(zoneMap);
+}
+
+/*
+ * addToZoneMap -- データページに格納したレコードの値を最小値と最大値に反映する
+ *
+ * 引数:
+ *	zoneMap: ゾーンマップ
+ *	pageNum: レコードを格納したデータページの番号
+ *	recordData: 格納したレコード
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ *
+ * データファイルの末尾にページを追加したときも、この関数で記録する。
+ */
+Result addToZoneMap(ZoneMap *zoneMap, int pageNum, RecordData *recordData)
+{
+    int *entry;
+    int modified = 0;
+    int value;
+    int i, n;
+
+    /* 記録のないページを飛ばしてページを追加したなら、飛ばしたページは何でもあり得るとしておく */
+    for (n = zoneMap->numPage; n < pageNum; n++) {
+        entry = getZoneMapEntry(zoneMap, n);
+        for (i = 0; i < zoneMap->numField; i++) {
+            entry[i * 2] = INT_MIN;
+            entry[i * 2 + 1] = INT_MAX;
+        }
+        if (writeZoneMapEntry(zoneMap, n) != OK) {
+            return NG;
+        }
+    }
+
+    /*
+     * 値が範囲の外なら広げる
+     * (recordDataのnumFieldは呼び出し側が設定していないことがあるので、
+     * フィールドの数はテーブルの定義から取る)
+     */
+    entry = getZoneMapEntry(zoneMap, pageNum);
+    for (i = 0; i < zoneMap->numTableField; i++) {
+        if ((n = zoneMap->column[i]) == -1) {
+            continue;
+        }
+        value = recordData->fieldData[i].intValue;
+        if (value < entry[n * 2]) {
+            entry[n * 2] = value;
+            modified = 1;
+        }
+        if (value > entry[n * 2 + 1]) {
+            entry[n * 2 + 1] = value;
+            modified = 1;
+        }
+    }
+
+    if (modified || pageNum >= zoneMap->numPage) {
+        return writeZoneMapEntry(zoneMap, pageNum);
+    }
+    return OK;
+}
+
+/*
+ * clearZoneMap -- データページが空になったことの記録
+ *
+ * 引数:
+ *	zoneMap: ゾーンマップ
+ *	pageNum: 空になったデータページの番号
+ *
+ * 返り値:
+ *	成功ならOK、失敗ならNGを返す
+ */
+Result clearZoneMap(ZoneMap *zoneMap, int pageNum)
+{
+    int *entry;
+    int i;
+
+    if (pageNum >= zoneMap->numPage) {
+        return OK;
+    }
+
+    entry = getZoneMapEntry(zoneMap, pageNum);
+    for (i = 0; i < zoneMap->numField; i++) {
+        entry[i * 2] = INT_MAX;
+        entry[i * 2 + 1] = INT_MIN;
+    }
+    return writeZoneMapEntry(zoneMap, pageNum);
+}
+
+/*
+ * truncateZoneMap -- データファイルを切り詰めたことの記録
+ *
+ * 引数:
+ *	zoneMap: ゾーンマップ
+ *	numPage: 切り詰めた後のデータファイルのページ数
+ *
+ * 返り値:
+ *	なし
+ *
+ * 切り詰めるページは、先にclearZoneMapで空にしておくこと
+ * (後でページを追加したときに、その項目を空から広げるため)。
+ */
+void truncateZoneMap(ZoneMap *zoneMap, int numPage)
+{
+    if (numPage < zoneMap->numPage) {
+        zoneMap->numPage = numPage;
+    }
+}
+
+/*
+ * checkZoneMap -- データページに条件に合うレコードがあり得るかどうか
+ *
+ * 引数:
+ *	zoneMap: ゾーンマップ
+ *	pageNum: データページの番号
+ *	field: 条件のフィールドの番号
+ *	condition: 条件
+ *
+ * 返り値:
+ *	条件に合うレコードがあり得なければ0、あり得れば1を返す
+ *	(記録のないページ、整数の値との比較でない条件では1を返す)
+ */
+int checkZoneMap(ZoneMap *zoneMap, int pageNum, int field, Condition *condition)
+{
+    int *entry;
+    int min, max;
+    int value;
+
+    if (pageNum >= zoneMap->numPage || field < 0 || field >= MAX_FIELD
+        || zoneMap->column[field] == -1 || condition->dataType != TYPE_INTEGER) {
+        return 1;
+    }
+
+    entry = getZoneMapEntry(zoneMap, pageNum);
+    min = entry[zoneMap->column[field] * 2];
+    max = entry[zoneMap->column[field] * 2 + 1];
+    if (min > max) {
+        /* 空のページ */
+        return 0;
+    }
+
+    value = condition->intValue;
+    switch (condition->operator) {
+        case OPR_EQUAL:
+            return min <= value && value <= max;
+        case OPR_NOT_EQUAL:
+            return !(min == value && max == value);
+        case OPR_GREATER_THAN:
+            return max > value;
+        case OPR_LESS_THAN:
+            return min < value;
+        default:
+            return 1;
+    }
+}